@@ -37,6 +37,13 @@ public:
      */
     static bool checkPermissions(const crow::request& req, AccessLevel required_level);
     
+    /**
+     * @brief Verifica un token ya extraído (mismo criterio que checkPermissions)
+     * 
+     * Lo usa también el WebSocket, que recibe el token en el comando "auth"
+     */
+    static bool checkToken(const std::string& token, AccessLevel required_level);
+    
     /**
      * @brief Extrae el token del header Authorization
      */
@@ -6,6 +6,8 @@
 
 namespace Handlers {
 
+class WebSocketHandler;
+
 /**
  * @brief Gestor de endpoints HTTP para control del mouse y teclado
  */
@@ -27,6 +29,15 @@ public:
      */
     static crow::response handleKeyPress(const crow::request& req);
 
+    /**
+     * @brief Encola un texto completo (UTF-8) para el thread de entrada
+     * 
+     * Espera JSON: {"text": "Hola, Mundo!", "layout": "latam"}  // layout opcional
+     * Responde 202 sin esperar a que se escriba, o 503 si la cola está llena.
+     * REQUIERE: Autenticación y permisos de FULL_CONTROL
+     */
+    static crow::response handleTypeText(const crow::request& req, WebSocketHandler& input);
+
     /**
      * @brief Endpoint de salud del servidor
      * NO REQUIERE autenticación
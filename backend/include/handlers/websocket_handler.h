@@ -2,11 +2,35 @@
 #define WEBSOCKET_HANDLER_H
 
 #include "crow/websocket.h"
+#include "../types.h"
+#include "../stream/frame_pool.h"
+#include "../stream/event_count.h"
+#include "../stream/frame_scheduler.h"
+#include "../stream/layer_selector.h"
+#include "../stream/scroll_detector.h"
+#include "../stream/send_queue.h"
+#include "../stream/spsc_queue.h"
+#include "../stream/stage_stats.h"
+#include "../stream/tile_classifier.h"
+#include "../stream/tile_encoder.h"
+#include "../stream/viewport.h"
+#include "../syscalls/screen_ring.h"
+#include "../utils/frame_protocol.h"
+#include "../utils/input_protocol.h"
+#include "../utils/jpeg_encoder.h"
+#include "../utils/keymap.h"
+#include "../utils/qoi_codec.h"
+#include <cstdint>
+#include <deque>
 #include <memory>
-#include <set>
+#include <map>
+#include <string>
+#include <vector>
 #include <mutex>
+#include <condition_variable>
 #include <thread>
 #include <atomic>
+#include <chrono>
 
 namespace Handlers {
 
@@ -18,22 +42,321 @@ namespace Handlers {
  */
 class WebSocketHandler {
 private:
-    std::set<crow::websocket::connection*> connections_;  // Conexiones activas
+    /**
+     * @brief Estado negociado por cada cliente
+     */
+    struct ClientState {
+        bool binary_frames;    // true: frames binarios, false: JSON + Base64 (legado)
+        bool needs_keyframe;   // Recién conectado o desincronizado: necesita un frame completo
+        bool subscribed;       // false: el cliente pausó el streaming (stop_stream)
+        Utils::FrameCodec codec;   // Codec de los frames binarios (los JSON siempre son JPEG)
+        Stream::StreamLayer layer; // Capa de calidad (solo JPEG; el resto usa HIGH)
+        bool layer_auto;           // La capa la elige 'selector' según la cola de envío
+        Stream::LayerSelector selector;
+        bool has_viewport;         // Solo recibe 'viewport' (FrameType::VIEWPORT), nunca la pantalla completa
+        Stream::Viewport viewport;
+        bool can_view;             // Se autenticó ("auth") con permiso de lectura: puede pedir "stats"
+        bool can_control;          // Se autenticó ("auth") con permiso de control: acepta entrada binaria
+        std::vector<uint16_t> held_keys;      // Teclas presionadas por el cliente y no soltadas
+        std::vector<uint16_t> held_buttons;   // Ídem botones del mouse
+        std::shared_ptr<Stream::SendQueue> queue;  // Cola de salida propia de la conexión
+
+        ClientState()
+            : binary_frames(false), needs_keyframe(true), subscribed(true),
+              codec(Utils::FrameCodec::JPEG), layer(Stream::StreamLayer::HIGH), layer_auto(true),
+              has_viewport(false), can_view(false), can_control(false) {}
+    };
+
+    /**
+     * @brief Frame capturado que espera a la etapa de codificación
+     *
+     * Los slots de la cola se reutilizan: 'dirty' conserva su capacidad.
+     */
+    struct CapturedFrame {
+        Stream::FrameRef raw;                  // Slot de raw_pool_ (vacío con screen_ring)
+        const unsigned char* bgra;             // Pixeles (en 'raw' o en el anillo)
+        screen_capture_info info;
+        bool partial;                          // Solo se capturó 'region' (todos los clientes usan viewport)
+        Stream::TileRect region;               // Zona capturada en 'bgra' (la pantalla si !partial)
+        std::vector<Stream::TileRect> dirty;   // Regiones modificadas (en coordenadas de pantalla)
+        std::vector<Stream::MoveRect> moves;   // Copias por scroll (las llena la codificación)
+        bool periodic_keyframe;
+        std::chrono::steady_clock::time_point captured_at;
+
+        CapturedFrame() : bgra(nullptr), info(), partial(false), region(), periodic_keyframe(false) {}
+    };
+
+    /**
+     * @brief Imagen de un viewport codificada en este tick
+     *
+     * Los clientes con el mismo viewport y codec comparten el mensaje.
+     */
+    struct ViewportJob {
+        Stream::Viewport viewport;
+        Utils::FrameCodec codec;
+        Stream::OutgoingMessage message;   // Vacío si no se pudo codificar
+    };
+
+    /**
+     * @brief Evento de entrada recibido que espera al thread de entrada
+     *
+     * Con 'text' es un comando "type": se escribe en orden con el resto de
+     * la entrada y se responde con "typed" en lugar de input_ack.
+     */
+    struct PendingInput {
+        Utils::InputMessage message;
+        std::shared_ptr<Stream::SendQueue> queue;   // Para devolver el input_ack
+        std::chrono::steady_clock::time_point received_at;
+        std::shared_ptr<const std::string> text;    // nullptr si no es "type"
+        Utils::KeyboardLayout layout = Utils::KeyboardLayout::US;
+        int typed = -1;                              // Caracteres escritos, -1 si falló
+        bool release = false;                        // Liberación al cerrar la conexión: sin posición ni ack
+    };
+
+    /**
+     * @brief Representación del stream: un codec y, para JPEG, una capa de calidad
+     *
+     * Cada variante se codifica a lo sumo una vez por frame y la comparten
+     * todos los clientes que la usan.
+     */
+    struct StreamVariant {
+        Utils::FrameCodec codec;
+        Stream::StreamLayer layer;
+        Utils::ImageEncoder* encoder;
+        std::vector<unsigned char> frame_data;      // Frame completo codificado
+        std::vector<unsigned char> tiles_payload;   // Payload del mensaje TILES
+
+        StreamVariant()
+            : codec(Utils::FrameCodec::JPEG), layer(Stream::StreamLayer::HIGH), encoder(nullptr) {}
+    };
+
+    // JPEG, QOI y MIXED, más las capas inferiores de JPEG
+    static const size_t VARIANT_COUNT = 3 + Stream::LAYER_COUNT - 1;
+
+    // Buffers preasignados: declarados antes de connections_ para que las
+    // colas (que guardan referencias a sus slots) se destruyan primero
+    Stream::FramePool raw_pool_;                          // Capturas BGRA (sin screen_ring)
+    Stream::FramePool message_pool_;                      // Mensajes binarios listos para enviar
+
+    // Captura -> codificación: cada elemento ocupa un slot de captura hasta
+    // que se codifica, por eso hay Config::PIPELINE_FRAMES + 1 slots
+    Stream::SpscQueue<CapturedFrame> pipeline_;
+    Stream::EventCount pipeline_event_;                   // Para dormir con la cola vacía o llena
+
+    std::map<crow::websocket::connection*, ClientState> connections_;  // Conexiones activas
     std::mutex connections_mutex_;                        // Mutex para thread-safety
-    std::thread screenshot_thread_;                       // Thread para screenshots
+    std::condition_variable demand_cv_;                   // Avisa cambios de suscriptores o stop()
+    size_t subscribers_;                                  // Conexiones con streaming activo
+    std::thread screenshot_thread_;                       // Etapa de captura
+    std::thread encode_thread_;                           // Etapa de codificación y encolado
     std::thread resources_thread_;                        // Thread para recursos
+    std::thread input_thread_;                            // Inyección de la entrada binaria
     std::atomic<bool> running_;                           // Flag de ejecución
+    std::atomic<bool> keyframe_pending_;                  // Algún cliente espera un keyframe
+    uint32_t frame_id_;                                   // Contador de frames enviados
+    Stream::FrameScheduler scheduler_;                    // Frecuencia de captura adaptativa
+
+    // Estado del thread de screenshots (buffers reutilizados entre frames)
+    Syscalls::ScreenRing screen_ring_;                    // Anillo mapeado del kernel (si existe)
+    // update() corre en la captura y encodeTiles() en la codificación: usan
+    // estado distinto del encoder
+    Stream::TileEncoder tile_encoder_;                    // Detección de regiones modificadas
+    Stream::TileRect last_region_;                        // Zona de la captura anterior
+
+    // Estado del thread de codificación
+    Utils::JpegEncoder jpeg_encoder_;
+    Utils::JpegEncoder jpeg_video_encoder_;               // Calidad baja para tiles de video
+    Utils::JpegEncoder jpeg_low_encoder_;                 // Capa "low"
+    Utils::JpegEncoder jpeg_half_encoder_;                // Capa "half"
+    Utils::QoiEncoder qoi_encoder_;
+    StreamVariant variants_[VARIANT_COUNT];               // Indexado por variantIndex()
+    std::vector<unsigned char> half_frame_;               // Frame a mitad de resolución (capa "half")
+    std::vector<Stream::TileRect> half_rects_;            // Regiones modificadas a mitad de resolución
+    Stream::TileClassifier tile_classifier_;              // Tratamiento por tile (codec MIXED)
+    std::vector<Stream::ClassifiedRect> regions_;
+    Stream::ScrollDetector scroll_detector_;              // Copias de rectángulos al hacer scroll
+    std::vector<unsigned char> moves_payload_;
+    Stream::ViewportScaler viewport_scaler_;              // Recorte y escala de los viewports
+    std::vector<unsigned char> viewport_data_;
+    std::vector<ViewportJob> viewport_jobs_;
+
+    // Entrada binaria: los threads de Crow encolan y el thread de entrada inyecta.
+    // El movimiento no se encola: solo se guarda la última posición
+    std::deque<PendingInput> input_queue_;
+    std::mutex input_mutex_;
+    std::condition_variable input_cv_;
+    bool motion_pending_;
+    PendingInput motion_;                                 // Posición más nueva sin inyectar
+    std::chrono::steady_clock::time_point motion_injected_at_;
+    uint64_t input_events_;                               // Eventos inyectados
+    uint64_t input_dropped_;                              // Descartados con la cola llena
+    uint64_t input_failed_;                               // En lotes que el kernel rechazó
+    uint64_t input_coalesced_;                            // Posiciones reemplazadas por una más nueva
+    Stream::StageStats input_stats_;                      // Desde que llega hasta que se inyecta
+
+    // Latencia por etapa (el envío la mide cada SendQueue)
+    Stream::StageStats capture_stats_;                    // Captura + detección de tiles
+    Stream::StageStats encode_stats_;                     // JPEG/tiles/Base64 + encolado
+    Stream::StageStats pipeline_stats_;                   // Desde la captura hasta las colas de envío
+
+    /**
+     * @brief Bloquea hasta que haya al menos una conexión suscrita
+     *
+     * @return false si el handler se detuvo mientras esperaba
+     */
+    bool waitForSubscribers();
+
+    /**
+     * @brief Cambia la suscripción de una conexión (start_stream/stop_stream)
+     */
+    void setSubscribed(crow::websocket::connection& conn, bool subscribed);
+
+    /**
+     * @brief Decide si alcanza con capturar una región de la pantalla
+     *
+     * Solo cuando todos los clientes suscritos usan viewport y no hay
+     * screen_ring (el anillo entrega el frame completo sin copiarlo).
+     *
+     * @param region Unión de los viewports
+     * @return true si hay que capturar solo 'region'
+     */
+    bool captureRegion(Stream::TileRect& region);
+
+    /**
+     * @brief Captura un frame
+     *
+     * Usa el anillo mapeado de screen_ring si el kernel lo soporta; si no,
+     * captura con screen_live en un slot de raw_pool_ (que queda en 'raw'),
+     * solo la región pedida si 'region' no es nullptr.
+     *
+     * @param raw Slot del pool usado (vacío si se usó el anillo)
+     * @param bgra Puntero al frame capturado
+     * @param damage Bitmap de tiles modificados del kernel (nullptr si no hay)
+     * @param region Región a capturar (nullptr: la pantalla completa)
+     * @return int 0 si es exitoso, -1 en caso de error
+     */
+    int captureFrame(Stream::FrameRef& raw, const unsigned char*& bgra,
+                     const uint8_t*& damage, screen_capture_info& info,
+                     const Stream::TileRect* region);
+
+    /**
+     * @brief Espera a que el kernel vea un cambio en la pantalla
+     *
+     * Vuelve al cambiar la pantalla, al llegar a 'deadline', si algún
+     * cliente necesita un keyframe o si el handler se detiene.
+     */
+    void waitForScreenChange(std::chrono::steady_clock::time_point deadline);
+
+    /**
+     * @brief Espera un slot libre en el pipeline (etapa de captura)
+     *
+     * @return nullptr si el handler se detuvo mientras esperaba
+     */
+    CapturedFrame* waitForPipelineSlot();
+
+    /**
+     * @brief Despierta a las etapas que esperan en el pipeline
+     */
+    void notifyPipeline();
 
     /**
-     * @brief Loop que envía screenshots continuamente
+     * @brief Etapa de captura: captura y detecta regiones mientras haya clientes suscritos
+     *
+     * Mientras se captura el frame N+1, el thread de codificación procesa
+     * el N y los threads de envío mandan el N-1.
      */
     void screenshotLoop();
 
     /**
-     * @brief Loop que envía recursos del sistema continuamente
+     * @brief Etapa de codificación: toma los frames capturados y los encola a cada cliente
+     */
+    void encodeLoop();
+
+    /**
+     * @brief Loop que envía recursos del sistema mientras haya clientes suscritos
      */
     void resourcesLoop();
 
+    /**
+     * @brief Thread de entrada: inyecta los eventos encolados por handleMessage
+     *
+     * Todo lo que se acumuló mientras se inyectaba el lote anterior va en
+     * una sola llamada a input_batch; después cada cliente recibe un
+     * input_ack con el último seq inyectado. Si solo hay movimiento, se
+     * inyecta a lo sumo una posición cada Config::INPUT_MOTION_TICK_US.
+     */
+    void inputLoop();
+
+    /**
+     * @brief Encola los mensajes de entrada binarios de una conexión autenticada
+     *
+     * Un MOVE reemplaza la posición pendiente. Antes de encolar otro evento
+     * la posición pendiente pasa a la cola para conservar el orden, salvo
+     * ante un botón, que trae su propia posición y la deja obsoleta.
+     */
+    void queueInput(crow::websocket::connection& conn, const std::string& message);
+
+    /**
+     * @brief Encola la liberación de lo que el cliente dejó presionado
+     *
+     * Se llama con connections_mutex_ tomado, al cerrar la conexión.
+     */
+    void queueReleases(const ClientState& client);
+
+    /**
+     * @brief Encola un comando "type" para el thread de entrada
+     *
+     * Con queue nullptr (POST /api/keyboard/type) no se responde "typed".
+     *
+     * @return false si la cola de entrada está llena
+     */
+    bool queueText(const std::shared_ptr<Stream::SendQueue>& queue, std::string text,
+                   Utils::KeyboardLayout layout);
+
+    /**
+     * @brief Inyecta un lote de eventos (input_batch o, sin él, las syscalls de una acción)
+     *
+     * Deja en 'typed' de cada "type" los caracteres escritos.
+     *
+     * @return false si input_batch rechazó el lote (no se aplicó, o no completo)
+     */
+    bool injectInput(std::vector<PendingInput>& events);
+
+    /**
+     * @brief Envía el frame capturado a cada cliente según su estado
+     *
+     * Los clientes binarios reciben solo las regiones modificadas (TILES),
+     * precedidas por las copias de rectángulo si hubo scroll,
+     * salvo cuando necesitan un keyframe (al conectarse o cada
+     * Config::KEYFRAME_INTERVAL frames). Los clientes JSON reciben el
+     * frame completo cuando algo cambió. Antes de decidir, los clientes
+     * JPEG con capa automática actualizan su capa según su cola de envío.
+     * Cada representación (por codec y capa) se codifica una sola vez y
+     * solo si algún cliente la necesita; el mismo buffer se comparte entre
+     * las colas de envío de todas las conexiones.
+     * Los mensajes binarios se escriben en slots de message_pool_; si no
+     * queda ninguno libre el tick se omite y los clientes afectados
+     * reciben un keyframe en el siguiente.
+     */
+    void broadcastFrame(const CapturedFrame& frame);
+
+    /**
+     * @brief Envía a los clientes con viewport su región, recortada y escalada
+     *
+     * Cada viewport distinto se codifica una vez (JPEG, o QOI si el cliente
+     * lo pidió) y solo si algo cambió dentro de él o el cliente necesita
+     * un frame completo. Todos los mensajes son keyframes de la región.
+     */
+    void broadcastViewports(const CapturedFrame& frame);
+
+    /**
+     * @brief Cambia la capa de un cliente y se lo avisa (llamar con connections_mutex_)
+     *
+     * Entre capas de la misma resolución los tiles siguen aplicándose sobre
+     * la imagen del cliente; entrar o salir de "half" necesita un keyframe.
+     */
+    void setLayer(ClientState& client, Stream::StreamLayer layer);
+
 public:
     WebSocketHandler();
     ~WebSocketHandler();
@@ -50,9 +373,12 @@ public:
 
     /**
      * @brief Maneja mensajes entrantes del cliente
+     *
+     * Los de texto son comandos JSON; los binarios, eventos de entrada
+     * (Utils::InputMessage) que solo se aceptan tras el comando "auth".
      */
     void handleMessage(crow::websocket::connection& conn, 
-                      const std::string& message);
+                      const std::string& message, bool is_binary = false);
 
     /**
      * @brief Inicia los threads de transmisión
@@ -65,9 +391,35 @@ public:
     void stop();
 
     /**
-     * @brief Envía un mensaje a todos los clientes conectados
+     * @brief Avisa que llegó un evento de entrada (mouse/teclado)
+     *
+     * Sube la frecuencia de captura y el muestreo de cambios del kernel
+     * para que el resultado se vea enseguida.
+     */
+    void notifyInput();
+
+    /**
+     * @brief Encola el texto de POST /api/keyboard/type para el thread de entrada
+     *
+     * El worker HTTP no espera a que se escriba.
+     *
+     * @return false si la cola de entrada está llena
+     */
+    bool queueTypeText(std::string text, Utils::KeyboardLayout layout);
+
+    /**
+     * @brief Encola un mensaje de telemetría para todos los clientes conectados
+     *
+     * No envía directamente: cada conexión lo despacha desde su propia cola.
      */
     void broadcast(const std::string& message);
+
+    /**
+     * @brief Estadísticas de las colas de envío por conexión en JSON
+     *
+     * Incluye formato, profundidad de la cola y frames enviados/descartados.
+     */
+    std::string getStatsJSON();
 };
 
 } // namespace Handlers
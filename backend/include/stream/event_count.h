@@ -0,0 +1,64 @@
+#ifndef EVENT_COUNT_H
+#define EVENT_COUNT_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace Stream {
+
+/**
+ * @brief Espera sin locks a que cambie el estado de una estructura lock-free
+ *
+ * Quien espera llama a await() con la condición; quien cambia el estado
+ * llama a notify() después. notify() solo hace una syscall (futex) si hay
+ * alguien durmiendo: con la cola del pipeline fluyendo, publicar o liberar
+ * un frame cuesta una barrera y una lectura, sin mutex ni condition_variable.
+ *
+ * La condición se vuelve a evaluar después de registrarse como durmiente,
+ * así un notify() entre la evaluación y el futex no se pierde.
+ */
+class EventCount {
+public:
+    EventCount();
+
+    EventCount(const EventCount&) = delete;
+    EventCount& operator=(const EventCount&) = delete;
+
+    /**
+     * @brief Bloquea hasta que ready() devuelva true
+     */
+    template <typename Predicate>
+    void await(Predicate ready) {
+        while (!ready()) {
+            uint32_t epoch = prepareWait();
+            if (ready()) {
+                cancelWait();
+                return;
+            }
+            wait(epoch);
+        }
+    }
+
+    /**
+     * @brief Despierta a los que esperan (después de cambiar el estado)
+     */
+    void notify();
+
+    /**
+     * @brief Veces que notify() tuvo que despertar a alguien
+     */
+    uint64_t wakeups() const { return wakeups_.load(std::memory_order_relaxed); }
+
+private:
+    uint32_t prepareWait();
+    void cancelWait();
+    void wait(uint32_t epoch);
+
+    std::atomic<uint32_t> epoch_;     // Palabra del futex: avanza con cada aviso
+    std::atomic<uint32_t> waiters_;   // Threads entre prepareWait() y el final de wait()
+    std::atomic<uint64_t> wakeups_;
+};
+
+} // namespace Stream
+
+#endif // EVENT_COUNT_H
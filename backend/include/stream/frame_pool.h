@@ -0,0 +1,106 @@
+#ifndef FRAME_POOL_H
+#define FRAME_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace Stream {
+
+class FramePool;
+
+/**
+ * @brief Referencia a un slot del pool (conteo de referencias)
+ *
+ * Copiar la referencia comparte el slot; cuando se destruye la última
+ * copia el slot vuelve a estar libre. Así un frame pasa de captura a
+ * codificación y a las colas de envío sin copiar bytes ni reservar memoria.
+ */
+class FrameRef {
+public:
+    FrameRef() : pool_(nullptr), slot_(0) {}
+    FrameRef(const FrameRef& other);
+    FrameRef(FrameRef&& other) noexcept;
+    FrameRef& operator=(const FrameRef& other);
+    FrameRef& operator=(FrameRef&& other) noexcept;
+    ~FrameRef();
+
+    explicit operator bool() const { return pool_ != nullptr; }
+
+    unsigned char* data() const;
+    size_t capacity() const;
+
+    /**
+     * @brief Bytes válidos escritos en el slot
+     */
+    size_t size() const;
+    void setSize(size_t size);
+
+    /**
+     * @brief Suelta la referencia antes de que se destruya el objeto
+     */
+    void reset();
+
+private:
+    friend class FramePool;
+    FrameRef(FramePool* pool, size_t slot) : pool_(pool), slot_(slot) {}
+
+    FramePool* pool_;
+    size_t slot_;
+};
+
+/**
+ * @brief Anillo fijo de buffers preasignados y alineados a página
+ *
+ * Todos los slots se reservan en el constructor; acquire() solo busca uno
+ * libre, por lo que en régimen estable no hay reservas de memoria por
+ * frame. El pool debe vivir más que todas sus referencias.
+ */
+class FramePool {
+public:
+    /**
+     * @param slot_count Número de slots
+     * @param slot_capacity Bytes por slot (se redondea a múltiplo de página)
+     */
+    FramePool(size_t slot_count, size_t slot_capacity);
+    ~FramePool();
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    /**
+     * @brief Toma un slot libre
+     *
+     * @return FrameRef vacío si todos los slots están en uso
+     */
+    FrameRef acquire();
+
+    size_t slotCount() const { return slot_count_; }
+    size_t slotCapacity() const { return slot_capacity_; }
+
+    /**
+     * @brief Slots libres en este momento
+     */
+    size_t available() const;
+
+private:
+    friend class FrameRef;
+
+    struct Slot {
+        unsigned char* data;
+        size_t size;
+        std::atomic<int> refs;
+    };
+
+    void retain(size_t slot);
+    void release(size_t slot);
+
+    const size_t slot_count_;
+    size_t slot_capacity_;
+    std::unique_ptr<Slot[]> slots_;
+    std::atomic<size_t> next_;               // Punto de partida de la búsqueda (anillo)
+};
+
+} // namespace Stream
+
+#endif // FRAME_POOL_H
@@ -0,0 +1,84 @@
+#ifndef FRAME_SCHEDULER_H
+#define FRAME_SCHEDULER_H
+
+#include "../types.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace Stream {
+
+/**
+ * @brief Decide cuándo capturar el siguiente frame
+ *
+ * Tras un evento de entrada (click, tecla) el intervalo baja de inmediato
+ * a 1/Config::MAX_FPS y se mantiene así durante Config::INPUT_BOOST_MS.
+ * Mientras la pantalla cambia el intervalo se reduce a la mitad en cada
+ * frame; cuando deja de cambiar se duplica hasta volver a 1/Config::IDLE_FPS.
+ * El tiempo de captura y codificación se descuenta de la espera.
+ *
+ * Si el kernel puede avisar cambios (screen_ring_wait) el loop usa
+ * waitMinInterval(): el siguiente frame lo dispara la pantalla y el
+ * scheduler solo limita la frecuencia a Config::MAX_FPS.
+ */
+class FrameScheduler {
+public:
+    explicit FrameScheduler(int max_fps = Config::MAX_FPS, int idle_fps = Config::IDLE_FPS);
+
+    FrameScheduler(const FrameScheduler&) = delete;
+    FrameScheduler& operator=(const FrameScheduler&) = delete;
+
+    /**
+     * @brief Registra un evento de entrada; interrumpe una espera larga
+     *
+     * Se puede llamar desde cualquier thread (handlers HTTP).
+     */
+    void notifyInput();
+
+    /**
+     * @brief Despierta al thread que espera (por ejemplo, al detener el handler)
+     */
+    void wake();
+
+    /**
+     * @brief Ajusta el intervalo según el frame terminado y espera al siguiente
+     *
+     * @param frame_start Momento en que empezó la captura del frame
+     * @param changed true si el frame tuvo regiones modificadas
+     */
+    void waitNextFrame(std::chrono::steady_clock::time_point frame_start, bool changed);
+
+    /**
+     * @brief Modo por eventos: espera solo el intervalo mínimo (Config::MAX_FPS)
+     *
+     * @param frame_start Momento en que empezó la captura del frame
+     * @return Momento a partir del cual capturar aunque la pantalla no
+     *         cambie (1/Config::IDLE_FPS después de frame_start)
+     */
+    std::chrono::steady_clock::time_point waitMinInterval(
+        std::chrono::steady_clock::time_point frame_start);
+
+    /**
+     * @brief Frecuencia objetivo actual (frames por segundo)
+     */
+    int currentFps() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    const std::chrono::milliseconds min_interval_;
+    const std::chrono::milliseconds idle_interval_;
+    std::atomic<long> interval_ms_;          // Intervalo actual (lo lee currentFps)
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    Clock::time_point last_input_;
+    Clock::time_point last_frame_start_;     // Para medir la frecuencia en modo por eventos
+    bool input_pending_;                     // Llegó entrada durante la espera
+    bool woken_;
+};
+
+} // namespace Stream
+
+#endif // FRAME_SCHEDULER_H
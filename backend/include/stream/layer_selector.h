@@ -0,0 +1,104 @@
+#ifndef LAYER_SELECTOR_H
+#define LAYER_SELECTOR_H
+
+#include "../types.h"
+#include "send_queue.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Stream {
+
+/**
+ * @brief Capas de calidad del stream (simulcast), de mayor a menor costo
+ *
+ * Cada capa se codifica una sola vez por frame y la comparten todos los
+ * clientes suscritos a ella.
+ */
+enum class StreamLayer : uint8_t {
+    HIGH = 0,   // Resolución completa, Config::JPEG_QUALITY
+    LOW = 1,    // Resolución completa, Config::LAYER_LOW_QUALITY
+    HALF = 2    // Mitad de resolución, Config::LAYER_HALF_QUALITY
+};
+
+const size_t LAYER_COUNT = 3;
+
+const char* layerName(StreamLayer layer);
+
+/**
+ * @brief Interpreta "high" | "low" | "half"
+ *
+ * @return false si el nombre no es una capa
+ */
+bool parseLayer(const std::string& name, StreamLayer& layer);
+
+/**
+ * @brief Elige la capa de una conexión según cuánto drena su cola de envío
+ *
+ * Cada Config::LAYER_WINDOW_MS compara los frames encolados con los que la
+ * cola descartó antes de enviarlos y mide cuánto tiempo estuvo frenada
+ * esperando las confirmaciones del cliente (SendQueueStats::stalled_us).
+ * Si drenó menos del Config::LAYER_DOWN_DRAIN_PERCENT o estuvo frenada al
+ * menos el Config::LAYER_DOWN_STALL_PERCENT de la ventana baja una capa.
+ * Tras Config::LAYER_UP_HOLD_MS sin descartes ni esperas largas prueba la
+ * capa superior; si la
+ * prueba falla (baja de nuevo antes de que pase otra espera) la espera se
+ * duplica hasta Config::LAYER_UP_HOLD_MAX_MS, así un enlace lento no
+ * oscila entre capas.
+ */
+class LayerSelector {
+public:
+    LayerSelector();
+
+    /**
+     * @brief Vuelve a HIGH y olvida las mediciones (conexión nueva o capa fija)
+     */
+    void reset();
+
+    /**
+     * @brief Registra los contadores acumulados de la cola de envío (SendQueue::stats)
+     *
+     * @return true si la capa cambió
+     */
+    bool update(const SendQueueStats& stats, std::chrono::steady_clock::time_point now);
+
+    StreamLayer layer() const { return layer_; }
+
+    /**
+     * @brief Porcentaje de frames drenados en la última ventana (100 = ninguno descartado)
+     */
+    int drainPercent() const { return drain_percent_; }
+
+    /**
+     * @brief Velocidad de envío medida en la última ventana (kbit/s)
+     */
+    uint64_t drainKbps() const { return drain_kbps_; }
+
+    /**
+     * @brief Porcentaje de la última ventana con frames frenados por el cliente
+     */
+    int stallPercent() const { return stall_percent_; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    StreamLayer layer_;
+    bool started_;                      // Ya hay contadores de referencia
+    Clock::time_point window_start_;
+    uint64_t window_queued_;            // Contadores al empezar la ventana
+    uint64_t window_dropped_;
+    uint64_t window_bytes_;             // Bytes confirmados (o enviados, sin acks)
+    uint64_t window_stalled_us_;
+    Clock::time_point stable_since_;    // Última bajada de capa (o inicio)
+    Clock::time_point raised_at_;       // Última subida (para detectar pruebas fallidas)
+    bool probing_;                      // La subida todavía no superó una espera
+    std::chrono::milliseconds hold_;    // Espera actual antes de subir
+    int drain_percent_;
+    uint64_t drain_kbps_;
+    int stall_percent_;
+};
+
+} // namespace Stream
+
+#endif // LAYER_SELECTOR_H
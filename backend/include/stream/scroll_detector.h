@@ -0,0 +1,118 @@
+#ifndef SCROLL_DETECTOR_H
+#define SCROLL_DETECTOR_H
+
+#include "../types.h"
+#include "tile_encoder.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Stream {
+
+/**
+ * @brief Copia de un rectángulo del frame anterior a otra posición
+ */
+struct MoveRect {
+    uint16_t src_x;
+    uint16_t src_y;
+    uint16_t dst_x;
+    uint16_t dst_y;
+    uint16_t w;
+    uint16_t h;
+};
+
+/**
+ * @brief Detecta desplazamientos (scroll) entre capturas consecutivas
+ *
+ * Al hacer scroll casi todos los tiles de la ventana cambian aunque el
+ * contenido solo se movió. El detector guarda un hash por fila de cada
+ * columna de tiles y un hash por columna de cada fila de tiles; en las
+ * zonas sucias busca el desplazamiento vertical (u horizontal) con el que
+ * las filas actuales coinciden con las del frame anterior. Cada
+ * desplazamiento se envía como una copia de rectángulo y de 'dirty' quedan
+ * solo los tiles que la copia no cubre (la franja nueva y los bordes).
+ *
+ * Los hashes se recalculan solo en los tiles sucios, así el costo es
+ * proporcional a lo que cambió. No es thread-safe.
+ */
+class ScrollDetector {
+public:
+    explicit ScrollDetector(int tile_size = Config::TILE_SIZE);
+
+    /**
+     * @brief Busca desplazamientos y quita de 'dirty' los tiles que cubren
+     *
+     * Las copias se aplican en orden sobre el frame anterior del cliente,
+     * antes de dibujar los tiles; nunca se pisan entre sí. En el primer
+     * frame (o tras reset() o un cambio de dimensiones) solo guarda los
+     * hashes.
+     *
+     * @param dirty Regiones sucias del frame (se reescriben)
+     * @param moves Copias detectadas (se sobrescribe)
+     * @return size_t Número de copias
+     */
+    size_t detect(const unsigned char* bgra, int width, int height, int stride,
+                  std::vector<TileRect>& dirty, std::vector<MoveRect>& moves);
+
+    /**
+     * @brief Olvida los hashes (el próximo frame no se compara)
+     */
+    void reset();
+
+    /**
+     * @brief Serializa las copias (little-endian)
+     *
+     * Formato: uint16 count, y por cada copia uint16 src_x, src_y, dst_x,
+     * dst_y, w, h. 'out' se sobrescribe conservando su capacidad.
+     */
+    static void writeMoves(const std::vector<MoveRect>& moves, std::vector<unsigned char>& out);
+
+    static const size_t MOVE_SIZE = 12;
+
+private:
+    // Desplazamiento encontrado en una columna (o fila) de tiles
+    struct Shift {
+        int offset;   // Posición actual - posición anterior
+        int start;    // Primera línea movida (en coordenadas actuales)
+        int end;      // Una después de la última
+    };
+
+    void hashTile(const unsigned char* bgra, int stride, int tx, int ty);
+
+    /**
+     * @brief Busca en [from, to) el desplazamiento de 'cur' respecto de 'prev'
+     */
+    bool findShift(const uint64_t* prev, const uint64_t* cur, int from, int to, Shift& shift);
+
+    /**
+     * @brief Agrega a 'moves' las copias de una dirección, fusionando bandas vecinas
+     */
+    void collectMoves(const std::vector<Shift>& shifts, const std::vector<uint8_t>& found,
+                      bool vertical, std::vector<MoveRect>& moves) const;
+
+    void markCovered(const MoveRect& move);
+    void rebuildDirty(std::vector<TileRect>& dirty) const;
+
+    int tile_size_;
+    int width_;
+    int height_;
+    int tiles_x_;
+    int tiles_y_;
+    bool valid_;
+
+    std::vector<uint64_t> row_hash_;        // [tx * height + y]: fila y dentro de la columna de tiles tx
+    std::vector<uint64_t> prev_row_hash_;
+    std::vector<uint64_t> col_hash_;        // [ty * width + x]: columna x dentro de la fila de tiles ty
+    std::vector<uint64_t> prev_col_hash_;
+    std::vector<uint8_t> dirty_map_;        // Un byte por tile
+
+    // Reutilizados entre frames
+    std::unordered_map<uint64_t, int> positions_;   // Hash -> línea del frame anterior (-1 si se repite)
+    std::unordered_map<int, int> votes_;            // Desplazamiento -> filas que lo apoyan
+    std::vector<Shift> shifts_;
+    std::vector<uint8_t> found_;
+};
+
+} // namespace Stream
+
+#endif // SCROLL_DETECTOR_H
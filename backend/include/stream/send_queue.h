@@ -0,0 +1,160 @@
+#ifndef SEND_QUEUE_H
+#define SEND_QUEUE_H
+
+#include "../types.h"
+#include "frame_pool.h"
+#include "stage_stats.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Stream {
+
+/**
+ * @brief Mensaje pendiente de envío
+ *
+ * El contenido es compartido: el mismo frame se encola en todas las
+ * conexiones sin copiarlo. Los frames binarios viajan en un slot de
+ * FramePool; los mensajes de texto (telemetría, JSON legado) en un string.
+ */
+struct OutgoingMessage {
+    FrameRef frame;                              // Frame binario (slot del pool)
+    std::shared_ptr<const std::string> data;     // Mensaje de texto
+    bool binary;      // send_binary o send_text
+    bool keyframe;    // false: delta (tiles); perderlo obliga a reenviar un keyframe
+    std::chrono::steady_clock::time_point queued_at;   // Lo fija pushFrame (latencia de envío)
+
+    OutgoingMessage() : binary(false), keyframe(true) {}
+};
+
+/**
+ * @brief Destino de los mensajes de una SendQueue (la conexión WebSocket)
+ *
+ * Los envíos no esperan a que los bytes salgan: Crow copia el mensaje a su
+ * buffer de escritura y vuelve. Cuánto llegó de verdad lo informa el
+ * cliente con SendQueue::ack().
+ */
+class MessageSink {
+public:
+    virtual ~MessageSink() = default;
+    virtual void sendBinary(std::string data) = 0;
+    virtual void sendText(std::string data) = 0;
+};
+
+/**
+ * @brief Estadísticas de una cola de envío
+ */
+struct SendQueueStats {
+    size_t queue_depth;          // Mensajes pendientes (frames + telemetría)
+    uint64_t frames_queued;      // Frames recibidos por pushFrame
+    uint64_t frames_sent;
+    uint64_t frames_dropped;     // Frames reemplazados antes de enviarse
+    uint64_t telemetry_sent;
+    uint64_t bytes_sent;
+    uint64_t bytes_in_flight;    // Binarios entregados a la conexión sin confirmar por el cliente
+    uint64_t stalled_us;         // Tiempo con frames pendientes frenados por bytes_in_flight
+    bool acks;                   // El cliente confirma lo recibido (hay control de flujo)
+    StageSnapshot send;          // Latencia de un frame: de encolado a enviado
+};
+
+/**
+ * @brief Cola de salida acotada de una conexión WebSocket
+ *
+ * Cada conexión tiene su propio thread de envío, así un cliente lento no
+ * retrasa a los demás ni bloquea el registro de conexiones. Como enviar no
+ * bloquea, el límite se aplica a lo que el cliente todavía no confirmó:
+ * con más de Config::SEND_INFLIGHT_BYTES en vuelo no se envían frames,
+ * quedan en la cola (a lo sumo Config::SEND_QUEUE_FRAMES) y si el cliente
+ * no alcanza se descartan los más viejos (gana el último). Un keyframe
+ * reemplaza todo lo pendiente. La telemetría nunca se descarta.
+ *
+ * El control de flujo empieza con el primer ack(); un cliente que nunca
+ * confirma recibe los frames sin límite, como antes.
+ */
+class SendQueue {
+public:
+    explicit SendQueue(std::unique_ptr<MessageSink> sink,
+                       size_t frame_capacity = Config::SEND_QUEUE_FRAMES,
+                       size_t inflight_budget = Config::SEND_INFLIGHT_BYTES);
+    ~SendQueue();
+
+    SendQueue(const SendQueue&) = delete;
+    SendQueue& operator=(const SendQueue&) = delete;
+
+    /**
+     * @brief Encola un frame, descartando los pendientes más viejos si no hay espacio
+     */
+    void pushFrame(const OutgoingMessage& message);
+
+    /**
+     * @brief Encola un mensaje de telemetría (recursos, respuestas); nunca se descarta
+     */
+    void pushTelemetry(const OutgoingMessage& message);
+
+    /**
+     * @brief Indica si se descartó un delta desde la última consulta
+     *
+     * En ese caso el cliente quedó desincronizado y necesita un keyframe.
+     */
+    bool takeResyncRequest();
+
+    /**
+     * @brief Registra la confirmación del cliente
+     *
+     * @param bytes_received Bytes binarios recibidos por el cliente desde
+     *        que se conectó (acumulado)
+     */
+    void ack(uint64_t bytes_received);
+
+    /**
+     * @brief Detiene el thread de envío (espera a que termine el envío en curso)
+     *
+     * Después de close() la conexión ya no se usa.
+     */
+    void close();
+
+    SendQueueStats stats() const;
+
+private:
+    void run();
+    void popFrame(OutgoingMessage& message);
+    bool canSendFrame() const;
+    void updateStall();
+
+    std::unique_ptr<MessageSink> sink_;
+    const size_t frame_capacity_;
+    const size_t inflight_budget_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<OutgoingMessage> frames_;       // Anillo fijo: sin reservas por frame
+    size_t frames_head_;
+    size_t frames_count_;
+    std::deque<OutgoingMessage> telemetry_;
+    bool closed_;
+    bool resync_;
+
+    uint64_t frames_queued_;
+    uint64_t frames_sent_;
+    uint64_t frames_dropped_;
+    uint64_t telemetry_sent_;
+    uint64_t bytes_sent_;
+    bool acks_;
+    uint64_t binary_sent_;                      // Bytes binarios entregados al sink
+    uint64_t binary_acked_;                     // Confirmados por el cliente
+    uint64_t stalled_us_;
+    std::chrono::steady_clock::time_point stalled_since_;   // Vacío si no está frenada
+    StageStats send_stats_;
+
+    std::thread thread_;
+};
+
+} // namespace Stream
+
+#endif // SEND_QUEUE_H
@@ -0,0 +1,89 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace Stream {
+
+/**
+ * @brief Cola acotada sin locks para un productor y un consumidor
+ *
+ * Los elementos se construyen una vez en el constructor y se reutilizan:
+ * el productor llena el slot que devuelve producerSlot() y lo publica con
+ * push(); el consumidor lee front() y lo libera con pop() cuando terminó de
+ * usarlo. Un elemento sigue ocupando su slot mientras el consumidor lo
+ * procesa, así el productor sabe cuántos están en uso.
+ *
+ * Solo un thread produce y solo un thread consume.
+ */
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity)
+        : slots_(capacity > 0 ? capacity : 1), head_(0), tail_(0) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    /**
+     * @brief Slot libre para llenar (productor)
+     *
+     * @return nullptr si la cola está llena
+     */
+    T* producerSlot() {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) == slots_.size()) {
+            return nullptr;
+        }
+        return &slots_[tail % slots_.size()];
+    }
+
+    /**
+     * @brief Publica el slot devuelto por producerSlot() (productor)
+     */
+    void push() {
+        tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Elemento más viejo (consumidor)
+     *
+     * @return nullptr si la cola está vacía
+     */
+    T* front() {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &slots_[head % slots_.size()];
+    }
+
+    /**
+     * @brief Libera el elemento devuelto por front() (consumidor)
+     */
+    void pop() {
+        head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Elementos publicados y no liberados (aproximado desde otros threads)
+     */
+    size_t size() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const { return slots_.size(); }
+
+private:
+    std::vector<T> slots_;
+
+    // En líneas de caché distintas: cada índice lo escribe un solo thread
+    alignas(64) std::atomic<size_t> head_;   // Próximo a consumir
+    alignas(64) std::atomic<size_t> tail_;   // Próximo a producir
+};
+
+} // namespace Stream
+
+#endif // SPSC_QUEUE_H
@@ -0,0 +1,43 @@
+#ifndef STAGE_STATS_H
+#define STAGE_STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace Stream {
+
+/**
+ * @brief Latencias de una etapa, en microsegundos
+ */
+struct StageSnapshot {
+    uint64_t frames;     // Frames procesados
+    uint64_t last_us;    // Último frame
+    uint64_t avg_us;     // Media móvil exponencial (peso 1/8)
+    uint64_t max_us;     // Máximo desde el arranque
+};
+
+/**
+ * @brief Mide la latencia de una etapa del pipeline
+ *
+ * Un solo thread llama a record(); snapshot() se puede llamar desde
+ * cualquiera (las estadísticas se leen sin lock).
+ */
+class StageStats {
+public:
+    StageStats();
+
+    void record(std::chrono::steady_clock::duration elapsed);
+
+    StageSnapshot snapshot() const;
+
+private:
+    std::atomic<uint64_t> frames_;
+    std::atomic<uint64_t> last_us_;
+    std::atomic<uint64_t> avg_us_;
+    std::atomic<uint64_t> max_us_;
+};
+
+} // namespace Stream
+
+#endif // STAGE_STATS_H
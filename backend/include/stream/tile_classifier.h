@@ -0,0 +1,147 @@
+#ifndef TILE_CLASSIFIER_H
+#define TILE_CLASSIFIER_H
+
+#include "../types.h"
+#include "../utils/frame_protocol.h"
+#include "../utils/image_encoder.h"
+#include "stage_stats.h"
+#include "tile_encoder.h"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace Stream {
+
+/**
+ * @brief Tipo de contenido de un tile, decide cómo se codifica
+ */
+enum class TileClass : uint8_t {
+    TEXT = 0,    // Texto/UI: pocos colores o bordes nítidos (sin pérdida)
+    PHOTO = 1,   // Imagen natural estable (JPEG normal)
+    VIDEO = 2    // Cambia casi en cada frame (JPEG de baja calidad)
+};
+
+const size_t TILE_CLASS_COUNT = 3;
+
+const char* tileClassName(TileClass tile_class);
+
+/**
+ * @brief Región de una sola clase (nunca más alta que un tile)
+ */
+struct ClassifiedRect {
+    TileRect rect;
+    TileClass tile_class;
+};
+
+/**
+ * @brief Estadísticas acumuladas de una clase
+ */
+struct TileClassSnapshot {
+    uint64_t regions;       // Regiones codificadas
+    uint64_t pixels;        // Pixeles codificados
+    uint64_t bytes;         // Bytes de salida
+    uint64_t kbps;          // Bytes de salida por segundo de stream (en kbit/s)
+    StageSnapshot encode;   // CPU por región
+};
+
+/**
+ * @brief Clasifica los tiles por contenido y los codifica según su clase
+ *
+ * Por cada tile que cambia mide la cantidad de colores, la densidad de
+ * bordes nítidos y de pixeles repetidos (sobre filas alternas), y guarda
+ * en qué frames cambió:
+ *  - si cambió en Config::TILE_VIDEO_CHANGES de los últimos 16 frames es VIDEO
+ *  - si no, con pocos colores, muchos bordes o fondo plano es TEXT; si no, PHOTO
+ * Los tiles que no cambian conservan su clase, así el costo es
+ * proporcional a lo que cambió. Un tile que deja de ser VIDEO vuelve a su
+ * clase de contenido en el siguiente keyframe.
+ *
+ * No es thread-safe salvo stats(), que se puede leer desde cualquier thread.
+ */
+class TileClassifier {
+public:
+    explicit TileClassifier(int tile_size = Config::TILE_SIZE);
+
+    /**
+     * @brief Codec y encoder para una clase (no toma posesión del encoder)
+     */
+    void setTreatment(TileClass tile_class, Utils::FrameCodec codec, Utils::ImageEncoder* encoder);
+
+    /**
+     * @brief Registra un frame: avanza el historial y reclasifica los tiles sucios
+     *
+     * Tras reset() o un cambio de dimensiones analiza todos los tiles.
+     */
+    void update(const unsigned char* bgra, int width, int height, int stride,
+                const std::vector<TileRect>& dirty);
+
+    /**
+     * @brief Invalida las clases (el próximo update analiza toda la pantalla)
+     */
+    void reset();
+
+    /**
+     * @brief Parte las regiones sucias donde cambia la clase de los tiles
+     */
+    void split(const std::vector<TileRect>& rects, std::vector<ClassifiedRect>& out) const;
+
+    /**
+     * @brief Toda la pantalla en regiones de una clase (para keyframes)
+     */
+    void fullFrame(std::vector<ClassifiedRect>& out) const;
+
+    /**
+     * @brief Codifica cada región con el tratamiento de su clase
+     *
+     * Formato (little-endian): uint16 count, y por cada región
+     * uint16 x, y, w, h + uint8 codec + uint8 clase + uint32 length + bytes
+     *
+     * @return bool false si alguna región no se pudo codificar
+     */
+    bool encodeRegions(const unsigned char* bgra, int stride,
+                       const std::vector<ClassifiedRect>& regions,
+                       std::vector<unsigned char>& payload);
+
+    TileClassSnapshot stats(TileClass tile_class) const;
+
+    /**
+     * @brief Bytes de cabecera de cada región en el payload
+     */
+    static const size_t REGION_HEADER_SIZE = 14;
+
+private:
+    struct Treatment {
+        Utils::FrameCodec codec;
+        Utils::ImageEncoder* encoder;
+    };
+
+    /**
+     * @brief Clase de contenido (TEXT o PHOTO) de un tile
+     */
+    TileClass analyze(const unsigned char* tile, int width, int height, int stride) const;
+
+    TileClass classAt(size_t tile) const;
+
+    int tile_size_;
+    int width_;
+    int height_;
+    int tiles_x_;
+    int tiles_y_;
+    bool valid_;
+    std::vector<uint16_t> history_;       // Bit i: el tile cambió hace i frames
+    std::vector<uint8_t> content_class_;  // TEXT o PHOTO según el último análisis
+    std::vector<unsigned char> region_data_;   // Región codificada temporal
+
+    Treatment treatments_[TILE_CLASS_COUNT];
+
+    // Estadísticas por clase (escritas solo por encodeRegions)
+    StageStats encode_stats_[TILE_CLASS_COUNT];
+    std::atomic<uint64_t> regions_[TILE_CLASS_COUNT];
+    std::atomic<uint64_t> pixels_[TILE_CLASS_COUNT];
+    std::atomic<uint64_t> bytes_[TILE_CLASS_COUNT];
+    std::atomic<int64_t> first_encode_ms_;   // Inicio de la ventana de bitrate (0 = sin datos)
+};
+
+} // namespace Stream
+
+#endif // TILE_CLASSIFIER_H
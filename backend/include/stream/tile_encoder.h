@@ -0,0 +1,103 @@
+#ifndef TILE_ENCODER_H
+#define TILE_ENCODER_H
+
+#include "../types.h"
+#include "../utils/image_encoder.h"
+#include "../utils/pixel_kernels.h"
+#include <cstdint>
+#include <vector>
+
+namespace Stream {
+
+/**
+ * @brief Rectángulo de pantalla (en pixeles) que cambió desde el frame anterior
+ */
+struct TileRect {
+    uint16_t x;
+    uint16_t y;
+    uint16_t w;
+    uint16_t h;
+};
+
+/**
+ * @brief Detecta regiones modificadas entre capturas y las codifica por tiles
+ *
+ * Divide la pantalla en tiles fijos de Config::TILE_SIZE pixeles y guarda
+ * una huella de 64 bits de cada tile (PixelKernels::hashBlock, vectorizada)
+ * en lugar de una copia del frame anterior: un tile cambió si su huella
+ * cambió, así que cada captura se lee una sola vez. Los tiles sucios contiguos
+ * de una misma fila se fusionan en un solo rectángulo para no repetir las
+ * cabeceras del codec en cada tile.
+ */
+class TileEncoder {
+public:
+    explicit TileEncoder(int tile_size = Config::TILE_SIZE);
+
+    /**
+     * @brief Compara el frame con el anterior y devuelve las regiones sucias
+     *
+     * En el primer frame (o si cambian las dimensiones) toda la pantalla
+     * se considera sucia. Las huellas del frame quedan como referencia.
+     *
+     * @param bgra Frame capturado
+     * @param width Ancho en pixeles
+     * @param height Alto en pixeles
+     * @param stride Bytes por línea
+     * @param dirty Rectángulos modificados (se sobrescribe)
+     * @return size_t Número de tiles modificados
+     */
+    size_t update(const unsigned char* bgra, int width, int height, int stride,
+                  std::vector<TileRect>& dirty);
+
+    /**
+     * @brief Regiones sucias a partir del bitmap de daño del kernel
+     *
+     * Usa el bitmap devuelto por screen_ring (un bit por tile, fila a fila)
+     * en lugar de comparar con el frame anterior. El bitmap debe usar el
+     * mismo tamaño de tile. Descarta las huellas de referencia, así un
+     * update() posterior vuelve a marcar toda la pantalla.
+     *
+     * @return size_t Número de tiles modificados
+     */
+    size_t updateFromDamage(const uint8_t* bitmap, int width, int height,
+                            std::vector<TileRect>& dirty);
+
+    /**
+     * @brief Olvida las huellas de referencia (el próximo update marca todo)
+     */
+    void reset();
+
+    /**
+     * @brief Codifica las regiones como payload de un mensaje TILES
+     *
+     * Formato (little-endian): uint16 count, y por cada región
+     * uint16 x, y, w, h + uint32 length + bytes codificados con 'encoder'
+     *
+     * @return bool false si alguna región no se pudo codificar
+     */
+    bool encodeTiles(const unsigned char* bgra, int stride,
+                     const std::vector<TileRect>& rects,
+                     Utils::ImageEncoder& encoder,
+                     std::vector<unsigned char>& payload);
+
+    int tileSize() const { return tile_size_; }
+
+private:
+    /**
+     * @brief Agrega a 'dirty' los tiles sucios contiguos de una fila fusionados
+     */
+    void mergeRow(int ty, int tiles_x, int width, int height,
+                  std::vector<TileRect>& dirty) const;
+
+    int tile_size_;
+    int width_;
+    int height_;
+    const Utils::PixelKernels::KernelTable* kernels_;   // hashBlock según la CPU
+    std::vector<uint64_t> tile_hash_;        // Huella de cada tile en el frame anterior
+    std::vector<uint8_t> dirty_map_;         // Un byte por tile
+    std::vector<unsigned char> tile_data_;   // Región codificada temporal
+};
+
+} // namespace Stream
+
+#endif // TILE_ENCODER_H
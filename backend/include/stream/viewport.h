@@ -0,0 +1,91 @@
+#ifndef VIEWPORT_H
+#define VIEWPORT_H
+
+#include "../types.h"
+#include "scroll_detector.h"
+#include "tile_encoder.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Stream {
+
+/**
+ * @brief Región de la pantalla que un cliente muestra ampliada
+ *
+ * x, y, w, h están en pixeles de la pantalla; out_w y out_h son el tamaño
+ * con el que el cliente la dibuja (su canvas).
+ */
+struct Viewport {
+    uint16_t x;
+    uint16_t y;
+    uint16_t w;
+    uint16_t h;
+    uint16_t out_w;
+    uint16_t out_h;
+
+    Viewport() : x(0), y(0), w(0), h(0), out_w(0), out_h(0) {}
+
+    bool operator==(const Viewport& other) const {
+        return x == other.x && y == other.y && w == other.w && h == other.h &&
+               out_w == other.out_w && out_h == other.out_h;
+    }
+
+    /**
+     * @brief Recorta la región a la pantalla
+     *
+     * @return false si queda más chica que Config::VIEWPORT_MIN_SIZE
+     */
+    bool clamp(int screen_width, int screen_height);
+
+    /**
+     * @brief Tamaño de la imagen codificada
+     *
+     * Nunca amplía: si la región entra en out_w x out_h se envía a su
+     * resolución nativa (el cliente la escala al dibujar); si no, se
+     * reduce manteniendo la proporción hasta entrar.
+     */
+    void encodedSize(int& width, int& height) const;
+
+    /**
+     * @brief Indica si algún rectángulo modificado o copiado toca la región
+     */
+    bool touches(const std::vector<TileRect>& dirty, const std::vector<MoveRect>& moves) const;
+};
+
+/**
+ * @brief Recorta y escala una región BGRA al tamaño de un viewport
+ *
+ * Reduce a la mitad con PixelKernels::downsampleBgra mientras el tamaño
+ * pedido sea la mitad o menos, y termina con un bilineal. Los buffers se
+ * conservan entre llamadas. No es thread-safe.
+ */
+class ViewportScaler {
+public:
+    /**
+     * @brief Prefijo del payload de FrameType::VIEWPORT: uint16 x, y, w, h
+     */
+    static const size_t HEADER_SIZE = 8;
+
+    /**
+     * @brief Escala 'src' (w x h pixeles) a out_w x out_h
+     *
+     * @return Pixeles resultantes (src si no hizo falta escalar) con su
+     *         stride en 'out_stride'
+     */
+    const unsigned char* scale(const unsigned char* src, int stride, int w, int h,
+                               int out_w, int out_h, int& out_stride);
+
+    /**
+     * @brief Escribe el prefijo del payload (la región en coordenadas de pantalla)
+     */
+    static void writeHeader(const Viewport& viewport, unsigned char* out);
+
+private:
+    std::vector<unsigned char> halves_[2];   // Reducciones sucesivas (se alternan)
+    std::vector<unsigned char> output_;
+};
+
+} // namespace Stream
+
+#endif // VIEWPORT_H
@@ -12,5 +12,10 @@
 #define SYS_MOUSE_ACTION        558
 #define SYS_KEYBOARD_CAPTION    559
 #define SYS_RESOURCES_PC        560
+#define SYS_SCREEN_RING_OPEN    561
+#define SYS_SCREEN_RING_CAPTURE 562
+#define SYS_SCREEN_RING_WAIT    563
+#define SYS_INPUT_BATCH         564
+#define SYS_SCREEN_LIVE_RECT    565
 
 #endif
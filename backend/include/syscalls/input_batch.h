@@ -0,0 +1,88 @@
+#ifndef INPUT_BATCH_H
+#define INPUT_BATCH_H
+
+#include "../types.h"
+#include <cstddef>
+#include <vector>
+
+namespace Syscalls {
+
+/**
+ * @brief Lote de eventos de teclado y mouse para la syscall input_batch (564)
+ *
+ * Acumula eventos tipados y submit() los inyecta todos con una sola
+ * syscall: el kernel los aplica en orden bajo un solo lock y emite un
+ * input_sync por grupo (cada sync() o delay() cierra uno). Un texto de 100
+ * teclas o un arrastre cuestan una syscall en lugar de cientos.
+ *
+ * Presionar y soltar deben quedar en grupos distintos; tap() y click() ya
+ * lo hacen. No es thread-safe.
+ */
+class InputBatch {
+public:
+    InputBatch();
+
+    void move(int x, int y);
+    void buttonDown(int button);
+    void buttonUp(int button);
+    void keyDown(int keycode);
+    void keyUp(int keycode);
+
+    /**
+     * @brief Rueda del mouse
+     *
+     * @param steps Pasos (positivo = arriba / derecha)
+     * @param horizontal true para la rueda horizontal
+     */
+    void wheel(int steps, bool horizontal = false);
+
+    /**
+     * @brief Cierra el grupo actual (un input_sync por dispositivo)
+     */
+    void sync();
+
+    /**
+     * @brief Cierra el grupo y espera en el kernel antes del siguiente
+     */
+    void delay(int microseconds);
+
+    /**
+     * @brief Presionar y soltar una tecla
+     */
+    void tap(int keycode);
+
+    /**
+     * @brief Presionar un botón, esperar Config::INPUT_CLICK_HOLD_US y soltarlo
+     */
+    void click(int button);
+
+    size_t size() const { return events_.size(); }
+    bool empty() const { return events_.empty(); }
+    void clear() { events_.clear(); }
+
+    /**
+     * @brief Inyecta los eventos acumulados y vacía el lote
+     *
+     * Lotes de más de Config::INPUT_BATCH_MAX_EVENTS eventos o con esperas
+     * que suman más de Config::INPUT_BATCH_MAX_DELAY_US se envían en varias
+     * llamadas. Si el kernel no tiene la syscall, supported() pasa a false
+     * para que el llamador use las syscalls de una acción.
+     *
+     * @return int 0 si es exitoso, -1 en caso de error
+     */
+    int submit();
+
+    /**
+     * @brief false si el kernel no implementa input_batch (ENOSYS)
+     */
+    static bool supported();
+
+private:
+    void push(uint16_t type, int code, int x = 0, int y = 0);
+
+    std::vector<input_batch_event> events_;
+};
+
+} // namespace Syscalls
+
+#endif // INPUT_BATCH_H
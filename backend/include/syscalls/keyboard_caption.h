@@ -1,10 +1,13 @@
 #ifndef KEYBOARD_CAPTION_H
 #define KEYBOARD_CAPTION_H
 
+#include "utils/keymap.h"
 #include <string>
 
 namespace Syscalls {
 
+class InputBatch;
+
 /**
  * @brief Simula la presión de una tecla
  * 
@@ -17,25 +20,40 @@ namespace Syscalls {
 int pressKey(int keycode);
 
 /**
- * @brief Convierte un carácter a su keycode correspondiente
+ * @brief Convierte un carácter a la tecla física que lo produce
  * 
- * Mapea caracteres comunes a sus keycodes del sistema Linux
+ * Usa la distribución Config::KEYBOARD_LAYOUT. Solo devuelve la tecla:
+ * las modificadoras (Shift, AltGr) las aplica typeText
  * 
  * @param c Carácter a convertir
  * @return int Keycode correspondiente, -1 si no se encuentra
  */
 int charToKeycode(char c);
 
+/**
+ * @brief Agrega a un lote las pulsaciones que escriben un texto
+ * 
+ * Busca cada carácter (UTF-8) en la tabla de la distribución
+ * (Utils::keyStroke) con sus modificadoras y teclas muertas, presiona las
+ * modificadoras solo cuando cambian y las deja sueltas al final. Cada
+ * Config::INPUT_TYPE_BURST_CHARS caracteres agrega una pausa. Los
+ * caracteres que la distribución no puede escribir se saltan.
+ * 
+ * @return int Número de caracteres agregados
+ */
+int appendText(InputBatch& batch, const std::string& text, Utils::KeyboardLayout layout);
+
 /**
  * @brief Simula escribir una cadena de texto
  * 
- * Convierte cada carácter de la cadena a su keycode y simula
- * la presión de cada tecla secuencialmente
+ * Todo el texto va en un lote de input_batch (appendText). Sin input_batch
+ * solo se escriben los caracteres que no necesitan modificadoras.
  * 
  * @param text Texto a escribir
- * @return int Número de teclas presionadas exitosamente
+ * @param layout Distribución de teclado de la máquina remota
+ * @return int Número de caracteres escritos, -1 en caso de error
  */
-int typeText(const std::string& text);
+int typeText(const std::string& text, Utils::KeyboardLayout layout);
 
 } // namespace Syscalls
 
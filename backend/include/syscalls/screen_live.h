@@ -10,8 +10,8 @@ namespace Syscalls {
 /**
  * @brief Captura la pantalla actual del sistema
  * 
- * Esta función invoca la syscall personalizada screen_live (556) para obtener
- * el contenido actual del framebuffer de la pantalla.
+ * Esta función invoca la syscall personalizada screen_live_rect (565) para
+ * obtener el contenido actual del framebuffer de la pantalla.
  * 
  * @param raw_data Vector donde se almacenarán los datos crudos BGRA
  * @param info Estructura con información de la captura (ancho, alto, etc.)
@@ -19,10 +19,47 @@ namespace Syscalls {
  */
 int captureScreen(std::vector<unsigned char>& raw_data, screen_capture_info& info);
 
+/**
+ * @brief Captura la pantalla en un buffer ya reservado (sin reservas por frame)
+ * 
+ * Pensada para los slots de Stream::FramePool.
+ * 
+ * @param buffer Buffer destino de al menos Config::SCREEN_WIDTH * Config::SCREEN_HEIGHT
+ *               * Config::BYTES_PER_PIXEL bytes
+ * @param capacity Tamaño del buffer
+ * @param info Estructura con información de la captura (ancho, alto, etc.)
+ * @return int 0 si es exitoso, -1 en caso de error
+ */
+int captureScreen(unsigned char* buffer, size_t capacity, screen_capture_info& info);
+
+/**
+ * @brief Captura solo una región de la pantalla
+ * 
+ * El kernel copia únicamente las filas de la región (respetando el stride
+ * del framebuffer) y las deja compactas: w * bytes_per_pixel bytes por fila.
+ * La región se recorta a la pantalla; info.x/y/w/h devuelven la región real
+ * e info.width/height siguen siendo las dimensiones de la pantalla.
+ * 
+ * @param x Columna inicial
+ * @param y Fila inicial
+ * @param w Ancho de la región
+ * @param h Alto de la región
+ * @param buffer Buffer destino de al menos w * h * bytes_per_pixel bytes
+ * @param capacity Tamaño del buffer
+ * @param info Información de la captura
+ * @return int 0 si es exitoso, -1 en caso de error
+ */
+int captureScreenRegion(uint32_t x, uint32_t y, uint32_t w, uint32_t h,
+                        unsigned char* buffer, size_t capacity, screen_capture_info& info);
+
 /**
  * @brief Convierte datos RAW BGRA a formato JPEG
  * 
- * Utiliza ImageMagick para convertir el buffer crudo a JPEG comprimido
+ * Codifica en memoria con Utils::JpegEncoder (sin archivos temporales ni
+ * procesos externos), usando Config::JPEG_QUALITY y Config::JPEG_SUBSAMPLING.
+ * La imagen se codifica en franjas de Config::JPEG_RESTART_ROWS filas de
+ * MCUs repartidas entre Config::JPEG_THREADS threads (0 = todos los núcleos).
+ * jpeg_data se sobrescribe conservando su capacidad.
  * 
  * @param raw_data Datos crudos BGRA de la captura
  * @param jpeg_data Vector donde se almacenará el JPEG resultante
@@ -34,6 +71,18 @@ bool convertToJPEG(const std::vector<unsigned char>& raw_data,
                    std::vector<unsigned char>& jpeg_data,
                    int width, int height);
 
+/**
+ * @brief Captura la pantalla y la codifica a JPEG
+ * 
+ * Reutiliza un buffer RAW por thread, por lo que no reserva memoria
+ * por frame una vez que los buffers alcanzaron su tamaño
+ * 
+ * @param jpeg_data Vector donde se almacenará el JPEG
+ * @param info Información de la captura (ancho, alto, etc.)
+ * @return bool true si la captura y la codificación fueron exitosas
+ */
+bool getScreenshotJPEG(std::vector<unsigned char>& jpeg_data, screen_capture_info& info);
+
 /**
  * @brief Obtiene un screenshot completo en formato Base64
  * 
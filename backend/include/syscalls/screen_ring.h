@@ -0,0 +1,120 @@
+#ifndef SCREEN_RING_H
+#define SCREEN_RING_H
+
+#include "../types.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Syscalls {
+
+/**
+ * @brief Captura de pantalla sin copias a través del anillo del kernel
+ *
+ * open() invoca screen_ring_open (561), que crea un anillo de slots en el
+ * kernel, y lo mapea en modo solo lectura. Cada capture() invoca
+ * screen_ring_capture (562): el kernel copia el framebuffer directo al
+ * siguiente slot y se devuelve un puntero a él, sin más copias ni reservas.
+ *
+ * El puntero es válido hasta que se hagan slot_count - 1 capturas más.
+ *
+ * Con tile_size > 0 el kernel además compara cada tile con la captura
+ * anterior y devuelve un bitmap de tiles modificados (damage()), así el
+ * backend no necesita guardar ni comparar el frame anterior.
+ *
+ * waitForChange() invoca screen_ring_wait (563): bloquea hasta que el
+ * kernel vea un cambio posterior a la última captura, así el loop de
+ * captura no tiene que despertarse con un temporizador.
+ */
+class ScreenRing {
+public:
+    ScreenRing();
+    ~ScreenRing();
+
+    ScreenRing(const ScreenRing&) = delete;
+    ScreenRing& operator=(const ScreenRing&) = delete;
+
+    /**
+     * @brief Crea y mapea el anillo
+     *
+     * @param slot_count Número de slots (2 a 8)
+     * @param tile_size Lado del tile para el seguimiento de daño (0 = desactivado)
+     * @return int 0 si es exitoso, -1 si el kernel no soporta la syscall o falla
+     */
+    int open(unsigned int slot_count = Config::SCREEN_RING_SLOTS,
+             unsigned int tile_size = Config::TILE_SIZE);
+
+    /**
+     * @brief Libera el mapeo y el fd
+     */
+    void close();
+
+    bool isOpen() const { return fd_ >= 0; }
+
+    /**
+     * @brief Captura la pantalla en el siguiente slot
+     *
+     * Si la resolución cambió el anillo se vuelve a abrir automáticamente.
+     *
+     * @param bgra Puntero al frame dentro del mapeo
+     * @param info Dimensiones de la captura (info.data apunta al slot)
+     * @param sequence Número de secuencia de la captura
+     * @return int 0 si es exitoso, -1 en caso de error
+     */
+    int capture(const unsigned char*& bgra, screen_capture_info& info, uint64_t& sequence);
+
+    /**
+     * @brief Bitmap de tiles modificados en la última captura
+     *
+     * Un bit por tile, fila a fila, el bit 0 de cada byte primero.
+     *
+     * @return Puntero al bitmap o nullptr si no hay seguimiento de daño
+     */
+    const uint8_t* damage() const { return damage_.empty() ? nullptr : damage_.data(); }
+
+    /**
+     * @brief Espera a que la pantalla cambie después de la última captura
+     *
+     * El kernel muestrea cada Config::CHANGE_SAMPLE_MS; cada espera que vence
+     * sin cambios duplica el intervalo hasta Config::CHANGE_SAMPLE_MAX_MS, y
+     * un cambio o notifyActivity() lo devuelven al mínimo.
+     *
+     * @param timeout_ms Tiempo máximo de espera
+     * @return int 1 si cambió, 0 si venció el timeout, -1 si el kernel no
+     *         soporta la espera (canWait() pasa a false)
+     */
+    int waitForChange(int timeout_ms);
+
+    /**
+     * @brief Vuelve a muestrear seguido (hubo entrada: la pantalla va a cambiar)
+     *
+     * Se puede llamar desde cualquier thread.
+     */
+    void notifyActivity() { sample_ms_ = Config::CHANGE_SAMPLE_MS; }
+
+    /**
+     * @brief true si se puede esperar cambios en lugar de capturar periódicamente
+     */
+    bool canWait() const { return fd_ >= 0 && wait_supported_; }
+
+    unsigned int tileSize() const { return ring_info_.tile_size; }
+    uint32_t dirtyTiles() const { return dirty_tiles_; }
+
+private:
+    int fd_;
+    unsigned char* map_;
+    size_t map_size_;
+    unsigned int slot_count_;
+    unsigned int tile_size_;
+    screen_ring_info ring_info_;
+    std::vector<uint8_t> damage_;   // Bitmap de daño (reservado en open)
+    uint32_t dirty_tiles_;
+    uint64_t generation_;           // Generación de la última captura
+    bool wait_supported_;
+    std::atomic<int> sample_ms_;    // Intervalo de muestreo de screen_ring_wait
+};
+
+} // namespace Syscalls
+
+#endif // SCREEN_RING_H
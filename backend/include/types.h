@@ -11,14 +11,80 @@
 #define SYS_MOUSE_ACTION 558
 #define SYS_KEYBOARD_CAPTION 559
 #define SYS_RESOURCES_PC 560
+#define SYS_SCREEN_RING_OPEN 561
+#define SYS_SCREEN_RING_CAPTURE 562
+#define SYS_SCREEN_RING_WAIT 563
+#define SYS_INPUT_BATCH 564
+#define SYS_SCREEN_LIVE_RECT 565
 
-// Estructura para la captura de pantalla
+// Estructura para la captura de pantalla (struct screen_capture_rect del
+// kernel, syscall screen_live_rect; screen_live solo usa los primeros 5 campos)
 struct screen_capture_info {
     uint32_t width;              // Ancho de la pantalla
     uint32_t height;             // Alto de la pantalla
     uint32_t bytes_per_pixel;    // Bytes por pixel (4 para BGRA)
-    uint64_t buffer_size;        // Tamaño total del buffer
+    uint64_t buffer_size;        // Bytes copiados (w * h * bytes_per_pixel)
     void* data;                  // Puntero al buffer de datos
+    uint32_t x;                  // Región a capturar (w = 0 o h = 0: pantalla completa);
+    uint32_t y;                  // el kernel devuelve la región recortada
+    uint32_t w;
+    uint32_t h;
+    uint64_t capacity;           // Tamaño del buffer 'data'
+};
+
+// Anillo de frames mapeado con mmap (screen_ring_open)
+struct screen_ring_info {
+    uint32_t width;              // Ancho de la pantalla
+    uint32_t height;             // Alto de la pantalla
+    uint32_t bytes_per_pixel;    // Bytes por pixel (4 para BGRA)
+    uint32_t slot_count;         // Slots del anillo
+    uint64_t slot_size;          // Bytes por slot (múltiplo de página)
+    uint64_t frame_size;         // Bytes válidos de cada frame
+    uint32_t tile_size;          // Entrada: lado del tile para el daño (0 = sin seguimiento)
+    uint32_t tiles_x;            // Tiles por fila
+    uint32_t tiles_y;            // Filas de tiles
+    uint32_t dirty_map_size;     // Bytes del bitmap de daño
+};
+
+// Resultado de screen_ring_capture
+struct screen_ring_frame {
+    uint32_t slot;               // Slot escrito (offset = slot * slot_size)
+    uint32_t width;
+    uint32_t height;
+    uint32_t bytes_per_pixel;
+    uint64_t sequence;           // Número de captura, empieza en 1
+    uint64_t frame_size;
+    unsigned char* dirty_map;    // Entrada: buffer para el bitmap (bit por tile, fila a fila)
+    uint32_t dirty_map_size;     // Entrada: tamaño del buffer
+    uint32_t dirty_tiles;        // Tiles que cambiaron desde la captura anterior
+    uint64_t generation;         // Generación del contenido capturado
+};
+
+// Espera de cambios (screen_ring_wait)
+struct screen_ring_wait {
+    uint64_t generation;         // Entrada: última vista; salida: generación actual
+    uint32_t timeout_ms;         // Tiempo máximo de espera
+    uint32_t interval_ms;        // Muestreo de la pantalla en el kernel (0 = por defecto)
+};
+
+// Tipos de evento de input_batch
+enum input_batch_type : uint16_t {
+    INPUT_BATCH_MOVE = 1,         // x, y absolutos
+    INPUT_BATCH_BUTTON_DOWN = 2,  // code: 1 izquierdo, 2 derecho, 3 medio
+    INPUT_BATCH_BUTTON_UP = 3,
+    INPUT_BATCH_KEY_DOWN = 4,     // code: keycode de linux/input.h
+    INPUT_BATCH_KEY_UP = 5,
+    INPUT_BATCH_WHEEL = 6,        // code: 0 vertical, 1 horizontal; x: pasos
+    INPUT_BATCH_SYNC = 7,         // Cierra el grupo de eventos (input_sync)
+    INPUT_BATCH_DELAY = 8         // Cierra el grupo y espera x microsegundos
+};
+
+// Evento de entrada para input_batch
+struct input_batch_event {
+    uint16_t type;               // input_batch_type
+    uint16_t code;
+    int32_t x;
+    int32_t y;
 };
 
 // Estructura para los recursos del sistema
@@ -62,7 +128,48 @@ namespace Config {
     const int SCREEN_WIDTH = 1280;
     const int SCREEN_HEIGHT = 800;
     const int BYTES_PER_PIXEL = 4;  // BGRA
-    const int FPS = 1;  // Frames por segundo
+    const int MAX_FPS = 30;             // Frecuencia máxima (tras entrada o con la pantalla cambiando)
+    const int IDLE_FPS = 1;             // Frecuencia con la pantalla quieta
+    const int INPUT_BOOST_MS = 1500;    // Tiempo a MAX_FPS después de un evento de entrada
+    const int JPEG_QUALITY = 75;        // Calidad JPEG (1-100)
+    const int JPEG_SUBSAMPLING = 420;   // 444, 422 o 420
+    const int JPEG_RESTART_ROWS = 2;    // Filas de MCUs por franja (marcadores RST)
+    const int JPEG_THREADS = 0;         // Threads del encoder JPEG (0 = todos los núcleos)
+    const int TILE_SIZE = 64;           // Lado de los tiles para detectar cambios
+    const int TILE_TEXT_MAX_COLORS = 32;  // Tiles con hasta estos colores son texto/UI (sin pérdida)
+    const int TILE_TEXT_EDGE_PERCENT = 5; // ... o con este % de bordes nítidos
+    const int TILE_TEXT_FLAT_PERCENT = 50; // ... o con este % de pixeles iguales al vecino (fondos)
+    const int TILE_VIDEO_CHANGES = 8;   // Cambios en los últimos 16 frames para tratar un tile como video
+    const int JPEG_VIDEO_QUALITY = 40;  // Calidad JPEG de los tiles de video
+    const int SCROLL_MIN_LINES = 32;    // Líneas mínimas de un desplazamiento para enviarlo como copia
+    const int VIEWPORT_MIN_SIZE = 16;   // Lado mínimo de la región de un viewport (set_viewport)
+    const int KEYFRAME_INTERVAL = 30;   // Frames entre keyframes completos
+    const int SEND_QUEUE_FRAMES = 2;    // Frames pendientes por conexión antes de descartar
+    const size_t SEND_INFLIGHT_BYTES = 1024 * 1024;  // Bytes enviados sin confirmar por el cliente antes de frenar los frames
+    const int LAYER_LOW_QUALITY = 45;   // Calidad JPEG de la capa "low" (resolución completa)
+    const int LAYER_HALF_QUALITY = 60;  // Calidad JPEG de la capa "half" (mitad de resolución)
+    const int LAYER_WINDOW_MS = 1000;   // Ventana para medir cuánto drena cada cola de envío
+    const int LAYER_DOWN_DRAIN_PERCENT = 90;  // Bajar de capa si la cola drena menos de este %
+    const int LAYER_DOWN_STALL_PERCENT = 50;  // ...o si pasó este % de la ventana frenada por el cliente
+    const int LAYER_STABLE_STALL_PERCENT = 10;  // Con más espera que esto la ventana no cuenta como estable
+    const int LAYER_UP_HOLD_MS = 5000;  // Tiempo sin descartes antes de probar la capa superior
+    const int LAYER_UP_HOLD_MAX_MS = 60000;   // Espera máxima tras pruebas fallidas
+    const int PIPELINE_FRAMES = 2;      // Frames entre captura y codificación (incluye el que se codifica)
+    const int RAW_FRAME_SLOTS = PIPELINE_FRAMES + 1;    // Buffers de captura preasignados
+    const int SCREEN_RING_SLOTS = PIPELINE_FRAMES + 1;  // Slots del anillo del kernel (screen_ring)
+    const int CHANGE_SAMPLE_MS = 10;    // Muestreo del kernel al esperar cambios de pantalla (activa)
+    const int CHANGE_SAMPLE_MAX_MS = 1000 / IDLE_FPS;  // Muestreo con la pantalla quieta (se duplica hasta acá)
+    const int CHANGE_WAIT_SLICE_MS = 100; // Espera máxima por llamada (para atender stop())
+    const int MESSAGE_SLOTS = 8;        // Mensajes binarios en vuelo (compartidos entre conexiones)
+    const int INPUT_BATCH_MAX_EVENTS = 4096;  // Eventos por llamada a input_batch (límite del kernel)
+    const int INPUT_BATCH_MAX_DELAY_US = 1000000;  // Suma de esperas por llamada a input_batch (límite del kernel)
+    const int INPUT_QUEUE_EVENTS = 1024;      // Eventos binarios pendientes de inyectar (el resto se descarta)
+    const int INPUT_MOTION_TICK_US = 8000;    // Período mínimo entre movimientos inyectados (125 Hz)
+    const int INPUT_CLICK_HOLD_US = 50000;    // Tiempo entre presionar y soltar un botón
+    const int INPUT_TYPE_BURST_CHARS = 32;    // Caracteres seguidos al escribir texto...
+    const int INPUT_TYPE_BURST_GAP_US = 8000; // ...y pausa para que el lector de evdev no pierda eventos
+    const size_t TYPE_TEXT_MAX_BYTES = 65536; // Texto máximo de /api/keyboard/type y "type"
+    const char* const KEYBOARD_LAYOUT = "us"; // Distribución de la máquina remota si el pedido no indica otra
     const int WEBSOCKET_PORT = 8080;
 
     // Nombres de grupos para control de acceso
@@ -0,0 +1,105 @@
+#ifndef FRAME_PROTOCOL_H
+#define FRAME_PROTOCOL_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+namespace Utils {
+
+/**
+ * @brief Tipos de mensaje binario enviados por el WebSocket
+ */
+enum class FrameType : uint8_t {
+    SCREENSHOT = 1,   // Frame completo
+    TILES = 2,        // Solo las regiones que cambiaron
+    VIEWPORT = 3      // Región ampliada de un cliente (set_viewport): x, y, w, h + imagen
+};
+
+/**
+ * @brief Flags de la cabecera
+ */
+const uint16_t FRAME_FLAG_KEYFRAME = 0x0001;   // Frame completo que reemplaza al anterior
+const uint16_t FRAME_FLAG_MOVES = 0x0002;      // El payload empieza con copias de rectángulos (scroll)
+
+/**
+ * @brief Codecs de imagen del payload
+ */
+enum class FrameCodec : uint8_t {
+    JPEG = 1,   // Con pérdida, para cualquier enlace
+    QOI = 2,    // Sin pérdida (Utils::QoiEncoder), para clientes en la LAN
+    MIXED = 3   // Por región según su contenido (Stream::TileClassifier)
+};
+
+/**
+ * @brief Cabecera fija de los mensajes binarios (little-endian, 24 bytes)
+ *
+ *  offset  tamaño  campo
+ *  0       1       type
+ *  1       1       codec
+ *  2       2       flags (FRAME_FLAG_*)
+ *  4       4       frame_id
+ *  8       8       timestamp (ms desde epoch)
+ *  16      2       width
+ *  18      2       height
+ *  20      4       payload_length
+ *  24      ...     payload (bytes codificados)
+ */
+struct FrameHeader {
+    FrameType type;
+    FrameCodec codec;
+    uint16_t flags;
+    uint32_t frame_id;
+    uint64_t timestamp;
+    uint16_t width;
+    uint16_t height;
+    uint32_t payload_length;
+};
+
+const size_t FRAME_HEADER_SIZE = 24;
+
+/**
+ * @brief Construye un mensaje binario (cabecera + payload) en 'out'
+ *
+ * 'out' se sobrescribe conservando su capacidad
+ *
+ * @param header Cabecera (payload_length se toma de 'size')
+ * @param payload Bytes codificados
+ * @param size Tamaño del payload
+ * @param out String destino para send_binary
+ */
+void buildFrameMessage(const FrameHeader& header, const unsigned char* payload,
+                       size_t size, std::string& out);
+
+/**
+ * @brief Escribe un mensaje binario (cabecera + payload) en un buffer fijo
+ *
+ * Variante sin reservas de memoria para los slots de Stream::FramePool.
+ *
+ * @return size_t Bytes escritos, 0 si no cabe en 'capacity'
+ */
+size_t writeFrameMessage(const FrameHeader& header, const unsigned char* payload,
+                         size_t size, unsigned char* out, size_t capacity);
+
+/**
+ * @brief Variante con el payload en dos partes (prefijo + cuerpo)
+ *
+ * Evita armar el payload completo en otro buffer cuando una parte se
+ * comparte entre mensajes, como las copias de FRAME_FLAG_MOVES.
+ *
+ * @return size_t Bytes escritos, 0 si no cabe en 'capacity'
+ */
+size_t writeFrameMessage(const FrameHeader& header, const unsigned char* prefix, size_t prefix_size,
+                         const unsigned char* payload, size_t size,
+                         unsigned char* out, size_t capacity);
+
+/**
+ * @brief Lee la cabecera de un mensaje binario
+ *
+ * @return bool false si el mensaje es más corto que la cabecera
+ */
+bool parseFrameHeader(const std::string& message, FrameHeader& header);
+
+} // namespace Utils
+
+#endif // FRAME_PROTOCOL_H
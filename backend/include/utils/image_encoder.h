@@ -0,0 +1,34 @@
+#ifndef IMAGE_ENCODER_H
+#define IMAGE_ENCODER_H
+
+#include <vector>
+
+namespace Utils {
+
+/**
+ * @brief Interfaz común de los codecs de imagen del stream
+ *
+ * Permite codificar keyframes y tiles con el codec que eligió cada cliente
+ * sin que TileEncoder ni el handler conozcan la implementación.
+ */
+class ImageEncoder {
+public:
+    virtual ~ImageEncoder() {}
+
+    /**
+     * @brief Codifica una imagen BGRA
+     *
+     * @param bgra Puntero al primer pixel (B, G, R, A por pixel)
+     * @param width Ancho en pixeles
+     * @param height Alto en pixeles
+     * @param stride Bytes por línea en el buffer de origen
+     * @param out Vector de salida; se sobrescribe conservando su capacidad
+     * @return bool true si la codificación fue exitosa
+     */
+    virtual bool encode(const unsigned char* bgra, int width, int height, int stride,
+                        std::vector<unsigned char>& out) = 0;
+};
+
+} // namespace Utils
+
+#endif // IMAGE_ENCODER_H
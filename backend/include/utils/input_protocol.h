@@ -0,0 +1,58 @@
+#ifndef INPUT_PROTOCOL_H
+#define INPUT_PROTOCOL_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace Utils {
+
+/**
+ * @brief Tipos de los mensajes binarios de entrada que envía el cliente
+ */
+enum class InputType : uint8_t {
+    MOVE = 1,          // x, y
+    BUTTON_DOWN = 2,   // code: 1 izquierdo, 2 derecho, 3 medio; x, y
+    BUTTON_UP = 3,
+    KEY_DOWN = 4,      // code: keycode de linux/input.h
+    KEY_UP = 5,
+    WHEEL = 6          // x: pasos horizontales, y: verticales (positivo = derecha / arriba)
+};
+
+/**
+ * @brief Mensaje de entrada (little-endian, 12 bytes)
+ *
+ *  offset  tamaño  campo
+ *  0       1       type (InputType)
+ *  1       1       reservado (0)
+ *  2       2       code
+ *  4       4       seq (lo elige el cliente; el servidor lo devuelve en input_ack)
+ *  8       2       x (int16)
+ *  10      2       y (int16)
+ *
+ * Un mensaje WebSocket binario puede traer varios seguidos.
+ */
+struct InputMessage {
+    InputType type;
+    uint16_t code;
+    uint32_t seq;
+    int16_t x;
+    int16_t y;
+};
+
+const size_t INPUT_MESSAGE_SIZE = 12;
+
+/**
+ * @brief Interpreta los mensajes de entrada de un mensaje binario
+ *
+ * Los mensajes se agregan a 'out'. No valida rangos (eso lo hace el kernel).
+ *
+ * @return false si el tamaño no es múltiplo de INPUT_MESSAGE_SIZE o algún
+ *         tipo es desconocido (en ese caso 'out' no cambia)
+ */
+bool parseInputMessages(const std::string& data, std::vector<InputMessage>& out);
+
+} // namespace Utils
+
+#endif // INPUT_PROTOCOL_H
@@ -0,0 +1,158 @@
+#ifndef JPEG_ENCODER_H
+#define JPEG_ENCODER_H
+
+#include "../types.h"
+#include "image_encoder.h"
+#include "pixel_kernels.h"
+#include "thread_pool.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Utils {
+
+/**
+ * @brief Submuestreo de crominancia soportado por el encoder
+ *
+ * El valor numérico coincide con la notación usual (4:4:4, 4:2:2, 4:2:0)
+ * para poder configurarlo desde Config::JPEG_SUBSAMPLING
+ */
+enum class ChromaSubsampling {
+    S444 = 444,   // Sin submuestreo (máxima nitidez en texto)
+    S422 = 422,   // Mitad de resolución horizontal en Cb/Cr
+    S420 = 420    // Mitad de resolución horizontal y vertical en Cb/Cr
+};
+
+/**
+ * @brief Parámetros de codificación JPEG
+ */
+struct JpegOptions {
+    int quality;                      // Calidad 1-100 (escala IJG)
+    ChromaSubsampling subsampling;    // Submuestreo de crominancia
+    int restart_rows;                 // Filas de MCUs por franja (0 = sin marcadores RST)
+    int threads;                      // Threads para codificar franjas (0 = todos los núcleos)
+
+    JpegOptions()
+        : quality(Config::JPEG_QUALITY),
+          subsampling(static_cast<ChromaSubsampling>(Config::JPEG_SUBSAMPLING)),
+          restart_rows(Config::JPEG_RESTART_ROWS),
+          threads(Config::JPEG_THREADS) {}
+};
+
+/**
+ * @brief Encoder JPEG baseline en memoria
+ *
+ * Convierte directamente un buffer BGRA (como el que devuelve la syscall
+ * screen_live) a JPEG sin archivos temporales ni procesos externos.
+ * Las tablas de cuantización y Huffman se calculan una sola vez por
+ * configuración y los buffers intermedios se reutilizan entre frames,
+ * por lo que en régimen estable no se hacen reservas de memoria.
+ * La conversión de color, el submuestreo y la carga de bloques usan
+ * los kernels de PixelKernels::active() (AVX2/SSE2/escalar).
+ *
+ * Con restart_rows > 0 la imagen se divide en franjas horizontales de
+ * restart_rows filas de MCUs separadas por marcadores RST (DRI). Cada
+ * franja se codifica por separado en un pool de threads y luego se
+ * concatenan. Las franjas dependen solo de restart_rows, así que el JPEG
+ * es idéntico byte a byte sin importar la cantidad de threads.
+ *
+ * No es thread-safe: usar una instancia por thread.
+ */
+class JpegEncoder : public ImageEncoder {
+public:
+    explicit JpegEncoder(const JpegOptions& options = JpegOptions());
+
+    /**
+     * @brief Cambia calidad/submuestreo (recalcula tablas solo si cambian)
+     */
+    void setOptions(const JpegOptions& options);
+
+    const JpegOptions& options() const { return options_; }
+
+    /**
+     * @brief Codifica una imagen BGRA a JPEG
+     *
+     * @param bgra Puntero al primer pixel (B, G, R, A por pixel)
+     * @param width Ancho en pixeles
+     * @param height Alto en pixeles
+     * @param stride Bytes por línea en el buffer de origen
+     * @param out Vector de salida; se sobrescribe conservando su capacidad
+     * @return bool true si la codificación fue exitosa
+     */
+    bool encode(const unsigned char* bgra, int width, int height, int stride,
+                std::vector<unsigned char>& out) override;
+
+private:
+    // Tabla Huffman expandida: código y longitud por símbolo
+    struct HuffmanTable {
+        uint16_t code[256];
+        uint8_t size[256];
+    };
+
+    // Escritor de bits con byte stuffing (0xFF -> 0xFF 0x00)
+    struct BitWriter {
+        std::vector<unsigned char>* out;
+        uint32_t buffer;
+        int count;
+
+        void put(uint32_t bits, int length);
+        void flush();
+    };
+
+    // Planos de una fila de MCUs; uno por thread (reutilizados entre frames)
+    struct McuRowBuffers {
+        std::vector<uint8_t> y_rows;
+        std::vector<uint8_t> cb_full;    // Crominancia antes del submuestreo
+        std::vector<uint8_t> cr_full;
+        std::vector<uint8_t> cb_rows;
+        std::vector<uint8_t> cr_rows;
+    };
+
+    // Geometría de la imagen que se está codificando
+    struct Layout {
+        const unsigned char* bgra;
+        int width;
+        int height;
+        int stride;
+        int mcu_w;
+        int mcu_h;
+        int mcus_x;
+        int mcus_y;
+        int padded_width;
+        int chroma_width;
+    };
+
+    JpegOptions options_;
+    const PixelKernels::KernelTable* kernels_;   // Kernels SIMD elegidos al arrancar
+
+    uint8_t quant_luma_[64];      // Tablas de cuantización (orden natural)
+    uint8_t quant_chroma_[64];
+    float fdiv_luma_[64];         // Divisores con los factores AAN incluidos
+    float fdiv_chroma_[64];
+
+    HuffmanTable dc_luma_, ac_luma_, dc_chroma_, ac_chroma_;
+
+    std::vector<McuRowBuffers> row_buffers_;           // Uno por thread
+    std::vector<std::vector<unsigned char>> strips_;   // Salida de cada franja
+    std::unique_ptr<ThreadPool> pool_;                 // Se crea con la primera imagen con franjas
+
+    void buildTables();
+    void writeHeaders(std::vector<unsigned char>& out, int width, int height,
+                      int restart_interval) const;
+
+    void convertMcuRow(const Layout& layout, McuRowBuffers& buffers, int mcu_row) const;
+
+    /**
+     * @brief Codifica las filas de MCUs [first_row, last_row) con predicción DC desde cero
+     */
+    void encodeMcuRows(const Layout& layout, McuRowBuffers& buffers,
+                       int first_row, int last_row, std::vector<unsigned char>& out) const;
+
+    void encodeBlock(BitWriter& writer, const uint8_t* plane, int plane_stride,
+                     const float* fdiv, const HuffmanTable& dc,
+                     const HuffmanTable& ac, int& last_dc) const;
+};
+
+} // namespace Utils
+
+#endif // JPEG_ENCODER_H
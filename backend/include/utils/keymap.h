@@ -0,0 +1,74 @@
+#ifndef KEYMAP_H
+#define KEYMAP_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+namespace Utils {
+
+/**
+ * @brief Distribuciones de teclado de la máquina remota
+ *
+ * La tabla de cada una dice qué tecla física (keycode de linux/input.h) y
+ * qué modificadoras producen cada carácter con esa distribución activa.
+ */
+enum class KeyboardLayout : uint8_t {
+    US = 0,      // "us": inglés (EE. UU.)
+    ES = 1,      // "es": español (España)
+    LATAM = 2    // "latam": español (Latinoamérica)
+};
+
+/**
+ * @brief Modificadoras de una pulsación (se combinan con |)
+ */
+enum KeyModifier : uint8_t {
+    KEY_MOD_NONE = 0,
+    KEY_MOD_SHIFT = 1,   // KEY_LEFTSHIFT
+    KEY_MOD_ALTGR = 2    // KEY_RIGHTALT
+};
+
+/**
+ * @brief Cómo se escribe un carácter
+ *
+ * Los acentos de las distribuciones españolas son teclas muertas: primero
+ * se pulsa la tecla muerta (dead_keycode con dead_modifiers) y después la
+ * letra. keycode 0 significa que el carácter no se puede escribir.
+ */
+struct KeyStroke {
+    uint8_t keycode;
+    uint8_t modifiers;
+    uint8_t dead_keycode;     // 0 si no hace falta tecla muerta
+    uint8_t dead_modifiers;
+};
+
+/**
+ * @brief Pulsación que produce un carácter Latin-1 (U+0000..U+00FF)
+ */
+const KeyStroke& keyStroke(KeyboardLayout layout, unsigned char c);
+
+/**
+ * @brief Nombre de la distribución ("us", "es", "latam")
+ */
+const char* keyboardLayoutName(KeyboardLayout layout);
+
+/**
+ * @brief Interpreta el nombre de una distribución
+ *
+ * @return false si no se conoce (en ese caso 'out' no cambia)
+ */
+bool parseKeyboardLayout(const std::string& name, KeyboardLayout& out);
+
+/**
+ * @brief Lee el siguiente carácter de un texto UTF-8
+ *
+ * Avanza 'offset' al carácter siguiente. Los caracteres fuera de Latin-1
+ * (emojis, €, ...) y los bytes inválidos se saltan devolviendo false.
+ *
+ * @return true si 'out' tiene un carácter Latin-1
+ */
+bool nextLatin1(const std::string& text, size_t& offset, unsigned char& out);
+
+} // namespace Utils
+
+#endif // KEYMAP_H
@@ -0,0 +1,85 @@
+#ifndef PIXEL_KERNELS_H
+#define PIXEL_KERNELS_H
+
+#include <cstdint>
+
+namespace Utils {
+namespace PixelKernels {
+
+/**
+ * @brief Convierte 'count' pixeles BGRA a planos Y, Cb, Cr (JFIF, punto fijo)
+ */
+typedef void (*BgraToYccRowFn)(const unsigned char* bgra, int count,
+                               uint8_t* y, uint8_t* cb, uint8_t* cr);
+
+/**
+ * @brief Submuestreo horizontal: out[x] = (in[2x] + in[2x+1] + 1) >> 1
+ */
+typedef void (*Downsample2x1Fn)(const uint8_t* in, int out_count, uint8_t* out);
+
+/**
+ * @brief Submuestreo 2x2: out[x] = (suma de los 4 vecinos + 2) >> 2
+ */
+typedef void (*Downsample2x2Fn)(const uint8_t* in0, const uint8_t* in1,
+                                int out_count, uint8_t* out);
+
+/**
+ * @brief Prepara un bloque 8x8 para la DCT: block[i] = sample - 128
+ */
+typedef void (*LoadBlockFn)(const uint8_t* plane, int stride, float* block);
+
+/**
+ * @brief Huella de 64 bits de un bloque de 'rows' filas de 'row_bytes' bytes
+ *
+ * No criptográfica: 32 carriles de 32 bits con la ronda de xxHash32 sobre
+ * palabras consecutivas (la palabra i de cada fila va al carril i % 32),
+ * plegados al final. 'row_bytes' debe ser múltiplo de 4 (pixeles BGRA).
+ */
+typedef uint64_t (*HashBlockFn)(const unsigned char* data, int stride, int row_bytes, int rows);
+
+/**
+ * @brief Reduce dos filas BGRA a una de 'out_count' pixeles (media 2x2 por canal)
+ *
+ * Mismo redondeo que Downsample2x2Fn: (suma de los 4 vecinos + 2) >> 2.
+ */
+typedef void (*DownsampleBgraFn)(const unsigned char* in0, const unsigned char* in1,
+                                 int out_count, unsigned char* out);
+
+/**
+ * @brief Conjunto de kernels para un nivel de instrucciones
+ *
+ * Todas las implementaciones producen resultados idénticos bit a bit
+ * a los de la versión escalar.
+ */
+struct KernelTable {
+    const char* name;
+    BgraToYccRowFn bgraToYccRow;
+    Downsample2x1Fn downsample2x1;
+    Downsample2x2Fn downsample2x2;
+    LoadBlockFn loadBlock;
+    HashBlockFn hashBlock;
+    DownsampleBgraFn downsampleBgra;
+};
+
+/**
+ * @brief Kernels elegidos según la CPU (se detecta una sola vez)
+ *
+ * Orden de preferencia: AVX2, SSE2, escalar
+ */
+const KernelTable& active();
+
+/**
+ * @brief Implementación escalar de referencia
+ */
+const KernelTable& scalar();
+
+/**
+ * @brief Implementaciones vectoriales (nullptr si la CPU no las soporta)
+ */
+const KernelTable* sse2();
+const KernelTable* avx2();
+
+} // namespace PixelKernels
+} // namespace Utils
+
+#endif // PIXEL_KERNELS_H
@@ -0,0 +1,50 @@
+#ifndef QOI_CODEC_H
+#define QOI_CODEC_H
+
+#include "image_encoder.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Utils {
+
+/**
+ * @brief Encoder sin pérdida en formato QOI ("Quite OK Image")
+ *
+ * Una sola pasada sobre el buffer BGRA: cada pixel se codifica como
+ * repetición del anterior, referencia a una tabla de 64 colores recientes,
+ * diferencia pequeña con el anterior o color completo. Es varias veces más
+ * rápido que JPEG y el texto se ve exacto, a cambio de más bytes; pensado
+ * para clientes en la LAN.
+ *
+ * Se escribe con 3 canales (el alfa de la captura se ignora), así
+ * cualquier decoder QOI estándar lo lee. El decoder del frontend está en
+ * frontend/src/services/qoiDecoder.js.
+ *
+ * No es thread-safe: usar una instancia por thread.
+ */
+class QoiEncoder : public ImageEncoder {
+public:
+    bool encode(const unsigned char* bgra, int width, int height, int stride,
+                std::vector<unsigned char>& out) override;
+
+    /**
+     * @brief Tamaño máximo de la salida para una imagen
+     */
+    static size_t maxEncodedSize(int width, int height);
+};
+
+/**
+ * @brief Decodifica una imagen QOI a BGRA (pruebas y benchmarks)
+ *
+ * @param data Bytes QOI
+ * @param size Tamaño de 'data'
+ * @param bgra Salida, width * height * 4 bytes
+ * @return bool false si el archivo no es QOI válido o está truncado
+ */
+bool qoiDecode(const unsigned char* data, size_t size, std::vector<unsigned char>& bgra,
+               int& width, int& height);
+
+} // namespace Utils
+
+#endif // QOI_CODEC_H
@@ -0,0 +1,79 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Utils {
+
+/**
+ * @brief Pool fijo de threads para repartir tareas independientes
+ *
+ * Los threads se crean una vez y duermen entre trabajos. parallelFor()
+ * reparte las tareas 0..count-1 dinámicamente (el thread que llama también
+ * trabaja) y vuelve cuando terminaron todas. No reserva memoria por trabajo.
+ *
+ * parallelFor() no es reentrante: un solo thread lo usa a la vez.
+ */
+class ThreadPool {
+public:
+    /**
+     * @param threads Threads que participan, contando al que llama
+     *                (0 = std::thread::hardware_concurrency())
+     */
+    explicit ThreadPool(int threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Número de threads que participan (incluye al que llama)
+     */
+    int size() const { return static_cast<int>(workers_.size()) + 1; }
+
+    /**
+     * @brief Ejecuta fn(task, worker) para cada task en [0, count)
+     *
+     * 'worker' está en [0, size()) e identifica al thread, para que cada
+     * uno use sus propios buffers. El reparto de tareas entre threads
+     * varía de una llamada a otra.
+     */
+    template <typename Fn>
+    void parallelFor(int count, Fn& fn) {
+        run(count, &invoke<Fn>, &fn);
+    }
+
+private:
+    typedef void (*TaskFn)(void* context, int task, int worker);
+
+    template <typename Fn>
+    static void invoke(void* context, int task, int worker) {
+        (*static_cast<Fn*>(context))(task, worker);
+    }
+
+    void run(int count, TaskFn fn, void* context);
+    void workerLoop(int worker);
+    void runTasks(int worker);
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable start_cv_;
+    std::condition_variable done_cv_;
+
+    // Trabajo actual (se publica con el mutex tomado)
+    TaskFn fn_;
+    void* context_;
+    int count_;
+    std::atomic<int> next_task_;
+    unsigned long job_;          // Se incrementa con cada trabajo
+    int active_;                 // Workers que todavía no terminaron el trabajo
+    bool stopping_;
+};
+
+} // namespace Utils
+
+#endif // THREAD_POOL_H
@@ -90,8 +90,10 @@ crow::response AuthHandler::handleLogout(const crow::request& req) {
 
 bool AuthHandler::checkPermissions(const crow::request& req, AccessLevel required_level) {
     // Extraer token del header Authorization
-    std::string token = extractToken(req);
+    return checkToken(extractToken(req), required_level);
+}
 
+bool AuthHandler::checkToken(const std::string& token, AccessLevel required_level) {
     (void)required_level;
     
     if (token.empty()) {
@@ -1,5 +1,6 @@
 #include "handlers/http_handler.h"
 #include "handlers/auth_handler.h"
+#include "handlers/websocket_handler.h"
 #include "syscalls/mouse_action.h"
 #include "syscalls/keyboard_caption.h"
 #include <iostream>
@@ -96,6 +97,59 @@ crow::response HTTPHandler::handleKeyPress(const crow::request& req) {
     return crow::response(result == 0 ? 200 : 500, response);
 }
 
+crow::response HTTPHandler::handleTypeText(const crow::request& req, WebSocketHandler& input) {
+    // Verificar autenticación y permisos
+    if (!AuthHandler::checkPermissions(req, AccessLevel::FULL_CONTROL)) {
+        crow::json::wvalue response;
+        response["success"] = false;
+        response["error"] = "Unauthorized: Full control access required";
+        return crow::response(403, response);
+    }
+    
+    auto json_data = crow::json::load(req.body);
+    
+    if (!json_data || !json_data.has("text")) {
+        crow::json::wvalue response;
+        response["success"] = false;
+        response["error"] = "Invalid JSON (expected \"text\")";
+        return crow::response(400, response);
+    }
+    
+    std::string text = json_data["text"].s();
+    if (text.size() > Config::TYPE_TEXT_MAX_BYTES) {
+        crow::json::wvalue response;
+        response["success"] = false;
+        response["error"] = "Text too long";
+        return crow::response(413, response);
+    }
+    
+    Utils::KeyboardLayout layout;
+    std::string layout_name = json_data.has("layout") ? std::string(json_data["layout"].s()) : Config::KEYBOARD_LAYOUT;
+    if (!Utils::parseKeyboardLayout(layout_name, layout)) {
+        crow::json::wvalue response;
+        response["success"] = false;
+        response["error"] = "Unknown layout (us, es, latam)";
+        return crow::response(400, response);
+    }
+    
+    // Escribir 64 KB lleva segundos: lo hace el thread de entrada, en orden
+    // con la entrada por WebSocket, y el worker queda libre
+    size_t bytes = text.size();
+    if (!input.queueTypeText(std::move(text), layout)) {
+        crow::json::wvalue response;
+        response["success"] = false;
+        response["error"] = "Input queue full";
+        return crow::response(503, response);
+    }
+    
+    crow::json::wvalue response;
+    response["success"] = true;
+    response["queued"] = bytes;
+    response["layout"] = Utils::keyboardLayoutName(layout);
+    
+    return crow::response(202, response);
+}
+
 crow::response HTTPHandler::handleHealth() {
     crow::json::wvalue response;
     response["status"] = "healthy";
@@ -1,83 +1,1072 @@
 #include "handlers/websocket_handler.h"
+#include "handlers/auth_handler.h"
+#include "syscalls/input_batch.h"
+#include "syscalls/keyboard_caption.h"
+#include "syscalls/mouse_action.h"
+#include "syscalls/mouse_tracking.h"
 #include "syscalls/screen_live.h"
 #include "syscalls/resources_pc.h"
+#include "utils/base64.h"
+#include "utils/frame_protocol.h"
+#include "utils/pixel_kernels.h"
 #include "crow/json.h"
+#include <algorithm>
 #include <iostream>
 #include <chrono>
 #include <thread>
 
 namespace Handlers {
 
-WebSocketHandler::WebSocketHandler() : running_(false) {}
+namespace {
+
+const size_t RAW_FRAME_BYTES = static_cast<size_t>(Config::SCREEN_WIDTH) * Config::SCREEN_HEIGHT *
+                               Config::BYTES_PER_PIXEL;
+
+// Peor caso de un mensaje: QOI no comprime y todos los tiles cambiaron
+// (cada región suma su cabecera, la más larga es la de MIXED, y la de QOI
+// a los 4 bytes por pixel)
+const size_t MAX_TILES = static_cast<size_t>((Config::SCREEN_WIDTH + Config::TILE_SIZE - 1) / Config::TILE_SIZE) *
+                         ((Config::SCREEN_HEIGHT + Config::TILE_SIZE - 1) / Config::TILE_SIZE);
+const size_t MAX_MOVES = static_cast<size_t>((Config::SCREEN_WIDTH + Config::TILE_SIZE - 1) / Config::TILE_SIZE) +
+                         (Config::SCREEN_HEIGHT + Config::TILE_SIZE - 1) / Config::TILE_SIZE;
+const size_t MESSAGE_BYTES = Utils::FRAME_HEADER_SIZE + 2 + MAX_MOVES * Stream::ScrollDetector::MOVE_SIZE + 2 +
+                             MAX_TILES * (Stream::TileClassifier::REGION_HEADER_SIZE +
+                                          Utils::QoiEncoder::maxEncodedSize(0, 0)) +
+                             RAW_FRAME_BYTES;
+
+// Conexión de Crow como destino de una SendQueue
+class CrowSink : public Stream::MessageSink {
+public:
+    explicit CrowSink(crow::websocket::connection& conn) : conn_(conn) {}
+    void sendBinary(std::string data) override { conn_.send_binary(std::move(data)); }
+    void sendText(std::string data) override { conn_.send_text(std::move(data)); }
+
+private:
+    crow::websocket::connection& conn_;
+};
+
+const size_t CODEC_COUNT = 3;   // Índices de variantIndex() para cada codec en HIGH
+
+size_t codecIndex(Utils::FrameCodec codec) {
+    return static_cast<size_t>(codec) - 1;
+}
+
+// Las capas inferiores de JPEG van después de los codecs
+size_t variantIndex(Utils::FrameCodec codec, Stream::StreamLayer layer) {
+    if (codec == Utils::FrameCodec::JPEG && layer != Stream::StreamLayer::HIGH) {
+        return CODEC_COUNT + static_cast<size_t>(layer) - 1;
+    }
+    return codecIndex(codec);
+}
+
+const char* codecName(Utils::FrameCodec codec) {
+    switch (codec) {
+        case Utils::FrameCodec::QOI: return "qoi";
+        case Utils::FrameCodec::MIXED: return "auto";
+        default: return "jpeg";
+    }
+}
+
+// Registra una tecla o un botón presionado
+void holdCode(std::vector<uint16_t>& held, uint16_t code) {
+    if (std::find(held.begin(), held.end(), code) == held.end()) {
+        held.push_back(code);
+    }
+}
+
+// Quita una tecla o un botón de los presionados; false si no estaba
+bool releaseCode(std::vector<uint16_t>& held, uint16_t code) {
+    auto it = std::find(held.begin(), held.end(), code);
+    if (it == held.end()) {
+        return false;
+    }
+    held.erase(it);
+    return true;
+}
+
+// Los tiles de video son chicos y cambian siempre: un solo thread y baja calidad
+Utils::JpegOptions videoJpegOptions() {
+    Utils::JpegOptions options;
+    options.quality = Config::JPEG_VIDEO_QUALITY;
+    options.threads = 1;
+    return options;
+}
+
+Utils::JpegOptions layerJpegOptions(int quality) {
+    Utils::JpegOptions options;
+    options.quality = quality;
+    return options;
+}
+
+// Frame a mitad de resolución (media 2x2); una columna o fila impar se descarta
+void halveFrame(const unsigned char* bgra, int width, int height, int stride,
+                std::vector<unsigned char>& out) {
+    const Utils::PixelKernels::KernelTable& kernels = Utils::PixelKernels::active();
+    const int half_width = width / 2;
+    out.resize(static_cast<size_t>(half_width) * (height / 2) * Config::BYTES_PER_PIXEL);
+    for (int y = 0; y < height / 2; y++) {
+        const unsigned char* row = bgra + static_cast<size_t>(2 * y) * stride;
+        kernels.downsampleBgra(row, row + stride, half_width,
+                               &out[static_cast<size_t>(y) * half_width * Config::BYTES_PER_PIXEL]);
+    }
+}
+
+// Regiones modificadas a mitad de resolución. La capa "half" no recibe las
+// copias de scroll (un desplazamiento impar no cae en pixeles enteros): sus
+// destinos se vuelven a codificar como regiones
+void halveRects(const std::vector<Stream::TileRect>& dirty, const std::vector<Stream::MoveRect>& moves,
+                int half_width, int half_height, std::vector<Stream::TileRect>& out) {
+    out.clear();
+    auto add = [&](int x, int y, int w, int h) {
+        int x0 = x / 2;
+        int y0 = y / 2;
+        int x1 = std::min((x + w + 1) / 2, half_width);
+        int y1 = std::min((y + h + 1) / 2, half_height);
+        if (x1 > x0 && y1 > y0) {
+            Stream::TileRect rect;
+            rect.x = static_cast<uint16_t>(x0);
+            rect.y = static_cast<uint16_t>(y0);
+            rect.w = static_cast<uint16_t>(x1 - x0);
+            rect.h = static_cast<uint16_t>(y1 - y0);
+            out.push_back(rect);
+        }
+    };
+    for (const Stream::MoveRect& move : moves) {
+        add(move.dst_x, move.dst_y, move.w, move.h);
+    }
+    for (const Stream::TileRect& rect : dirty) {
+        add(rect.x, rect.y, rect.w, rect.h);
+    }
+}
+
+} // namespace
+
+WebSocketHandler::WebSocketHandler()
+    : raw_pool_(Config::RAW_FRAME_SLOTS, RAW_FRAME_BYTES),
+      message_pool_(Config::MESSAGE_SLOTS, MESSAGE_BYTES),
+      pipeline_(Config::PIPELINE_FRAMES),
+      subscribers_(0),
+      running_(false),
+      keyframe_pending_(false),
+      frame_id_(0),
+      jpeg_video_encoder_(videoJpegOptions()),
+      jpeg_low_encoder_(layerJpegOptions(Config::LAYER_LOW_QUALITY)),
+      jpeg_half_encoder_(layerJpegOptions(Config::LAYER_HALF_QUALITY)),
+      motion_pending_(false),
+      input_events_(0),
+      input_dropped_(0),
+      input_failed_(0),
+      input_coalesced_(0) {
+    Utils::ImageEncoder* jpeg_layers[Stream::LAYER_COUNT] = {
+        &jpeg_encoder_, &jpeg_low_encoder_, &jpeg_half_encoder_};
+    for (size_t l = 0; l < Stream::LAYER_COUNT; l++) {
+        Stream::StreamLayer layer = static_cast<Stream::StreamLayer>(l);
+        StreamVariant& variant = variants_[variantIndex(Utils::FrameCodec::JPEG, layer)];
+        variant.codec = Utils::FrameCodec::JPEG;
+        variant.layer = layer;
+        variant.encoder = jpeg_layers[l];
+    }
+    variants_[codecIndex(Utils::FrameCodec::QOI)].codec = Utils::FrameCodec::QOI;
+    variants_[codecIndex(Utils::FrameCodec::QOI)].encoder = &qoi_encoder_;
+    // MIXED no tiene un encoder propio: cada región usa el de su clase
+    variants_[codecIndex(Utils::FrameCodec::MIXED)].codec = Utils::FrameCodec::MIXED;
+    half_frame_.reserve(RAW_FRAME_BYTES / 4);
+    
+    tile_classifier_.setTreatment(Stream::TileClass::TEXT, Utils::FrameCodec::QOI, &qoi_encoder_);
+    tile_classifier_.setTreatment(Stream::TileClass::PHOTO, Utils::FrameCodec::JPEG, &jpeg_encoder_);
+    tile_classifier_.setTreatment(Stream::TileClass::VIDEO, Utils::FrameCodec::JPEG, &jpeg_video_encoder_);
+}
 
 WebSocketHandler::~WebSocketHandler() {
     stop();
 }
 
 void WebSocketHandler::addConnection(crow::websocket::connection& conn) {
-    std::lock_guard<std::mutex> lock(connections_mutex_);
-    connections_.insert(&conn);
-    std::cout << " Nueva conexión WebSocket. Total: " << connections_.size() << std::endl;
+    ClientState client;
+    client.queue = std::make_shared<Stream::SendQueue>(std::unique_ptr<Stream::MessageSink>(new CrowSink(conn)));
+    
+    {
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        connections_[&conn] = client;
+        subscribers_++;
+        std::cout << " Nueva conexión WebSocket. Total: " << connections_.size() << std::endl;
+    }
+    keyframe_pending_ = true;
+    demand_cv_.notify_all();
 }
 
 void WebSocketHandler::removeConnection(crow::websocket::connection& conn) {
-    std::lock_guard<std::mutex> lock(connections_mutex_);
-    connections_.erase(&conn);
-    std::cout << " Conexión WebSocket cerrada. Total: " << connections_.size() << std::endl;
+    std::shared_ptr<Stream::SendQueue> queue;
+    {
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        auto it = connections_.find(&conn);
+        if (it != connections_.end()) {
+            queue = it->second.queue;
+            if (it->second.subscribed) {
+                subscribers_--;
+            }
+            // Un cliente que se va entre presionar y soltar no deja teclas trabadas
+            queueReleases(it->second);
+            connections_.erase(it);
+        }
+        std::cout << " Conexión WebSocket cerrada. Total: " << connections_.size() << std::endl;
+    }
+    
+    // Fuera del lock: close() espera a que termine el envío en curso
+    if (queue) {
+        queue->close();
+    }
 }
 
 void WebSocketHandler::handleMessage(crow::websocket::connection& conn, 
-                                     const std::string& message) {
-    std::cout << " Mensaje recibido: " << message << std::endl;
-    
-    (void)conn;
-
+                                     const std::string& message, bool is_binary) {
+    if (is_binary) {
+        queueInput(conn, message);
+        return;
+    }
     
-    // Aquí podrías parsear comandos del cliente si es necesario
     auto json_msg = crow::json::load(message);
     
     if (json_msg && json_msg.has("command")) {
         std::string command = json_msg["command"].s();
         
-        if (command == "start_stream") {
+        // Solo el comando: "auth" trae el token y "type" el texto pegado.
+        // frame_ack llega con cada frame y no se registra
+        if (command != "frame_ack") {
+            std::cout << " Comando recibido: " << command << std::endl;
+        }
+        
+        if (command == "set_format") {
+            // Negociación: {"command": "set_format", "format": "binary" | "json",
+            //               "codec": "jpeg" | "qoi" | "auto",
+            //               "layer": "auto" | "high" | "low" | "half"}
+            std::string format = json_msg.has("format") ? std::string(json_msg["format"].s()) : "json";
+            bool binary = (format == "binary");
+            // QOI solo viaja en frames binarios; un codec desconocido cae a JPEG
+            Utils::FrameCodec codec = Utils::FrameCodec::JPEG;
+            if (binary && json_msg.has("codec")) {
+                std::string name = json_msg["codec"].s();
+                if (name == "qoi") {
+                    codec = Utils::FrameCodec::QOI;
+                } else if (name == "auto") {
+                    codec = Utils::FrameCodec::MIXED;
+                }
+            }
+            // Las capas son de JPEG; sin "layer" (o con "auto") la elige el servidor
+            Stream::StreamLayer layer = Stream::StreamLayer::HIGH;
+            bool layer_auto = (codec == Utils::FrameCodec::JPEG);
+            if (layer_auto && json_msg.has("layer")) {
+                layer_auto = !Stream::parseLayer(json_msg["layer"].s(), layer);
+            }
+            std::shared_ptr<Stream::SendQueue> queue;
+            {
+                std::lock_guard<std::mutex> lock(connections_mutex_);
+                auto it = connections_.find(&conn);
+                if (it == connections_.end()) {
+                    return;
+                }
+                it->second.binary_frames = binary;
+                it->second.codec = codec;
+                it->second.layer = layer;
+                it->second.layer_auto = layer_auto;
+                it->second.selector.reset();
+                it->second.has_viewport = false;
+                it->second.needs_keyframe = true;
+                queue = it->second.queue;
+            }
+            keyframe_pending_ = true;
+            
+            crow::json::wvalue reply;
+            reply["type"] = "format";
+            reply["format"] = binary ? "binary" : "json";
+            reply["codec"] = codecName(codec);
+            reply["layer"] = layer_auto ? "auto" : Stream::layerName(layer);
+            
+            Stream::OutgoingMessage outgoing;
+            outgoing.data = std::make_shared<const std::string>(reply.dump());
+            queue->pushTelemetry(outgoing);
+            
+            std::cout << "  Formato de frames: " << (binary ? "binario" : "JSON")
+                      << " (" << codecName(codec) << ", capa "
+                      << (layer_auto ? "auto" : Stream::layerName(layer)) << ")" << std::endl;
+        } else if (command == "set_viewport") {
+            // {"command": "set_viewport", "x", "y", "w", "h", "out_w", "out_h"} en pixeles
+            // de pantalla y del canvas del cliente; sin "w"/"h" (o en 0) vuelve a la pantalla completa
+            Stream::Viewport viewport;
+            auto field = [&json_msg](const char* name) {
+                return json_msg.has(name) ? static_cast<uint16_t>(std::max<int64_t>(
+                    0, std::min<int64_t>(json_msg[name].i(), UINT16_MAX))) : static_cast<uint16_t>(0);
+            };
+            viewport.x = field("x");
+            viewport.y = field("y");
+            viewport.w = field("w");
+            viewport.h = field("h");
+            viewport.out_w = field("out_w");
+            viewport.out_h = field("out_h");
+            bool active = viewport.clamp(Config::SCREEN_WIDTH, Config::SCREEN_HEIGHT);
+            
+            std::shared_ptr<Stream::SendQueue> queue;
+            {
+                std::lock_guard<std::mutex> lock(connections_mutex_);
+                auto it = connections_.find(&conn);
+                if (it == connections_.end()) {
+                    return;
+                }
+                // Los viewports viajan solo en frames binarios
+                active = active && it->second.binary_frames;
+                if (active != it->second.has_viewport || !(viewport == it->second.viewport)) {
+                    it->second.has_viewport = active;
+                    it->second.viewport = viewport;
+                    it->second.needs_keyframe = true;
+                    keyframe_pending_ = true;
+                }
+                queue = it->second.queue;
+            }
+            
+            crow::json::wvalue reply;
+            reply["type"] = "viewport";
+            reply["active"] = active;
+            if (active) {
+                int width = 0;
+                int height = 0;
+                viewport.encodedSize(width, height);
+                reply["x"] = viewport.x;
+                reply["y"] = viewport.y;
+                reply["w"] = viewport.w;
+                reply["h"] = viewport.h;
+                reply["width"] = width;
+                reply["height"] = height;
+            }
+            
+            Stream::OutgoingMessage outgoing;
+            outgoing.data = std::make_shared<const std::string>(reply.dump());
+            queue->pushTelemetry(outgoing);
+        } else if (command == "auth") {
+            // {"command": "auth", "token": "..."}: habilita la entrada binaria por
+            // este socket con el mismo criterio que los endpoints HTTP de control
+            std::string token = json_msg.has("token") ? std::string(json_msg["token"].s()) : "";
+            bool view = AuthHandler::checkToken(token, AccessLevel::VIEW_ONLY);
+            bool control = AuthHandler::checkToken(token, AccessLevel::FULL_CONTROL);
+            std::shared_ptr<Stream::SendQueue> queue;
+            {
+                std::lock_guard<std::mutex> lock(connections_mutex_);
+                auto it = connections_.find(&conn);
+                if (it == connections_.end()) {
+                    return;
+                }
+                it->second.can_view = view;
+                it->second.can_control = control;
+                queue = it->second.queue;
+            }
+            
+            crow::json::wvalue reply;
+            reply["type"] = "auth";
+            reply["control"] = control;
+            Stream::OutgoingMessage outgoing;
+            outgoing.data = std::make_shared<const std::string>(reply.dump());
+            queue->pushTelemetry(outgoing);
+        } else if (command == "type") {
+            // {"command": "type", "text": "...", "layout": "us" | "es" | "latam"}:
+            // igual que POST /api/keyboard/type, requiere "auth" con control.
+            // Se escribe en el thread de entrada, en orden con los eventos
+            // binarios, y "typed" llega cuando termina
+            std::shared_ptr<Stream::SendQueue> queue;
+            bool control = false;
+            {
+                std::lock_guard<std::mutex> lock(connections_mutex_);
+                auto it = connections_.find(&conn);
+                if (it == connections_.end()) {
+                    return;
+                }
+                control = it->second.can_control;
+                queue = it->second.queue;
+            }
+            
+            std::string text = json_msg.has("text") ? std::string(json_msg["text"].s()) : "";
+            std::string layout_name = json_msg.has("layout") ? std::string(json_msg["layout"].s()) : Config::KEYBOARD_LAYOUT;
+            Utils::KeyboardLayout layout = Utils::KeyboardLayout::US;
+            if (!control) {
+                std::cerr << " \"type\" sin \"auth\" con permiso de control, se ignora" << std::endl;
+            } else if (text.size() <= Config::TYPE_TEXT_MAX_BYTES && Utils::parseKeyboardLayout(layout_name, layout) &&
+                       queueText(queue, std::move(text), layout)) {
+                return;
+            }
+            
+            crow::json::wvalue reply;
+            reply["type"] = "typed";
+            reply["success"] = false;
+            reply["typed"] = -1;
+            Stream::OutgoingMessage outgoing;
+            outgoing.data = std::make_shared<const std::string>(reply.dump());
+            queue->pushTelemetry(outgoing);
+        } else if (command == "frame_ack") {
+            // {"command": "frame_ack", "bytes": N}: bytes binarios recibidos por
+            // el cliente desde que se conectó. Activa el control de flujo
+            if (!json_msg.has("bytes")) {
+                return;
+            }
+            std::shared_ptr<Stream::SendQueue> queue;
+            {
+                std::lock_guard<std::mutex> lock(connections_mutex_);
+                auto it = connections_.find(&conn);
+                if (it == connections_.end()) {
+                    return;
+                }
+                queue = it->second.queue;
+            }
+            queue->ack(static_cast<uint64_t>(json_msg["bytes"].d()));
+        } else if (command == "stats") {
+            // Como GET /api/stream/stats requiere autenticación: trae la IP y
+            // el permiso de cada cliente conectado
+            std::shared_ptr<Stream::SendQueue> queue;
+            bool view = false;
+            {
+                std::lock_guard<std::mutex> lock(connections_mutex_);
+                auto it = connections_.find(&conn);
+                if (it == connections_.end()) {
+                    return;
+                }
+                view = it->second.can_view;
+                queue = it->second.queue;
+            }
+            
+            Stream::OutgoingMessage outgoing;
+            if (view) {
+                outgoing.data = std::make_shared<const std::string>(getStatsJSON());
+            } else {
+                std::cerr << " \"stats\" sin \"auth\", se rechaza" << std::endl;
+                crow::json::wvalue reply;
+                reply["type"] = "stream_stats";
+                reply["success"] = false;
+                reply["error"] = "Requiere \"auth\"";
+                outgoing.data = std::make_shared<const std::string>(reply.dump());
+            }
+            queue->pushTelemetry(outgoing);
+        } else if (command == "start_stream") {
             std::cout << "  Iniciando streaming..." << std::endl;
+            setSubscribed(conn, true);
         } else if (command == "stop_stream") {
             std::cout << "  Pausando streaming..." << std::endl;
+            setSubscribed(conn, false);
         }
     }
 }
 
+void WebSocketHandler::setSubscribed(crow::websocket::connection& conn, bool subscribed) {
+    {
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        auto it = connections_.find(&conn);
+        if (it == connections_.end() || it->second.subscribed == subscribed) {
+            return;
+        }
+        
+        it->second.subscribed = subscribed;
+        if (subscribed) {
+            // Al reanudar la imagen anterior quedó vieja: empezar con un frame completo
+            it->second.needs_keyframe = true;
+            keyframe_pending_ = true;
+            subscribers_++;
+        } else {
+            subscribers_--;
+        }
+        std::cout << " Clientes suscritos: " << subscribers_ << std::endl;
+    }
+    demand_cv_.notify_all();
+}
+
+bool WebSocketHandler::waitForSubscribers() {
+    std::unique_lock<std::mutex> lock(connections_mutex_);
+    demand_cv_.wait(lock, [this] { return !running_ || subscribers_ > 0; });
+    return running_;
+}
+
+bool WebSocketHandler::captureRegion(Stream::TileRect& region) {
+    if (screen_ring_.isOpen()) {
+        return false;
+    }
+    
+    int x0 = Config::SCREEN_WIDTH;
+    int y0 = Config::SCREEN_HEIGHT;
+    int x1 = 0;
+    int y1 = 0;
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    for (auto& entry : connections_) {
+        const ClientState& client = entry.second;
+        if (!client.subscribed) {
+            continue;
+        }
+        if (!client.binary_frames || !client.has_viewport) {
+            return false;
+        }
+        x0 = std::min<int>(x0, client.viewport.x);
+        y0 = std::min<int>(y0, client.viewport.y);
+        x1 = std::max<int>(x1, client.viewport.x + client.viewport.w);
+        y1 = std::max<int>(y1, client.viewport.y + client.viewport.h);
+    }
+    if (x1 <= x0 || y1 <= y0 ||
+        (x0 == 0 && y0 == 0 && x1 == Config::SCREEN_WIDTH && y1 == Config::SCREEN_HEIGHT)) {
+        return false;
+    }
+    
+    region.x = static_cast<uint16_t>(x0);
+    region.y = static_cast<uint16_t>(y0);
+    region.w = static_cast<uint16_t>(x1 - x0);
+    region.h = static_cast<uint16_t>(y1 - y0);
+    return true;
+}
+
+int WebSocketHandler::captureFrame(Stream::FrameRef& raw, const unsigned char*& bgra,
+                                   const uint8_t*& damage, screen_capture_info& info,
+                                   const Stream::TileRect* region) {
+    damage = nullptr;
+    if (screen_ring_.isOpen()) {
+        uint64_t sequence = 0;
+        if (screen_ring_.capture(bgra, info, sequence) != 0) {
+            return -1;
+        }
+        // El bitmap solo sirve si usa los mismos tiles que el encoder
+        if (screen_ring_.tileSize() == static_cast<unsigned int>(tile_encoder_.tileSize())) {
+            damage = screen_ring_.damage();
+        }
+        return 0;
+    }
+    
+    raw = raw_pool_.acquire();
+    if (!raw) {
+        std::cerr << " Sin buffers de captura libres" << std::endl;
+        return -1;
+    }
+    int result = region
+        ? Syscalls::captureScreenRegion(region->x, region->y, region->w, region->h,
+                                        raw.data(), raw.capacity(), info)
+        : Syscalls::captureScreen(raw.data(), raw.capacity(), info);
+    if (result != 0) {
+        return -1;
+    }
+    raw.setSize(info.buffer_size);
+    bgra = raw.data();
+    return 0;
+}
+
 void WebSocketHandler::screenshotLoop() {
     std::cout << " Thread de screenshots iniciado" << std::endl;
     
-    while (running_) {
-        // Obtener screenshot en Base64
-        std::string base64_image = Syscalls::getScreenshotBase64();
+    // Sin soporte del kernel se sigue usando screen_live (una copia más)
+    if (screen_ring_.open() != 0) {
+        std::cout << " Usando screen_live para capturar" << std::endl;
+    }
+    
+    encode_thread_ = std::thread(&WebSocketHandler::encodeLoop, this);
+    uint32_t ticks = 0;
+    
+    while (waitForSubscribers()) {
+        auto frame_start = std::chrono::steady_clock::now();
+        bool changed = false;
         
-        if (!base64_image.empty()) {
-            // Crear mensaje JSON
-            crow::json::wvalue json_msg;
-            json_msg["type"] = "screenshot";
-            json_msg["data"] = base64_image;
-            json_msg["timestamp"] = std::chrono::system_clock::now().time_since_epoch().count();
+        // Sin slot libre no se captura: el slot del anillo o del pool que
+        // usaría todavía lo está codificando la etapa siguiente
+        CapturedFrame* frame = waitForPipelineSlot();
+        if (!frame) {
+            break;
+        }
+        
+        auto capture_start = std::chrono::steady_clock::now();
+        const uint8_t* damage = nullptr;
+        Stream::TileRect region;
+        frame->partial = captureRegion(region);
+        if (captureFrame(frame->raw, frame->bgra, damage, frame->info,
+                         frame->partial ? &region : nullptr) == 0) {
+            const screen_capture_info& info = frame->info;
+            if (frame->partial) {
+                // El kernel devuelve la región recortada a la pantalla
+                frame->region.x = static_cast<uint16_t>(info.x);
+                frame->region.y = static_cast<uint16_t>(info.y);
+                frame->region.w = static_cast<uint16_t>(info.w);
+                frame->region.h = static_cast<uint16_t>(info.h);
+            } else {
+                frame->region.x = 0;
+                frame->region.y = 0;
+                frame->region.w = static_cast<uint16_t>(info.width);
+                frame->region.h = static_cast<uint16_t>(info.height);
+            }
+            // Las huellas solo sirven contra una captura de la misma zona
+            const Stream::TileRect& area = frame->region;
+            if (area.x != last_region_.x || area.y != last_region_.y ||
+                area.w != last_region_.w || area.h != last_region_.h) {
+                tile_encoder_.reset();
+                last_region_ = area;
+            }
+            int stride = area.w * Config::BYTES_PER_PIXEL;
+            // Con el bitmap del kernel no hace falta comparar con el frame anterior
+            size_t dirty_tiles = damage
+                ? tile_encoder_.updateFromDamage(damage, info.width, info.height, frame->dirty)
+                : tile_encoder_.update(frame->bgra, area.w, area.h, stride, frame->dirty);
+            for (Stream::TileRect& rect : frame->dirty) {
+                rect.x = static_cast<uint16_t>(rect.x + area.x);
+                rect.y = static_cast<uint16_t>(rect.y + area.y);
+            }
+            changed = (dirty_tiles > 0);
             
-            std::string message = json_msg.dump();
+            frame->periodic_keyframe = (++ticks % Config::KEYFRAME_INTERVAL == 0);
+            frame->captured_at = capture_start;
+            capture_stats_.record(std::chrono::steady_clock::now() - capture_start);
             
-            // Enviar a todos los clientes
-            broadcast(message);
+            pipeline_.push();
+            notifyPipeline();
+        } else {
+            frame->raw.reset();
         }
         
-        // Esperar según FPS configurado (1 FPS = 1000ms)
-        std::this_thread::sleep_for(std::chrono::milliseconds(1000 / Config::FPS));
+        if (screen_ring_.canWait()) {
+            // Por eventos: el kernel avisa cuando la pantalla cambia
+            waitForScreenChange(scheduler_.waitMinInterval(frame_start));
+        } else {
+            // Entre Config::IDLE_FPS y Config::MAX_FPS según la actividad
+            scheduler_.waitNextFrame(frame_start, changed);
+        }
+    }
+    
+    // La codificación termina con lo pendiente antes de cerrar el anillo
+    notifyPipeline();
+    if (encode_thread_.joinable()) {
+        encode_thread_.join();
     }
     
+    screen_ring_.close();
     std::cout << " Thread de screenshots detenido" << std::endl;
 }
 
+WebSocketHandler::CapturedFrame* WebSocketHandler::waitForPipelineSlot() {
+    CapturedFrame* slot = nullptr;
+    // Solo duerme con la cola llena
+    pipeline_event_.await([this, &slot] {
+        return !running_ || (slot = pipeline_.producerSlot()) != nullptr;
+    });
+    return running_ ? slot : nullptr;
+}
+
+void WebSocketHandler::notifyPipeline() {
+    // Sin syscall si el otro thread no está durmiendo
+    pipeline_event_.notify();
+}
+
+void WebSocketHandler::encodeLoop() {
+    std::cout << " Thread de codificación iniciado" << std::endl;
+    
+    while (true) {
+        CapturedFrame* frame = nullptr;
+        // Solo duerme con la cola vacía
+        pipeline_event_.await([this, &frame] {
+            return (frame = pipeline_.front()) != nullptr || !running_;
+        });
+        if (!frame) {
+            break;
+        }
+        
+        auto encode_start = std::chrono::steady_clock::now();
+        if (frame->partial) {
+            // Una región no sirve para comparar filas con la pantalla completa
+            frame->moves.clear();
+            scroll_detector_.reset();
+        } else {
+            // Sobre el frame anterior de la codificación: el mismo que tienen los clientes al día
+            scroll_detector_.detect(frame->bgra, frame->info.width, frame->info.height,
+                                    frame->info.width * Config::BYTES_PER_PIXEL, frame->dirty, frame->moves);
+        }
+        broadcastFrame(*frame);
+        broadcastViewports(*frame);
+        auto encode_end = std::chrono::steady_clock::now();
+        encode_stats_.record(encode_end - encode_start);
+        pipeline_stats_.record(encode_end - frame->captured_at);
+        
+        // Liberar el slot de captura antes de devolver el elemento a la cola
+        frame->raw.reset();
+        pipeline_.pop();
+        notifyPipeline();
+    }
+    
+    std::cout << " Thread de codificación detenido" << std::endl;
+}
+
+void WebSocketHandler::waitForScreenChange(std::chrono::steady_clock::time_point deadline) {
+    // Por tramos cortos para notar stop() y nuevos suscriptores sin esperar al timeout
+    while (running_ && !keyframe_pending_.exchange(false)) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0) {
+            return;
+        }
+        int slice = static_cast<int>(std::min<long long>(remaining, Config::CHANGE_WAIT_SLICE_MS));
+        if (screen_ring_.waitForChange(slice) != 0) {
+            return;
+        }
+    }
+}
+
+void WebSocketHandler::broadcastFrame(const CapturedFrame& frame) {
+    const unsigned char* bgra = frame.bgra;
+    const screen_capture_info& info = frame.info;
+    const bool periodic_keyframe = frame.periodic_keyframe;
+    const bool changed = !frame.dirty.empty() || !frame.moves.empty();
+    const int stride = info.width * Config::BYTES_PER_PIXEL;
+    const size_t mixed = codecIndex(Utils::FrameCodec::MIXED);
+    const size_t half = variantIndex(Utils::FrameCodec::JPEG, Stream::StreamLayer::HALF);
+    
+    // Qué representaciones hacen falta en este tick (por variante)
+    bool need_keyframe[VARIANT_COUNT] = {};
+    bool need_tiles[VARIANT_COUNT] = {};
+    bool need_json[VARIANT_COUNT] = {};
+    bool needed = false;
+    bool classify = false;   // Hay clientes MIXED: el historial de los tiles debe avanzar
+    {
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        auto now = std::chrono::steady_clock::now();
+        for (auto& entry : connections_) {
+            ClientState& client = entry.second;
+            if (!client.subscribed || (client.binary_frames && client.has_viewport)) {
+                continue;
+            }
+            // Un delta descartado en la cola deja al cliente desincronizado
+            if (client.queue->takeResyncRequest()) {
+                client.needs_keyframe = true;
+            }
+            if (frame.partial) {
+                // Llegó (o dejó su viewport) después de decidir la captura: la
+                // próxima será completa
+                client.needs_keyframe = true;
+                keyframe_pending_ = true;
+                continue;
+            }
+            if (client.layer_auto) {
+                Stream::SendQueueStats stats = client.queue->stats();
+                if (client.selector.update(stats, now)) {
+                    setLayer(client, client.selector.layer());
+                }
+            }
+            size_t v = variantIndex(client.codec, client.layer);
+            if (client.binary_frames) {
+                classify = classify || v == mixed;
+                if (client.needs_keyframe || periodic_keyframe) {
+                    need_keyframe[v] = needed = true;
+                } else if (changed) {
+                    need_tiles[v] = needed = true;
+                }
+            } else if (client.needs_keyframe || changed) {
+                need_json[v] = needed = true;
+            }
+        }
+    }
+    
+    // Cada frame cuenta para la frecuencia de cambio, aunque no se envíe nada
+    if (classify && !frame.partial) {
+        tile_classifier_.update(bgra, info.width, info.height, stride, frame.dirty);
+    } else {
+        tile_classifier_.reset();
+    }
+    
+    if (!needed) {
+        return;
+    }
+    
+    // La capa "half" se codifica desde su propia imagen reducida
+    const int half_width = info.width / 2;
+    const int half_height = info.height / 2;
+    const int half_stride = half_width * Config::BYTES_PER_PIXEL;
+    if (need_keyframe[half] || need_tiles[half] || need_json[half]) {
+        halveFrame(bgra, info.width, info.height, stride, half_frame_);
+    }
+    if (need_tiles[half]) {
+        halveRects(frame.dirty, frame.moves, half_width, half_height, half_rects_);
+    }
+    
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    frame_id_++;
+    
+    Utils::FrameHeader header;
+    header.frame_id = frame_id_;
+    header.timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(now).count();
+    
+    // Mensajes compartidos por todas las colas de este tick
+    // Las copias se comparten entre los mensajes de tiles de resolución completa
+    moves_payload_.clear();
+    if (!frame.moves.empty()) {
+        Stream::ScrollDetector::writeMoves(frame.moves, moves_payload_);
+    }
+    
+    Stream::OutgoingMessage keyframe_message[VARIANT_COUNT];
+    Stream::OutgoingMessage tiles_message[VARIANT_COUNT];
+    Stream::OutgoingMessage json_message[VARIANT_COUNT];
+    
+    bool tiles_lost[VARIANT_COUNT] = {};   // Los clientes que esperaban tiles quedan desincronizados
+    
+    for (size_t v = 0; v < VARIANT_COUNT; v++) {
+        StreamVariant& variant = variants_[v];
+        const bool halved = (v == half);
+        const unsigned char* pixels = halved ? half_frame_.data() : bgra;
+        const int width = halved ? half_width : info.width;
+        const int height = halved ? half_height : info.height;
+        const int pixels_stride = halved ? half_stride : stride;
+        header.codec = variant.codec;
+        header.width = static_cast<uint16_t>(width);
+        header.height = static_cast<uint16_t>(height);
+        
+        // El frame completo se codifica una vez para keyframes y clientes JSON.
+        // En MIXED el keyframe son todas las regiones de la pantalla
+        if (need_keyframe[v] || need_json[v]) {
+            bool encoded;
+            if (v == mixed) {
+                tile_classifier_.fullFrame(regions_);
+                encoded = tile_classifier_.encodeRegions(bgra, stride, regions_, variant.frame_data);
+            } else {
+                encoded = variant.encoder->encode(pixels, width, height, pixels_stride, variant.frame_data);
+            }
+            if (!encoded) {
+                // Los clientes de esta variante reintentan el keyframe en el próximo tick
+                std::cerr << " Error al codificar el frame (" << codecName(variant.codec) << ", "
+                          << Stream::layerName(variant.layer) << ")" << std::endl;
+                need_keyframe[v] = false;
+                need_json[v] = false;
+            }
+        }
+        
+        if (need_keyframe[v]) {
+            Stream::OutgoingMessage& message = keyframe_message[v];
+            message.frame = message_pool_.acquire();
+            header.type = Utils::FrameType::SCREENSHOT;
+            header.flags = Utils::FRAME_FLAG_KEYFRAME;
+            size_t size = message.frame
+                ? Utils::writeFrameMessage(header, variant.frame_data.data(), variant.frame_data.size(),
+                                           message.frame.data(), message.frame.capacity())
+                : 0;
+            if (size == 0) {
+                std::cerr << " Sin buffer para el keyframe, se reintenta en el próximo frame" << std::endl;
+                message.frame.reset();
+                need_keyframe[v] = false;
+            } else {
+                message.frame.setSize(size);
+                message.binary = true;
+                message.keyframe = true;
+            }
+        }
+        
+        if (need_tiles[v]) {
+            Stream::OutgoingMessage& message = tiles_message[v];
+            message.frame = message_pool_.acquire();
+            size_t size = 0;
+            bool encoded;
+            if (v == mixed) {
+                tile_classifier_.split(frame.dirty, regions_);
+                encoded = tile_classifier_.encodeRegions(bgra, stride, regions_, variant.tiles_payload);
+            } else {
+                encoded = tile_encoder_.encodeTiles(pixels, pixels_stride, halved ? half_rects_ : frame.dirty,
+                                                    *variant.encoder, variant.tiles_payload);
+            }
+            if (!encoded) {
+                std::cerr << " Error al codificar tiles" << std::endl;
+            } else if (message.frame) {
+                const bool moves = !halved && !frame.moves.empty();
+                header.type = Utils::FrameType::TILES;
+                header.flags = moves ? Utils::FRAME_FLAG_MOVES : 0;
+                size = Utils::writeFrameMessage(header, moves_payload_.data(), moves ? moves_payload_.size() : 0,
+                                                variant.tiles_payload.data(), variant.tiles_payload.size(),
+                                                message.frame.data(), message.frame.capacity());
+            }
+            if (size == 0) {
+                message.frame.reset();
+                need_tiles[v] = false;
+                tiles_lost[v] = true;
+            } else {
+                message.frame.setSize(size);
+                message.binary = true;
+                message.keyframe = false;
+            }
+        }
+        
+        if (need_json[v]) {
+            // Formato legado: JPEG en Base64 dentro de JSON (siempre es un frame completo)
+            crow::json::wvalue json_msg;
+            json_msg["type"] = "screenshot";
+            json_msg["data"] = Utils::base64Encode(variant.frame_data);
+            json_msg["timestamp"] = now.count();
+            json_message[v].data = std::make_shared<const std::string>(json_msg.dump());
+            json_message[v].binary = false;
+            json_message[v].keyframe = true;
+        }
+    }
+    
+    // Encolar no bloquea: el envío real lo hace el thread de cada conexión
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    
+    for (auto& entry : connections_) {
+        ClientState& client = entry.second;
+        if (!client.subscribed || (client.binary_frames && client.has_viewport)) {
+            continue;
+        }
+        size_t v = variantIndex(client.codec, client.layer);
+        if (client.binary_frames) {
+            if (client.needs_keyframe || periodic_keyframe) {
+                // Un cliente que llegó (o cambió de codec) después del escaneo espera al próximo tick
+                if (need_keyframe[v]) {
+                    client.queue->pushFrame(keyframe_message[v]);
+                    client.needs_keyframe = false;
+                } else {
+                    // Sin keyframe en este tick (o sin buffer): tampoco recibió los tiles
+                    client.needs_keyframe = true;
+                    keyframe_pending_ = true;
+                }
+            } else if (need_tiles[v]) {
+                client.queue->pushFrame(tiles_message[v]);
+            } else if (tiles_lost[v]) {
+                client.needs_keyframe = true;
+                keyframe_pending_ = true;
+            }
+        } else if (need_json[v] && (client.needs_keyframe || changed)) {
+            client.queue->pushFrame(json_message[v]);
+            client.needs_keyframe = false;
+        }
+    }
+}
+
+void WebSocketHandler::broadcastViewports(const CapturedFrame& frame) {
+    viewport_jobs_.clear();
+    {
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        for (auto& entry : connections_) {
+            ClientState& client = entry.second;
+            if (!client.subscribed || !client.binary_frames || !client.has_viewport) {
+                continue;
+            }
+            if (!client.needs_keyframe && !frame.periodic_keyframe &&
+                !client.viewport.touches(frame.dirty, frame.moves)) {
+                continue;
+            }
+            // MIXED clasifica tiles de la pantalla: para una región ampliada se usa JPEG
+            Utils::FrameCodec codec = client.codec == Utils::FrameCodec::QOI
+                ? Utils::FrameCodec::QOI : Utils::FrameCodec::JPEG;
+            bool shared = false;
+            for (const ViewportJob& job : viewport_jobs_) {
+                shared = shared || (job.viewport == client.viewport && job.codec == codec);
+            }
+            if (!shared) {
+                ViewportJob job;
+                job.viewport = client.viewport;
+                job.codec = codec;
+                viewport_jobs_.push_back(job);
+            }
+        }
+    }
+    
+    if (viewport_jobs_.empty()) {
+        return;
+    }
+    
+    const Stream::TileRect& area = frame.region;
+    const int stride = area.w * Config::BYTES_PER_PIXEL;
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    
+    for (ViewportJob& job : viewport_jobs_) {
+        const Stream::Viewport& viewport = job.viewport;
+        // Un viewport que cambió después de decidir la captura puede quedar fuera de ella
+        if (viewport.x < area.x || viewport.y < area.y ||
+            viewport.x + viewport.w > area.x + area.w || viewport.y + viewport.h > area.y + area.h) {
+            continue;
+        }
+        
+        int width = 0;
+        int height = 0;
+        int scaled_stride = 0;
+        viewport.encodedSize(width, height);
+        const unsigned char* origin = frame.bgra + static_cast<size_t>(viewport.y - area.y) * stride +
+                                      (viewport.x - area.x) * Config::BYTES_PER_PIXEL;
+        const unsigned char* scaled = viewport_scaler_.scale(origin, stride, viewport.w, viewport.h,
+                                                             width, height, scaled_stride);
+        Utils::ImageEncoder& encoder = job.codec == Utils::FrameCodec::QOI
+            ? static_cast<Utils::ImageEncoder&>(qoi_encoder_) : jpeg_encoder_;
+        if (!encoder.encode(scaled, width, height, scaled_stride, viewport_data_)) {
+            std::cerr << " Error al codificar el viewport" << std::endl;
+            continue;
+        }
+        
+        Utils::FrameHeader header;
+        header.type = Utils::FrameType::VIEWPORT;
+        header.codec = job.codec;
+        header.flags = Utils::FRAME_FLAG_KEYFRAME;
+        header.frame_id = ++frame_id_;
+        header.timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(now).count();
+        header.width = static_cast<uint16_t>(width);
+        header.height = static_cast<uint16_t>(height);
+        
+        unsigned char prefix[Stream::ViewportScaler::HEADER_SIZE];
+        Stream::ViewportScaler::writeHeader(viewport, prefix);
+        job.message.frame = message_pool_.acquire();
+        size_t size = job.message.frame
+            ? Utils::writeFrameMessage(header, prefix, sizeof(prefix), viewport_data_.data(), viewport_data_.size(),
+                                       job.message.frame.data(), job.message.frame.capacity())
+            : 0;
+        if (size == 0) {
+            std::cerr << " Sin buffer para el viewport, se reintenta en el próximo frame" << std::endl;
+            job.message.frame.reset();
+            continue;
+        }
+        job.message.frame.setSize(size);
+        job.message.binary = true;
+        job.message.keyframe = true;   // Cada imagen reemplaza a la anterior
+    }
+    
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    for (auto& entry : connections_) {
+        ClientState& client = entry.second;
+        if (!client.subscribed || !client.binary_frames || !client.has_viewport) {
+            continue;
+        }
+        Utils::FrameCodec codec = client.codec == Utils::FrameCodec::QOI
+            ? Utils::FrameCodec::QOI : Utils::FrameCodec::JPEG;
+        for (const ViewportJob& job : viewport_jobs_) {
+            if (!(job.viewport == client.viewport) || job.codec != codec) {
+                continue;
+            }
+            if (job.message.frame) {
+                client.queue->pushFrame(job.message);
+                client.needs_keyframe = false;
+            } else {
+                client.needs_keyframe = true;
+                keyframe_pending_ = true;
+            }
+        }
+    }
+}
+
+void WebSocketHandler::setLayer(ClientState& client, Stream::StreamLayer layer) {
+    if (layer == client.layer) {
+        return;
+    }
+    bool resize = (layer == Stream::StreamLayer::HALF) != (client.layer == Stream::StreamLayer::HALF);
+    client.layer = layer;
+    if (resize) {
+        client.needs_keyframe = true;
+        keyframe_pending_ = true;
+    }
+    
+    crow::json::wvalue notice;
+    notice["type"] = "layer";
+    notice["layer"] = Stream::layerName(layer);
+    notice["drain_percent"] = client.selector.drainPercent();
+    notice["drain_kbps"] = client.selector.drainKbps();
+    notice["stall_percent"] = client.selector.stallPercent();
+    
+    Stream::OutgoingMessage outgoing;
+    outgoing.data = std::make_shared<const std::string>(notice.dump());
+    client.queue->pushTelemetry(outgoing);
+    
+    std::cout << " Capa del cliente: " << Stream::layerName(layer) << " (drena "
+              << client.selector.drainPercent() << "%, " << client.selector.drainKbps()
+              << " kbit/s, frenada " << client.selector.stallPercent() << "%)" << std::endl;
+}
+
 void WebSocketHandler::resourcesLoop() {
     std::cout << " Thread de recursos iniciado" << std::endl;
     
-    while (running_) {
+    while (waitForSubscribers()) {
         // Obtener recursos en JSON
         std::string resources_json = Syscalls::getResourcesJSON();
         
@@ -85,8 +1074,9 @@ void WebSocketHandler::resourcesLoop() {
             broadcast(resources_json);
         }
         
-        // Actualizar cada 2 segundos
-        std::this_thread::sleep_for(std::chrono::seconds(2));
+        // Actualizar cada 2 segundos (stop() interrumpe la espera)
+        std::unique_lock<std::mutex> lock(connections_mutex_);
+        demand_cv_.wait_for(lock, std::chrono::seconds(2), [this] { return !running_; });
     }
     
     std::cout << " Thread de recursos detenido" << std::endl;
@@ -103,6 +1093,7 @@ void WebSocketHandler::start() {
     // Iniciar threads
     screenshot_thread_ = std::thread(&WebSocketHandler::screenshotLoop, this);
     resources_thread_ = std::thread(&WebSocketHandler::resourcesLoop, this);
+    input_thread_ = std::thread(&WebSocketHandler::inputLoop, this);
     
     std::cout << " WebSocket Handler iniciado" << std::endl;
 }
@@ -112,7 +1103,18 @@ void WebSocketHandler::stop() {
         return;
     }
     
-    running_ = false;
+    {
+        // Con el lock tomado para que ningún loop pierda el aviso
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        running_ = false;
+    }
+    demand_cv_.notify_all();
+    scheduler_.wake();
+    notifyPipeline();
+    {
+        std::lock_guard<std::mutex> lock(input_mutex_);
+    }
+    input_cv_.notify_all();
     
     // Esperar a que los threads terminen
     if (screenshot_thread_.joinable()) {
@@ -121,20 +1123,434 @@ void WebSocketHandler::stop() {
     if (resources_thread_.joinable()) {
         resources_thread_.join();
     }
+    if (input_thread_.joinable()) {
+        input_thread_.join();
+    }
+    
+    // Detener los threads de envío (fuera del lock del registro)
+    std::vector<std::shared_ptr<Stream::SendQueue>> queues;
+    {
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        for (auto& entry : connections_) {
+            queues.push_back(entry.second.queue);
+        }
+    }
+    for (auto& queue : queues) {
+        queue->close();
+    }
     
     std::cout << " WebSocket Handler detenido" << std::endl;
 }
 
+void WebSocketHandler::notifyInput() {
+    scheduler_.notifyInput();
+    screen_ring_.notifyActivity();
+}
+
+void WebSocketHandler::queueInput(crow::websocket::connection& conn, const std::string& message) {
+    std::vector<Utils::InputMessage> messages;
+    if (!Utils::parseInputMessages(message, messages)) {
+        std::cerr << " Mensaje de entrada inválido (" << message.size() << " bytes)" << std::endl;
+        return;
+    }
+    
+    // connections_mutex_ durante todo el encolado: lo presionado por el
+    // cliente (held_keys/held_buttons) cambia junto con la cola
+    std::lock_guard<std::mutex> clients_lock(connections_mutex_);
+    auto client = connections_.find(&conn);
+    if (client == connections_.end()) {
+        return;
+    }
+    if (!client->second.can_control) {
+        std::cerr << " Entrada binaria sin \"auth\" con permiso de control, se ignora" << std::endl;
+        return;
+    }
+    ClientState& state = client->second;
+    
+    auto now = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(input_mutex_);
+        for (const Utils::InputMessage& input : messages) {
+            PendingInput pending;
+            pending.message = input;
+            pending.queue = state.queue;
+            pending.received_at = now;
+            
+            // Solo importa la última posición: una vieja nunca espera en la cola
+            if (input.type == Utils::InputType::MOVE) {
+                if (motion_pending_) {
+                    input_coalesced_++;
+                }
+                motion_ = std::move(pending);
+                motion_pending_ = true;
+                continue;
+            }
+            
+            // Soltar algo que se presionó nunca se descarta: la tecla o el
+            // botón quedaría presionado en el dispositivo virtual
+            bool release = false;
+            if (input.type == Utils::InputType::KEY_UP) {
+                release = releaseCode(state.held_keys, input.code);
+            } else if (input.type == Utils::InputType::BUTTON_UP) {
+                release = releaseCode(state.held_buttons, input.code);
+            }
+            if (!release && input_queue_.size() >= static_cast<size_t>(Config::INPUT_QUEUE_EVENTS)) {
+                input_dropped_++;
+                continue;
+            }
+            if (input.type == Utils::InputType::KEY_DOWN) {
+                holdCode(state.held_keys, input.code);
+            } else if (input.type == Utils::InputType::BUTTON_DOWN) {
+                holdCode(state.held_buttons, input.code);
+            }
+            if (motion_pending_) {
+                if (input.type == Utils::InputType::BUTTON_DOWN || input.type == Utils::InputType::BUTTON_UP) {
+                    input_coalesced_++;
+                } else {
+                    input_queue_.push_back(std::move(motion_));
+                }
+                motion_pending_ = false;
+            }
+            input_queue_.push_back(std::move(pending));
+        }
+    }
+    input_cv_.notify_one();
+}
+
+void WebSocketHandler::queueReleases(const ClientState& client) {
+    if (client.held_keys.empty() && client.held_buttons.empty()) {
+        return;
+    }
+    std::cout << " Soltando " << client.held_keys.size() << " teclas y " << client.held_buttons.size()
+              << " botones de la conexión cerrada" << std::endl;
+    
+    auto now = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(input_mutex_);
+        auto push = [this, now](Utils::InputType type, uint16_t code) {
+            PendingInput pending;
+            pending.message = Utils::InputMessage();
+            pending.message.type = type;
+            pending.message.code = code;
+            pending.received_at = now;
+            pending.release = true;
+            input_queue_.push_back(std::move(pending));
+        };
+        for (uint16_t code : client.held_buttons) {
+            push(Utils::InputType::BUTTON_UP, code);
+        }
+        for (uint16_t code : client.held_keys) {
+            push(Utils::InputType::KEY_UP, code);
+        }
+    }
+    input_cv_.notify_one();
+}
+
+bool WebSocketHandler::queueTypeText(std::string text, Utils::KeyboardLayout layout) {
+    return queueText(nullptr, std::move(text), layout);
+}
+
+bool WebSocketHandler::queueText(const std::shared_ptr<Stream::SendQueue>& queue, std::string text,
+                                 Utils::KeyboardLayout layout) {
+    PendingInput pending;
+    pending.message = Utils::InputMessage();
+    pending.queue = queue;
+    pending.received_at = std::chrono::steady_clock::now();
+    pending.text = std::make_shared<const std::string>(std::move(text));
+    pending.layout = layout;
+    {
+        std::lock_guard<std::mutex> lock(input_mutex_);
+        if (input_queue_.size() >= static_cast<size_t>(Config::INPUT_QUEUE_EVENTS)) {
+            input_dropped_++;
+            return false;
+        }
+        // Como cualquier evento discreto, va después de la posición pendiente
+        if (motion_pending_) {
+            input_queue_.push_back(std::move(motion_));
+            motion_pending_ = false;
+        }
+        input_queue_.push_back(std::move(pending));
+    }
+    input_cv_.notify_one();
+    return true;
+}
+
+void WebSocketHandler::inputLoop() {
+    std::vector<PendingInput> events;
+    std::vector<const Stream::SendQueue*> acked;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(input_mutex_);
+            input_cv_.wait(lock, [this] { return !running_ || !input_queue_.empty() || motion_pending_; });
+            // Con solo movimiento pendiente se espera al próximo tick (un evento
+            // discreto despierta antes); mientras tanto las posiciones se reemplazan
+            auto next_motion = motion_injected_at_ + std::chrono::microseconds(Config::INPUT_MOTION_TICK_US);
+            input_cv_.wait_until(lock, next_motion, [this] { return !running_ || !input_queue_.empty(); });
+            if (!running_) {
+                return;
+            }
+            events.assign(std::make_move_iterator(input_queue_.begin()),
+                          std::make_move_iterator(input_queue_.end()));
+            input_queue_.clear();
+            // La posición pendiente es posterior a todo lo encolado
+            if (motion_pending_) {
+                events.push_back(std::move(motion_));
+                motion_pending_ = false;
+                motion_injected_at_ = std::chrono::steady_clock::now();
+            }
+        }
+        
+        bool applied = injectInput(events);
+        notifyInput();
+        
+        auto now = std::chrono::steady_clock::now();
+        for (const PendingInput& pending : events) {
+            input_stats_.record(now - pending.received_at);
+        }
+        {
+            std::lock_guard<std::mutex> lock(input_mutex_);
+            (applied ? input_events_ : input_failed_) += events.size();
+        }
+        
+        // Un input_ack por conexión con el último seq inyectado (confirma también
+        // los anteriores); si el lote falló, un input_nack con el mismo alcance.
+        // Los "type" no tienen seq: se responden aparte con "typed"
+        acked.clear();
+        for (auto it = events.rbegin(); it != events.rend(); ++it) {
+            if (it->text || it->release) {
+                continue;
+            }
+            if (std::find(acked.begin(), acked.end(), it->queue.get()) != acked.end()) {
+                continue;
+            }
+            acked.push_back(it->queue.get());
+            crow::json::wvalue ack;
+            ack["type"] = applied ? "input_ack" : "input_nack";
+            ack["seq"] = it->message.seq;
+            Stream::OutgoingMessage outgoing;
+            outgoing.data = std::make_shared<const std::string>(ack.dump());
+            it->queue->pushTelemetry(outgoing);
+        }
+        for (const PendingInput& pending : events) {
+            if (!pending.text) {
+                continue;
+            }
+            if (!pending.queue) {
+                // Vino por HTTP, que ya respondió 202
+                if (!applied || pending.typed < 0) {
+                    std::cerr << " Error escribiendo texto de /api/keyboard/type" << std::endl;
+                }
+                continue;
+            }
+            crow::json::wvalue reply;
+            reply["type"] = "typed";
+            reply["success"] = applied && pending.typed >= 0;
+            reply["typed"] = applied ? pending.typed : -1;
+            Stream::OutgoingMessage outgoing;
+            outgoing.data = std::make_shared<const std::string>(reply.dump());
+            pending.queue->pushTelemetry(outgoing);
+        }
+        events.clear();
+    }
+}
+
+bool WebSocketHandler::injectInput(std::vector<PendingInput>& events) {
+    // input_batch recorta las posiciones a la pantalla real; las syscalls de
+    // una acción esperan coordenadas dentro de Config::SCREEN_WIDTH x SCREEN_HEIGHT
+    auto clampX = [](int x) { return std::min(std::max(x, 0), Config::SCREEN_WIDTH - 1); };
+    auto clampY = [](int y) { return std::min(std::max(y, 0), Config::SCREEN_HEIGHT - 1); };
+    
+    if (Syscalls::InputBatch::supported()) {
+        Syscalls::InputBatch batch;
+        for (PendingInput& pending : events) {
+            if (pending.text) {
+                pending.typed = Syscalls::appendText(batch, *pending.text, pending.layout);
+                continue;
+            }
+            const Utils::InputMessage& input = pending.message;
+            switch (input.type) {
+                case Utils::InputType::MOVE:
+                    batch.move(input.x, input.y);
+                    break;
+                case Utils::InputType::BUTTON_DOWN:
+                case Utils::InputType::BUTTON_UP:
+                    // El botón se aplica donde lo vio el cliente (una liberación
+                    // al cerrar la conexión, donde esté el cursor)
+                    if (!pending.release) {
+                        batch.move(input.x, input.y);
+                    }
+                    if (input.type == Utils::InputType::BUTTON_DOWN) {
+                        batch.buttonDown(input.code);
+                    } else {
+                        batch.buttonUp(input.code);
+                    }
+                    break;
+                case Utils::InputType::KEY_DOWN:
+                    batch.keyDown(input.code);
+                    break;
+                case Utils::InputType::KEY_UP:
+                    batch.keyUp(input.code);
+                    break;
+                case Utils::InputType::WHEEL:
+                    if (input.y != 0) {
+                        batch.wheel(input.y);
+                    }
+                    if (input.x != 0) {
+                        batch.wheel(input.x, true);
+                    }
+                    break;
+            }
+            batch.sync();   // Cada mensaje es un grupo: presionar y soltar nunca se juntan
+        }
+        if (batch.submit() == 0) {
+            return true;
+        }
+        if (Syscalls::InputBatch::supported()) {
+            std::cerr << " input_batch rechazó " << events.size() << " eventos de entrada" << std::endl;
+            return false;
+        }
+    }
+    
+    // Sin input_batch: las syscalls de una acción solo saben mover, hacer
+    // click y pulsar, así que el click se hace al presionar y se ignoran
+    // las liberaciones y la rueda
+    for (PendingInput& pending : events) {
+        if (pending.text) {
+            pending.typed = Syscalls::typeText(*pending.text, pending.layout);
+            continue;
+        }
+        const Utils::InputMessage& input = pending.message;
+        switch (input.type) {
+            case Utils::InputType::MOVE:
+                Syscalls::moveMouse(clampX(input.x), clampY(input.y));
+                break;
+            case Utils::InputType::BUTTON_DOWN:
+                if (input.code == Syscalls::LEFT_CLICK || input.code == Syscalls::RIGHT_CLICK) {
+                    Syscalls::clickAt(clampX(input.x), clampY(input.y), input.code);
+                }
+                break;
+            case Utils::InputType::KEY_DOWN:
+                Syscalls::pressKey(input.code);
+                break;
+            default:
+                break;
+        }
+    }
+    return true;
+}
+
 void WebSocketHandler::broadcast(const std::string& message) {
+    Stream::OutgoingMessage outgoing;
+    outgoing.data = std::make_shared<const std::string>(message);
+    outgoing.binary = false;
+    
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    
+    for (auto& entry : connections_) {
+        entry.second.queue->pushTelemetry(outgoing);
+    }
+}
+
+namespace {
+
+crow::json::wvalue stageJSON(const Stream::StageSnapshot& stage) {
+    crow::json::wvalue json;
+    json["frames"] = stage.frames;
+    json["last_us"] = stage.last_us;
+    json["avg_us"] = stage.avg_us;
+    json["max_us"] = stage.max_us;
+    return json;
+}
+
+} // namespace
+
+std::string WebSocketHandler::getStatsJSON() {
+    crow::json::wvalue result;
+    result["type"] = "stream_stats";
+    result["fps"] = scheduler_.currentFps();
+    
+    // Sin lock: las estadísticas de las etapas y la ocupación son atómicas
+    crow::json::wvalue pipeline;
+    pipeline["capture"] = stageJSON(capture_stats_.snapshot());
+    pipeline["encode"] = stageJSON(encode_stats_.snapshot());
+    pipeline["total"] = stageJSON(pipeline_stats_.snapshot());
+    pipeline["queue_depth"] = pipeline_.size();
+    pipeline["queue_capacity"] = pipeline_.capacity();
+    pipeline["wakeups"] = pipeline_event_.wakeups();
+    result["pipeline"] = std::move(pipeline);
+    
+    // Tratamiento por clase de tile (clientes con codec "auto")
+    crow::json::wvalue tile_classes;
+    for (size_t c = 0; c < Stream::TILE_CLASS_COUNT; c++) {
+        Stream::TileClass tile_class = static_cast<Stream::TileClass>(c);
+        Stream::TileClassSnapshot stats = tile_classifier_.stats(tile_class);
+        crow::json::wvalue json;
+        json["regions"] = stats.regions;
+        json["pixels"] = stats.pixels;
+        json["bytes"] = stats.bytes;
+        json["kbps"] = stats.kbps;
+        json["encode"] = stageJSON(stats.encode);
+        tile_classes[Stream::tileClassName(tile_class)] = std::move(json);
+    }
+    result["tile_classes"] = std::move(tile_classes);
+    
+    // Entrada binaria: latencia desde que llega hasta que se inyecta
+    crow::json::wvalue input;
+    {
+        std::lock_guard<std::mutex> lock(input_mutex_);
+        input["events"] = input_events_;
+        input["dropped"] = input_dropped_;
+        input["failed"] = input_failed_;
+        input["coalesced"] = input_coalesced_;
+        input["pending"] = input_queue_.size() + (motion_pending_ ? 1 : 0);
+    }
+    input["batch"] = Syscalls::InputBatch::supported();
+    input["latency"] = stageJSON(input_stats_.snapshot());
+    result["input"] = std::move(input);
+    
     std::lock_guard<std::mutex> lock(connections_mutex_);
     
-    for (auto* conn : connections_) {
-        try {
-            conn->send_text(message);
-        } catch (const std::exception& e) {
-            std::cerr << " Error al enviar mensaje: " << e.what() << std::endl;
+    std::vector<crow::json::wvalue> clients;
+    for (auto& entry : connections_) {
+        Stream::SendQueueStats stats = entry.second.queue->stats();
+        
+        crow::json::wvalue client;
+        client["remote_ip"] = entry.first->get_remote_ip();
+        client["format"] = entry.second.binary_frames ? "binary" : "json";
+        client["codec"] = codecName(entry.second.codec);
+        if (entry.second.has_viewport) {
+            const Stream::Viewport& viewport = entry.second.viewport;
+            crow::json::wvalue json;
+            json["x"] = viewport.x;
+            json["y"] = viewport.y;
+            json["w"] = viewport.w;
+            json["h"] = viewport.h;
+            json["out_w"] = viewport.out_w;
+            json["out_h"] = viewport.out_h;
+            client["viewport"] = std::move(json);
         }
+        client["layer"] = Stream::layerName(entry.second.layer);
+        client["layer_auto"] = entry.second.layer_auto;
+        client["drain_percent"] = entry.second.selector.drainPercent();
+        client["drain_kbps"] = entry.second.selector.drainKbps();
+        client["stall_percent"] = entry.second.selector.stallPercent();
+        client["subscribed"] = entry.second.subscribed;
+        client["control"] = entry.second.can_control;
+        client["queue_depth"] = stats.queue_depth;
+        client["frames_queued"] = stats.frames_queued;
+        client["frames_sent"] = stats.frames_sent;
+        client["frames_dropped"] = stats.frames_dropped;
+        client["telemetry_sent"] = stats.telemetry_sent;
+        client["bytes_sent"] = stats.bytes_sent;
+        client["acks"] = stats.acks;
+        client["bytes_in_flight"] = stats.bytes_in_flight;
+        client["stalled_ms"] = stats.stalled_us / 1000;
+        client["send"] = stageJSON(stats.send);
+        clients.push_back(std::move(client));
     }
+    
+    result["connections"] = std::move(clients);
+    return result.dump();
 }
 
 } // namespace Handlers
\ No newline at end of file
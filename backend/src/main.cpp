@@ -4,6 +4,7 @@
 #include "handlers/websocket_handler.h"
 #include "handlers/http_handler.h"
 #include "handlers/auth_handler.h"
+#include "utils/pixel_kernels.h"
 #include "types.h"
 #include <iostream>
 #include <csignal>
@@ -31,6 +32,9 @@ int main() {
     std::cout << "║   Puerto: " << Config::WEBSOCKET_PORT << "                                  ║" << std::endl;
     std::cout << "╚════════════════════════════════════════════════╝" << std::endl;
     
+    // Detectar una sola vez las extensiones SIMD de la CPU
+    std::cout << " Kernels de pixeles: " << Utils::PixelKernels::active().name << std::endl;
+    
     // Crear aplicación Crow con CORS
     crow::App<crow::CORSHandler> app;
     
@@ -74,14 +78,44 @@ int main() {
     CROW_ROUTE(app, "/api/mouse/click")
     .methods("POST"_method)
     ([](const crow::request& req) {
-        return Handlers::HTTPHandler::handleMouseClick(req);
+        crow::response res = Handlers::HTTPHandler::handleMouseClick(req);
+        if (res.code == 200) {
+            ws_handler->notifyInput();  // Capturar más seguido para mostrar el efecto
+        }
+        return res;
     });
     
     // Presionar tecla (REQUIERE auth + FULL_CONTROL)
     CROW_ROUTE(app, "/api/keyboard/press")
     .methods("POST"_method)
     ([](const crow::request& req) {
-        return Handlers::HTTPHandler::handleKeyPress(req);
+        crow::response res = Handlers::HTTPHandler::handleKeyPress(req);
+        if (res.code == 200) {
+            ws_handler->notifyInput();  // Capturar más seguido para mostrar el efecto
+        }
+        return res;
+    });
+    
+    // Escribir texto (REQUIERE auth + FULL_CONTROL)
+    CROW_ROUTE(app, "/api/keyboard/type")
+    .methods("POST"_method)
+    ([](const crow::request& req) {
+        // El thread de entrada avisa (notifyInput) cuando termina de escribir
+        return Handlers::HTTPHandler::handleTypeText(req, *ws_handler);
+    });
+    
+    // Estadísticas de las colas de envío (REQUIERE auth)
+    CROW_ROUTE(app, "/api/stream/stats")
+    ([](const crow::request& req) {
+        if (!Handlers::AuthHandler::checkPermissions(req, AccessLevel::VIEW_ONLY)) {
+            crow::json::wvalue response;
+            response["success"] = false;
+            response["error"] = "Unauthorized";
+            return crow::response(403, response);
+        }
+        crow::response res(ws_handler->getStatsJSON());
+        res.set_header("Content-Type", "application/json");
+        return res;
     });
     
     // ==================== WEBSOCKET (STREAMING) ====================
@@ -96,8 +130,8 @@ int main() {
             std::cout << " Cliente WebSocket desconectado (código " << code << "): " << reason << std::endl;
             ws_handler->removeConnection(conn);
         })
-        .onmessage([](crow::websocket::connection& conn, const std::string& message, bool /*is_binary*/) {
-            ws_handler->handleMessage(conn, message);
+        .onmessage([](crow::websocket::connection& conn, const std::string& message, bool is_binary) {
+            ws_handler->handleMessage(conn, message, is_binary);
         });
     
     // Iniciar el handler de WebSocket
@@ -113,6 +147,8 @@ int main() {
     std::cout << "   GET  /health               - Estado del servidor" << std::endl;
     std::cout << "   POST /api/mouse/click      - Click del mouse" << std::endl;
     std::cout << "   POST /api/keyboard/press   - Presionar tecla" << std::endl;
+    std::cout << "   POST /api/keyboard/type    - Escribir texto" << std::endl;
+    std::cout << "   GET  /api/stream/stats     - Colas de envío por conexión" << std::endl;
     
     std::cout << "\n Streaming (WebSocket):" << std::endl;
     std::cout << "   ws://0.0.0.0:" << Config::WEBSOCKET_PORT << "/ws" << std::endl;
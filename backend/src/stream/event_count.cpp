@@ -0,0 +1,44 @@
+#include "stream/event_count.h"
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace Stream {
+
+// El futex opera sobre la palabra de 32 bits del atómico
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "epoch_ debe ser una palabra de futex");
+
+EventCount::EventCount() : epoch_(0), waiters_(0), wakeups_(0) {}
+
+uint32_t EventCount::prepareWait() {
+    waiters_.fetch_add(1, std::memory_order_relaxed);
+    // Con la barrera de notify(): o el que avisa ve al durmiente, o el
+    // durmiente ve el estado nuevo al reevaluar la condición
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return epoch_.load(std::memory_order_relaxed);
+}
+
+void EventCount::cancelWait() {
+    waiters_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void EventCount::wait(uint32_t epoch) {
+    // Si epoch_ ya avanzó el kernel vuelve enseguida (EAGAIN)
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch_), FUTEX_WAIT_PRIVATE, epoch,
+            nullptr, nullptr, 0);
+    waiters_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void EventCount::notify() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters_.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+    epoch_.fetch_add(1, std::memory_order_relaxed);
+    wakeups_.fetch_add(1, std::memory_order_relaxed);
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch_), FUTEX_WAKE_PRIVATE, INT_MAX,
+            nullptr, nullptr, 0);
+}
+
+} // namespace Stream
@@ -0,0 +1,134 @@
+#include "stream/frame_pool.h"
+#include <cstdlib>
+#include <new>
+#include <unistd.h>
+
+namespace Stream {
+
+// ==================== FrameRef ====================
+
+FrameRef::FrameRef(const FrameRef& other) : pool_(other.pool_), slot_(other.slot_) {
+    if (pool_) {
+        pool_->retain(slot_);
+    }
+}
+
+FrameRef::FrameRef(FrameRef&& other) noexcept : pool_(other.pool_), slot_(other.slot_) {
+    other.pool_ = nullptr;
+}
+
+FrameRef& FrameRef::operator=(const FrameRef& other) {
+    if (this != &other) {
+        if (other.pool_) {
+            other.pool_->retain(other.slot_);
+        }
+        reset();
+        pool_ = other.pool_;
+        slot_ = other.slot_;
+    }
+    return *this;
+}
+
+FrameRef& FrameRef::operator=(FrameRef&& other) noexcept {
+    if (this != &other) {
+        reset();
+        pool_ = other.pool_;
+        slot_ = other.slot_;
+        other.pool_ = nullptr;
+    }
+    return *this;
+}
+
+FrameRef::~FrameRef() {
+    reset();
+}
+
+void FrameRef::reset() {
+    if (pool_) {
+        pool_->release(slot_);
+        pool_ = nullptr;
+    }
+}
+
+unsigned char* FrameRef::data() const {
+    return pool_ ? pool_->slots_[slot_].data : nullptr;
+}
+
+size_t FrameRef::capacity() const {
+    return pool_ ? pool_->slot_capacity_ : 0;
+}
+
+size_t FrameRef::size() const {
+    return pool_ ? pool_->slots_[slot_].size : 0;
+}
+
+void FrameRef::setSize(size_t size) {
+    if (pool_) {
+        pool_->slots_[slot_].size = size <= pool_->slot_capacity_ ? size : pool_->slot_capacity_;
+    }
+}
+
+// ==================== FramePool ====================
+
+FramePool::FramePool(size_t slot_count, size_t slot_capacity)
+    : slot_count_(slot_count),
+      slot_capacity_(0),
+      slots_(new Slot[slot_count]),
+      next_(0) {
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    slot_capacity_ = (slot_capacity + page - 1) / page * page;
+
+    for (size_t i = 0; i < slot_count_; i++) {
+        void* memory = nullptr;
+        if (posix_memalign(&memory, page, slot_capacity_) != 0) {
+            for (size_t j = 0; j < i; j++) {
+                free(slots_[j].data);
+            }
+            throw std::bad_alloc();
+        }
+        slots_[i].data = static_cast<unsigned char*>(memory);
+        slots_[i].size = 0;
+        slots_[i].refs.store(0);
+    }
+}
+
+FramePool::~FramePool() {
+    for (size_t i = 0; i < slot_count_; i++) {
+        free(slots_[i].data);
+    }
+}
+
+FrameRef FramePool::acquire() {
+    size_t start = next_.fetch_add(1, std::memory_order_relaxed);
+
+    for (size_t n = 0; n < slot_count_; n++) {
+        size_t index = (start + n) % slot_count_;
+        int expected = 0;
+        if (slots_[index].refs.compare_exchange_strong(expected, 1, std::memory_order_acquire)) {
+            slots_[index].size = 0;
+            return FrameRef(this, index);
+        }
+    }
+
+    return FrameRef();
+}
+
+size_t FramePool::available() const {
+    size_t count = 0;
+    for (size_t i = 0; i < slot_count_; i++) {
+        if (slots_[i].refs.load(std::memory_order_relaxed) == 0) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void FramePool::retain(size_t slot) {
+    slots_[slot].refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void FramePool::release(size_t slot) {
+    slots_[slot].refs.fetch_sub(1, std::memory_order_release);
+}
+
+} // namespace Stream
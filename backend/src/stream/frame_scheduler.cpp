@@ -0,0 +1,84 @@
+#include "stream/frame_scheduler.h"
+#include <algorithm>
+
+namespace Stream {
+
+FrameScheduler::FrameScheduler(int max_fps, int idle_fps)
+    : min_interval_(1000 / std::max(max_fps, 1)),
+      idle_interval_(1000 / std::max(std::min(idle_fps, max_fps), 1)),
+      interval_ms_(idle_interval_.count()),
+      last_input_(),
+      last_frame_start_(),
+      input_pending_(false),
+      woken_(false) {}
+
+void FrameScheduler::notifyInput() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        last_input_ = Clock::now();
+        input_pending_ = true;
+    }
+    cv_.notify_one();
+}
+
+void FrameScheduler::wake() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        woken_ = true;
+    }
+    cv_.notify_one();
+}
+
+void FrameScheduler::waitNextFrame(Clock::time_point frame_start, bool changed) {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    const auto boost = std::chrono::milliseconds(Config::INPUT_BOOST_MS);
+    bool recent_input = input_pending_ || (Clock::now() - last_input_ < boost);
+    input_pending_ = false;
+
+    std::chrono::milliseconds interval(interval_ms_.load());
+    if (recent_input) {
+        interval = min_interval_;
+    } else if (changed) {
+        interval = std::max(min_interval_, interval / 2);
+    } else {
+        interval = std::min(idle_interval_, interval * 2);
+    }
+    interval_ms_ = interval.count();
+
+    // La espera cuenta desde el inicio del frame: descuenta captura y codificación
+    cv_.wait_until(lock, frame_start + interval, [this] {
+        return input_pending_ || woken_;
+    });
+
+    if (input_pending_ && !woken_) {
+        // Entrada durante una espera larga: capturar ya, sin pasar de MAX_FPS
+        interval_ms_ = min_interval_.count();
+        cv_.wait_until(lock, frame_start + min_interval_, [this] { return woken_; });
+    }
+    woken_ = false;
+}
+
+FrameScheduler::Clock::time_point FrameScheduler::waitMinInterval(Clock::time_point frame_start) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    input_pending_ = false;
+
+    // La frecuencia la marca la pantalla: se reporta la medida
+    if (last_frame_start_ != Clock::time_point()) {
+        auto measured = std::chrono::duration_cast<std::chrono::milliseconds>(
+            frame_start - last_frame_start_);
+        interval_ms_ = std::max(min_interval_, measured).count();
+    }
+    last_frame_start_ = frame_start;
+
+    cv_.wait_until(lock, frame_start + min_interval_, [this] { return woken_; });
+    woken_ = false;
+    return frame_start + idle_interval_;
+}
+
+int FrameScheduler::currentFps() const {
+    long interval = interval_ms_.load();
+    return interval > 0 ? static_cast<int>(1000 / interval) : 0;
+}
+
+} // namespace Stream
@@ -0,0 +1,119 @@
+#include "stream/layer_selector.h"
+#include <algorithm>
+
+namespace Stream {
+
+const char* layerName(StreamLayer layer) {
+    switch (layer) {
+        case StreamLayer::LOW: return "low";
+        case StreamLayer::HALF: return "half";
+        default: return "high";
+    }
+}
+
+bool parseLayer(const std::string& name, StreamLayer& layer) {
+    for (size_t i = 0; i < LAYER_COUNT; i++) {
+        if (name == layerName(static_cast<StreamLayer>(i))) {
+            layer = static_cast<StreamLayer>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+LayerSelector::LayerSelector() {
+    reset();
+}
+
+void LayerSelector::reset() {
+    layer_ = StreamLayer::HIGH;
+    started_ = false;
+    window_start_ = Clock::time_point();
+    window_queued_ = 0;
+    window_dropped_ = 0;
+    window_bytes_ = 0;
+    window_stalled_us_ = 0;
+    stable_since_ = Clock::time_point();
+    raised_at_ = Clock::time_point();
+    probing_ = false;
+    hold_ = std::chrono::milliseconds(Config::LAYER_UP_HOLD_MS);
+    drain_percent_ = 100;
+    drain_kbps_ = 0;
+    stall_percent_ = 0;
+}
+
+bool LayerSelector::update(const SendQueueStats& stats, Clock::time_point now) {
+    const uint64_t frames_queued = stats.frames_queued;
+    const uint64_t frames_dropped = stats.frames_dropped;
+    // Con acks cuenta lo que llegó al cliente, no lo que quedó en el buffer de Crow
+    const uint64_t bytes_delivered = stats.bytes_sent > stats.bytes_in_flight ? stats.bytes_sent - stats.bytes_in_flight : 0;
+    if (!started_) {
+        started_ = true;
+        window_start_ = now;
+        stable_since_ = now;
+        window_queued_ = frames_queued;
+        window_dropped_ = frames_dropped;
+        window_bytes_ = bytes_delivered;
+        window_stalled_us_ = stats.stalled_us;
+        return false;
+    }
+
+    const auto elapsed = now - window_start_;
+    if (elapsed < std::chrono::milliseconds(Config::LAYER_WINDOW_MS)) {
+        return false;
+    }
+
+    const uint64_t queued = frames_queued - window_queued_;
+    const uint64_t dropped = std::min(frames_dropped - window_dropped_, queued);
+    const auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+    drain_percent_ = queued > 0 ? static_cast<int>(100 * (queued - dropped) / queued) : 100;
+    const uint64_t delivered = bytes_delivered > window_bytes_ ? bytes_delivered - window_bytes_ : 0;
+    drain_kbps_ = delivered * 8 / static_cast<uint64_t>(std::max<long long>(elapsed_ms, 1));
+    const uint64_t stalled_us = stats.stalled_us - window_stalled_us_;
+    stall_percent_ = static_cast<int>(std::min<uint64_t>(100, stalled_us / 10 / static_cast<uint64_t>(std::max<long long>(elapsed_ms, 1))));
+
+    window_start_ = now;
+    window_queued_ = frames_queued;
+    window_dropped_ = frames_dropped;
+    window_bytes_ = bytes_delivered;
+    window_stalled_us_ = stats.stalled_us;
+
+    const size_t index = static_cast<size_t>(layer_);
+
+    if (drain_percent_ < Config::LAYER_DOWN_DRAIN_PERCENT || stall_percent_ >= Config::LAYER_DOWN_STALL_PERCENT) {
+        stable_since_ = now;
+        if (probing_ && now - raised_at_ < hold_) {
+            // La capa superior no alcanzó: esperar más antes de volver a probar
+            hold_ = std::min(hold_ * 2, std::chrono::milliseconds(Config::LAYER_UP_HOLD_MAX_MS));
+        }
+        probing_ = false;
+        if (index + 1 < LAYER_COUNT) {
+            layer_ = static_cast<StreamLayer>(index + 1);
+            return true;
+        }
+        return false;
+    }
+
+    if (dropped > 0 || stall_percent_ >= Config::LAYER_STABLE_STALL_PERCENT) {
+        // Descartes aislados o esperas cortas: no bajan la capa pero tampoco cuentan como estables
+        stable_since_ = now;
+        return false;
+    }
+
+    if (probing_ && now - raised_at_ >= hold_) {
+        // La prueba se sostuvo: la próxima subida vuelve a la espera base
+        probing_ = false;
+        hold_ = std::chrono::milliseconds(Config::LAYER_UP_HOLD_MS);
+    }
+
+    if (index > 0 && now - stable_since_ >= hold_) {
+        layer_ = static_cast<StreamLayer>(index - 1);
+        stable_since_ = now;
+        raised_at_ = now;
+        probing_ = true;
+        return true;
+    }
+    return false;
+}
+
+} // namespace Stream
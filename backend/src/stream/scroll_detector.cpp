@@ -0,0 +1,351 @@
+#include "stream/scroll_detector.h"
+#include <algorithm>
+#include <cstring>
+
+namespace Stream {
+
+namespace {
+
+const uint64_t HASH_SEED = 0xcbf29ce484222325ull;
+const int MIN_VOTES = 4;   // Filas únicas que deben apoyar un desplazamiento
+
+inline uint64_t mix(uint64_t hash, uint32_t value) {
+    hash = (hash ^ value) * 0x9E3779B97F4A7C15ull;
+    return hash ^ (hash >> 29);
+}
+
+void putLE(std::vector<unsigned char>& out, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out.push_back(static_cast<unsigned char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+bool intersects(int ax, int ay, int aw, int ah, int bx, int by, int bw, int bh) {
+    return ax < bx + bw && bx < ax + aw && ay < by + bh && by < ay + ah;
+}
+
+// Una copia nueva no puede leer de lo que otra ya escribió ni escribir encima
+bool conflicts(const MoveRect& move, const std::vector<MoveRect>& moves) {
+    for (const MoveRect& other : moves) {
+        if (intersects(move.src_x, move.src_y, move.w, move.h, other.dst_x, other.dst_y, other.w, other.h) ||
+            intersects(move.dst_x, move.dst_y, move.w, move.h, other.dst_x, other.dst_y, other.w, other.h)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+ScrollDetector::ScrollDetector(int tile_size)
+    : tile_size_(tile_size), width_(0), height_(0), tiles_x_(0), tiles_y_(0), valid_(false) {}
+
+void ScrollDetector::reset() {
+    valid_ = false;
+}
+
+void ScrollDetector::hashTile(const unsigned char* bgra, int stride, int tx, int ty) {
+    const int x0 = tx * tile_size_;
+    const int y0 = ty * tile_size_;
+    const int w = std::min(tile_size_, width_ - x0);
+    const int h = std::min(tile_size_, height_ - y0);
+    uint64_t* rows = &row_hash_[static_cast<size_t>(tx) * height_ + y0];
+    uint64_t* cols = &col_hash_[static_cast<size_t>(ty) * width_ + x0];
+
+    for (int c = 0; c < w; c++) {
+        cols[c] = HASH_SEED;
+    }
+
+    // Una pasada para los dos sentidos; el alfa de la captura no cuenta
+    for (int r = 0; r < h; r++) {
+        const unsigned char* line = bgra + static_cast<size_t>(y0 + r) * stride + x0 * 4;
+        uint64_t row = HASH_SEED;
+        for (int c = 0; c < w; c++) {
+            uint32_t px;
+            std::memcpy(&px, line + c * 4, 4);
+            px |= 0xFF000000u;
+            row = mix(row, px);
+            cols[c] = mix(cols[c], px);
+        }
+        rows[r] = row;
+    }
+}
+
+bool ScrollDetector::findShift(const uint64_t* prev, const uint64_t* cur, int from, int to, Shift& shift) {
+    // Líneas del frame anterior que aparecen una sola vez (las repetidas,
+    // como el fondo entre líneas de texto, no indican nada)
+    positions_.clear();
+    for (int i = from; i < to; i++) {
+        auto inserted = positions_.emplace(prev[i], i);
+        if (!inserted.second) {
+            inserted.first->second = -1;
+        }
+    }
+
+    votes_.clear();
+    for (int i = from; i < to; i++) {
+        if (cur[i] == prev[i]) {
+            continue;
+        }
+        auto it = positions_.find(cur[i]);
+        if (it != positions_.end() && it->second >= 0) {
+            votes_[i - it->second]++;
+        }
+    }
+
+    int offset = 0;
+    int best = 0;
+    for (const auto& vote : votes_) {
+        if (vote.second > best) {
+            offset = vote.first;
+            best = vote.second;
+        }
+    }
+    if (best < MIN_VOTES) {
+        return false;
+    }
+
+    // Tramo más largo que coincide con ese desplazamiento
+    int run_start = 0;
+    int run_length = 0;
+    int best_start = 0;
+    int best_length = 0;
+    for (int i = from; i < to; i++) {
+        const int source = i - offset;
+        if (source >= from && source < to && cur[i] == prev[source]) {
+            if (run_length++ == 0) {
+                run_start = i;
+            }
+            if (run_length > best_length) {
+                best_start = run_start;
+                best_length = run_length;
+            }
+        } else {
+            run_length = 0;
+        }
+    }
+    if (best_length < Config::SCROLL_MIN_LINES) {
+        return false;
+    }
+
+    shift.offset = offset;
+    shift.start = best_start;
+    shift.end = best_start + best_length;
+    return true;
+}
+
+void ScrollDetector::collectMoves(const std::vector<Shift>& shifts, const std::vector<uint8_t>& found,
+                                  bool vertical, std::vector<MoveRect>& moves) const {
+    const int bands = static_cast<int>(shifts.size());
+    const int limit = vertical ? width_ : height_;
+
+    for (int first = 0; first < bands;) {
+        if (!found[first]) {
+            first++;
+            continue;
+        }
+
+        // Bandas vecinas con el mismo desplazamiento se copian juntas
+        Shift group = shifts[first];
+        int last = first;
+        while (last + 1 < bands && found[last + 1] && shifts[last + 1].offset == group.offset) {
+            const int start = std::max(group.start, shifts[last + 1].start);
+            const int end = std::min(group.end, shifts[last + 1].end);
+            if (end - start < Config::SCROLL_MIN_LINES) {
+                break;
+            }
+            group.start = start;
+            group.end = end;
+            last++;
+        }
+
+        const int band_start = first * tile_size_;
+        const int band_end = std::min((last + 1) * tile_size_, limit);
+        MoveRect move;
+        if (vertical) {
+            move.src_x = move.dst_x = static_cast<uint16_t>(band_start);
+            move.w = static_cast<uint16_t>(band_end - band_start);
+            move.dst_y = static_cast<uint16_t>(group.start);
+            move.src_y = static_cast<uint16_t>(group.start - group.offset);
+            move.h = static_cast<uint16_t>(group.end - group.start);
+        } else {
+            move.src_y = move.dst_y = static_cast<uint16_t>(band_start);
+            move.h = static_cast<uint16_t>(band_end - band_start);
+            move.dst_x = static_cast<uint16_t>(group.start);
+            move.src_x = static_cast<uint16_t>(group.start - group.offset);
+            move.w = static_cast<uint16_t>(group.end - group.start);
+        }
+        if (!conflicts(move, moves)) {
+            moves.push_back(move);
+        }
+
+        first = last + 1;
+    }
+}
+
+void ScrollDetector::markCovered(const MoveRect& move) {
+    // Solo los tiles que la copia cubre por completo dejan de estar sucios
+    const int tx_begin = (move.dst_x + tile_size_ - 1) / tile_size_;
+    const int ty_begin = (move.dst_y + tile_size_ - 1) / tile_size_;
+    for (int ty = ty_begin; ty < tiles_y_; ty++) {
+        const int y_end = std::min((ty + 1) * tile_size_, height_);
+        if (y_end > move.dst_y + move.h) {
+            break;
+        }
+        for (int tx = tx_begin; tx < tiles_x_; tx++) {
+            const int x_end = std::min((tx + 1) * tile_size_, width_);
+            if (x_end > move.dst_x + move.w) {
+                break;
+            }
+            dirty_map_[static_cast<size_t>(ty) * tiles_x_ + tx] = 0;
+        }
+    }
+}
+
+void ScrollDetector::rebuildDirty(std::vector<TileRect>& dirty) const {
+    dirty.clear();
+
+    for (int ty = 0; ty < tiles_y_; ty++) {
+        const int y = ty * tile_size_;
+        for (int tx = 0; tx < tiles_x_;) {
+            if (!dirty_map_[static_cast<size_t>(ty) * tiles_x_ + tx]) {
+                tx++;
+                continue;
+            }
+            int end = tx + 1;
+            while (end < tiles_x_ && dirty_map_[static_cast<size_t>(ty) * tiles_x_ + end]) {
+                end++;
+            }
+
+            TileRect rect;
+            rect.x = static_cast<uint16_t>(tx * tile_size_);
+            rect.y = static_cast<uint16_t>(y);
+            rect.w = static_cast<uint16_t>(std::min(end * tile_size_, width_) - rect.x);
+            rect.h = static_cast<uint16_t>(std::min(tile_size_, height_ - y));
+            dirty.push_back(rect);
+            tx = end;
+        }
+    }
+}
+
+size_t ScrollDetector::detect(const unsigned char* bgra, int width, int height, int stride,
+                              std::vector<TileRect>& dirty, std::vector<MoveRect>& moves) {
+    moves.clear();
+
+    if (width != width_ || height != height_) {
+        width_ = width;
+        height_ = height;
+        tiles_x_ = (width + tile_size_ - 1) / tile_size_;
+        tiles_y_ = (height + tile_size_ - 1) / tile_size_;
+        row_hash_.assign(static_cast<size_t>(tiles_x_) * height, 0);
+        col_hash_.assign(static_cast<size_t>(tiles_y_) * width, 0);
+        valid_ = false;
+    }
+
+    if (!valid_) {
+        for (int ty = 0; ty < tiles_y_; ty++) {
+            for (int tx = 0; tx < tiles_x_; tx++) {
+                hashTile(bgra, stride, tx, ty);
+            }
+        }
+        prev_row_hash_ = row_hash_;
+        prev_col_hash_ = col_hash_;
+        valid_ = true;
+        return 0;
+    }
+
+    if (dirty.empty()) {
+        return 0;
+    }
+
+    dirty_map_.assign(static_cast<size_t>(tiles_x_) * tiles_y_, 0);
+    for (const TileRect& rect : dirty) {
+        const int ty_end = std::min(tiles_y_, (rect.y + rect.h + tile_size_ - 1) / tile_size_);
+        const int tx_end = std::min(tiles_x_, (rect.x + rect.w + tile_size_ - 1) / tile_size_);
+        for (int ty = rect.y / tile_size_; ty < ty_end; ty++) {
+            for (int tx = rect.x / tile_size_; tx < tx_end; tx++) {
+                dirty_map_[static_cast<size_t>(ty) * tiles_x_ + tx] = 1;
+            }
+        }
+    }
+
+    // Los hashes de los tiles limpios no cambian: se parte de los anteriores
+    prev_row_hash_.swap(row_hash_);
+    prev_col_hash_.swap(col_hash_);
+    row_hash_ = prev_row_hash_;
+    col_hash_ = prev_col_hash_;
+    for (int ty = 0; ty < tiles_y_; ty++) {
+        for (int tx = 0; tx < tiles_x_; tx++) {
+            if (dirty_map_[static_cast<size_t>(ty) * tiles_x_ + tx]) {
+                hashTile(bgra, stride, tx, ty);
+            }
+        }
+    }
+
+    // Scroll vertical: por cada columna de tiles, en el tramo que tiene tiles sucios
+    shifts_.assign(tiles_x_, Shift());
+    found_.assign(tiles_x_, 0);
+    for (int tx = 0; tx < tiles_x_; tx++) {
+        int first = -1;
+        int last = -1;
+        for (int ty = 0; ty < tiles_y_; ty++) {
+            if (dirty_map_[static_cast<size_t>(ty) * tiles_x_ + tx]) {
+                first = first < 0 ? ty : first;
+                last = ty;
+            }
+        }
+        if (first >= 0) {
+            const size_t base = static_cast<size_t>(tx) * height_;
+            found_[tx] = findShift(&prev_row_hash_[base], &row_hash_[base], first * tile_size_,
+                                   std::min((last + 1) * tile_size_, height_), shifts_[tx]);
+        }
+    }
+    collectMoves(shifts_, found_, true, moves);
+    for (const MoveRect& move : moves) {
+        markCovered(move);
+    }
+
+    // Scroll horizontal sobre lo que sigue sucio
+    const size_t vertical_moves = moves.size();
+    shifts_.assign(tiles_y_, Shift());
+    found_.assign(tiles_y_, 0);
+    for (int ty = 0; ty < tiles_y_; ty++) {
+        int first = -1;
+        int last = -1;
+        for (int tx = 0; tx < tiles_x_; tx++) {
+            if (dirty_map_[static_cast<size_t>(ty) * tiles_x_ + tx]) {
+                first = first < 0 ? tx : first;
+                last = tx;
+            }
+        }
+        if (first >= 0) {
+            const size_t base = static_cast<size_t>(ty) * width_;
+            found_[ty] = findShift(&prev_col_hash_[base], &col_hash_[base], first * tile_size_,
+                                   std::min((last + 1) * tile_size_, width_), shifts_[ty]);
+        }
+    }
+    collectMoves(shifts_, found_, false, moves);
+    for (size_t i = vertical_moves; i < moves.size(); i++) {
+        markCovered(moves[i]);
+    }
+
+    if (!moves.empty()) {
+        rebuildDirty(dirty);
+    }
+    return moves.size();
+}
+
+void ScrollDetector::writeMoves(const std::vector<MoveRect>& moves, std::vector<unsigned char>& out) {
+    out.clear();
+    putLE(out, static_cast<uint32_t>(moves.size()), 2);
+    for (const MoveRect& move : moves) {
+        putLE(out, move.src_x, 2);
+        putLE(out, move.src_y, 2);
+        putLE(out, move.dst_x, 2);
+        putLE(out, move.dst_y, 2);
+        putLE(out, move.w, 2);
+        putLE(out, move.h, 2);
+    }
+}
+
+} // namespace Stream
@@ -0,0 +1,222 @@
+#include "stream/send_queue.h"
+#include <algorithm>
+#include <iostream>
+
+namespace Stream {
+
+SendQueue::SendQueue(std::unique_ptr<MessageSink> sink, size_t frame_capacity, size_t inflight_budget)
+    : sink_(std::move(sink)),
+      frame_capacity_(frame_capacity > 0 ? frame_capacity : 1),
+      inflight_budget_(inflight_budget),
+      frames_(frame_capacity_),
+      frames_head_(0),
+      frames_count_(0),
+      closed_(false),
+      resync_(false),
+      frames_queued_(0),
+      frames_sent_(0),
+      frames_dropped_(0),
+      telemetry_sent_(0),
+      bytes_sent_(0),
+      acks_(false),
+      binary_sent_(0),
+      binary_acked_(0),
+      stalled_us_(0) {
+    thread_ = std::thread(&SendQueue::run, this);
+}
+
+SendQueue::~SendQueue() {
+    close();
+}
+
+void SendQueue::pushFrame(const OutgoingMessage& message) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_) {
+            return;
+        }
+
+        OutgoingMessage dropped;
+        if (message.keyframe) {
+            // Un keyframe deja obsoleto todo lo pendiente
+            frames_dropped_ += frames_count_;
+            while (frames_count_ > 0) {
+                popFrame(dropped);
+            }
+        } else {
+            while (frames_count_ >= frame_capacity_) {
+                // Un delta se aplica sobre todo lo anterior: perder cualquier
+                // frame deja al cliente con una imagen incompleta
+                resync_ = true;
+                popFrame(dropped);
+                frames_dropped_++;
+            }
+        }
+
+        OutgoingMessage& slot = frames_[(frames_head_ + frames_count_) % frame_capacity_];
+        slot = message;
+        slot.queued_at = std::chrono::steady_clock::now();
+        frames_count_++;
+        frames_queued_++;
+        updateStall();
+    }
+    cv_.notify_one();
+}
+
+void SendQueue::pushTelemetry(const OutgoingMessage& message) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_) {
+            return;
+        }
+        telemetry_.push_back(message);
+    }
+    cv_.notify_one();
+}
+
+void SendQueue::ack(uint64_t bytes_received) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        acks_ = true;
+        // Acumulado: un ack viejo o adelantado no puede mover la cuenta hacia atrás
+        binary_acked_ = std::max(binary_acked_, std::min(bytes_received, binary_sent_));
+        updateStall();
+    }
+    cv_.notify_one();
+}
+
+bool SendQueue::takeResyncRequest() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    bool resync = resync_;
+    resync_ = false;
+    return resync;
+}
+
+void SendQueue::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_ && !thread_.joinable()) {
+            return;
+        }
+        closed_ = true;
+        OutgoingMessage dropped;
+        while (frames_count_ > 0) {
+            popFrame(dropped);
+        }
+        telemetry_.clear();
+        updateStall();
+    }
+    cv_.notify_one();
+
+    if (thread_.joinable() && thread_.get_id() != std::this_thread::get_id()) {
+        thread_.join();
+    }
+}
+
+SendQueueStats SendQueue::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    SendQueueStats stats;
+    stats.queue_depth = frames_count_ + telemetry_.size();
+    stats.frames_queued = frames_queued_;
+    stats.frames_sent = frames_sent_;
+    stats.frames_dropped = frames_dropped_;
+    stats.telemetry_sent = telemetry_sent_;
+    stats.bytes_sent = bytes_sent_;
+    stats.bytes_in_flight = binary_sent_ - binary_acked_;
+    stats.stalled_us = stalled_us_;
+    if (stalled_since_ != std::chrono::steady_clock::time_point()) {
+        stats.stalled_us += std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - stalled_since_).count();
+    }
+    stats.acks = acks_;
+    stats.send = send_stats_.snapshot();
+    return stats;
+}
+
+void SendQueue::run() {
+    while (true) {
+        OutgoingMessage message;
+        bool is_frame = false;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            // Los frames esperan mientras el cliente tenga demasiado sin confirmar;
+            // entretanto pushFrame los reemplaza y descarta
+            cv_.wait(lock, [this] {
+                return closed_ || !telemetry_.empty() || (frames_count_ > 0 && canSendFrame());
+            });
+            if (closed_) {
+                return;
+            }
+
+            // La telemetría es pequeña y no se descarta: va primero
+            if (!telemetry_.empty()) {
+                message = std::move(telemetry_.front());
+                telemetry_.pop_front();
+            } else {
+                popFrame(message);
+                is_frame = true;
+            }
+            // Se cuenta antes de enviar para que un ack rápido no quede por delante
+            if (message.frame) {
+                binary_sent_ += message.frame.size();
+            } else if (message.binary) {
+                binary_sent_ += message.data->size();
+            }
+            updateStall();
+        }
+
+        // Envío sin ningún lock tomado. Crow recibe el mensaje por valor, lo
+        // copia a su propio buffer de escritura y vuelve sin esperar al socket
+        size_t size = 0;
+        try {
+            if (message.frame) {
+                size = message.frame.size();
+                sink_->sendBinary(std::string(reinterpret_cast<const char*>(message.frame.data()), size));
+            } else if (message.binary) {
+                size = message.data->size();
+                sink_->sendBinary(*message.data);
+            } else {
+                size = message.data->size();
+                sink_->sendText(*message.data);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << " Error al enviar mensaje: " << e.what() << std::endl;
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (is_frame) {
+            frames_sent_++;
+            send_stats_.record(std::chrono::steady_clock::now() - message.queued_at);
+        } else {
+            telemetry_sent_++;
+        }
+        bytes_sent_ += size;
+    }
+}
+
+bool SendQueue::canSendFrame() const {
+    // Sin nada en vuelo siempre sale un frame, aunque sea más grande que el límite
+    return !acks_ || binary_sent_ - binary_acked_ < inflight_budget_;
+}
+
+void SendQueue::updateStall() {
+    using Clock = std::chrono::steady_clock;
+    bool stalled = !closed_ && frames_count_ > 0 && !canSendFrame();
+    if (stalled && stalled_since_ == Clock::time_point()) {
+        stalled_since_ = Clock::now();
+    } else if (!stalled && stalled_since_ != Clock::time_point()) {
+        stalled_us_ += std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - stalled_since_).count();
+        stalled_since_ = Clock::time_point();
+    }
+}
+
+void SendQueue::popFrame(OutgoingMessage& message) {
+    // Mover libera el slot del anillo (y su referencia al pool)
+    message = std::move(frames_[frames_head_]);
+    frames_[frames_head_] = OutgoingMessage();
+    frames_head_ = (frames_head_ + 1) % frame_capacity_;
+    frames_count_--;
+}
+
+} // namespace Stream
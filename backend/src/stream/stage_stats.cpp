@@ -0,0 +1,34 @@
+#include "stream/stage_stats.h"
+
+namespace Stream {
+
+StageStats::StageStats() : frames_(0), last_us_(0), avg_us_(0), max_us_(0) {}
+
+void StageStats::record(std::chrono::steady_clock::duration elapsed) {
+    uint64_t us = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+
+    uint64_t frames = frames_.load(std::memory_order_relaxed);
+    uint64_t avg = avg_us_.load(std::memory_order_relaxed);
+
+    // El primer frame fija la media; después pesa 1/8
+    avg = frames == 0 ? us : avg - avg / 8 + us / 8;
+
+    avg_us_.store(avg, std::memory_order_relaxed);
+    last_us_.store(us, std::memory_order_relaxed);
+    if (us > max_us_.load(std::memory_order_relaxed)) {
+        max_us_.store(us, std::memory_order_relaxed);
+    }
+    frames_.store(frames + 1, std::memory_order_relaxed);
+}
+
+StageSnapshot StageStats::snapshot() const {
+    StageSnapshot snapshot;
+    snapshot.frames = frames_.load(std::memory_order_relaxed);
+    snapshot.last_us = last_us_.load(std::memory_order_relaxed);
+    snapshot.avg_us = avg_us_.load(std::memory_order_relaxed);
+    snapshot.max_us = max_us_.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+} // namespace Stream
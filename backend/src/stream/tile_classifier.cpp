@@ -0,0 +1,264 @@
+#include "stream/tile_classifier.h"
+#include <algorithm>
+#include <bitset>
+#include <chrono>
+#include <cstring>
+
+namespace Stream {
+
+namespace {
+
+const int EDGE_THRESHOLD = 32;      // Salto de luma que cuenta como borde nítido
+const int COLOR_TABLE_SIZE = 128;   // Tabla de colores distintos (potencia de 2, > TILE_TEXT_MAX_COLORS)
+
+void putLE(std::vector<unsigned char>& out, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out.push_back(static_cast<unsigned char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+int64_t steadyMillis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+const char* tileClassName(TileClass tile_class) {
+    switch (tile_class) {
+        case TileClass::TEXT: return "text";
+        case TileClass::PHOTO: return "photo";
+        case TileClass::VIDEO: return "video";
+    }
+    return "unknown";
+}
+
+TileClassifier::TileClassifier(int tile_size)
+    : tile_size_(tile_size), width_(0), height_(0), tiles_x_(0), tiles_y_(0),
+      valid_(false), first_encode_ms_(0) {
+    for (size_t c = 0; c < TILE_CLASS_COUNT; c++) {
+        treatments_[c].codec = Utils::FrameCodec::JPEG;
+        treatments_[c].encoder = nullptr;
+        regions_[c] = 0;
+        pixels_[c] = 0;
+        bytes_[c] = 0;
+    }
+}
+
+void TileClassifier::setTreatment(TileClass tile_class, Utils::FrameCodec codec,
+                                  Utils::ImageEncoder* encoder) {
+    Treatment& treatment = treatments_[static_cast<size_t>(tile_class)];
+    treatment.codec = codec;
+    treatment.encoder = encoder;
+}
+
+void TileClassifier::reset() {
+    valid_ = false;
+}
+
+TileClass TileClassifier::analyze(const unsigned char* tile, int width, int height, int stride) const {
+    uint32_t colors[COLOR_TABLE_SIZE] = {0};
+    int color_count = 0;
+    int edges = 0;
+    int flat = 0;      // Pixeles iguales al de su izquierda (fondos de UI)
+    int samples = 0;
+
+    // Filas alternas: alcanza para distinguir texto de imágenes a mitad de costo
+    for (int y = 0; y < height; y += 2) {
+        const unsigned char* row = tile + static_cast<size_t>(y) * stride;
+        int previous_luma = 0;
+
+        for (int x = 0; x < width; x++) {
+            const unsigned char* px = row + x * 4;
+            int luma = (px[0] + px[1] * 5 + px[2] * 2) >> 3;
+            if (x > 0) {
+                int delta = luma - previous_luma;
+                if (delta >= EDGE_THRESHOLD || delta <= -EDGE_THRESHOLD) {
+                    edges++;
+                } else if (std::memcmp(px, px - 4, 3) == 0) {
+                    flat++;
+                }
+                samples++;
+            }
+            previous_luma = luma;
+
+            // Colores distintos hasta pasar el límite (el alfa se fuerza para no usar 0)
+            if (color_count <= Config::TILE_TEXT_MAX_COLORS) {
+                uint32_t color;
+                std::memcpy(&color, px, 4);
+                color |= 0xFF000000u;
+                uint32_t slot = (color * 2654435761u) >> 25;   // 7 bits: COLOR_TABLE_SIZE
+                while (colors[slot] != 0 && colors[slot] != color) {
+                    slot = (slot + 1) & (COLOR_TABLE_SIZE - 1);
+                }
+                if (colors[slot] == 0) {
+                    colors[slot] = color;
+                    color_count++;
+                }
+            }
+        }
+    }
+
+    if (color_count <= Config::TILE_TEXT_MAX_COLORS ||
+        edges * 100 >= samples * Config::TILE_TEXT_EDGE_PERCENT ||
+        flat * 100 >= samples * Config::TILE_TEXT_FLAT_PERCENT) {
+        return TileClass::TEXT;
+    }
+    return TileClass::PHOTO;
+}
+
+TileClass TileClassifier::classAt(size_t tile) const {
+    if (static_cast<int>(std::bitset<16>(history_[tile]).count()) >= Config::TILE_VIDEO_CHANGES) {
+        return TileClass::VIDEO;
+    }
+    return static_cast<TileClass>(content_class_[tile]);
+}
+
+void TileClassifier::update(const unsigned char* bgra, int width, int height, int stride,
+                            const std::vector<TileRect>& dirty) {
+    const bool full = !valid_ || width != width_ || height != height_;
+
+    if (width != width_ || height != height_) {
+        width_ = width;
+        height_ = height;
+        tiles_x_ = (width + tile_size_ - 1) / tile_size_;
+        tiles_y_ = (height + tile_size_ - 1) / tile_size_;
+        history_.assign(static_cast<size_t>(tiles_x_) * tiles_y_, 0);
+        content_class_.assign(history_.size(), static_cast<uint8_t>(TileClass::PHOTO));
+    }
+
+    for (uint16_t& bits : history_) {
+        bits = static_cast<uint16_t>(bits << 1);
+    }
+
+    auto analyzeTile = [&](int tx, int ty) {
+        const int x0 = tx * tile_size_;
+        const int y0 = ty * tile_size_;
+        content_class_[static_cast<size_t>(ty) * tiles_x_ + tx] = static_cast<uint8_t>(
+            analyze(bgra + static_cast<size_t>(y0) * stride + x0 * 4,
+                    std::min(tile_size_, width - x0), std::min(tile_size_, height - y0), stride));
+    };
+
+    if (full) {
+        for (int ty = 0; ty < tiles_y_; ty++) {
+            for (int tx = 0; tx < tiles_x_; tx++) {
+                analyzeTile(tx, ty);
+            }
+        }
+        valid_ = true;
+    }
+
+    for (const TileRect& rect : dirty) {
+        const int ty_end = std::min(tiles_y_, (rect.y + rect.h + tile_size_ - 1) / tile_size_);
+        const int tx_end = std::min(tiles_x_, (rect.x + rect.w + tile_size_ - 1) / tile_size_);
+        for (int ty = rect.y / tile_size_; ty < ty_end; ty++) {
+            for (int tx = rect.x / tile_size_; tx < tx_end; tx++) {
+                history_[static_cast<size_t>(ty) * tiles_x_ + tx] |= 1;
+                if (!full) {
+                    analyzeTile(tx, ty);
+                }
+            }
+        }
+    }
+}
+
+void TileClassifier::split(const std::vector<TileRect>& rects, std::vector<ClassifiedRect>& out) const {
+    out.clear();
+
+    for (const TileRect& rect : rects) {
+        const int x_end = rect.x + rect.w;
+        const int y_end = rect.y + rect.h;
+
+        // Las regiones de TileEncoder pueden cubrir varias filas de tiles
+        for (int y = rect.y; y < y_end; y = (y / tile_size_ + 1) * tile_size_) {
+            const int ty = y / tile_size_;
+            const int h = std::min((ty + 1) * tile_size_, y_end) - y;
+            int x = rect.x;
+
+            while (x < x_end) {
+                TileClass tile_class = classAt(static_cast<size_t>(ty) * tiles_x_ + x / tile_size_);
+                int next = (x / tile_size_ + 1) * tile_size_;
+                while (next < x_end &&
+                       classAt(static_cast<size_t>(ty) * tiles_x_ + next / tile_size_) == tile_class) {
+                    next += tile_size_;
+                }
+                next = std::min(next, x_end);
+
+                ClassifiedRect region;
+                region.rect.x = static_cast<uint16_t>(x);
+                region.rect.y = static_cast<uint16_t>(y);
+                region.rect.w = static_cast<uint16_t>(next - x);
+                region.rect.h = static_cast<uint16_t>(h);
+                region.tile_class = tile_class;
+                out.push_back(region);
+                x = next;
+            }
+        }
+    }
+}
+
+void TileClassifier::fullFrame(std::vector<ClassifiedRect>& out) const {
+    std::vector<TileRect> screen(1);
+    screen[0].x = 0;
+    screen[0].y = 0;
+    screen[0].w = static_cast<uint16_t>(width_);
+    screen[0].h = static_cast<uint16_t>(height_);
+    split(screen, out);
+}
+
+bool TileClassifier::encodeRegions(const unsigned char* bgra, int stride,
+                                   const std::vector<ClassifiedRect>& regions,
+                                   std::vector<unsigned char>& payload) {
+    payload.clear();
+    putLE(payload, static_cast<uint32_t>(regions.size()), 2);
+
+    int64_t expected = 0;
+    first_encode_ms_.compare_exchange_strong(expected, steadyMillis());
+
+    for (const ClassifiedRect& region : regions) {
+        const size_t c = static_cast<size_t>(region.tile_class);
+        const Treatment& treatment = treatments_[c];
+        const TileRect& rect = region.rect;
+        if (!treatment.encoder) {
+            return false;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        const unsigned char* origin = bgra + static_cast<size_t>(rect.y) * stride + rect.x * 4;
+        if (!treatment.encoder->encode(origin, rect.w, rect.h, stride, region_data_)) {
+            return false;
+        }
+        encode_stats_[c].record(std::chrono::steady_clock::now() - start);
+
+        putLE(payload, rect.x, 2);
+        putLE(payload, rect.y, 2);
+        putLE(payload, rect.w, 2);
+        putLE(payload, rect.h, 2);
+        putLE(payload, static_cast<uint32_t>(treatment.codec), 1);
+        putLE(payload, static_cast<uint32_t>(region.tile_class), 1);
+        putLE(payload, static_cast<uint32_t>(region_data_.size()), 4);
+        payload.insert(payload.end(), region_data_.begin(), region_data_.end());
+
+        regions_[c].fetch_add(1, std::memory_order_relaxed);
+        pixels_[c].fetch_add(static_cast<uint64_t>(rect.w) * rect.h, std::memory_order_relaxed);
+        bytes_[c].fetch_add(region_data_.size(), std::memory_order_relaxed);
+    }
+
+    return true;
+}
+
+TileClassSnapshot TileClassifier::stats(TileClass tile_class) const {
+    const size_t c = static_cast<size_t>(tile_class);
+    TileClassSnapshot snapshot;
+    snapshot.regions = regions_[c].load(std::memory_order_relaxed);
+    snapshot.pixels = pixels_[c].load(std::memory_order_relaxed);
+    snapshot.bytes = bytes_[c].load(std::memory_order_relaxed);
+    snapshot.encode = encode_stats_[c].snapshot();
+
+    int64_t first = first_encode_ms_.load(std::memory_order_relaxed);
+    int64_t elapsed = first > 0 ? steadyMillis() - first : 0;
+    snapshot.kbps = elapsed > 0 ? snapshot.bytes * 8 / static_cast<uint64_t>(elapsed) : 0;
+    return snapshot;
+}
+
+} // namespace Stream
@@ -0,0 +1,143 @@
+#include "stream/tile_encoder.h"
+#include <algorithm>
+
+namespace Stream {
+
+namespace {
+
+void putLE(std::vector<unsigned char>& out, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out.push_back(static_cast<unsigned char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+} // namespace
+
+TileEncoder::TileEncoder(int tile_size)
+    : tile_size_(tile_size), width_(0), height_(0), kernels_(&Utils::PixelKernels::active()) {}
+
+void TileEncoder::reset() {
+    width_ = 0;
+    height_ = 0;
+}
+
+size_t TileEncoder::update(const unsigned char* bgra, int width, int height, int stride,
+                           std::vector<TileRect>& dirty) {
+    dirty.clear();
+
+    const int tiles_x = (width + tile_size_ - 1) / tile_size_;
+    const int tiles_y = (height + tile_size_ - 1) / tile_size_;
+    const bool full = (width != width_ || height != height_);
+
+    if (full) {
+        width_ = width;
+        height_ = height;
+        tile_hash_.assign(static_cast<size_t>(tiles_x) * tiles_y, 0);
+    }
+    dirty_map_.assign(static_cast<size_t>(tiles_x) * tiles_y, full ? 1 : 0);
+
+    size_t dirty_tiles = 0;
+
+    for (int ty = 0; ty < tiles_y; ty++) {
+        const int y0 = ty * tile_size_;
+        const int rows = std::min(tile_size_, height - y0);
+
+        for (int tx = 0; tx < tiles_x; tx++) {
+            const int x0 = tx * tile_size_;
+            const int bytes = std::min(tile_size_, width - x0) * 4;
+            const size_t tile = static_cast<size_t>(ty) * tiles_x + tx;
+
+            uint64_t hash = kernels_->hashBlock(bgra + static_cast<size_t>(y0) * stride + x0 * 4,
+                                                stride, bytes, rows);
+            if (hash != tile_hash_[tile]) {
+                tile_hash_[tile] = hash;
+                dirty_map_[tile] = 1;
+            }
+            dirty_tiles += dirty_map_[tile];
+        }
+
+        mergeRow(ty, tiles_x, width, height, dirty);
+    }
+
+    return dirty_tiles;
+}
+
+size_t TileEncoder::updateFromDamage(const uint8_t* bitmap, int width, int height,
+                                     std::vector<TileRect>& dirty) {
+    dirty.clear();
+
+    // Las huellas de referencia dejan de estar al día
+    reset();
+
+    const int tiles_x = (width + tile_size_ - 1) / tile_size_;
+    const int tiles_y = (height + tile_size_ - 1) / tile_size_;
+    const size_t tiles = static_cast<size_t>(tiles_x) * tiles_y;
+
+    dirty_map_.resize(tiles);
+    size_t dirty_tiles = 0;
+    for (size_t i = 0; i < tiles; i++) {
+        dirty_map_[i] = (bitmap[i / 8] >> (i % 8)) & 1;
+        dirty_tiles += dirty_map_[i];
+    }
+
+    if (dirty_tiles == 0) {
+        return 0;
+    }
+
+    for (int ty = 0; ty < tiles_y; ty++) {
+        mergeRow(ty, tiles_x, width, height, dirty);
+    }
+
+    return dirty_tiles;
+}
+
+void TileEncoder::mergeRow(int ty, int tiles_x, int width, int height,
+                           std::vector<TileRect>& dirty) const {
+    const int y0 = ty * tile_size_;
+    const int rows = std::min(tile_size_, height - y0);
+
+    // Fusionar tiles sucios contiguos de la fila
+    int tx = 0;
+    while (tx < tiles_x) {
+        if (!dirty_map_[ty * tiles_x + tx]) {
+            tx++;
+            continue;
+        }
+        int start = tx;
+        while (tx < tiles_x && dirty_map_[ty * tiles_x + tx]) {
+            tx++;
+        }
+        TileRect rect;
+        rect.x = static_cast<uint16_t>(start * tile_size_);
+        rect.y = static_cast<uint16_t>(y0);
+        rect.w = static_cast<uint16_t>(std::min(tx * tile_size_, width) - start * tile_size_);
+        rect.h = static_cast<uint16_t>(rows);
+        dirty.push_back(rect);
+    }
+}
+
+bool TileEncoder::encodeTiles(const unsigned char* bgra, int stride,
+                              const std::vector<TileRect>& rects,
+                              Utils::ImageEncoder& encoder,
+                              std::vector<unsigned char>& payload) {
+    payload.clear();
+    putLE(payload, static_cast<uint32_t>(rects.size()), 2);
+
+    for (const TileRect& rect : rects) {
+        const unsigned char* origin = bgra + static_cast<size_t>(rect.y) * stride + rect.x * 4;
+        if (!encoder.encode(origin, rect.w, rect.h, stride, tile_data_)) {
+            return false;
+        }
+
+        putLE(payload, rect.x, 2);
+        putLE(payload, rect.y, 2);
+        putLE(payload, rect.w, 2);
+        putLE(payload, rect.h, 2);
+        putLE(payload, static_cast<uint32_t>(tile_data_.size()), 4);
+        payload.insert(payload.end(), tile_data_.begin(), tile_data_.end());
+    }
+
+    return true;
+}
+
+} // namespace Stream
@@ -0,0 +1,129 @@
+#include "stream/viewport.h"
+#include "utils/pixel_kernels.h"
+#include <algorithm>
+
+namespace Stream {
+
+namespace {
+
+bool intersects(int ax, int ay, int aw, int ah, int bx, int by, int bw, int bh) {
+    return ax < bx + bw && bx < ax + aw && ay < by + bh && by < ay + ah;
+}
+
+void putLE16(unsigned char* out, uint16_t value) {
+    out[0] = static_cast<unsigned char>(value & 0xFF);
+    out[1] = static_cast<unsigned char>(value >> 8);
+}
+
+} // namespace
+
+bool Viewport::clamp(int screen_width, int screen_height) {
+    int x1 = std::min<int>(x + w, screen_width);
+    int y1 = std::min<int>(y + h, screen_height);
+    if (x1 - x < Config::VIEWPORT_MIN_SIZE || y1 - y < Config::VIEWPORT_MIN_SIZE) {
+        return false;
+    }
+    w = static_cast<uint16_t>(x1 - x);
+    h = static_cast<uint16_t>(y1 - y);
+    // Nunca se amplía, así que una salida más grande que la pantalla no aporta nada
+    out_w = static_cast<uint16_t>(std::min<int>(std::max<int>(out_w, 1), screen_width));
+    out_h = static_cast<uint16_t>(std::min<int>(std::max<int>(out_h, 1), screen_height));
+    return true;
+}
+
+void Viewport::encodedSize(int& width, int& height) const {
+    if (w <= out_w && h <= out_h) {
+        width = w;
+        height = h;
+        return;
+    }
+    // Escala min(out_w / w, out_h / h) sin pasar por punto flotante
+    if (static_cast<uint32_t>(out_w) * h <= static_cast<uint32_t>(out_h) * w) {
+        width = out_w;
+        height = std::max(1, static_cast<int>((static_cast<uint32_t>(h) * out_w + w / 2) / w));
+    } else {
+        height = out_h;
+        width = std::max(1, static_cast<int>((static_cast<uint32_t>(w) * out_h + h / 2) / h));
+    }
+}
+
+bool Viewport::touches(const std::vector<TileRect>& dirty, const std::vector<MoveRect>& moves) const {
+    for (const TileRect& rect : dirty) {
+        if (intersects(x, y, w, h, rect.x, rect.y, rect.w, rect.h)) {
+            return true;
+        }
+    }
+    for (const MoveRect& move : moves) {
+        if (intersects(x, y, w, h, move.dst_x, move.dst_y, move.w, move.h)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const unsigned char* ViewportScaler::scale(const unsigned char* src, int stride, int w, int h,
+                                           int out_w, int out_h, int& out_stride) {
+    const Utils::PixelKernels::KernelTable& kernels = Utils::PixelKernels::active();
+
+    // Reducciones exactas a la mitad mientras sobre resolución
+    int current = 0;
+    while (w >= 2 * out_w && h >= 2 * out_h) {
+        const int half_w = w / 2;
+        const int half_h = h / 2;
+        std::vector<unsigned char>& half = halves_[current];
+        half.resize(static_cast<size_t>(half_w) * half_h * 4);
+        for (int y = 0; y < half_h; y++) {
+            const unsigned char* row = src + static_cast<size_t>(2 * y) * stride;
+            kernels.downsampleBgra(row, row + stride, half_w, &half[static_cast<size_t>(y) * half_w * 4]);
+        }
+        src = half.data();
+        stride = half_w * 4;
+        w = half_w;
+        h = half_h;
+        current ^= 1;
+    }
+
+    if (w == out_w && h == out_h) {
+        out_stride = stride;
+        return src;
+    }
+
+    // Bilineal en punto fijo (16 bits de fracción), muestreando en el centro de cada pixel
+    output_.resize(static_cast<size_t>(out_w) * out_h * 4);
+    const uint32_t step_x = (static_cast<uint32_t>(w) << 16) / out_w;
+    const uint32_t step_y = (static_cast<uint32_t>(h) << 16) / out_h;
+    const int max_x = (w - 1) << 16;
+    const int max_y = (h - 1) << 16;
+
+    for (int oy = 0; oy < out_h; oy++) {
+        int fy = std::min(std::max(static_cast<int>(oy * step_y + step_y / 2) - 0x8000, 0), max_y);
+        const unsigned char* row0 = src + static_cast<size_t>(fy >> 16) * stride;
+        const unsigned char* row1 = row0 + ((fy >> 16) + 1 < h ? stride : 0);
+        const int wy = (fy & 0xFFFF) >> 8;
+        unsigned char* out = &output_[static_cast<size_t>(oy) * out_w * 4];
+
+        for (int ox = 0; ox < out_w; ox++) {
+            int fx = std::min(std::max(static_cast<int>(ox * step_x + step_x / 2) - 0x8000, 0), max_x);
+            const int x0 = (fx >> 16) * 4;
+            const int x1 = x0 + ((fx >> 16) + 1 < w ? 4 : 0);
+            const int wx = (fx & 0xFFFF) >> 8;
+            for (int c = 0; c < 4; c++) {
+                int top = row0[x0 + c] * (256 - wx) + row0[x1 + c] * wx;
+                int bottom = row1[x0 + c] * (256 - wx) + row1[x1 + c] * wx;
+                out[ox * 4 + c] = static_cast<unsigned char>((top * (256 - wy) + bottom * wy + 32768) >> 16);
+            }
+        }
+    }
+
+    out_stride = out_w * 4;
+    return output_.data();
+}
+
+void ViewportScaler::writeHeader(const Viewport& viewport, unsigned char* out) {
+    putLE16(out, viewport.x);
+    putLE16(out + 2, viewport.y);
+    putLE16(out + 4, viewport.w);
+    putLE16(out + 6, viewport.h);
+}
+
+} // namespace Stream
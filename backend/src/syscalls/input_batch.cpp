@@ -0,0 +1,123 @@
+#include "syscalls/input_batch.h"
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include "syscalls.h"
+
+namespace Syscalls {
+
+// Se descubre en la primera llamada: un kernel sin la syscall devuelve ENOSYS
+static std::atomic<bool> batch_supported(true);
+
+InputBatch::InputBatch() {
+    events_.reserve(64);
+}
+
+void InputBatch::push(uint16_t type, int code, int x, int y) {
+    input_batch_event event;
+    event.type = type;
+    event.code = static_cast<uint16_t>(code);
+    event.x = x;
+    event.y = y;
+    events_.push_back(event);
+}
+
+void InputBatch::move(int x, int y) {
+    push(INPUT_BATCH_MOVE, 0, x, y);
+}
+
+void InputBatch::buttonDown(int button) {
+    push(INPUT_BATCH_BUTTON_DOWN, button);
+}
+
+void InputBatch::buttonUp(int button) {
+    push(INPUT_BATCH_BUTTON_UP, button);
+}
+
+void InputBatch::keyDown(int keycode) {
+    push(INPUT_BATCH_KEY_DOWN, keycode);
+}
+
+void InputBatch::keyUp(int keycode) {
+    push(INPUT_BATCH_KEY_UP, keycode);
+}
+
+void InputBatch::wheel(int steps, bool horizontal) {
+    push(INPUT_BATCH_WHEEL, horizontal ? 1 : 0, steps);
+}
+
+void InputBatch::sync() {
+    push(INPUT_BATCH_SYNC, 0);
+}
+
+void InputBatch::delay(int microseconds) {
+    push(INPUT_BATCH_DELAY, 0, microseconds);
+}
+
+void InputBatch::tap(int keycode) {
+    keyDown(keycode);
+    sync();
+    keyUp(keycode);
+    sync();
+}
+
+void InputBatch::click(int button) {
+    buttonDown(button);
+    delay(Config::INPUT_CLICK_HOLD_US);
+    buttonUp(button);
+    sync();
+}
+
+int InputBatch::submit() {
+    if (events_.empty()) {
+        return 0;
+    }
+    if (!batch_supported.load(std::memory_order_relaxed)) {
+        events_.clear();
+        return -1;
+    }
+
+    int result = 0;
+    size_t offset = 0;
+    while (offset < events_.size()) {
+        // Cada llamada respeta los límites del kernel: eventos y suma de esperas
+        size_t count = 0;
+        long delay_us = 0;
+        while (offset + count < events_.size() && count < static_cast<size_t>(Config::INPUT_BATCH_MAX_EVENTS)) {
+            const input_batch_event& event = events_[offset + count];
+            if (event.type == INPUT_BATCH_DELAY) {
+                if (count > 0 && delay_us + event.x > Config::INPUT_BATCH_MAX_DELAY_US) {
+                    break;
+                }
+                delay_us += event.x;
+            }
+            count++;
+        }
+        long applied = syscall(SYS_INPUT_BATCH, events_.data() + offset, count);
+        offset += count;
+        if (applied < 0) {
+            if (errno == ENOSYS) {
+                batch_supported.store(false, std::memory_order_relaxed);
+                std::cerr << " input_batch no disponible, se usan las syscalls de una acción" << std::endl;
+            } else {
+                std::cerr << " Error en input_batch: " << std::strerror(errno) << std::endl;
+            }
+            result = -1;
+            break;
+        }
+    }
+
+    events_.clear();
+    return result;
+}
+
+bool InputBatch::supported() {
+    return batch_supported.load(std::memory_order_relaxed);
+}
+
+} // namespace Syscalls
@@ -1,48 +1,54 @@
 #include "syscalls/keyboard_caption.h"
+#include "syscalls/input_batch.h"
 #include <unistd.h>
 #include <sys/syscall.h>
 #include <iostream>
-#include <map>
-#include <cctype>
+#include <linux/input-event-codes.h>
 #include "syscalls.h"
 
 
 namespace Syscalls {
 
-// Mapa de caracteres a keycodes (basado en tu lista)
-static const std::map<char, int> char_to_keycode = {
-    // Números
-    {'1', 2}, {'2', 3}, {'3', 4}, {'4', 5}, {'5', 6},
-    {'6', 7}, {'7', 8}, {'8', 9}, {'9', 10}, {'0', 11},
-    
-    // Letras minúsculas
-    {'a', 30}, {'b', 48}, {'c', 46}, {'d', 32}, {'e', 18},
-    {'f', 33}, {'g', 34}, {'h', 35}, {'i', 23}, {'j', 36},
-    {'k', 37}, {'l', 38}, {'m', 50}, {'n', 49}, {'o', 24},
-    {'p', 25}, {'q', 16}, {'r', 19}, {'s', 31}, {'t', 20},
-    {'u', 22}, {'v', 47}, {'w', 17}, {'x', 45}, {'y', 21},
-    {'z', 44},
-    
-    // Letras mayúsculas (mismo keycode, el sistema interpreta mayúscula por contexto)
-    {'A', 30}, {'B', 48}, {'C', 46}, {'D', 32}, {'E', 18},
-    {'F', 33}, {'G', 34}, {'H', 35}, {'I', 23}, {'J', 36},
-    {'K', 37}, {'L', 38}, {'M', 50}, {'N', 49}, {'O', 24},
-    {'P', 25}, {'Q', 16}, {'R', 19}, {'S', 31}, {'T', 20},
-    {'U', 22}, {'V', 47}, {'W', 17}, {'X', 45}, {'Y', 21},
-    {'Z', 44},
-    
-    // Símbolos y caracteres especiales
-    {' ', 57},  // Espacio
-    {'-', 12}, {'=', 13}, {'[', 26}, {']', 27},
-    {';', 39}, {'\'', 40}, {'`', 41}, {'\\', 43},
-    {',', 51}, {'.', 52}, {'/', 53},
-    
-    // Teclas especiales
-    {'\n', 96}, // Enter ---> cambio de 28 a 96
-    {'\t', 15}, // Tab
-    {'\b', 14}, // Backspace
+namespace {
+
+// Modificadoras de Utils::KeyStroke y la tecla que las produce
+struct ModifierKey {
+    uint8_t modifier;
+    int keycode;
+};
+
+const ModifierKey MODIFIER_KEYS[] = {
+    {Utils::KEY_MOD_SHIFT, KEY_LEFTSHIFT},
+    {Utils::KEY_MOD_ALTGR, KEY_RIGHTALT},
 };
 
+// Presiona o suelta solo las modificadoras que cambian: una racha de
+// mayúsculas mantiene Shift presionado
+void setModifiers(InputBatch& batch, uint8_t& held, uint8_t wanted) {
+    if (held == wanted) {
+        return;
+    }
+    for (const ModifierKey& modifier : MODIFIER_KEYS) {
+        bool was_held = (held & modifier.modifier) != 0;
+        bool want = (wanted & modifier.modifier) != 0;
+        if (was_held && !want) {
+            batch.keyUp(modifier.keycode);
+        } else if (!was_held && want) {
+            batch.keyDown(modifier.keycode);
+        }
+    }
+    batch.sync();
+    held = wanted;
+}
+
+Utils::KeyboardLayout defaultLayout() {
+    Utils::KeyboardLayout layout = Utils::KeyboardLayout::US;
+    Utils::parseKeyboardLayout(Config::KEYBOARD_LAYOUT, layout);
+    return layout;
+}
+
+} // namespace
+
 int pressKey(int keycode) {
     std::cout << "  Presionando tecla con keycode: " << keycode << std::endl;
     
@@ -59,37 +65,83 @@ int pressKey(int keycode) {
 }
 
 int charToKeycode(char c) {
-    auto it = char_to_keycode.find(c);
-    if (it != char_to_keycode.end()) {
-        return it->second;
+    const Utils::KeyStroke& stroke = Utils::keyStroke(defaultLayout(), static_cast<unsigned char>(c));
+    if (stroke.keycode != 0) {
+        return stroke.keycode;
     }
     
     std::cerr << "  Carácter no mapeado: '" << c << "' (ASCII: " << (int)c << ")" << std::endl;
     return -1;
 }
 
-int typeText(const std::string& text) {
-    std::cout << "  Escribiendo texto: \"" << text << "\"" << std::endl;
+int appendText(InputBatch& batch, const std::string& text, Utils::KeyboardLayout layout) {
+    int typed = 0;
+    size_t offset = 0;
+    unsigned char c = 0;
+    uint8_t held = Utils::KEY_MOD_NONE;
+    
+    // Sin pausas por tecla, solo una cada Config::INPUT_TYPE_BURST_CHARS caracteres
+    while (offset < text.size()) {
+        if (!Utils::nextLatin1(text, offset, c)) {
+            continue;
+        }
+        const Utils::KeyStroke& stroke = Utils::keyStroke(layout, c);
+        if (stroke.keycode == 0) {
+            continue;
+        }
+        if (stroke.dead_keycode != 0) {
+            setModifiers(batch, held, stroke.dead_modifiers);
+            batch.tap(stroke.dead_keycode);
+        }
+        setModifiers(batch, held, stroke.modifiers);
+        batch.tap(stroke.keycode);
+        if (++typed % Config::INPUT_TYPE_BURST_CHARS == 0) {
+            batch.delay(Config::INPUT_TYPE_BURST_GAP_US);
+        }
+    }
+    setModifiers(batch, held, Utils::KEY_MOD_NONE);
+    return typed;
+}
+
+int typeText(const std::string& text, Utils::KeyboardLayout layout) {
+    std::cout << "  Escribiendo texto: " << text.size() << " bytes (" << Utils::keyboardLayoutName(layout) << ")" << std::endl;
     
-    int success_count = 0;
+    // Todo el texto en una sola syscall
+    if (InputBatch::supported()) {
+        InputBatch batch;
+        int typed = appendText(batch, text, layout);
+        if (batch.submit() == 0) {
+            std::cout << " Texto escrito: " << typed << " caracteres" << std::endl;
+            return typed;
+        }
+        if (InputBatch::supported()) {
+            return -1;
+        }
+    }
+    
+    int typed = 0;
+    size_t offset = 0;
+    unsigned char c = 0;
     
-    for (char c : text) {
-        int keycode = charToKeycode(c);
-        if (keycode == -1) {
-            continue; // Saltar caracteres no mapeados
+    // keyboard_caption solo pulsa una tecla: se escriben los caracteres sin
+    // modificadoras. El keyup lo hace el kernel sin bloquear, así que no
+    // hace falta esperar entre teclas
+    while (offset < text.size()) {
+        if (!Utils::nextLatin1(text, offset, c)) {
+            continue;
+        }
+        const Utils::KeyStroke& stroke = Utils::keyStroke(layout, c);
+        if (stroke.keycode == 0 || stroke.modifiers != 0 || stroke.dead_keycode != 0) {
+            continue;
         }
-        
-        if (pressKey(keycode) == 0) {
-            success_count++;
+        if (pressKey(stroke.keycode) == 0) {
+            typed++;
         }
-        
-        // Pequeña pausa entre teclas para simular escritura natural
-        usleep(50000); // 50ms
     }
     
-    std::cout << " Texto escrito: " << success_count << "/" << text.length() << " caracteres" << std::endl;
+    std::cout << " Texto escrito: " << typed << " caracteres" << std::endl;
     
-    return success_count;
+    return typed;
 }
 
-} // namespace Syscalls
\ No newline at end of file
+} // namespace Syscalls
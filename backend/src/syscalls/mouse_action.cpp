@@ -1,5 +1,6 @@
 #include "syscalls/mouse_action.h"
 #include "syscalls/mouse_tracking.h"
+#include "syscalls/input_batch.h"
 #include <unistd.h>
 #include <sys/syscall.h>
 #include "syscalls.h"
@@ -31,6 +32,20 @@ int clickMouse(int button) {
 int clickAt(int x, int y, int button) {
     std::cout << " Click en (" << x << ", " << y << ")" << std::endl;
     
+    // Movimiento y click en una sola syscall
+    if (InputBatch::supported()) {
+        InputBatch batch;
+        batch.move(x, y);
+        batch.sync();
+        batch.click(button);
+        if (batch.submit() == 0) {
+            return 0;
+        }
+        if (InputBatch::supported()) {
+            return -1;
+        }
+    }
+    
     // Primero mover el mouse a la posición
     if (moveMouse(x, y) != 0) {
         return -1;
@@ -1,11 +1,11 @@
 #include "syscalls/screen_live.h"
 #include "utils/base64.h"
+#include "utils/jpeg_encoder.h"
 #include <unistd.h>
 #include <sys/syscall.h>
+#include <cerrno>
 #include <cstring>
 #include <iostream>
-#include <fstream>
-#include <cstdlib>
 
 #include "syscalls.h"
 
@@ -13,29 +13,55 @@
 namespace Syscalls {
 
 int captureScreen(std::vector<unsigned char>& raw_data, screen_capture_info& info) {
-    // Limpiar la estructura
-    std::memset(&info, 0, sizeof(info));
-    
     // Reservar buffer para resolución máxima esperada
     size_t buffer_size = Config::SCREEN_WIDTH * Config::SCREEN_HEIGHT * Config::BYTES_PER_PIXEL;
     raw_data.resize(buffer_size);
     
-    // Configurar el puntero al buffer
-    info.data = raw_data.data();
-    
-    // Invocar la syscall personalizada
-    long result = syscall(SYS_SCREEN_LIVE, &info);
-    
-    if (result < 0) {
-        std::cerr << " Error al capturar pantalla: " << result << std::endl;
+    if (captureScreen(raw_data.data(), raw_data.size(), info) != 0) {
         return -1;
     }
     
     // Ajustar el tamaño del vector al tamaño real capturado
     raw_data.resize(info.buffer_size);
+    return 0;
+}
+
+int captureScreen(unsigned char* buffer, size_t capacity, screen_capture_info& info) {
+    // w = h = 0: pantalla visible completa
+    return captureScreenRegion(0, 0, 0, 0, buffer, capacity, info);
+}
+
+int captureScreenRegion(uint32_t x, uint32_t y, uint32_t w, uint32_t h,
+                        unsigned char* buffer, size_t capacity, screen_capture_info& info) {
+    // Limpiar la estructura
+    std::memset(&info, 0, sizeof(info));
+    
+    if (!buffer || capacity == 0) {
+        std::cerr << " Buffer de captura vacío" << std::endl;
+        return -1;
+    }
+    
+    // Configurar el puntero al buffer, su tamaño y la región
+    info.data = buffer;
+    info.capacity = capacity;
+    info.x = x;
+    info.y = y;
+    info.w = w;
+    info.h = h;
+    
+    // screen_live_rect: screen_live (556) conserva la estructura de 5 campos
+    long result = syscall(SYS_SCREEN_LIVE_RECT, &info);
     
-    std::cout << " Captura exitosa: " << info.width << "x" << info.height 
-              << " (" << info.buffer_size << " bytes)" << std::endl;
+    if (result < 0) {
+        if (errno == ENOSPC) {
+            // El kernel no copió nada: informa cuánto hacía falta
+            std::cerr << " Buffer de captura insuficiente: " << capacity << " de "
+                      << info.buffer_size << " bytes" << std::endl;
+        } else {
+            std::cerr << " Error al capturar pantalla: " << std::strerror(errno) << std::endl;
+        }
+        return -1;
+    }
     
     return 0;
 }
@@ -44,68 +70,46 @@ bool convertToJPEG(const std::vector<unsigned char>& raw_data,
                    std::vector<unsigned char>& jpeg_data,
                    int width, int height) {
     
-    // Guardar archivo RAW temporal
-    const char* raw_path = "/tmp/screen.raw";
-    const char* jpeg_path = "/tmp/screen.jpeg";
+    // Un encoder por thread: conserva tablas y buffers entre frames
+    static thread_local Utils::JpegEncoder encoder;
     
-    std::ofstream raw_file(raw_path, std::ios::binary);
-    if (!raw_file) {
-        std::cerr << " Error al crear archivo RAW temporal" << std::endl;
+    int stride = width * Config::BYTES_PER_PIXEL;
+    if (width <= 0 || height <= 0 ||
+        raw_data.size() < static_cast<size_t>(stride) * height) {
+        std::cerr << " Buffer RAW insuficiente para " << width << "x" << height << std::endl;
         return false;
     }
     
-    raw_file.write(reinterpret_cast<const char*>(raw_data.data()), raw_data.size());
-    raw_file.close();
-    
-    // Construir comando de ImageMagick
-    std::string command = "convert -size " + std::to_string(width) + "x" + 
-                         std::to_string(height) + " -depth 8 bgra:" + 
-                         raw_path + " " + jpeg_path;
-    
-    int ret = system(command.c_str());
-    if (ret != 0) {
+    if (!encoder.encode(raw_data.data(), width, height, stride, jpeg_data)) {
         std::cerr << " Error al convertir a JPEG" << std::endl;
         return false;
     }
     
-    // Leer el archivo JPEG resultante
-    std::ifstream jpeg_file(jpeg_path, std::ios::binary | std::ios::ate);
-    if (!jpeg_file) {
-        std::cerr << " Error al leer archivo JPEG" << std::endl;
-        return false;
-    }
-    
-    size_t file_size = jpeg_file.tellg();
-    jpeg_file.seekg(0, std::ios::beg);
-    
-    jpeg_data.resize(file_size);
-    jpeg_file.read(reinterpret_cast<char*>(jpeg_data.data()), file_size);
-    jpeg_file.close();
-    
-    // Limpiar archivos temporales
-    std::remove(raw_path);
-    std::remove(jpeg_path);
-    
-    std::cout << " JPEG generado: " << file_size << " bytes" << std::endl;
+    std::cout << " JPEG generado: " << jpeg_data.size() << " bytes" << std::endl;
     
     return true;
 }
 
-std::string getScreenshotBase64() {
-    // Vector para datos crudos
-    std::vector<unsigned char> raw_data;
-    screen_capture_info info;
+bool getScreenshotJPEG(std::vector<unsigned char>& jpeg_data, screen_capture_info& info) {
+    // Buffer RAW reutilizado entre frames del mismo thread
+    static thread_local std::vector<unsigned char> raw_data;
     
     // Capturar la pantalla
     if (captureScreen(raw_data, info) != 0) {
-        return "";
+        return false;
     }
     
+    // Convertir a JPEG
+    return convertToJPEG(raw_data, jpeg_data, info.width, info.height);
+}
+
+std::string getScreenshotBase64() {
+    screen_capture_info info;
+    
     // Vector para JPEG
     std::vector<unsigned char> jpeg_data;
     
-    // Convertir a JPEG
-    if (!convertToJPEG(raw_data, jpeg_data, info.width, info.height)) {
+    if (!getScreenshotJPEG(jpeg_data, info)) {
         return "";
     }
     
@@ -0,0 +1,145 @@
+#include "syscalls/screen_ring.h"
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include "syscalls.h"
+
+namespace Syscalls {
+
+ScreenRing::ScreenRing()
+    : fd_(-1), map_(nullptr), map_size_(0), slot_count_(0), tile_size_(0), dirty_tiles_(0),
+      generation_(0), wait_supported_(false), sample_ms_(Config::CHANGE_SAMPLE_MS) {
+    std::memset(&ring_info_, 0, sizeof(ring_info_));
+}
+
+ScreenRing::~ScreenRing() {
+    close();
+}
+
+int ScreenRing::open(unsigned int slot_count, unsigned int tile_size) {
+    close();
+
+    std::memset(&ring_info_, 0, sizeof(ring_info_));
+    ring_info_.tile_size = tile_size;
+
+    long fd = syscall(SYS_SCREEN_RING_OPEN, slot_count, &ring_info_);
+    if (fd < 0) {
+        std::cerr << " screen_ring no disponible: " << std::strerror(errno) << std::endl;
+        return -1;
+    }
+
+    size_t size = ring_info_.slot_count * ring_info_.slot_size;
+    void* map = mmap(nullptr, size, PROT_READ, MAP_SHARED, static_cast<int>(fd), 0);
+    if (map == MAP_FAILED) {
+        std::cerr << " Error al mapear screen_ring: " << std::strerror(errno) << std::endl;
+        ::close(static_cast<int>(fd));
+        return -1;
+    }
+
+    fd_ = static_cast<int>(fd);
+    map_ = static_cast<unsigned char*>(map);
+    map_size_ = size;
+    slot_count_ = slot_count;
+    tile_size_ = tile_size;
+    damage_.assign(ring_info_.dirty_map_size, 0);
+    generation_ = 0;
+    wait_supported_ = (ring_info_.tile_size > 0);
+
+    std::cout << " screen_ring: " << ring_info_.width << "x" << ring_info_.height
+              << ", " << ring_info_.slot_count << " slots" << std::endl;
+    return 0;
+}
+
+void ScreenRing::close() {
+    damage_.clear();
+    if (map_) {
+        munmap(map_, map_size_);
+        map_ = nullptr;
+        map_size_ = 0;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+int ScreenRing::capture(const unsigned char*& bgra, screen_capture_info& info, uint64_t& sequence) {
+    if (fd_ < 0) {
+        return -1;
+    }
+
+    screen_ring_frame frame;
+    std::memset(&frame, 0, sizeof(frame));
+    frame.dirty_map = damage_.empty() ? nullptr : damage_.data();
+    frame.dirty_map_size = static_cast<uint32_t>(damage_.size());
+    long result = syscall(SYS_SCREEN_RING_CAPTURE, fd_, &frame);
+
+    if (result < 0 && errno == ESTALE) {
+        // Cambió la resolución: el anillo anterior ya no sirve
+        std::cout << " Resolución cambiada, reabriendo screen_ring" << std::endl;
+        if (open(slot_count_, tile_size_) != 0) {
+            return -1;
+        }
+        frame.dirty_map = damage_.empty() ? nullptr : damage_.data();
+        frame.dirty_map_size = static_cast<uint32_t>(damage_.size());
+        result = syscall(SYS_SCREEN_RING_CAPTURE, fd_, &frame);
+    }
+
+    if (result < 0) {
+        std::cerr << " Error al capturar con screen_ring: " << std::strerror(errno) << std::endl;
+        return -1;
+    }
+
+    bgra = map_ + static_cast<size_t>(frame.slot) * ring_info_.slot_size;
+    sequence = frame.sequence;
+    dirty_tiles_ = frame.dirty_tiles;
+    generation_ = frame.generation;
+
+    info.width = frame.width;
+    info.height = frame.height;
+    info.bytes_per_pixel = frame.bytes_per_pixel;
+    info.buffer_size = frame.frame_size;
+    info.data = const_cast<unsigned char*>(bgra);
+    return 0;
+}
+
+int ScreenRing::waitForChange(int timeout_ms) {
+    if (!canWait()) {
+        return -1;
+    }
+
+    screen_ring_wait wait;
+    wait.generation = generation_;
+    wait.timeout_ms = static_cast<uint32_t>(std::max(timeout_ms, 0));
+    wait.interval_ms = static_cast<uint32_t>(sample_ms_.load());
+
+    if (syscall(SYS_SCREEN_RING_WAIT, fd_, &wait) == 0) {
+        sample_ms_ = Config::CHANGE_SAMPLE_MS;
+        return 1;
+    }
+
+    switch (errno) {
+    case ETIMEDOUT: {
+        // Pantalla quieta: muestrear cada vez menos (si entró entrada, ya volvió al mínimo)
+        int sample_ms = static_cast<int>(wait.interval_ms);
+        sample_ms_.compare_exchange_strong(sample_ms, std::min(sample_ms * 2, Config::CHANGE_SAMPLE_MAX_MS));
+        return 0;
+    }
+    case EINTR:
+        return 0;
+    case ESTALE:
+        // Cambió la resolución: la próxima captura reabre el anillo
+        return 1;
+    default:
+        std::cerr << " screen_ring_wait no disponible: " << std::strerror(errno) << std::endl;
+        wait_supported_ = false;
+        return -1;
+    }
+}
+
+} // namespace Syscalls
@@ -0,0 +1,84 @@
+#include "utils/frame_protocol.h"
+#include <cstring>
+
+namespace Utils {
+
+namespace {
+
+void putLE(unsigned char* out, size_t offset, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out[offset + i] = static_cast<unsigned char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+void writeHeader(const FrameHeader& header, size_t size, unsigned char* out) {
+    putLE(out, 0, static_cast<uint8_t>(header.type), 1);
+    putLE(out, 1, static_cast<uint8_t>(header.codec), 1);
+    putLE(out, 2, header.flags, 2);
+    putLE(out, 4, header.frame_id, 4);
+    putLE(out, 8, header.timestamp, 8);
+    putLE(out, 16, header.width, 2);
+    putLE(out, 18, header.height, 2);
+    putLE(out, 20, size, 4);
+}
+
+uint64_t getLE(const std::string& in, size_t offset, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value |= static_cast<uint64_t>(static_cast<unsigned char>(in[offset + i])) << (8 * i);
+    }
+    return value;
+}
+
+} // namespace
+
+void buildFrameMessage(const FrameHeader& header, const unsigned char* payload,
+                       size_t size, std::string& out) {
+    unsigned char raw_header[FRAME_HEADER_SIZE];
+    writeHeader(header, size, raw_header);
+
+    out.assign(reinterpret_cast<const char*>(raw_header), FRAME_HEADER_SIZE);
+    out.append(reinterpret_cast<const char*>(payload), size);
+}
+
+size_t writeFrameMessage(const FrameHeader& header, const unsigned char* payload,
+                         size_t size, unsigned char* out, size_t capacity) {
+    return writeFrameMessage(header, nullptr, 0, payload, size, out, capacity);
+}
+
+size_t writeFrameMessage(const FrameHeader& header, const unsigned char* prefix, size_t prefix_size,
+                         const unsigned char* payload, size_t size,
+                         unsigned char* out, size_t capacity) {
+    if (capacity < FRAME_HEADER_SIZE || prefix_size > capacity - FRAME_HEADER_SIZE ||
+        size > capacity - FRAME_HEADER_SIZE - prefix_size) {
+        return 0;
+    }
+
+    writeHeader(header, prefix_size + size, out);
+    if (prefix_size > 0) {
+        std::memcpy(out + FRAME_HEADER_SIZE, prefix, prefix_size);
+    }
+    if (size > 0) {
+        std::memcpy(out + FRAME_HEADER_SIZE + prefix_size, payload, size);
+    }
+    return FRAME_HEADER_SIZE + prefix_size + size;
+}
+
+bool parseFrameHeader(const std::string& message, FrameHeader& header) {
+    if (message.size() < FRAME_HEADER_SIZE) {
+        return false;
+    }
+
+    header.type = static_cast<FrameType>(getLE(message, 0, 1));
+    header.codec = static_cast<FrameCodec>(getLE(message, 1, 1));
+    header.flags = static_cast<uint16_t>(getLE(message, 2, 2));
+    header.frame_id = static_cast<uint32_t>(getLE(message, 4, 4));
+    header.timestamp = getLE(message, 8, 8);
+    header.width = static_cast<uint16_t>(getLE(message, 16, 2));
+    header.height = static_cast<uint16_t>(getLE(message, 18, 2));
+    header.payload_length = static_cast<uint32_t>(getLE(message, 20, 4));
+
+    return true;
+}
+
+} // namespace Utils
@@ -0,0 +1,41 @@
+#include "utils/input_protocol.h"
+
+namespace Utils {
+
+namespace {
+
+uint32_t getLE(const std::string& in, size_t offset, int bytes) {
+    uint32_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value |= static_cast<uint32_t>(static_cast<unsigned char>(in[offset + i])) << (8 * i);
+    }
+    return value;
+}
+
+} // namespace
+
+bool parseInputMessages(const std::string& data, std::vector<InputMessage>& out) {
+    if (data.empty() || data.size() % INPUT_MESSAGE_SIZE != 0) {
+        return false;
+    }
+
+    for (size_t offset = 0; offset < data.size(); offset += INPUT_MESSAGE_SIZE) {
+        uint8_t type = static_cast<uint8_t>(data[offset]);
+        if (type < static_cast<uint8_t>(InputType::MOVE) || type > static_cast<uint8_t>(InputType::WHEEL)) {
+            return false;
+        }
+    }
+
+    for (size_t offset = 0; offset < data.size(); offset += INPUT_MESSAGE_SIZE) {
+        InputMessage message;
+        message.type = static_cast<InputType>(data[offset]);
+        message.code = static_cast<uint16_t>(getLE(data, offset + 2, 2));
+        message.seq = getLE(data, offset + 4, 4);
+        message.x = static_cast<int16_t>(getLE(data, offset + 8, 2));
+        message.y = static_cast<int16_t>(getLE(data, offset + 10, 2));
+        out.push_back(message);
+    }
+    return true;
+}
+
+} // namespace Utils
@@ -0,0 +1,540 @@
+#include "utils/jpeg_encoder.h"
+#include <algorithm>
+#include <cstring>
+
+namespace Utils {
+
+namespace {
+
+// Orden zig-zag: posición k -> índice natural dentro del bloque 8x8
+const uint8_t ZIGZAG[64] = {
+     0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63
+};
+
+// Tablas de cuantización base (ITU T.81 Anexo K), orden natural
+const uint8_t BASE_QUANT_LUMA[64] = {
+    16, 11, 10, 16,  24,  40,  51,  61,
+    12, 12, 14, 19,  26,  58,  60,  55,
+    14, 13, 16, 24,  40,  57,  69,  56,
+    14, 17, 22, 29,  51,  87,  80,  62,
+    18, 22, 37, 56,  68, 109, 103,  77,
+    24, 35, 55, 64,  81, 104, 113,  92,
+    49, 64, 78, 87, 103, 121, 120, 101,
+    72, 92, 95, 98, 112, 100, 103,  99
+};
+
+const uint8_t BASE_QUANT_CHROMA[64] = {
+    17, 18, 24, 47, 99, 99, 99, 99,
+    18, 21, 26, 66, 99, 99, 99, 99,
+    24, 26, 56, 99, 99, 99, 99, 99,
+    47, 66, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99
+};
+
+// Tablas Huffman estándar (ITU T.81 Anexo K.3)
+const uint8_t DC_LUMA_BITS[16] = {0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0};
+const uint8_t DC_LUMA_VALS[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+
+const uint8_t DC_CHROMA_BITS[16] = {0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0};
+const uint8_t DC_CHROMA_VALS[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+
+const uint8_t AC_LUMA_BITS[16] = {0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d};
+const uint8_t AC_LUMA_VALS[162] = {
+    0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+    0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0,
+    0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+    0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+    0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+    0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7,
+    0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5,
+    0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+    0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+    0xf9, 0xfa
+};
+
+const uint8_t AC_CHROMA_BITS[16] = {0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77};
+const uint8_t AC_CHROMA_VALS[162] = {
+    0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+    0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0,
+    0x15, 0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34, 0xe1, 0x25, 0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26,
+    0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+    0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+    0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+    0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5,
+    0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3,
+    0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda,
+    0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+    0xf9, 0xfa
+};
+
+// Factores de escala de la DCT AAN (Arai-Agui-Nakajima)
+const float AAN_SCALE[8] = {
+    1.0f, 1.387039845f, 1.306562965f, 1.175875602f,
+    1.0f, 0.785694958f, 0.541196100f, 0.275899379f
+};
+
+// DCT 1D flotante AAN sobre 8 elementos separados por 'step'
+inline void fdct8(float* d, int step) {
+    float tmp0 = d[0 * step] + d[7 * step];
+    float tmp7 = d[0 * step] - d[7 * step];
+    float tmp1 = d[1 * step] + d[6 * step];
+    float tmp6 = d[1 * step] - d[6 * step];
+    float tmp2 = d[2 * step] + d[5 * step];
+    float tmp5 = d[2 * step] - d[5 * step];
+    float tmp3 = d[3 * step] + d[4 * step];
+    float tmp4 = d[3 * step] - d[4 * step];
+
+    // Parte par
+    float tmp10 = tmp0 + tmp3;
+    float tmp13 = tmp0 - tmp3;
+    float tmp11 = tmp1 + tmp2;
+    float tmp12 = tmp1 - tmp2;
+
+    d[0 * step] = tmp10 + tmp11;
+    d[4 * step] = tmp10 - tmp11;
+
+    float z1 = (tmp12 + tmp13) * 0.707106781f;
+    d[2 * step] = tmp13 + z1;
+    d[6 * step] = tmp13 - z1;
+
+    // Parte impar
+    tmp10 = tmp4 + tmp5;
+    tmp11 = tmp5 + tmp6;
+    tmp12 = tmp6 + tmp7;
+
+    float z5 = (tmp10 - tmp12) * 0.382683433f;
+    float z2 = 0.541196100f * tmp10 + z5;
+    float z4 = 1.306562965f * tmp12 + z5;
+    float z3 = tmp11 * 0.707106781f;
+
+    float z11 = tmp7 + z3;
+    float z13 = tmp7 - z3;
+
+    d[5 * step] = z13 + z2;
+    d[3 * step] = z13 - z2;
+    d[1 * step] = z11 + z4;
+    d[7 * step] = z11 - z4;
+}
+
+inline int bitLength(int value) {
+    int magnitude = value < 0 ? -value : value;
+    int bits = 0;
+    while (magnitude) {
+        bits++;
+        magnitude >>= 1;
+    }
+    return bits;
+}
+
+void scaleQuantTable(const uint8_t* base, int quality, uint8_t* out) {
+    quality = std::max(1, std::min(100, quality));
+    int scale = quality < 50 ? 5000 / quality : 200 - quality * 2;
+    for (int i = 0; i < 64; i++) {
+        int value = (base[i] * scale + 50) / 100;
+        out[i] = static_cast<uint8_t>(std::max(1, std::min(255, value)));
+    }
+}
+
+void putMarker(std::vector<unsigned char>& out, uint8_t marker) {
+    out.push_back(0xFF);
+    out.push_back(marker);
+}
+
+void putWord(std::vector<unsigned char>& out, int value) {
+    out.push_back(static_cast<unsigned char>((value >> 8) & 0xFF));
+    out.push_back(static_cast<unsigned char>(value & 0xFF));
+}
+
+void putHuffmanTable(std::vector<unsigned char>& out, int table_class_id,
+                     const uint8_t* bits, const uint8_t* vals) {
+    int count = 0;
+    for (int i = 0; i < 16; i++) {
+        count += bits[i];
+    }
+    out.push_back(static_cast<unsigned char>(table_class_id));
+    out.insert(out.end(), bits, bits + 16);
+    out.insert(out.end(), vals, vals + count);
+}
+
+} // namespace
+
+// ==================== BitWriter ====================
+
+void JpegEncoder::BitWriter::put(uint32_t bits, int length) {
+    buffer = (buffer << length) | (bits & ((1u << length) - 1));
+    count += length;
+
+    while (count >= 8) {
+        unsigned char byte = static_cast<unsigned char>((buffer >> (count - 8)) & 0xFF);
+        out->push_back(byte);
+        if (byte == 0xFF) {
+            out->push_back(0x00);  // Byte stuffing
+        }
+        count -= 8;
+    }
+}
+
+void JpegEncoder::BitWriter::flush() {
+    // Completar el último byte con unos (T.81 F.1.2.3)
+    if (count > 0) {
+        int pad = 8 - count;
+        put((1u << pad) - 1, pad);
+    }
+    buffer = 0;
+    count = 0;
+}
+
+// ==================== JpegEncoder ====================
+
+JpegEncoder::JpegEncoder(const JpegOptions& options)
+    : options_(options), kernels_(&PixelKernels::active()) {
+    buildTables();
+}
+
+void JpegEncoder::setOptions(const JpegOptions& options) {
+    bool changed = options.quality != options_.quality ||
+                   options.subsampling != options_.subsampling;
+    if (options.threads != options_.threads) {
+        pool_.reset();
+    }
+    options_ = options;
+    if (changed) {
+        buildTables();
+    }
+}
+
+void JpegEncoder::buildTables() {
+    scaleQuantTable(BASE_QUANT_LUMA, options_.quality, quant_luma_);
+    scaleQuantTable(BASE_QUANT_CHROMA, options_.quality, quant_chroma_);
+
+    for (int row = 0; row < 8; row++) {
+        for (int col = 0; col < 8; col++) {
+            int i = row * 8 + col;
+            float aan = AAN_SCALE[row] * AAN_SCALE[col] * 8.0f;
+            fdiv_luma_[i] = 1.0f / (quant_luma_[i] * aan);
+            fdiv_chroma_[i] = 1.0f / (quant_chroma_[i] * aan);
+        }
+    }
+
+    auto build = [](HuffmanTable& table, const uint8_t* bits, const uint8_t* vals) {
+        std::memset(&table, 0, sizeof(table));
+        int k = 0;
+        uint16_t code = 0;
+        for (int length = 1; length <= 16; length++) {
+            for (int i = 0; i < bits[length - 1]; i++) {
+                table.code[vals[k]] = code;
+                table.size[vals[k]] = static_cast<uint8_t>(length);
+                code++;
+                k++;
+            }
+            code <<= 1;
+        }
+    };
+
+    build(dc_luma_, DC_LUMA_BITS, DC_LUMA_VALS);
+    build(ac_luma_, AC_LUMA_BITS, AC_LUMA_VALS);
+    build(dc_chroma_, DC_CHROMA_BITS, DC_CHROMA_VALS);
+    build(ac_chroma_, AC_CHROMA_BITS, AC_CHROMA_VALS);
+}
+
+void JpegEncoder::writeHeaders(std::vector<unsigned char>& out, int width, int height,
+                               int restart_interval) const {
+    // SOI
+    putMarker(out, 0xD8);
+
+    // APP0 JFIF
+    putMarker(out, 0xE0);
+    putWord(out, 16);
+    const unsigned char jfif[] = {'J', 'F', 'I', 'F', 0, 1, 1, 0, 0, 1, 0, 1, 0, 0};
+    out.insert(out.end(), jfif, jfif + sizeof(jfif));
+
+    // DQT: dos tablas en orden zig-zag
+    putMarker(out, 0xDB);
+    putWord(out, 2 + 2 * 65);
+    out.push_back(0x00);
+    for (int k = 0; k < 64; k++) {
+        out.push_back(quant_luma_[ZIGZAG[k]]);
+    }
+    out.push_back(0x01);
+    for (int k = 0; k < 64; k++) {
+        out.push_back(quant_chroma_[ZIGZAG[k]]);
+    }
+
+    // SOF0: baseline, 3 componentes
+    uint8_t luma_sampling = 0x11;
+    if (options_.subsampling == ChromaSubsampling::S422) {
+        luma_sampling = 0x21;
+    } else if (options_.subsampling == ChromaSubsampling::S420) {
+        luma_sampling = 0x22;
+    }
+
+    putMarker(out, 0xC0);
+    putWord(out, 8 + 3 * 3);
+    out.push_back(8);
+    putWord(out, height);
+    putWord(out, width);
+    out.push_back(3);
+    const unsigned char components[] = {1, luma_sampling, 0, 2, 0x11, 1, 3, 0x11, 1};
+    out.insert(out.end(), components, components + sizeof(components));
+
+    // DHT: las cuatro tablas estándar
+    putMarker(out, 0xC4);
+    putWord(out, 2 + (17 + 12) * 2 + (17 + 162) * 2);
+    putHuffmanTable(out, 0x00, DC_LUMA_BITS, DC_LUMA_VALS);
+    putHuffmanTable(out, 0x10, AC_LUMA_BITS, AC_LUMA_VALS);
+    putHuffmanTable(out, 0x01, DC_CHROMA_BITS, DC_CHROMA_VALS);
+    putHuffmanTable(out, 0x11, AC_CHROMA_BITS, AC_CHROMA_VALS);
+
+    // DRI: un marcador RST cada 'restart_interval' MCUs
+    if (restart_interval > 0) {
+        putMarker(out, 0xDD);
+        putWord(out, 4);
+        putWord(out, restart_interval);
+    }
+
+    // SOS
+    putMarker(out, 0xDA);
+    putWord(out, 12);
+    out.push_back(3);
+    const unsigned char scan[] = {1, 0x00, 2, 0x11, 3, 0x11, 0, 63, 0};
+    out.insert(out.end(), scan, scan + sizeof(scan));
+}
+
+void JpegEncoder::convertMcuRow(const Layout& layout, McuRowBuffers& buffers,
+                                int mcu_row) const {
+    const int width = layout.width;
+    const int padded_width = layout.padded_width;
+    const int chroma_width = layout.chroma_width;
+
+    for (int r = 0; r < layout.mcu_h; r++) {
+        // Replicar la última línea si la imagen no es múltiplo del MCU
+        int src_y = std::min(mcu_row * layout.mcu_h + r, layout.height - 1);
+        const unsigned char* src = layout.bgra + static_cast<size_t>(src_y) * layout.stride;
+
+        uint8_t* y_line = &buffers.y_rows[r * padded_width];
+        uint8_t* cb_line = &buffers.cb_full[r * padded_width];
+        uint8_t* cr_line = &buffers.cr_full[r * padded_width];
+
+        kernels_->bgraToYccRow(src, width, y_line, cb_line, cr_line);
+
+        // Replicar la última columna
+        for (int x = width; x < padded_width; x++) {
+            y_line[x] = y_line[width - 1];
+            cb_line[x] = cb_line[width - 1];
+            cr_line[x] = cr_line[width - 1];
+        }
+    }
+
+    // Submuestreo de crominancia a un bloque de 8 líneas
+    for (int r = 0; r < 8; r++) {
+        uint8_t* cb_out = &buffers.cb_rows[r * chroma_width];
+        uint8_t* cr_out = &buffers.cr_rows[r * chroma_width];
+
+        if (options_.subsampling == ChromaSubsampling::S444) {
+            std::memcpy(cb_out, &buffers.cb_full[r * padded_width], chroma_width);
+            std::memcpy(cr_out, &buffers.cr_full[r * padded_width], chroma_width);
+        } else if (options_.subsampling == ChromaSubsampling::S422) {
+            kernels_->downsample2x1(&buffers.cb_full[r * padded_width], chroma_width, cb_out);
+            kernels_->downsample2x1(&buffers.cr_full[r * padded_width], chroma_width, cr_out);
+        } else {
+            kernels_->downsample2x2(&buffers.cb_full[(2 * r) * padded_width],
+                                    &buffers.cb_full[(2 * r + 1) * padded_width], chroma_width, cb_out);
+            kernels_->downsample2x2(&buffers.cr_full[(2 * r) * padded_width],
+                                    &buffers.cr_full[(2 * r + 1) * padded_width], chroma_width, cr_out);
+        }
+    }
+}
+
+void JpegEncoder::encodeBlock(BitWriter& writer, const uint8_t* plane, int plane_stride,
+                              const float* fdiv, const HuffmanTable& dc,
+                              const HuffmanTable& ac, int& last_dc) const {
+    float data[64];
+    kernels_->loadBlock(plane, plane_stride, data);
+
+    for (int r = 0; r < 8; r++) {
+        fdct8(data + r * 8, 1);
+    }
+    for (int c = 0; c < 8; c++) {
+        fdct8(data + c, 8);
+    }
+
+    int coeffs[64];
+    for (int k = 0; k < 64; k++) {
+        int n = ZIGZAG[k];
+        float v = data[n] * fdiv[n];
+        coeffs[k] = static_cast<int>(v < 0.0f ? v - 0.5f : v + 0.5f);
+    }
+
+    // Coeficiente DC (diferencial)
+    int diff = coeffs[0] - last_dc;
+    last_dc = coeffs[0];
+
+    int nbits = bitLength(diff);
+    writer.put(dc.code[nbits], dc.size[nbits]);
+    if (nbits) {
+        writer.put(diff < 0 ? diff - 1 : diff, nbits);
+    }
+
+    // Coeficientes AC con run-length de ceros
+    int run = 0;
+    for (int k = 1; k < 64; k++) {
+        int v = coeffs[k];
+        if (v == 0) {
+            run++;
+            continue;
+        }
+        while (run > 15) {
+            writer.put(ac.code[0xF0], ac.size[0xF0]);  // ZRL
+            run -= 16;
+        }
+        nbits = bitLength(v);
+        int symbol = (run << 4) | nbits;
+        writer.put(ac.code[symbol], ac.size[symbol]);
+        writer.put(v < 0 ? v - 1 : v, nbits);
+        run = 0;
+    }
+    if (run > 0) {
+        writer.put(ac.code[0x00], ac.size[0x00]);  // EOB
+    }
+}
+
+void JpegEncoder::encodeMcuRows(const Layout& layout, McuRowBuffers& buffers,
+                                int first_row, int last_row,
+                                std::vector<unsigned char>& out) const {
+    const int mcu_w = layout.mcu_w;
+    const int mcu_h = layout.mcu_h;
+    const int padded_width = layout.padded_width;
+
+    BitWriter writer;
+    writer.out = &out;
+    writer.buffer = 0;
+    writer.count = 0;
+
+    int last_dc_y = 0;
+    int last_dc_cb = 0;
+    int last_dc_cr = 0;
+
+    for (int mcu_row = first_row; mcu_row < last_row; mcu_row++) {
+        convertMcuRow(layout, buffers, mcu_row);
+
+        for (int mcu_x = 0; mcu_x < layout.mcus_x; mcu_x++) {
+            // Bloques de luminancia del MCU (1, 2 o 4)
+            for (int by = 0; by < mcu_h; by += 8) {
+                for (int bx = 0; bx < mcu_w; bx += 8) {
+                    const uint8_t* block = &buffers.y_rows[by * padded_width + mcu_x * mcu_w + bx];
+                    encodeBlock(writer, block, padded_width, fdiv_luma_,
+                                dc_luma_, ac_luma_, last_dc_y);
+                }
+            }
+
+            encodeBlock(writer, &buffers.cb_rows[mcu_x * 8], layout.chroma_width, fdiv_chroma_,
+                        dc_chroma_, ac_chroma_, last_dc_cb);
+            encodeBlock(writer, &buffers.cr_rows[mcu_x * 8], layout.chroma_width, fdiv_chroma_,
+                        dc_chroma_, ac_chroma_, last_dc_cr);
+        }
+    }
+
+    writer.flush();
+}
+
+bool JpegEncoder::encode(const unsigned char* bgra, int width, int height, int stride,
+                         std::vector<unsigned char>& out) {
+    if (!bgra || width <= 0 || height <= 0 || width > 65535 || height > 65535 ||
+        stride < width * 4) {
+        return false;
+    }
+
+    Layout layout;
+    layout.bgra = bgra;
+    layout.width = width;
+    layout.height = height;
+    layout.stride = stride;
+    layout.mcu_w = 8;
+    layout.mcu_h = 8;
+    if (options_.subsampling == ChromaSubsampling::S422) {
+        layout.mcu_w = 16;
+    } else if (options_.subsampling == ChromaSubsampling::S420) {
+        layout.mcu_w = 16;
+        layout.mcu_h = 16;
+    }
+    layout.mcus_x = (width + layout.mcu_w - 1) / layout.mcu_w;
+    layout.mcus_y = (height + layout.mcu_h - 1) / layout.mcu_h;
+    layout.padded_width = layout.mcus_x * layout.mcu_w;
+    layout.chroma_width = layout.padded_width / (layout.mcu_w / 8);
+
+    // Franjas: el intervalo de reinicio (en MCUs) tiene que caber en 16 bits
+    int strip_rows = layout.mcus_y;
+    if (options_.restart_rows > 0) {
+        strip_rows = std::min(options_.restart_rows, std::max(1, 65535 / layout.mcus_x));
+    }
+    const int strip_count = (layout.mcus_y + strip_rows - 1) / strip_rows;
+    const int restart_interval = strip_count > 1 ? strip_rows * layout.mcus_x : 0;
+
+    if (strip_count > 1 && !pool_ && options_.threads != 1) {
+        pool_.reset(new ThreadPool(options_.threads));
+    }
+    // Buffers para cada thread del pool: cualquiera puede tomar cualquier franja
+    const int threads = (strip_count > 1 && pool_) ? pool_->size() : 1;
+
+    // resize() no libera capacidad: tras el primer frame no hay reservas
+    if (row_buffers_.size() < static_cast<size_t>(threads)) {
+        row_buffers_.resize(threads);
+    }
+    for (int i = 0; i < threads; i++) {
+        McuRowBuffers& buffers = row_buffers_[i];
+        buffers.y_rows.resize(static_cast<size_t>(layout.mcu_h) * layout.padded_width);
+        buffers.cb_full.resize(static_cast<size_t>(layout.mcu_h) * layout.padded_width);
+        buffers.cr_full.resize(static_cast<size_t>(layout.mcu_h) * layout.padded_width);
+        buffers.cb_rows.resize(static_cast<size_t>(8) * layout.chroma_width);
+        buffers.cr_rows.resize(static_cast<size_t>(8) * layout.chroma_width);
+    }
+
+    out.clear();
+    writeHeaders(out, width, height, restart_interval);
+
+    if (strip_count == 1) {
+        encodeMcuRows(layout, row_buffers_[0], 0, layout.mcus_y, out);
+    } else {
+        if (strips_.size() < static_cast<size_t>(strip_count)) {
+            strips_.resize(strip_count);
+        }
+
+        // Cada franja termina en un byte completo seguido de su RSTn
+        auto encodeStrip = [&](int strip, int worker) {
+            std::vector<unsigned char>& data = strips_[strip];
+            data.clear();
+            int first_row = strip * strip_rows;
+            int last_row = std::min(first_row + strip_rows, layout.mcus_y);
+            encodeMcuRows(layout, row_buffers_[worker], first_row, last_row, data);
+            if (strip + 1 < strip_count) {
+                putMarker(data, static_cast<uint8_t>(0xD0 + (strip & 7)));
+            }
+        };
+
+        if (threads > 1) {
+            pool_->parallelFor(strip_count, encodeStrip);
+        } else {
+            for (int strip = 0; strip < strip_count; strip++) {
+                encodeStrip(strip, 0);
+            }
+        }
+
+        for (int strip = 0; strip < strip_count; strip++) {
+            out.insert(out.end(), strips_[strip].begin(), strips_[strip].end());
+        }
+    }
+
+    // EOI
+    putMarker(out, 0xD9);
+
+    return true;
+}
+
+} // namespace Utils
@@ -0,0 +1,225 @@
+#include "utils/keymap.h"
+#include <array>
+#include <linux/input-event-codes.h>
+
+namespace Utils {
+
+namespace {
+
+using KeyTable = std::array<KeyStroke, 256>;
+
+constexpr uint8_t SHIFT = KEY_MOD_SHIFT;
+constexpr uint8_t ALTGR = KEY_MOD_ALTGR;
+
+constexpr uint8_t LETTER_KEYS[26] = {
+    KEY_A, KEY_B, KEY_C, KEY_D, KEY_E, KEY_F, KEY_G, KEY_H, KEY_I, KEY_J, KEY_K, KEY_L, KEY_M,
+    KEY_N, KEY_O, KEY_P, KEY_Q, KEY_R, KEY_S, KEY_T, KEY_U, KEY_V, KEY_W, KEY_X, KEY_Y, KEY_Z
+};
+
+constexpr uint8_t DIGIT_KEYS[10] = {
+    KEY_0, KEY_1, KEY_2, KEY_3, KEY_4, KEY_5, KEY_6, KEY_7, KEY_8, KEY_9
+};
+
+constexpr void set(KeyTable& table, unsigned char c, uint8_t keycode, uint8_t modifiers = 0,
+                   uint8_t dead_keycode = 0, uint8_t dead_modifiers = 0) {
+    table[c] = KeyStroke{keycode, modifiers, dead_keycode, dead_modifiers};
+}
+
+// Lo que no cambia entre distribuciones: letras, dígitos y teclas de control
+constexpr KeyTable baseTable() {
+    KeyTable table{};
+    for (int i = 0; i < 26; i++) {
+        set(table, static_cast<unsigned char>('a' + i), LETTER_KEYS[i]);
+        set(table, static_cast<unsigned char>('A' + i), LETTER_KEYS[i], SHIFT);
+    }
+    for (int i = 0; i < 10; i++) {
+        set(table, static_cast<unsigned char>('0' + i), DIGIT_KEYS[i]);
+    }
+    set(table, ' ', KEY_SPACE);
+    set(table, '\t', KEY_TAB);
+    set(table, '\b', KEY_BACKSPACE);
+    set(table, '\n', KEY_KPENTER);   // Enter del teclado numérico: igual en todas las distribuciones
+    return table;
+}
+
+// Vocales acentuadas con una tecla muerta. 'lower' son las minúsculas en
+// Latin-1 para a, e, i, o, u; las mayúsculas están 0x20 antes
+constexpr void setDeadVowels(KeyTable& table, const unsigned char (&lower)[5],
+                             uint8_t dead_keycode, uint8_t dead_modifiers) {
+    const uint8_t vowels[5] = {KEY_A, KEY_E, KEY_I, KEY_O, KEY_U};
+    for (int i = 0; i < 5; i++) {
+        set(table, lower[i], vowels[i], 0, dead_keycode, dead_modifiers);
+        set(table, static_cast<unsigned char>(lower[i] - 0x20), vowels[i], SHIFT, dead_keycode, dead_modifiers);
+    }
+}
+
+constexpr unsigned char ACUTE_VOWELS[5] = {0xE1, 0xE9, 0xED, 0xF3, 0xFA};       // á é í ó ú
+constexpr unsigned char GRAVE_VOWELS[5] = {0xE0, 0xE8, 0xEC, 0xF2, 0xF9};       // à è ì ò ù
+constexpr unsigned char CIRCUMFLEX_VOWELS[5] = {0xE2, 0xEA, 0xEE, 0xF4, 0xFB};  // â ê î ô û
+constexpr unsigned char DIAERESIS_VOWELS[5] = {0xE4, 0xEB, 0xEF, 0xF6, 0xFC};   // ä ë ï ö ü
+
+// Teclas muertas de las distribuciones españolas. La tecla muerta seguida
+// de espacio da el carácter suelto (` y ^); ´ y ¨ salen pulsándola dos veces
+constexpr void setDeadKeys(KeyTable& table,
+                           uint8_t acute, uint8_t acute_mods, uint8_t diaeresis, uint8_t diaeresis_mods,
+                           uint8_t grave, uint8_t grave_mods, uint8_t circumflex, uint8_t circumflex_mods) {
+    setDeadVowels(table, ACUTE_VOWELS, acute, acute_mods);
+    setDeadVowels(table, DIAERESIS_VOWELS, diaeresis, diaeresis_mods);
+    setDeadVowels(table, GRAVE_VOWELS, grave, grave_mods);
+    setDeadVowels(table, CIRCUMFLEX_VOWELS, circumflex, circumflex_mods);
+    set(table, 0xFF, KEY_Y, 0, diaeresis, diaeresis_mods);           // ÿ
+    set(table, 0xB4, acute, acute_mods, acute, acute_mods);          // ´
+    set(table, 0xA8, diaeresis, diaeresis_mods, diaeresis, diaeresis_mods);  // ¨
+    set(table, '`', KEY_SPACE, 0, grave, grave_mods);
+    set(table, '^', KEY_SPACE, 0, circumflex, circumflex_mods);
+}
+
+constexpr KeyTable usTable() {
+    KeyTable table = baseTable();
+    const char shifted_digits[] = ")!@#$%^&*(";
+    for (int i = 0; i < 10; i++) {
+        set(table, static_cast<unsigned char>(shifted_digits[i]), DIGIT_KEYS[i], SHIFT);
+    }
+    set(table, '-', KEY_MINUS);        set(table, '_', KEY_MINUS, SHIFT);
+    set(table, '=', KEY_EQUAL);        set(table, '+', KEY_EQUAL, SHIFT);
+    set(table, '[', KEY_LEFTBRACE);    set(table, '{', KEY_LEFTBRACE, SHIFT);
+    set(table, ']', KEY_RIGHTBRACE);   set(table, '}', KEY_RIGHTBRACE, SHIFT);
+    set(table, ';', KEY_SEMICOLON);    set(table, ':', KEY_SEMICOLON, SHIFT);
+    set(table, '\'', KEY_APOSTROPHE);  set(table, '"', KEY_APOSTROPHE, SHIFT);
+    set(table, '`', KEY_GRAVE);        set(table, '~', KEY_GRAVE, SHIFT);
+    set(table, '\\', KEY_BACKSLASH);   set(table, '|', KEY_BACKSLASH, SHIFT);
+    set(table, ',', KEY_COMMA);        set(table, '<', KEY_COMMA, SHIFT);
+    set(table, '.', KEY_DOT);          set(table, '>', KEY_DOT, SHIFT);
+    set(table, '/', KEY_SLASH);        set(table, '?', KEY_SLASH, SHIFT);
+    return table;
+}
+
+// Común a España y Latinoamérica: fila de números con Shift y la fila inferior
+constexpr void setSpanishCommon(KeyTable& table) {
+    const char shifted_digits[] = "=!\"\0$%&/()";   // Shift+3 depende de la distribución
+    for (int i = 0; i < 10; i++) {
+        if (shifted_digits[i] != '\0') {
+            set(table, static_cast<unsigned char>(shifted_digits[i]), DIGIT_KEYS[i], SHIFT);
+        }
+    }
+    set(table, '\'', KEY_MINUS);       set(table, '?', KEY_MINUS, SHIFT);
+    set(table, '+', KEY_RIGHTBRACE);   set(table, '*', KEY_RIGHTBRACE, SHIFT);
+    set(table, 0xF1, KEY_SEMICOLON);   set(table, 0xD1, KEY_SEMICOLON, SHIFT);   // ñ Ñ
+    set(table, '<', KEY_102ND);        set(table, '>', KEY_102ND, SHIFT);
+    set(table, ',', KEY_COMMA);        set(table, ';', KEY_COMMA, SHIFT);
+    set(table, '.', KEY_DOT);          set(table, ':', KEY_DOT, SHIFT);
+    set(table, '-', KEY_SLASH);        set(table, '_', KEY_SLASH, SHIFT);
+}
+
+constexpr KeyTable esTable() {
+    KeyTable table = baseTable();
+    setSpanishCommon(table);
+    set(table, 0xBA, KEY_GRAVE);       set(table, 0xAA, KEY_GRAVE, SHIFT);       // º ª
+    set(table, '\\', KEY_GRAVE, ALTGR);
+    set(table, '|', KEY_1, ALTGR);
+    set(table, '@', KEY_2, ALTGR);
+    set(table, 0xB7, KEY_3, SHIFT);    set(table, '#', KEY_3, ALTGR);            // ·
+    set(table, '~', KEY_4, ALTGR);
+    set(table, 0xAC, KEY_6, ALTGR);                                              // ¬
+    set(table, 0xA1, KEY_EQUAL);       set(table, 0xBF, KEY_EQUAL, SHIFT);       // ¡ ¿
+    set(table, '[', KEY_LEFTBRACE, ALTGR);
+    set(table, ']', KEY_RIGHTBRACE, ALTGR);
+    set(table, '{', KEY_APOSTROPHE, ALTGR);
+    set(table, 0xE7, KEY_BACKSLASH);   set(table, 0xC7, KEY_BACKSLASH, SHIFT);   // ç Ç
+    set(table, '}', KEY_BACKSLASH, ALTGR);
+    setDeadKeys(table, KEY_APOSTROPHE, 0, KEY_APOSTROPHE, SHIFT,
+                KEY_LEFTBRACE, 0, KEY_LEFTBRACE, SHIFT);
+    return table;
+}
+
+constexpr KeyTable latamTable() {
+    KeyTable table = baseTable();
+    setSpanishCommon(table);
+    set(table, '|', KEY_GRAVE);        set(table, 0xB0, KEY_GRAVE, SHIFT);       // °
+    set(table, 0xAC, KEY_GRAVE, ALTGR);                                          // ¬
+    set(table, '#', KEY_3, SHIFT);
+    set(table, '@', KEY_Q, ALTGR);
+    set(table, '\\', KEY_MINUS, ALTGR);
+    set(table, 0xBF, KEY_EQUAL);       set(table, 0xA1, KEY_EQUAL, SHIFT);       // ¿ ¡
+    set(table, '~', KEY_RIGHTBRACE, ALTGR);
+    set(table, '{', KEY_APOSTROPHE);   set(table, '[', KEY_APOSTROPHE, SHIFT);
+    set(table, '}', KEY_BACKSLASH);    set(table, ']', KEY_BACKSLASH, SHIFT);
+    setDeadKeys(table, KEY_LEFTBRACE, 0, KEY_LEFTBRACE, SHIFT,
+                KEY_BACKSLASH, ALTGR, KEY_APOSTROPHE, ALTGR);
+    return table;
+}
+
+constexpr KeyTable US_KEYMAP = usTable();
+constexpr KeyTable ES_KEYMAP = esTable();
+constexpr KeyTable LATAM_KEYMAP = latamTable();
+
+static_assert(US_KEYMAP['A'].keycode == KEY_A && US_KEYMAP['A'].modifiers == SHIFT, "US: A = Shift+a");
+static_assert(ES_KEYMAP['@'].keycode == KEY_2 && ES_KEYMAP['@'].modifiers == ALTGR, "ES: @ = AltGr+2");
+static_assert(LATAM_KEYMAP[0xE1].dead_keycode == KEY_LEFTBRACE, "LATAM: á = ´ + a");
+
+} // namespace
+
+const KeyStroke& keyStroke(KeyboardLayout layout, unsigned char c) {
+    switch (layout) {
+        case KeyboardLayout::ES:
+            return ES_KEYMAP[c];
+        case KeyboardLayout::LATAM:
+            return LATAM_KEYMAP[c];
+        case KeyboardLayout::US:
+        default:
+            return US_KEYMAP[c];
+    }
+}
+
+const char* keyboardLayoutName(KeyboardLayout layout) {
+    switch (layout) {
+        case KeyboardLayout::ES:
+            return "es";
+        case KeyboardLayout::LATAM:
+            return "latam";
+        case KeyboardLayout::US:
+        default:
+            return "us";
+    }
+}
+
+bool parseKeyboardLayout(const std::string& name, KeyboardLayout& out) {
+    for (KeyboardLayout layout : {KeyboardLayout::US, KeyboardLayout::ES, KeyboardLayout::LATAM}) {
+        if (name == keyboardLayoutName(layout)) {
+            out = layout;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool nextLatin1(const std::string& text, size_t& offset, unsigned char& out) {
+    unsigned char lead = static_cast<unsigned char>(text[offset++]);
+    if (lead < 0x80) {
+        out = lead;
+        return true;
+    }
+
+    // Largo de la secuencia según el primer byte; un byte de continuación
+    // suelto o un primer byte inválido se salta solo
+    size_t length = (lead & 0xE0) == 0xC0 ? 2 : (lead & 0xF0) == 0xE0 ? 3 : (lead & 0xF8) == 0xF0 ? 4 : 1;
+    if (length == 1) {
+        return false;
+    }
+    uint32_t codepoint = lead & (0x7F >> length);
+    size_t end = offset + length - 1;
+    for (; offset < end && offset < text.size(); offset++) {
+        unsigned char next = static_cast<unsigned char>(text[offset]);
+        if ((next & 0xC0) != 0x80) {
+            return false;   // Secuencia cortada: el byte se lee como el inicio del siguiente
+        }
+        codepoint = (codepoint << 6) | (next & 0x3F);
+    }
+    if (offset < end || codepoint > 0xFF) {
+        return false;
+    }
+    out = static_cast<unsigned char>(codepoint);
+    return true;
+}
+
+} // namespace Utils
@@ -0,0 +1,518 @@
+#include "utils/pixel_kernels.h"
+#include <cstddef>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define PIXEL_KERNELS_X86 1
+#endif
+
+namespace Utils {
+namespace PixelKernels {
+
+namespace {
+
+/*
+ * Coeficientes JFIF en punto fijo de 14 bits. Caben en int16 para que
+ * las versiones SSE2/AVX2 (pmaddwd) den exactamente el mismo resultado.
+ */
+const int Y_R = 4899, Y_G = 9617, Y_B = 1868, Y_BIAS = 8192;
+const int CB_R = -2765, CB_G = -5427, CB_B = 8192;
+const int CR_R = 8192, CR_G = -6860, CR_B = -1332;
+const int C_BIAS = (128 << 14) + 8191;
+
+// Huella de bloques: ronda de xxHash32 por carril. 32 carriles (128 bytes por
+// vuelta) dan 4 cadenas independientes en AVX2 y 8 en SSE2: con un solo
+// acumulador la latencia de la multiplicación limita el throughput
+const int HASH_LANES = 32;
+const uint32_t HASH_P1 = 2654435761u;
+const uint32_t HASH_P2 = 2246822519u;
+const uint32_t HASH_SEED = 0x27d4eb2fu;
+
+inline uint32_t hashRound(uint32_t acc, uint32_t word) {
+    acc += word * HASH_P2;
+    acc = (acc << 13) | (acc >> 19);
+    return acc * HASH_P1;
+}
+
+inline void hashInit(uint32_t lanes[HASH_LANES]) {
+    for (int i = 0; i < HASH_LANES; i++) {
+        lanes[i] = HASH_SEED + static_cast<uint32_t>(i) * HASH_P1;
+    }
+}
+
+// Palabras de una fila a partir de 'first' (cola de las versiones vectoriales)
+inline void hashWords(uint32_t lanes[HASH_LANES], const unsigned char* line, int first, int words) {
+    for (int i = first; i < words; i++) {
+        uint32_t word;
+        std::memcpy(&word, line + i * 4, 4);
+        lanes[i % HASH_LANES] = hashRound(lanes[i % HASH_LANES], word);
+    }
+}
+
+inline uint64_t hashFold(const uint32_t lanes[HASH_LANES], int row_bytes, int rows) {
+    uint64_t hash = static_cast<uint64_t>(row_bytes) << 32 | static_cast<uint32_t>(rows);
+    for (int i = 0; i < HASH_LANES; i++) {
+        hash = (hash ^ lanes[i]) * 0x9E3779B97F4A7C15ull;
+        hash ^= hash >> 31;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    return hash ^ (hash >> 33);
+}
+
+// ==================== Escalar ====================
+
+void bgraToYccRowScalar(const unsigned char* bgra, int count,
+                        uint8_t* y, uint8_t* cb, uint8_t* cr) {
+    for (int i = 0; i < count; i++) {
+        const int b = bgra[i * 4 + 0];
+        const int g = bgra[i * 4 + 1];
+        const int r = bgra[i * 4 + 2];
+        y[i]  = static_cast<uint8_t>((Y_R * r + Y_G * g + Y_B * b + Y_BIAS) >> 14);
+        cb[i] = static_cast<uint8_t>((CB_R * r + CB_G * g + CB_B * b + C_BIAS) >> 14);
+        cr[i] = static_cast<uint8_t>((CR_R * r + CR_G * g + CR_B * b + C_BIAS) >> 14);
+    }
+}
+
+void downsample2x1Scalar(const uint8_t* in, int out_count, uint8_t* out) {
+    for (int x = 0; x < out_count; x++) {
+        out[x] = static_cast<uint8_t>((in[2 * x] + in[2 * x + 1] + 1) >> 1);
+    }
+}
+
+void downsample2x2Scalar(const uint8_t* in0, const uint8_t* in1, int out_count, uint8_t* out) {
+    for (int x = 0; x < out_count; x++) {
+        out[x] = static_cast<uint8_t>(
+            (in0[2 * x] + in0[2 * x + 1] + in1[2 * x] + in1[2 * x + 1] + 2) >> 2);
+    }
+}
+
+void loadBlockScalar(const uint8_t* plane, int stride, float* block) {
+    for (int r = 0; r < 8; r++) {
+        const uint8_t* line = plane + r * stride;
+        for (int c = 0; c < 8; c++) {
+            block[r * 8 + c] = static_cast<float>(line[c]) - 128.0f;
+        }
+    }
+}
+
+uint64_t hashBlockScalar(const unsigned char* data, int stride, int row_bytes, int rows) {
+    uint32_t lanes[HASH_LANES];
+    hashInit(lanes);
+    for (int r = 0; r < rows; r++) {
+        hashWords(lanes, data + static_cast<size_t>(r) * stride, 0, row_bytes / 4);
+    }
+    return hashFold(lanes, row_bytes, rows);
+}
+
+void downsampleBgraScalar(const unsigned char* in0, const unsigned char* in1,
+                          int out_count, unsigned char* out) {
+    for (int i = 0; i < out_count * 4; i++) {
+        const int c = (i / 4) * 8 + i % 4;   // Canal i % 4 del primer pixel del par
+        out[i] = static_cast<unsigned char>((in0[c] + in0[c + 4] + in1[c] + in1[c + 4] + 2) >> 2);
+    }
+}
+
+const KernelTable SCALAR_TABLE = {
+    "scalar",
+    bgraToYccRowScalar,
+    downsample2x1Scalar,
+    downsample2x2Scalar,
+    loadBlockScalar,
+    hashBlockScalar,
+    downsampleBgraScalar
+};
+
+#ifdef PIXEL_KERNELS_X86
+
+// ==================== SSE2 ====================
+
+// 4 pixeles: pmaddwd sobre pares (B,G) y (R,A), luego suma de los pares
+inline __m128i ycc4Sse2(__m128i lo16, __m128i hi16, __m128i coef, __m128i bias) {
+    __m128 a = _mm_castsi128_ps(_mm_madd_epi16(lo16, coef));
+    __m128 b = _mm_castsi128_ps(_mm_madd_epi16(hi16, coef));
+    __m128i even = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+    __m128i odd = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    return _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(even, odd), bias), 14);
+}
+
+// 16 pixeles -> 16 bytes de un canal
+inline __m128i ycc16Sse2(const __m128i lo[4], const __m128i hi[4], __m128i coef, __m128i bias) {
+    __m128i p0 = ycc4Sse2(lo[0], hi[0], coef, bias);
+    __m128i p1 = ycc4Sse2(lo[1], hi[1], coef, bias);
+    __m128i p2 = ycc4Sse2(lo[2], hi[2], coef, bias);
+    __m128i p3 = ycc4Sse2(lo[3], hi[3], coef, bias);
+    return _mm_packus_epi16(_mm_packs_epi32(p0, p1), _mm_packs_epi32(p2, p3));
+}
+
+void bgraToYccRowSse2(const unsigned char* bgra, int count,
+                      uint8_t* y, uint8_t* cb, uint8_t* cr) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i coef_y = _mm_setr_epi16(Y_B, Y_G, Y_R, 0, Y_B, Y_G, Y_R, 0);
+    const __m128i coef_cb = _mm_setr_epi16(CB_B, CB_G, CB_R, 0, CB_B, CB_G, CB_R, 0);
+    const __m128i coef_cr = _mm_setr_epi16(CR_B, CR_G, CR_R, 0, CR_B, CR_G, CR_R, 0);
+    const __m128i bias_y = _mm_set1_epi32(Y_BIAS);
+    const __m128i bias_c = _mm_set1_epi32(C_BIAS);
+
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i lo[4];
+        __m128i hi[4];
+        for (int k = 0; k < 4; k++) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bgra + (i + k * 4) * 4));
+            lo[k] = _mm_unpacklo_epi8(v, zero);
+            hi[k] = _mm_unpackhi_epi8(v, zero);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(y + i), ycc16Sse2(lo, hi, coef_y, bias_y));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(cb + i), ycc16Sse2(lo, hi, coef_cb, bias_c));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(cr + i), ycc16Sse2(lo, hi, coef_cr, bias_c));
+    }
+
+    bgraToYccRowScalar(bgra + i * 4, count - i, y + i, cb + i, cr + i);
+}
+
+void downsample2x1Sse2(const uint8_t* in, int out_count, uint8_t* out) {
+    const __m128i mask = _mm_set1_epi16(0x00FF);
+
+    int x = 0;
+    for (; x + 16 <= out_count; x += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2 * x));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2 * x + 16));
+        __m128i ra = _mm_avg_epu16(_mm_and_si128(a, mask), _mm_srli_epi16(a, 8));
+        __m128i rb = _mm_avg_epu16(_mm_and_si128(b, mask), _mm_srli_epi16(b, 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), _mm_packus_epi16(ra, rb));
+    }
+
+    downsample2x1Scalar(in + 2 * x, out_count - x, out + x);
+}
+
+inline __m128i sum2x2Sse2(__m128i a, __m128i b, __m128i mask, __m128i two) {
+    __m128i sum = _mm_add_epi16(_mm_and_si128(a, mask), _mm_srli_epi16(a, 8));
+    sum = _mm_add_epi16(sum, _mm_and_si128(b, mask));
+    sum = _mm_add_epi16(sum, _mm_srli_epi16(b, 8));
+    return _mm_srli_epi16(_mm_add_epi16(sum, two), 2);
+}
+
+void downsample2x2Sse2(const uint8_t* in0, const uint8_t* in1, int out_count, uint8_t* out) {
+    const __m128i mask = _mm_set1_epi16(0x00FF);
+    const __m128i two = _mm_set1_epi16(2);
+
+    int x = 0;
+    for (; x + 16 <= out_count; x += 16) {
+        __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in0 + 2 * x));
+        __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in0 + 2 * x + 16));
+        __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in1 + 2 * x));
+        __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in1 + 2 * x + 16));
+        __m128i r0 = sum2x2Sse2(a0, b0, mask, two);
+        __m128i r1 = sum2x2Sse2(a1, b1, mask, two);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), _mm_packus_epi16(r0, r1));
+    }
+
+    downsample2x2Scalar(in0 + 2 * x, in1 + 2 * x, out_count - x, out + x);
+}
+
+void loadBlockSse2(const uint8_t* plane, int stride, float* block) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i offset = _mm_set1_epi32(128);
+
+    for (int r = 0; r < 8; r++) {
+        __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(plane + r * stride));
+        __m128i w = _mm_unpacklo_epi8(v, zero);
+        __m128i lo = _mm_sub_epi32(_mm_unpacklo_epi16(w, zero), offset);
+        __m128i hi = _mm_sub_epi32(_mm_unpackhi_epi16(w, zero), offset);
+        _mm_storeu_ps(block + r * 8, _mm_cvtepi32_ps(lo));
+        _mm_storeu_ps(block + r * 8 + 4, _mm_cvtepi32_ps(hi));
+    }
+}
+
+// SSE2 no tiene multiplicación de 32 bits por carril: dos pmuludq
+inline __m128i mullo32Sse2(__m128i a, __m128i b) {
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+inline __m128i hashRoundSse2(__m128i acc, __m128i words, __m128i p1, __m128i p2) {
+    acc = _mm_add_epi32(acc, mullo32Sse2(words, p2));
+    acc = _mm_or_si128(_mm_slli_epi32(acc, 13), _mm_srli_epi32(acc, 19));
+    return mullo32Sse2(acc, p1);
+}
+
+uint64_t hashBlockSse2(const unsigned char* data, int stride, int row_bytes, int rows) {
+    const int VECTORS = HASH_LANES / 4;
+    const __m128i p1 = _mm_set1_epi32(static_cast<int>(HASH_P1));
+    const __m128i p2 = _mm_set1_epi32(static_cast<int>(HASH_P2));
+    const int words = row_bytes / 4;
+    const int body = words - words % HASH_LANES;
+
+    alignas(16) uint32_t lanes[HASH_LANES];
+    hashInit(lanes);
+    __m128i acc[VECTORS];
+    for (int v = 0; v < VECTORS; v++) {
+        acc[v] = _mm_load_si128(reinterpret_cast<const __m128i*>(lanes + v * 4));
+    }
+
+    for (int r = 0; r < rows; r++) {
+        const unsigned char* line = data + static_cast<size_t>(r) * stride;
+        for (int i = 0; i < body; i += HASH_LANES) {
+            for (int v = 0; v < VECTORS; v++) {
+                acc[v] = hashRoundSse2(acc[v], _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(line + i * 4 + v * 16)), p1, p2);
+            }
+        }
+        if (body < words) {
+            for (int v = 0; v < VECTORS; v++) {
+                _mm_store_si128(reinterpret_cast<__m128i*>(lanes + v * 4), acc[v]);
+            }
+            hashWords(lanes, line, body, words);
+            for (int v = 0; v < VECTORS; v++) {
+                acc[v] = _mm_load_si128(reinterpret_cast<const __m128i*>(lanes + v * 4));
+            }
+        }
+    }
+
+    for (int v = 0; v < VECTORS; v++) {
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes + v * 4), acc[v]);
+    }
+    return hashFold(lanes, row_bytes, rows);
+}
+
+// 2 pixeles de cada fila (16 bits por canal) -> suma de los 4 por canal
+inline __m128i sumBgraPairsSse2(__m128i a, __m128i b) {
+    __m128i sum = _mm_add_epi16(a, b);
+    return _mm_add_epi16(sum, _mm_srli_si128(sum, 8));
+}
+
+void downsampleBgraSse2(const unsigned char* in0, const unsigned char* in1,
+                        int out_count, unsigned char* out) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i two = _mm_set1_epi16(2);
+
+    int x = 0;
+    for (; x + 4 <= out_count; x += 4) {
+        __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in0 + x * 8));
+        __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in0 + x * 8 + 16));
+        __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in1 + x * 8));
+        __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in1 + x * 8 + 16));
+        // Cada suma deja un pixel de salida en los 64 bits bajos
+        __m128i p0 = sumBgraPairsSse2(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero));
+        __m128i p1 = sumBgraPairsSse2(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero));
+        __m128i p2 = sumBgraPairsSse2(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero));
+        __m128i p3 = sumBgraPairsSse2(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero));
+        __m128i lo = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(p0, p1), two), 2);
+        __m128i hi = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(p2, p3), two), 2);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 4), _mm_packus_epi16(lo, hi));
+    }
+
+    downsampleBgraScalar(in0 + x * 8, in1 + x * 8, out_count - x, out + x * 4);
+}
+
+const KernelTable SSE2_TABLE = {
+    "sse2",
+    bgraToYccRowSse2,
+    downsample2x1Sse2,
+    downsample2x2Sse2,
+    loadBlockSse2,
+    hashBlockSse2,
+    downsampleBgraSse2
+};
+
+// ==================== AVX2 ====================
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+// 8 pixeles (uno de 32 bytes) -> 8 int32 en orden
+AVX2_TARGET inline __m256i ycc8Avx2(__m256i v, __m256i coef, __m256i bias) {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256 a = _mm256_castsi256_ps(_mm256_madd_epi16(_mm256_unpacklo_epi8(v, zero), coef));
+    __m256 b = _mm256_castsi256_ps(_mm256_madd_epi16(_mm256_unpackhi_epi8(v, zero), coef));
+    __m256i even = _mm256_castps_si256(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+    __m256i odd = _mm256_castps_si256(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    return _mm256_srai_epi32(_mm256_add_epi32(_mm256_add_epi32(even, odd), bias), 14);
+}
+
+// 16 pixeles -> 16 bytes de un canal
+AVX2_TARGET inline __m128i ycc16Avx2(__m256i v0, __m256i v1, __m256i coef, __m256i bias) {
+    __m256i packed = _mm256_packs_epi32(ycc8Avx2(v0, coef, bias), ycc8Avx2(v1, coef, bias));
+    packed = _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0));
+    return _mm_packus_epi16(_mm256_castsi256_si128(packed), _mm256_extracti128_si256(packed, 1));
+}
+
+AVX2_TARGET void bgraToYccRowAvx2(const unsigned char* bgra, int count,
+                                  uint8_t* y, uint8_t* cb, uint8_t* cr) {
+    const __m256i coef_y = _mm256_setr_epi16(Y_B, Y_G, Y_R, 0, Y_B, Y_G, Y_R, 0,
+                                             Y_B, Y_G, Y_R, 0, Y_B, Y_G, Y_R, 0);
+    const __m256i coef_cb = _mm256_setr_epi16(CB_B, CB_G, CB_R, 0, CB_B, CB_G, CB_R, 0,
+                                              CB_B, CB_G, CB_R, 0, CB_B, CB_G, CB_R, 0);
+    const __m256i coef_cr = _mm256_setr_epi16(CR_B, CR_G, CR_R, 0, CR_B, CR_G, CR_R, 0,
+                                              CR_B, CR_G, CR_R, 0, CR_B, CR_G, CR_R, 0);
+    const __m256i bias_y = _mm256_set1_epi32(Y_BIAS);
+    const __m256i bias_c = _mm256_set1_epi32(C_BIAS);
+
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bgra + i * 4));
+        __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bgra + i * 4 + 32));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(y + i), ycc16Avx2(v0, v1, coef_y, bias_y));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(cb + i), ycc16Avx2(v0, v1, coef_cb, bias_c));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(cr + i), ycc16Avx2(v0, v1, coef_cr, bias_c));
+    }
+
+    bgraToYccRowScalar(bgra + i * 4, count - i, y + i, cb + i, cr + i);
+}
+
+AVX2_TARGET void downsample2x1Avx2(const uint8_t* in, int out_count, uint8_t* out) {
+    const __m256i mask = _mm256_set1_epi16(0x00FF);
+
+    int x = 0;
+    for (; x + 32 <= out_count; x += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 2 * x));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 2 * x + 32));
+        __m256i ra = _mm256_avg_epu16(_mm256_and_si256(a, mask), _mm256_srli_epi16(a, 8));
+        __m256i rb = _mm256_avg_epu16(_mm256_and_si256(b, mask), _mm256_srli_epi16(b, 8));
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(ra, rb), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x), packed);
+    }
+
+    downsample2x1Scalar(in + 2 * x, out_count - x, out + x);
+}
+
+AVX2_TARGET inline __m256i sum2x2Avx2(__m256i a, __m256i b, __m256i mask, __m256i two) {
+    __m256i sum = _mm256_add_epi16(_mm256_and_si256(a, mask), _mm256_srli_epi16(a, 8));
+    sum = _mm256_add_epi16(sum, _mm256_and_si256(b, mask));
+    sum = _mm256_add_epi16(sum, _mm256_srli_epi16(b, 8));
+    return _mm256_srli_epi16(_mm256_add_epi16(sum, two), 2);
+}
+
+AVX2_TARGET void downsample2x2Avx2(const uint8_t* in0, const uint8_t* in1, int out_count, uint8_t* out) {
+    const __m256i mask = _mm256_set1_epi16(0x00FF);
+    const __m256i two = _mm256_set1_epi16(2);
+
+    int x = 0;
+    for (; x + 32 <= out_count; x += 32) {
+        __m256i a0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in0 + 2 * x));
+        __m256i a1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in0 + 2 * x + 32));
+        __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in1 + 2 * x));
+        __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in1 + 2 * x + 32));
+        __m256i r0 = sum2x2Avx2(a0, b0, mask, two);
+        __m256i r1 = sum2x2Avx2(a1, b1, mask, two);
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(r0, r1), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x), packed);
+    }
+
+    downsample2x2Scalar(in0 + 2 * x, in1 + 2 * x, out_count - x, out + x);
+}
+
+AVX2_TARGET void loadBlockAvx2(const uint8_t* plane, int stride, float* block) {
+    const __m256i offset = _mm256_set1_epi32(128);
+
+    for (int r = 0; r < 8; r++) {
+        __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(plane + r * stride));
+        __m256i w = _mm256_sub_epi32(_mm256_cvtepu8_epi32(v), offset);
+        _mm256_storeu_ps(block + r * 8, _mm256_cvtepi32_ps(w));
+    }
+}
+
+AVX2_TARGET inline __m256i hashRoundAvx2(__m256i acc, __m256i words, __m256i p1, __m256i p2) {
+    acc = _mm256_add_epi32(acc, _mm256_mullo_epi32(words, p2));
+    acc = _mm256_or_si256(_mm256_slli_epi32(acc, 13), _mm256_srli_epi32(acc, 19));
+    return _mm256_mullo_epi32(acc, p1);
+}
+
+AVX2_TARGET uint64_t hashBlockAvx2(const unsigned char* data, int stride, int row_bytes, int rows) {
+    const int VECTORS = HASH_LANES / 8;
+    const __m256i p1 = _mm256_set1_epi32(static_cast<int>(HASH_P1));
+    const __m256i p2 = _mm256_set1_epi32(static_cast<int>(HASH_P2));
+    const int words = row_bytes / 4;
+    const int body = words - words % HASH_LANES;
+
+    alignas(32) uint32_t lanes[HASH_LANES];
+    hashInit(lanes);
+    __m256i acc[VECTORS];
+    for (int v = 0; v < VECTORS; v++) {
+        acc[v] = _mm256_load_si256(reinterpret_cast<const __m256i*>(lanes + v * 8));
+    }
+
+    for (int r = 0; r < rows; r++) {
+        const unsigned char* line = data + static_cast<size_t>(r) * stride;
+        for (int i = 0; i < body; i += HASH_LANES) {
+            for (int v = 0; v < VECTORS; v++) {
+                acc[v] = hashRoundAvx2(acc[v], _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i*>(line + i * 4 + v * 32)), p1, p2);
+            }
+        }
+        if (body < words) {
+            for (int v = 0; v < VECTORS; v++) {
+                _mm256_store_si256(reinterpret_cast<__m256i*>(lanes + v * 8), acc[v]);
+            }
+            hashWords(lanes, line, body, words);
+            for (int v = 0; v < VECTORS; v++) {
+                acc[v] = _mm256_load_si256(reinterpret_cast<const __m256i*>(lanes + v * 8));
+            }
+        }
+    }
+
+    for (int v = 0; v < VECTORS; v++) {
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes + v * 8), acc[v]);
+    }
+    return hashFold(lanes, row_bytes, rows);
+}
+
+const KernelTable AVX2_TABLE = {
+    "avx2",
+    bgraToYccRowAvx2,
+    downsample2x1Avx2,
+    downsample2x2Avx2,
+    loadBlockAvx2,
+    hashBlockAvx2,
+    downsampleBgraSse2   // Limitado por memoria: AVX2 no mejora la versión SSE2
+};
+
+#endif // PIXEL_KERNELS_X86
+
+const KernelTable& selectKernels() {
+    if (const KernelTable* table = avx2()) {
+        return *table;
+    }
+    if (const KernelTable* table = sse2()) {
+        return *table;
+    }
+    return SCALAR_TABLE;
+}
+
+} // namespace
+
+const KernelTable& active() {
+    // Inicialización estática thread-safe: la CPU se consulta una vez
+    static const KernelTable& table = selectKernels();
+    return table;
+}
+
+const KernelTable& scalar() {
+    return SCALAR_TABLE;
+}
+
+const KernelTable* sse2() {
+#ifdef PIXEL_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) {
+        return &SSE2_TABLE;
+    }
+#endif
+    return nullptr;
+}
+
+const KernelTable* avx2() {
+#ifdef PIXEL_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return &AVX2_TABLE;
+    }
+#endif
+    return nullptr;
+}
+
+} // namespace PixelKernels
+} // namespace Utils
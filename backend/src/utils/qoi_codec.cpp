@@ -0,0 +1,201 @@
+#include "utils/qoi_codec.h"
+#include <cstring>
+
+namespace Utils {
+
+namespace {
+
+// Operaciones del formato (https://qoiformat.org/qoi-specification.pdf)
+const uint8_t QOI_OP_INDEX = 0x00;   // 00xxxxxx
+const uint8_t QOI_OP_DIFF = 0x40;    // 01xxxxxx
+const uint8_t QOI_OP_LUMA = 0x80;    // 10xxxxxx
+const uint8_t QOI_OP_RUN = 0xC0;     // 11xxxxxx
+const uint8_t QOI_OP_RGB = 0xFE;
+const uint8_t QOI_OP_RGBA = 0xFF;
+const uint8_t QOI_MASK_2 = 0xC0;
+
+const size_t QOI_HEADER_SIZE = 14;
+const unsigned char QOI_PADDING[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+
+// Pixel empaquetado como 0xAARRGGBB (el orden de memoria de BGRA en little-endian)
+inline uint32_t hashIndex(uint32_t px) {
+    uint32_t r = (px >> 16) & 0xFF;
+    uint32_t g = (px >> 8) & 0xFF;
+    uint32_t b = px & 0xFF;
+    uint32_t a = px >> 24;
+    return (r * 3 + g * 5 + b * 7 + a * 11) & 63;
+}
+
+inline void putBE32(unsigned char* out, uint32_t value) {
+    out[0] = static_cast<unsigned char>(value >> 24);
+    out[1] = static_cast<unsigned char>(value >> 16);
+    out[2] = static_cast<unsigned char>(value >> 8);
+    out[3] = static_cast<unsigned char>(value);
+}
+
+inline uint32_t getBE32(const unsigned char* in) {
+    return (static_cast<uint32_t>(in[0]) << 24) | (static_cast<uint32_t>(in[1]) << 16) |
+           (static_cast<uint32_t>(in[2]) << 8) | in[3];
+}
+
+} // namespace
+
+size_t QoiEncoder::maxEncodedSize(int width, int height) {
+    // Peor caso con 3 canales: QOI_OP_RGB (4 bytes) en cada pixel
+    return QOI_HEADER_SIZE + static_cast<size_t>(width) * height * 4 + sizeof(QOI_PADDING);
+}
+
+bool QoiEncoder::encode(const unsigned char* bgra, int width, int height, int stride,
+                        std::vector<unsigned char>& out) {
+    if (!bgra || width <= 0 || height <= 0 || stride < width * 4) {
+        return false;
+    }
+
+    // Se escribe con un puntero sobre el tamaño máximo y luego se recorta;
+    // resize() no libera capacidad, así que tras el primer frame no hay reservas
+    out.resize(maxEncodedSize(width, height));
+    unsigned char* p = out.data();
+
+    std::memcpy(p, "qoif", 4);
+    putBE32(p + 4, static_cast<uint32_t>(width));
+    putBE32(p + 8, static_cast<uint32_t>(height));
+    p[12] = 3;    // Canales: RGB
+    p[13] = 0;    // Espacio de color: sRGB
+    p += QOI_HEADER_SIZE;
+
+    uint32_t index[64] = {0};
+    uint32_t prev = 0xFF000000u;   // Negro opaco
+    int run = 0;
+
+    for (int y = 0; y < height; y++) {
+        const unsigned char* row = bgra + static_cast<size_t>(y) * stride;
+
+        for (int x = 0; x < width; x++) {
+            // El alfa de la captura no importa: se fuerza opaco
+            uint32_t px;
+            std::memcpy(&px, row + x * 4, 4);
+            px |= 0xFF000000u;
+
+            if (px == prev) {
+                if (++run == 62) {
+                    *p++ = static_cast<unsigned char>(QOI_OP_RUN | (run - 1));
+                    run = 0;
+                }
+                continue;
+            }
+
+            if (run > 0) {
+                *p++ = static_cast<unsigned char>(QOI_OP_RUN | (run - 1));
+                run = 0;
+            }
+
+            uint32_t slot = hashIndex(px);
+            if (index[slot] == px) {
+                *p++ = static_cast<unsigned char>(QOI_OP_INDEX | slot);
+            } else {
+                index[slot] = px;
+
+                int8_t vr = static_cast<int8_t>(((px >> 16) & 0xFF) - ((prev >> 16) & 0xFF));
+                int8_t vg = static_cast<int8_t>(((px >> 8) & 0xFF) - ((prev >> 8) & 0xFF));
+                int8_t vb = static_cast<int8_t>((px & 0xFF) - (prev & 0xFF));
+                int8_t vg_r = static_cast<int8_t>(vr - vg);
+                int8_t vg_b = static_cast<int8_t>(vb - vg);
+
+                if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2) {
+                    *p++ = static_cast<unsigned char>(QOI_OP_DIFF | (vr + 2) << 4 | (vg + 2) << 2 | (vb + 2));
+                } else if (vg_r > -9 && vg_r < 8 && vg > -33 && vg < 32 && vg_b > -9 && vg_b < 8) {
+                    *p++ = static_cast<unsigned char>(QOI_OP_LUMA | (vg + 32));
+                    *p++ = static_cast<unsigned char>((vg_r + 8) << 4 | (vg_b + 8));
+                } else {
+                    *p++ = QOI_OP_RGB;
+                    *p++ = static_cast<unsigned char>(px >> 16);
+                    *p++ = static_cast<unsigned char>(px >> 8);
+                    *p++ = static_cast<unsigned char>(px);
+                }
+            }
+            prev = px;
+        }
+    }
+
+    if (run > 0) {
+        *p++ = static_cast<unsigned char>(QOI_OP_RUN | (run - 1));
+    }
+
+    std::memcpy(p, QOI_PADDING, sizeof(QOI_PADDING));
+    p += sizeof(QOI_PADDING);
+
+    out.resize(static_cast<size_t>(p - out.data()));
+    return true;
+}
+
+bool qoiDecode(const unsigned char* data, size_t size, std::vector<unsigned char>& bgra,
+               int& width, int& height) {
+    if (!data || size < QOI_HEADER_SIZE + sizeof(QOI_PADDING) || std::memcmp(data, "qoif", 4) != 0) {
+        return false;
+    }
+
+    uint32_t w = getBE32(data + 4);
+    uint32_t h = getBE32(data + 8);
+    uint8_t channels = data[12];
+    if (w == 0 || h == 0 || w > 65535 || h > 65535 || (channels != 3 && channels != 4)) {
+        return false;
+    }
+
+    width = static_cast<int>(w);
+    height = static_cast<int>(h);
+    bgra.resize(static_cast<size_t>(w) * h * 4);
+
+    const size_t end = size - sizeof(QOI_PADDING);
+    size_t pos = QOI_HEADER_SIZE;
+    uint8_t index[64][4] = {{0}};
+    uint8_t r = 0, g = 0, b = 0, a = 255;
+    int run = 0;
+
+    for (size_t i = 0; i < bgra.size(); i += 4) {
+        if (run > 0) {
+            run--;
+        } else {
+            if (pos >= end) {
+                return false;
+            }
+            uint8_t op = data[pos++];
+
+            if (op == QOI_OP_RGB) {
+                if (pos + 3 > end) return false;
+                r = data[pos]; g = data[pos + 1]; b = data[pos + 2];
+                pos += 3;
+            } else if (op == QOI_OP_RGBA) {
+                if (pos + 4 > end) return false;
+                r = data[pos]; g = data[pos + 1]; b = data[pos + 2]; a = data[pos + 3];
+                pos += 4;
+            } else if ((op & QOI_MASK_2) == QOI_OP_INDEX) {
+                r = index[op][0]; g = index[op][1]; b = index[op][2]; a = index[op][3];
+            } else if ((op & QOI_MASK_2) == QOI_OP_DIFF) {
+                r = static_cast<uint8_t>(r + ((op >> 4) & 0x03) - 2);
+                g = static_cast<uint8_t>(g + ((op >> 2) & 0x03) - 2);
+                b = static_cast<uint8_t>(b + (op & 0x03) - 2);
+            } else if ((op & QOI_MASK_2) == QOI_OP_LUMA) {
+                if (pos >= end) return false;
+                uint8_t second = data[pos++];
+                int vg = (op & 0x3F) - 32;
+                r = static_cast<uint8_t>(r + vg - 8 + ((second >> 4) & 0x0F));
+                g = static_cast<uint8_t>(g + vg);
+                b = static_cast<uint8_t>(b + vg - 8 + (second & 0x0F));
+            } else {
+                run = op & 0x3F;
+            }
+
+            uint8_t* entry = index[(r * 3 + g * 5 + b * 7 + a * 11) & 63];
+            entry[0] = r; entry[1] = g; entry[2] = b; entry[3] = a;
+        }
+
+        bgra[i] = b;
+        bgra[i + 1] = g;
+        bgra[i + 2] = r;
+        bgra[i + 3] = a;
+    }
+
+    return true;
+}
+
+} // namespace Utils
@@ -0,0 +1,90 @@
+#include "utils/thread_pool.h"
+#include <algorithm>
+
+namespace Utils {
+
+ThreadPool::ThreadPool(int threads)
+    : fn_(nullptr), context_(nullptr), count_(0), next_task_(0),
+      job_(0), active_(0), stopping_(false) {
+    if (threads <= 0) {
+        threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+
+    // El thread que llama a parallelFor es el worker 0
+    workers_.reserve(threads - 1);
+    for (int i = 1; i < threads; i++) {
+        workers_.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    start_cv_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::runTasks(int worker) {
+    int task;
+    while ((task = next_task_.fetch_add(1)) < count_) {
+        fn_(context_, task, worker);
+    }
+}
+
+void ThreadPool::run(int count, TaskFn fn, void* context) {
+    if (count <= 0) {
+        return;
+    }
+
+    // Sin workers o con una sola tarea no vale la pena despertar a nadie
+    if (workers_.empty() || count == 1) {
+        for (int task = 0; task < count; task++) {
+            fn(context, task, 0);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        fn_ = fn;
+        context_ = context;
+        count_ = count;
+        next_task_ = 0;
+        active_ = static_cast<int>(workers_.size());
+        job_++;
+    }
+    start_cv_.notify_all();
+
+    runTasks(0);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this] { return active_ == 0; });
+}
+
+void ThreadPool::workerLoop(int worker) {
+    unsigned long seen = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            start_cv_.wait(lock, [this, seen] { return stopping_ || job_ != seen; });
+            if (stopping_) {
+                return;
+            }
+            seen = job_;
+        }
+
+        runTasks(worker);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--active_ == 0) {
+            done_cv_.notify_one();
+        }
+    }
+}
+
+} // namespace Utils
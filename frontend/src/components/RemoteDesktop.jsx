@@ -1,51 +1,216 @@
 import { useRef, useEffect, useState } from 'react';
 import { useAuth } from '../hooks/useAuth';
 import apiService from '../services/apiService';
+import websocketService, {
+  INPUT_BUTTON_DOWN, INPUT_BUTTON_UP, INPUT_KEY_DOWN, INPUT_KEY_UP, INPUT_WHEEL,
+} from '../services/websocketService';
+import { linuxKeycode } from '../services/keycodes';
+
+// Convierte el Base64 del formato legado a Blob para decodificarlo igual que los binarios
+const base64ToBlob = (base64) => {
+  const bytes = Uint8Array.from(atob(base64), (c) => c.charCodeAt(0));
+  return new Blob([bytes], { type: 'image/jpeg' });
+};
+
+// Resolución del escritorio remoto
+const SCREEN_WIDTH = 1280;
+const SCREEN_HEIGHT = 800;
+
+// Zoom con Ctrl + rueda: factor por paso y máximo
+const ZOOM_STEP = 1.25;
+const ZOOM_MAX = 8;
+
+// MouseEvent.button -> código de botón del servidor (1 izquierdo, 2 derecho, 3 medio)
+const BUTTON_CODES = { 0: 1, 1: 3, 2: 2 };
 
 const RemoteDesktop = ({ screenshot }) => {
   const canvasRef = useRef(null);
   const { token, canControl } = useAuth();
   const [canvasSize, setCanvasSize] = useState({ width: 1280, height: 800 });
 
-  // Dibujamos la imagen recibida en el canvas
+  // Cola de dibujo: los frames se decodifican en paralelo pero se pintan en orden,
+  // así un tile nunca queda debajo de un keyframe más viejo
+  const drawQueueRef = useRef(Promise.resolve());
+
+  // Región de la pantalla que muestra el canvas (toda la pantalla sin zoom).
+  // Con zoom el servidor envía solo esa región con todo su detalle
+  const viewRef = useRef({ x: 0, y: 0, w: SCREEN_WIDTH, h: SCREEN_HEIGHT });
+  const zoomRef = useRef(1);
+
+  // Escuchamos los frames directamente del servicio (sin pasar por el estado de React)
+  // para no perder ninguna actualización parcial
+  useEffect(() => {
+    const handleFrame = (frame) => {
+      const canvas = canvasRef.current;
+      if (!canvas) return;
+
+      const ctx = canvas.getContext('2d');
+      const frameWidth = frame.width || canvas.width;
+      const frameHeight = frame.height || canvas.height;
+
+      // Keyframe/legado: una sola región que cubre toda la pantalla
+      const regions = frame.tiles || [{
+        x: 0,
+        y: 0,
+        w: frameWidth,
+        h: frameHeight,
+        imageData: frame.imageData,
+        blob: frame.imageData ? null : (frame.blob || base64ToBlob(frame.data)),
+      }];
+
+      // QOI llega ya decodificado (ImageData); JPEG como Blob
+      const decoded = Promise.all(regions.map(
+        (region) => createImageBitmap(region.imageData || region.blob)));
+
+      drawQueueRef.current = drawQueueRef.current
+        .then(() => decoded)
+        .then((bitmaps) => {
+          const scaleX = canvas.width / frameWidth;
+          const scaleY = canvas.height / frameHeight;
+
+          // Scroll: el contenido que solo se movió se copia dentro del canvas
+          (frame.moves || []).forEach((move) => {
+            ctx.drawImage(canvas,
+                          move.srcX * scaleX, move.srcY * scaleY, move.w * scaleX, move.h * scaleY,
+                          move.dstX * scaleX, move.dstY * scaleY, move.w * scaleX, move.h * scaleY);
+          });
+
+          bitmaps.forEach((bitmap, i) => {
+            const region = regions[i];
+            ctx.drawImage(bitmap, region.x * scaleX, region.y * scaleY,
+                          region.w * scaleX, region.h * scaleY);
+            bitmap.close();
+          });
+        })
+        .catch((error) => {
+          console.error('Error al decodificar frame:', error);
+        });
+    };
+
+    // Con zoom solo se dibujan viewports; sin zoom, solo la pantalla completa
+    const handleScreen = (frame) => {
+      if (zoomRef.current === 1) handleFrame(frame);
+    };
+
+    const handleViewport = (frame) => {
+      const view = viewRef.current;
+      // Un viewport viejo (llegó después de cambiar el zoom) se descarta
+      if (zoomRef.current === 1 || frame.x !== view.x || frame.y !== view.y ||
+          frame.w !== view.w || frame.h !== view.h) {
+        return;
+      }
+      // La imagen cubre todo el canvas: se dibuja como un keyframe del tamaño codificado
+      handleFrame({ ...frame, tiles: null, moves: null });
+    };
+
+    websocketService.on('screenshot', handleScreen);
+    websocketService.on('tiles', handleScreen);
+    websocketService.on('viewport', handleViewport);
+
+    return () => {
+      websocketService.off('screenshot', handleScreen);
+      websocketService.off('tiles', handleScreen);
+      websocketService.off('viewport', handleViewport);
+      websocketService.clearViewport();
+    };
+  }, []);
+
+  // Con permiso de control, la entrada va por el WebSocket en lugar de HTTP
   useEffect(() => {
-    if (!screenshot || !canvasRef.current) return;
+    websocketService.authenticate(canControl() ? token : null);
+  }, [token]);
 
+  // Ctrl + rueda: zoom centrado en el cursor. Se registra a mano porque
+  // React agrega 'wheel' como pasivo y no se podría evitar el scroll de la página
+  useEffect(() => {
     const canvas = canvasRef.current;
-    const ctx = canvas.getContext('2d');
-    const img = new Image();
-
-    img.onload = () => {
-      // Limpiar canvas
-      ctx.clearRect(0, 0, canvas.width, canvas.height);
-      
-      // Dibujar imagen
-      ctx.drawImage(img, 0, 0, canvas.width, canvas.height);
+    if (!canvas) return undefined;
+
+    const handleWheel = (event) => {
+      if (!event.ctrlKey) {
+        // Rueda sin Ctrl: scroll en el escritorio remoto (un paso por evento)
+        if (!websocketService.canSendInput()) return;
+        event.preventDefault();
+        const x = Math.sign(event.deltaX);
+        const y = -Math.sign(event.deltaY);
+        if (x !== 0 || y !== 0) websocketService.sendInput(INPUT_WHEEL, 0, x, y);
+        return;
+      }
+      event.preventDefault();
+
+      const rect = canvas.getBoundingClientRect();
+      const old = viewRef.current;
+      const next = event.deltaY < 0 ? zoomRef.current * ZOOM_STEP : zoomRef.current / ZOOM_STEP;
+      // Redondeo para volver exactamente a 1 tras acercar y alejar
+      const zoom = next < 1.01 ? 1 : Math.min(ZOOM_MAX, next);
+      if (zoom === zoomRef.current) return;
+
+      // El punto bajo el cursor queda fijo
+      const fx = (event.clientX - rect.left) / rect.width;
+      const fy = (event.clientY - rect.top) / rect.height;
+      const w = Math.round(SCREEN_WIDTH / zoom);
+      const h = Math.round(SCREEN_HEIGHT / zoom);
+      const x = Math.round(Math.min(SCREEN_WIDTH - w, Math.max(0, old.x + fx * old.w - fx * w)));
+      const y = Math.round(Math.min(SCREEN_HEIGHT - h, Math.max(0, old.y + fy * old.h - fy * h)));
+      const view = { x, y, w, h };
+
+      // Mientras llega la región nueva se amplía lo que ya está en el canvas
+      const ctx = canvas.getContext('2d');
+      const sx = canvas.width / old.w;
+      const sy = canvas.height / old.h;
+      drawQueueRef.current = drawQueueRef.current.then(() => {
+        ctx.drawImage(canvas, (x - old.x) * sx, (y - old.y) * sy, w * sx, h * sy,
+                      0, 0, canvas.width, canvas.height);
+      });
+
+      zoomRef.current = zoom;
+      viewRef.current = view;
+      if (zoom === 1) {
+        websocketService.clearViewport();
+      } else {
+        websocketService.setViewport(view, canvas.width, canvas.height);
+      }
+    };
+
+    canvas.addEventListener('wheel', handleWheel, { passive: false });
+    return () => canvas.removeEventListener('wheel', handleWheel);
+  }, []);
+
+  // Coordenadas reales del escritorio remoto para un evento del canvas (a través del zoom)
+  const toScreen = (event) => {
+    const rect = canvasRef.current.getBoundingClientRect();
+    const view = viewRef.current;
+    return {
+      x: Math.floor(view.x + ((event.clientX - rect.left) / rect.width) * view.w),
+      y: Math.floor(view.y + ((event.clientY - rect.top) / rect.height) * view.h),
     };
+  };
+
+  // Presionar y soltar por separado (permite arrastrar); solo por WebSocket
+  const handleMouseButton = (event, type) => {
+    const code = BUTTON_CODES[event.button];
+    if (!code || !websocketService.canSendInput()) return;
+    const { x, y } = toScreen(event);
+    websocketService.sendInput(type, code, x, y);
+  };
 
-    // El backend envía "data:image/jpeg;base64,..." directamente o solo el base64?
-    // Según tu código, envía solo el base64, así que agregamos el prefijo
-    img.src = `data:image/jpeg;base64,${screenshot.image}`;
-  }, [screenshot]);
+  // Movimiento (hover y arrastre): el servicio lo limita a un envío por frame
+  const handleMouseMove = (event) => {
+    if (!websocketService.canSendInput()) return;
+    const { x, y } = toScreen(event);
+    websocketService.sendPointer(x, y);
+  };
 
-  // Handler para clicks en el canvas
+  // Handler para clicks en el canvas (HTTP, si la entrada no va por el socket)
   const handleCanvasClick = async (event) => {
     if (!canControl()) {
       console.log('No tienes permisos de control');
       return;
     }
+    if (websocketService.canSendInput()) return;
+
+    const { x: realX, y: realY } = toScreen(event);
 
-    const canvas = canvasRef.current;
-    const rect = canvas.getBoundingClientRect();
-    
-    // Calcular coordenadas relativas al canvas
-    const canvasX = event.clientX - rect.left;
-    const canvasY = event.clientY - rect.top;
-    
-    // Escalar a las coordenadas reales del escritorio remoto (1280x800)
-    const realX = Math.floor((canvasX / rect.width) * 1280);
-    const realY = Math.floor((canvasY / rect.height) * 800);
-    
     // Determinar qué botón se presionó (1=izquierdo, 2=derecho)
     const button = event.button === 0 ? 1 : 2;
 
@@ -66,9 +231,27 @@ const RemoteDesktop = ({ screenshot }) => {
       return;
     }
 
+    // Ctrl+V pega el portapapeles local: se sueltan las modificadoras remotas
+    // y se deja que el navegador dispare 'paste'
+    if ((event.ctrlKey || event.metaKey) && event.code === 'KeyV') {
+      if (websocketService.canSendInput()) {
+        ['ControlLeft', 'ControlRight', 'MetaLeft', 'MetaRight'].forEach((code) => {
+          websocketService.sendInput(INPUT_KEY_UP, linuxKeycode(code));
+        });
+      }
+      return;
+    }
+
     // Prevenir comportamiento por defecto del navegador
     event.preventDefault();
 
+    // Por el socket se envía la tecla física; el servidor aplica las modificadoras
+    const keycode = linuxKeycode(event.code);
+    if (keycode !== null && websocketService.canSendInput()) {
+      if (!event.repeat) websocketService.sendInput(INPUT_KEY_DOWN, keycode);
+      return;
+    }
+
     let key = event.key;
 
     // Mapeo de teclas especiales al formato que el backend espera
@@ -93,6 +276,28 @@ const RemoteDesktop = ({ screenshot }) => {
     }
   };
 
+  // Pegar: el texto va entero al servidor, que lo escribe en un solo lote
+  const handlePaste = async (event) => {
+    if (!canControl()) return;
+    const text = event.clipboardData.getData('text');
+    if (!text) return;
+    event.preventDefault();
+
+    if (websocketService.typeText(text)) return;
+    try {
+      await apiService.typeText(text, token);
+    } catch (error) {
+      console.error('Error al escribir texto:', error);
+    }
+  };
+
+  const handleKeyUp = (event) => {
+    const keycode = linuxKeycode(event.code);
+    if (keycode === null || !websocketService.canSendInput()) return;
+    event.preventDefault();
+    websocketService.sendInput(INPUT_KEY_UP, keycode);
+  };
+
   return (
     <div style={{ 
       display: 'flex', 
@@ -100,7 +305,7 @@ const RemoteDesktop = ({ screenshot }) => {
       alignItems: 'center',
       padding: '20px'
     }}>
-      {!screenshot ? (
+      {!screenshot && (
         <div style={{ 
           width: canvasSize.width, 
           height: canvasSize.height,
@@ -111,25 +316,32 @@ const RemoteDesktop = ({ screenshot }) => {
         }}>
           <p>Esperando conexión...</p>
         </div>
-      ) : (
-        <canvas
-          ref={canvasRef}
-          width={canvasSize.width}
-          height={canvasSize.height}
-          onClick={handleCanvasClick}
-          onContextMenu={(e) => {
-            e.preventDefault();
-            handleCanvasClick(e);
-          }}
-          onKeyDown={handleKeyDown}
-          tabIndex="0" // Necesario para que el canvas pueda recibir eventos de teclado
-          style={{
-            border: '2px solid #333',
-            cursor: canControl() ? 'crosshair' : 'default'
-          }}
-        />
       )}
 
+      {/* El canvas siempre está montado para no perder el primer keyframe */}
+      <canvas
+        ref={canvasRef}
+        width={canvasSize.width}
+        height={canvasSize.height}
+        onClick={handleCanvasClick}
+        onMouseMove={handleMouseMove}
+        onMouseDown={(e) => handleMouseButton(e, INPUT_BUTTON_DOWN)}
+        onMouseUp={(e) => handleMouseButton(e, INPUT_BUTTON_UP)}
+        onContextMenu={(e) => {
+          e.preventDefault();
+          handleCanvasClick(e);
+        }}
+        onKeyDown={handleKeyDown}
+        onKeyUp={handleKeyUp}
+        onPaste={handlePaste}
+        tabIndex="0" // Necesario para que el canvas pueda recibir eventos de teclado
+        style={{
+          display: screenshot ? 'block' : 'none',
+          border: '2px solid #333',
+          cursor: canControl() ? 'crosshair' : 'default'
+        }}
+      />
+
       {/* Instrucciones */}
       <div style={{ marginTop: '15px', textAlign: 'center' }}>
         {canControl() ? (
@@ -137,7 +349,7 @@ const RemoteDesktop = ({ screenshot }) => {
         ) : (
           <p>Solo puedes visualizar (sin permisos de control)</p>
         )}
-        <small>Haz click en el canvas y usa tu teclado para interactuar</small>
+        <small>Haz click en el canvas y usa tu teclado para interactuar (Ctrl + rueda para ampliar)</small>
       </div>
     </div>
   );
@@ -44,9 +44,12 @@ export const useWebSocket = () => {
 
     // Cuando llega un screenshot
     const handleScreenshot = (data) => {
-      // data.data contiene el base64 de la imagen
+      // Formato binario: data.blob (JPEG) o data.imageData (QOI);
+      // formato legado: data.data (base64)
       setScreenshot({
         image: data.data,
+        blob: data.blob,
+        imageData: data.imageData,
         timestamp: data.timestamp,
       });
     };
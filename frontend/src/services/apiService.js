@@ -78,6 +78,17 @@ const apiService = {
       body: JSON.stringify({ key }),
     });
   },
+
+  // Escribir texto: el servidor lo encola y responde 202 (layout opcional)
+  typeText: async (text, token, layout) => {
+    return request('/api/keyboard/type', {
+      method: 'POST',
+      headers: {
+        'Authorization': `Bearer ${token}`,
+      },
+      body: JSON.stringify(layout ? { text, layout } : { text }),
+    });
+  },
 };
 
 export default apiService;
\ No newline at end of file
@@ -0,0 +1,72 @@
+// Decoder QOI ("Quite OK Image") para el codec sin pérdida del stream
+// (FrameCodec::QOI en el backend, ver backend/api_docu.md).
+// Devuelve un ImageData listo para createImageBitmap/putImageData.
+
+const QOI_HEADER_SIZE = 14;
+const QOI_PADDING_SIZE = 8;
+const QOI_OP_INDEX = 0x00;
+const QOI_OP_DIFF = 0x40;
+const QOI_OP_LUMA = 0x80;
+const QOI_OP_RGB = 0xfe;
+const QOI_OP_RGBA = 0xff;
+const QOI_MASK_2 = 0xc0;
+
+// bytes: Uint8Array con la imagen QOI completa (cabecera incluida)
+export function decodeQoi(bytes) {
+  if (bytes.length < QOI_HEADER_SIZE + QOI_PADDING_SIZE ||
+      bytes[0] !== 0x71 || bytes[1] !== 0x6f || bytes[2] !== 0x69 || bytes[3] !== 0x66) {
+    throw new Error('QOI inválido');
+  }
+
+  const view = new DataView(bytes.buffer, bytes.byteOffset, bytes.byteLength);
+  const width = view.getUint32(4);
+  const height = view.getUint32(8);
+  const pixels = new Uint8ClampedArray(width * height * 4);
+  const index = new Uint8Array(64 * 4);
+  const end = bytes.length - QOI_PADDING_SIZE;
+
+  let pos = QOI_HEADER_SIZE;
+  let r = 0, g = 0, b = 0, a = 255;
+  let run = 0;
+
+  for (let i = 0; i < pixels.length; i += 4) {
+    if (run > 0) {
+      run--;
+    } else if (pos < end) {
+      const op = bytes[pos++];
+
+      if (op === QOI_OP_RGB) {
+        r = bytes[pos]; g = bytes[pos + 1]; b = bytes[pos + 2];
+        pos += 3;
+      } else if (op === QOI_OP_RGBA) {
+        r = bytes[pos]; g = bytes[pos + 1]; b = bytes[pos + 2]; a = bytes[pos + 3];
+        pos += 4;
+      } else if ((op & QOI_MASK_2) === QOI_OP_INDEX) {
+        const slot = op * 4;
+        r = index[slot]; g = index[slot + 1]; b = index[slot + 2]; a = index[slot + 3];
+      } else if ((op & QOI_MASK_2) === QOI_OP_DIFF) {
+        r = (r + ((op >> 4) & 0x03) - 2) & 0xff;
+        g = (g + ((op >> 2) & 0x03) - 2) & 0xff;
+        b = (b + (op & 0x03) - 2) & 0xff;
+      } else if ((op & QOI_MASK_2) === QOI_OP_LUMA) {
+        const second = bytes[pos++];
+        const vg = (op & 0x3f) - 32;
+        r = (r + vg - 8 + ((second >> 4) & 0x0f)) & 0xff;
+        g = (g + vg) & 0xff;
+        b = (b + vg - 8 + (second & 0x0f)) & 0xff;
+      } else {
+        run = op & 0x3f;
+      }
+
+      const slot = ((r * 3 + g * 5 + b * 7 + a * 11) & 63) * 4;
+      index[slot] = r; index[slot + 1] = g; index[slot + 2] = b; index[slot + 3] = a;
+    }
+
+    pixels[i] = r;
+    pixels[i + 1] = g;
+    pixels[i + 2] = b;
+    pixels[i + 3] = a;
+  }
+
+  return new ImageData(pixels, width, height);
+}
@@ -1,17 +1,73 @@
+import { decodeQoi } from './qoiDecoder';
 
 // URL del WebSocket - CAMBIAR según tu configuración
 const WS_URL = 'ws://10.150.1.233:8080/ws';
 
+// Cabecera fija de los frames binarios (ver backend/api_docu.md)
+const FRAME_HEADER_SIZE = 24;
+const FRAME_TYPE_SCREENSHOT = 1;
+const FRAME_TYPE_TILES = 2;
+const FRAME_TYPE_VIEWPORT = 3;   // Región ampliada: uint16 x, y, w, h + imagen
+const FRAME_FLAG_MOVES = 0x0002;   // El payload empieza con copias de rectángulos (scroll)
+const CODEC_JPEG = 1;
+const CODEC_QOI = 2;
+const CODEC_MIXED = 3;   // Cada región trae su codec (texto sin pérdida, fotos/video en JPEG)
+const CODEC_MIME = { [CODEC_JPEG]: 'image/jpeg' };
+
+// Mensajes binarios de entrada (12 bytes, ver backend/api_docu.md)
+const INPUT_MESSAGE_SIZE = 12;
+export const INPUT_MOVE = 1;
+export const INPUT_BUTTON_DOWN = 2;
+export const INPUT_BUTTON_UP = 3;
+export const INPUT_KEY_DOWN = 4;
+export const INPUT_KEY_UP = 5;
+export const INPUT_WHEEL = 6;
+const INPUT_PENDING_MAX = 256;   // Envíos sin confirmar que se recuerdan para medir la latencia
+
+// Codec pedido al iniciar el stream: 'auto' (el servidor elige por región
+// según su contenido), 'jpeg' (cualquier red) o 'qoi' (sin pérdida, más
+// rápido pero más pesado: pensado para la LAN)
+const STREAM_CODEC = 'auto';
+
+// Capa de calidad con codec 'jpeg': 'auto' (el servidor baja o sube según
+// lo que drena la conexión), 'high', 'low' o 'half' (mitad de resolución)
+const STREAM_LAYER = 'auto';
+
 class WebSocketService {
   constructor() {
     this.ws = null;
+    this.codec = STREAM_CODEC;
+    this.layer = STREAM_LAYER;
+    this.viewport = null;
+    this.token = null;
+    this.inputControl = false;      // El servidor aceptó el token: la entrada va por el socket
+    this.inputSeq = 0;
+    this.pointer = null;            // Última posición del puntero sin enviar
+    this.pointerFrame = null;       // requestAnimationFrame que la enviará
+    this.inputSentAt = new Map();   // seq -> performance.now() del envío
+    this.inputRtt = null;           // Última latencia de entrada medida (ms)
     this.listeners = {
+      input: [],
       screenshot: [],
+      tiles: [],
+      viewport: [],
       resources: [],
       open: [],
       close: [],
       error: [],
     };
+
+    // Con la pestaña oculta no tiene sentido recibir frames: el servidor
+    // deja de capturar si ningún cliente está suscrito
+    if (typeof document !== 'undefined') {
+      document.addEventListener('visibilitychange', () => {
+        if (document.hidden) {
+          this.pauseStream();
+        } else {
+          this.resumeStream();
+        }
+      });
+    }
   }
 
   // Conectar al WebSocket
@@ -23,15 +79,37 @@ class WebSocketService {
 
     console.log('Conectando a WebSocket:', WS_URL);
     this.ws = new WebSocket(WS_URL);
+    this.ws.binaryType = 'arraybuffer';
+    this.receivedBytes = 0;   // Binarios recibidos en esta conexión (se confirman con frame_ack)
 
     // Evento: conexión establecida
     this.ws.onopen = () => {
       console.log('WebSocket conectado');
+      // Pedimos frames binarios (sin Base64) con el codec elegido
+      this.send({ command: 'set_format', format: 'binary', codec: this.codec, layer: this.layer });
+      // set_format descarta el viewport: al reconectar se vuelve a pedir
+      if (this.viewport) {
+        this.send({ command: 'set_viewport', ...this.viewport });
+      }
+      if (this.token) {
+        this.send({ command: 'auth', token: this.token });
+      }
+      if (typeof document !== 'undefined' && document.hidden) {
+        this.pauseStream();
+      }
       this.notifyListeners('open', { connected: true });
     };
 
     // Evento: mensaje recibido
     this.ws.onmessage = (event) => {
+      if (event.data instanceof ArrayBuffer) {
+        // Confirmar lo recibido: el servidor frena los frames si el enlace no alcanza
+        this.receivedBytes += event.data.byteLength;
+        this.send({ command: 'frame_ack', bytes: this.receivedBytes });
+        this.handleBinaryFrame(event.data);
+        return;
+      }
+
       try {
         const data = JSON.parse(event.data);
         console.log('Mensaje recibido:', data.type);
@@ -41,6 +119,18 @@ class WebSocketService {
           this.notifyListeners('screenshot', data);
         } else if (data.type === 'resources') {
           this.notifyListeners('resources', data);
+        } else if (data.type === 'layer') {
+          // Los frames de la capa 'half' traen su tamaño en la cabecera y se escalan al dibujar
+          console.log(`Capa de calidad: ${data.layer} (drena ${data.drain_percent}%, ${data.drain_kbps} kbit/s)`);
+        } else if (data.type === 'auth') {
+          this.inputControl = data.control;
+          console.log(data.control ? 'Entrada por WebSocket habilitada' : 'Sin permiso de control por WebSocket');
+        } else if (data.type === 'input_ack' || data.type === 'input_nack') {
+          this.handleInputAck(data.seq, data.type === 'input_ack');
+        } else if (data.type === 'viewport') {
+          console.log(data.active
+            ? `Viewport ${data.w}x${data.h} en (${data.x}, ${data.y}) enviado a ${data.width}x${data.height}`
+            : 'Viewport desactivado: pantalla completa');
         }
       } catch (error) {
         console.error('Error al parsear mensaje:', error);
@@ -49,6 +139,9 @@ class WebSocketService {
 
     // Evento: conexión cerrada
     this.ws.onclose = () => {
+      this.inputControl = false;
+      this.inputSentAt.clear();
+      this.dropPointer();
       console.log(' WebSocket desconectado');
       this.notifyListeners('close', { connected: false });
     };
@@ -60,6 +153,118 @@ class WebSocketService {
     };
   }
 
+  // Imagen de una región: QOI se decodifica aquí a ImageData, el resto
+  // viaja como Blob para que lo decodifique el navegador
+  decodeImage(buffer, offset, length, codec) {
+    const bytes = new Uint8Array(buffer, offset, length);
+    if (codec === CODEC_QOI) {
+      return { imageData: decodeQoi(bytes) };
+    }
+    return { blob: new Blob([bytes], { type: CODEC_MIME[codec] || 'application/octet-stream' }) };
+  }
+
+  // Payload de regiones: uint16 count + (x, y, w, h, [codec, clase,] length, bytes).
+  // Con codec por región cada una trae su codec y su clase de contenido
+  parseRegions(view, buffer, start, perRegionCodec, codec) {
+    const regions = [];
+    const headerSize = perRegionCodec ? 14 : 12;
+    let offset = start;
+    const count = view.getUint16(offset, true);
+    offset += 2;
+
+    for (let i = 0; i < count; i++) {
+      const regionCodec = perRegionCodec ? view.getUint8(offset + 8) : codec;
+      const length = view.getUint32(offset + headerSize - 4, true);
+      regions.push({
+        x: view.getUint16(offset, true),
+        y: view.getUint16(offset + 2, true),
+        w: view.getUint16(offset + 4, true),
+        h: view.getUint16(offset + 6, true),
+        ...this.decodeImage(buffer, offset + headerSize, length, regionCodec),
+      });
+      offset += headerSize + length;
+    }
+
+    return regions;
+  }
+
+  // Copias de rectángulos: uint16 count + (src_x, src_y, dst_x, dst_y, w, h)
+  parseMoves(view, start) {
+    const moves = [];
+    const count = view.getUint16(start, true);
+    for (let i = 0; i < count; i++) {
+      const offset = start + 2 + i * 12;
+      moves.push({
+        srcX: view.getUint16(offset, true),
+        srcY: view.getUint16(offset + 2, true),
+        dstX: view.getUint16(offset + 4, true),
+        dstY: view.getUint16(offset + 6, true),
+        w: view.getUint16(offset + 8, true),
+        h: view.getUint16(offset + 10, true),
+      });
+    }
+    return moves;
+  }
+
+  // Decodificar un frame binario: cabecera fija + bytes de la imagen
+  handleBinaryFrame(buffer) {
+    if (buffer.byteLength < FRAME_HEADER_SIZE) return;
+
+    const view = new DataView(buffer);
+    const type = view.getUint8(0);
+    const codec = view.getUint8(1);
+    const flags = view.getUint16(2, true);
+    const payloadLength = view.getUint32(20, true);
+
+    const frame = {
+      frameId: view.getUint32(4, true),
+      timestamp: Number(view.getBigUint64(8, true)),
+      width: view.getUint16(16, true),
+      height: view.getUint16(18, true),
+    };
+
+    // Las copias (scroll) se aplican antes de dibujar las regiones
+    let regionsStart = FRAME_HEADER_SIZE;
+    if (flags & FRAME_FLAG_MOVES) {
+      frame.moves = this.parseMoves(view, regionsStart);
+      regionsStart += 2 + frame.moves.length * 12;
+    }
+
+    if (type === FRAME_TYPE_VIEWPORT) {
+      // Siempre una imagen completa de la región, en coordenadas de pantalla
+      const start = FRAME_HEADER_SIZE;
+      this.notifyListeners('viewport', {
+        ...frame,
+        type: 'viewport',
+        x: view.getUint16(start, true),
+        y: view.getUint16(start + 2, true),
+        w: view.getUint16(start + 4, true),
+        h: view.getUint16(start + 6, true),
+        ...this.decodeImage(buffer, start + 8, payloadLength - 8, codec),
+      });
+    } else if (codec === CODEC_MIXED) {
+      // Keyframes y tiles usan el mismo payload: regiones con su propio codec
+      const event = type === FRAME_TYPE_SCREENSHOT ? 'screenshot' : 'tiles';
+      this.notifyListeners(event, {
+        ...frame,
+        type: event,
+        tiles: this.parseRegions(view, buffer, regionsStart, true),
+      });
+    } else if (type === FRAME_TYPE_SCREENSHOT) {
+      this.notifyListeners('screenshot', {
+        ...frame,
+        type: 'screenshot',
+        ...this.decodeImage(buffer, FRAME_HEADER_SIZE, payloadLength, codec),
+      });
+    } else if (type === FRAME_TYPE_TILES) {
+      this.notifyListeners('tiles', {
+        ...frame,
+        type: 'tiles',
+        tiles: this.parseRegions(view, buffer, regionsStart, false, codec),
+      });
+    }
+  }
+
   // Desconectar WebSocket
   disconnect() {
     if (this.ws) {
@@ -69,6 +274,151 @@ class WebSocketService {
     }
   }
 
+  // Pausar/reanudar el envío de frames para esta conexión
+  pauseStream() {
+    if (this.ws && this.ws.readyState === WebSocket.OPEN) {
+      this.send({ command: 'stop_stream' });
+    }
+  }
+
+  resumeStream() {
+    if (this.ws && this.ws.readyState === WebSocket.OPEN) {
+      this.send({ command: 'start_stream' });
+    }
+  }
+
+  // Pedir solo una región de la pantalla (x, y, w, h en pixeles de la
+  // pantalla) para dibujarla en outW x outH: el servidor la envía con todo
+  // su detalle en vez de ampliar el frame completo
+  setViewport(rect, outW, outH) {
+    this.viewport = {
+      x: Math.round(rect.x),
+      y: Math.round(rect.y),
+      w: Math.round(rect.w),
+      h: Math.round(rect.h),
+      out_w: Math.round(outW),
+      out_h: Math.round(outH),
+    };
+    if (this.ws && this.ws.readyState === WebSocket.OPEN) {
+      this.send({ command: 'set_viewport', ...this.viewport });
+    }
+  }
+
+  // Volver a la pantalla completa
+  clearViewport() {
+    if (!this.viewport) return;
+    this.viewport = null;
+    if (this.ws && this.ws.readyState === WebSocket.OPEN) {
+      this.send({ command: 'set_viewport', active: false });
+    }
+  }
+
+  // Habilitar la entrada por el socket con el token de la sesión (se
+  // reenvía al reconectar)
+  authenticate(token) {
+    this.token = token;
+    if (!token) {
+      this.inputControl = false;
+      return;
+    }
+    if (this.ws && this.ws.readyState === WebSocket.OPEN) {
+      this.send({ command: 'auth', token });
+    }
+  }
+
+  // true si los eventos de entrada pueden ir por el socket en lugar de HTTP
+  canSendInput() {
+    return this.inputControl && this.ws && this.ws.readyState === WebSocket.OPEN;
+  }
+
+  // Movimiento del puntero: se envía a lo sumo una posición por frame de
+  // pantalla (la última); el servidor vuelve a agruparlas por tick de inyección
+  sendPointer(x, y) {
+    if (!this.canSendInput()) return false;
+    this.pointer = { x, y };
+    if (this.pointerFrame === null) {
+      this.pointerFrame = requestAnimationFrame(() => {
+        this.pointerFrame = null;
+        this.flushPointer();
+      });
+    }
+    return true;
+  }
+
+  flushPointer() {
+    if (!this.pointer) return;
+    const { x, y } = this.pointer;
+    this.dropPointer();
+    this.writeInput(INPUT_MOVE, 0, x, y);
+  }
+
+  dropPointer() {
+    this.pointer = null;
+    if (this.pointerFrame !== null) {
+      cancelAnimationFrame(this.pointerFrame);
+      this.pointerFrame = null;
+    }
+  }
+
+  // Enviar un evento de entrada binario: type, code (botón o keycode), x, y.
+  // La posición pendiente sale antes para conservar el orden; un botón trae
+  // la suya y la reemplaza. Devuelve el seq usado o null si no se pudo enviar
+  sendInput(type, code = 0, x = 0, y = 0) {
+    if (!this.canSendInput()) return null;
+    if (type === INPUT_BUTTON_DOWN || type === INPUT_BUTTON_UP) {
+      this.dropPointer();
+    } else {
+      this.flushPointer();
+    }
+    return this.writeInput(type, code, x, y);
+  }
+
+  // Codifica y envía un mensaje de 12 bytes (little-endian)
+  writeInput(type, code, x, y) {
+    const seq = (this.inputSeq + 1) >>> 0;
+    this.inputSeq = seq;
+    const buffer = new ArrayBuffer(INPUT_MESSAGE_SIZE);
+    const view = new DataView(buffer);
+    view.setUint8(0, type);
+    view.setUint16(2, code, true);
+    view.setUint32(4, seq, true);
+    view.setInt16(8, x, true);
+    view.setInt16(10, y, true);
+    this.ws.send(buffer);
+
+    this.inputSentAt.set(seq, performance.now());
+    if (this.inputSentAt.size > INPUT_PENDING_MAX) {
+      this.inputSentAt.delete(this.inputSentAt.keys().next().value);
+    }
+    return seq;
+  }
+
+  // El ack (o nack, si el servidor no pudo inyectar el lote) cubre su seq y
+  // todos los anteriores de esta conexión
+  handleInputAck(seq, applied) {
+    const sentAt = this.inputSentAt.get(seq);
+    for (const pending of this.inputSentAt.keys()) {
+      this.inputSentAt.delete(pending);
+      if (pending === seq) break;
+    }
+    if (!applied) {
+      console.warn(`El servidor no pudo inyectar la entrada (hasta seq ${seq})`);
+      this.notifyListeners('input', { seq, applied: false });
+      return;
+    }
+    if (sentAt === undefined) return;
+    this.inputRtt = performance.now() - sentAt;
+    this.notifyListeners('input', { seq, applied: true, rtt: this.inputRtt });
+  }
+
+  // Escribir un texto completo (por ejemplo al pegar); requiere control
+  typeText(text, layout) {
+    if (!this.canSendInput()) return false;
+    this.flushPointer();
+    this.send(layout ? { command: 'type', text, layout } : { command: 'type', text });
+    return true;
+  }
+
   // Enviar mensaje al servidor (por si quieres enviar comandos)
   send(message) {
     if (this.ws && this.ws.readyState === WebSocket.OPEN) {
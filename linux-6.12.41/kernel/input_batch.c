@@ -0,0 +1,356 @@
+#include <linux/syscalls.h>
+#include <linux/kernel.h>
+#include <linux/input.h>
+#include <linux/slab.h>
+#include <linux/string.h>
+#include <linux/uaccess.h>
+#include <linux/delay.h>
+#include <linux/mutex.h>
+#include <linux/fb.h>
+#include <linux/hrtimer.h>
+#include <linux/ktime.h>
+#include <linux/sched/signal.h>
+
+/*
+ * Entrada por lotes
+ *
+ * keyboard_caption, mouse_tracking y mouse_action inyectan una acción por
+ * llamada, cada una con su mutex y su dispositivo. input_batch recibe un
+ * arreglo de eventos tipados y los aplica en orden con un solo lock: un
+ * pegado de 100 teclas o un arrastre cuestan una syscall.
+ *
+ * Los eventos se acumulan en los dispositivos hasta un INPUT_BATCH_SYNC, un
+ * INPUT_BATCH_DELAY o el final del lote; ahí se emite un input_sync por
+ * dispositivo que tenga eventos pendientes. Para que una tecla o un botón se
+ * vean como pulsación, presionar y soltar deben quedar en grupos distintos.
+ *
+ * El lote se valida entero antes de aplicar nada: con un evento inválido
+ * no se inyecta ninguno.
+ *
+ * El rango del puntero es el del framebuffer registrado (se actualiza si
+ * cambia la resolución) y las posiciones se recortan a él. Las esperas
+ * (INPUT_BATCH_DELAY) suman a lo sumo INPUT_BATCH_MAX_DELAY_US por lote y
+ * se duermen sin batch_lock, de forma interrumpible: otro lote puede
+ * aplicarse entre dos grupos de uno que espera.
+ */
+
+#define INPUT_BATCH_MAX_EVENTS   4096
+#define INPUT_BATCH_MAX_DELAY_US 1000000   /* Suma de los INPUT_BATCH_DELAY de un lote */
+#define INPUT_BATCH_DELAY_SLACK_NS (50 * NSEC_PER_USEC)
+#define INPUT_BATCH_DEFAULT_WIDTH  1280    /* Sin framebuffer registrado */
+#define INPUT_BATCH_DEFAULT_HEIGHT 800
+
+enum input_batch_type {
+    INPUT_BATCH_MOVE = 1,         /* x, y absolutos */
+    INPUT_BATCH_BUTTON_DOWN = 2,  /* code: 1 izquierdo, 2 derecho, 3 medio */
+    INPUT_BATCH_BUTTON_UP = 3,
+    INPUT_BATCH_KEY_DOWN = 4,     /* code: keycode de linux/input.h */
+    INPUT_BATCH_KEY_UP = 5,
+    INPUT_BATCH_WHEEL = 6,        /* code: 0 vertical, 1 horizontal; x: pasos */
+    INPUT_BATCH_SYNC = 7,         /* Cierra el grupo actual */
+    INPUT_BATCH_DELAY = 8,        /* Cierra el grupo y espera x microsegundos */
+};
+
+struct input_batch_event {
+    __u16 type;
+    __u16 code;
+    __s32 x;
+    __s32 y;
+};
+
+/* Declarar símbolos externos del framebuffer */
+extern struct fb_info *registered_fb[];
+extern int num_registered_fb;
+
+/* Puntero absoluto (con rueda) y teclado, creados en la primera llamada */
+static struct input_dev *batch_pointer = NULL;
+static struct input_dev *batch_keyboard = NULL;
+static DEFINE_MUTEX(batch_lock);
+
+static const unsigned int batch_buttons[] = { 0, BTN_LEFT, BTN_RIGHT, BTN_MIDDLE };
+
+static bool batch_valid_key(unsigned int code)
+{
+    /* Los botones (BTN_MISC..KEY_OK) son del puntero */
+    return code >= 1 && code <= KEY_MAX && (code < BTN_MISC || code >= KEY_OK);
+}
+
+/* Resolución del framebuffer registrado, o la por defecto si no hay */
+static void batch_screen_size(int *width, int *height)
+{
+    struct fb_info *fb = num_registered_fb > 0 ? registered_fb[0] : NULL;
+
+    if (fb && fb->var.xres && fb->var.yres) {
+        *width = fb->var.xres;
+        *height = fb->var.yres;
+    } else {
+        *width = INPUT_BATCH_DEFAULT_WIDTH;
+        *height = INPUT_BATCH_DEFAULT_HEIGHT;
+    }
+}
+
+/*
+ * update_batch_range - Ajusta el rango ABS_X/ABS_Y a la pantalla actual
+ *
+ * Se llama con batch_lock tomado.
+ */
+static void update_batch_range(void)
+{
+    int width, height;
+
+    batch_screen_size(&width, &height);
+    if (input_abs_get_max(batch_pointer, ABS_X) == width - 1 &&
+        input_abs_get_max(batch_pointer, ABS_Y) == height - 1)
+        return;
+
+    input_abs_set_max(batch_pointer, ABS_X, width - 1);
+    input_abs_set_max(batch_pointer, ABS_Y, height - 1);
+    pr_info("input_batch: Rango del puntero %dx%d\n", width, height);
+}
+
+static int init_batch_devices(void)
+{
+    struct input_dev *pointer;
+    struct input_dev *keyboard;
+    unsigned int code;
+    int width, height;
+    int err;
+
+    if (batch_pointer && batch_keyboard) {
+        update_batch_range();
+        return 0;
+    }
+
+    pointer = input_allocate_device();
+    keyboard = input_allocate_device();
+    if (!pointer || !keyboard) {
+        pr_err("input_batch: No se pudieron alocar los dispositivos\n");
+        input_free_device(pointer);
+        input_free_device(keyboard);
+        return -ENOMEM;
+    }
+
+    pointer->name = "Syscall Virtual Pointer (batch)";
+    pointer->phys = "syscall/input_batch0";
+    pointer->id.bustype = BUS_VIRTUAL;
+    pointer->id.vendor  = 0x1234;
+    pointer->id.product = 0x567a;
+    pointer->id.version = 0x0100;
+
+    batch_screen_size(&width, &height);
+    set_bit(EV_ABS, pointer->evbit);
+    input_set_abs_params(pointer, ABS_X, 0, width - 1, 0, 0);
+    input_set_abs_params(pointer, ABS_Y, 0, height - 1, 0, 0);
+    set_bit(EV_KEY, pointer->evbit);
+    set_bit(BTN_LEFT, pointer->keybit);
+    set_bit(BTN_RIGHT, pointer->keybit);
+    set_bit(BTN_MIDDLE, pointer->keybit);
+    set_bit(EV_REL, pointer->evbit);
+    set_bit(REL_WHEEL, pointer->relbit);
+    set_bit(REL_HWHEEL, pointer->relbit);
+
+    keyboard->name = "Syscall Virtual Keyboard (batch)";
+    keyboard->phys = "syscall/input_batch1";
+    keyboard->id.bustype = BUS_VIRTUAL;
+    keyboard->id.vendor  = 0x0001;
+    keyboard->id.product = 0x0003;
+    keyboard->id.version = 0x0100;
+
+    set_bit(EV_KEY, keyboard->evbit);
+    for (code = 1; code <= KEY_MAX; code++) {
+        if (batch_valid_key(code))
+            set_bit(code, keyboard->keybit);
+    }
+
+    err = input_register_device(pointer);
+    if (err) {
+        pr_err("input_batch: No se pudo registrar el puntero: %d\n", err);
+        input_free_device(pointer);
+        input_free_device(keyboard);
+        return err;
+    }
+
+    err = input_register_device(keyboard);
+    if (err) {
+        pr_err("input_batch: No se pudo registrar el teclado: %d\n", err);
+        input_unregister_device(pointer);
+        input_free_device(keyboard);
+        return err;
+    }
+
+    batch_pointer = pointer;
+    batch_keyboard = keyboard;
+    pr_info("input_batch: Dispositivos virtuales creados exitosamente\n");
+    return 0;
+}
+
+static int validate_batch_event(const struct input_batch_event *ev)
+{
+    switch (ev->type) {
+    case INPUT_BATCH_MOVE:
+        return 0;   /* Se recorta al rango del puntero al aplicarlo */
+    case INPUT_BATCH_BUTTON_DOWN:
+    case INPUT_BATCH_BUTTON_UP:
+        return ev->code >= 1 && ev->code < ARRAY_SIZE(batch_buttons) ? 0 : -EINVAL;
+    case INPUT_BATCH_KEY_DOWN:
+    case INPUT_BATCH_KEY_UP:
+        return batch_valid_key(ev->code) ? 0 : -EINVAL;
+    case INPUT_BATCH_WHEEL:
+        return ev->code <= 1 ? 0 : -EINVAL;
+    case INPUT_BATCH_SYNC:
+        return 0;
+    case INPUT_BATCH_DELAY:
+        return ev->x >= 0 && ev->x <= INPUT_BATCH_MAX_DELAY_US ? 0 : -EINVAL;
+    default:
+        return -EINVAL;
+    }
+}
+
+/*
+ * batch_sleep - Espera 'us' microsegundos; una señal la corta
+ *
+ * Se llama sin batch_lock.
+ *
+ * Return: 0, o -EINTR si llegó una señal
+ */
+static int batch_sleep(u32 us)
+{
+    ktime_t timeout = ns_to_ktime((u64)us * NSEC_PER_USEC);
+
+    set_current_state(TASK_INTERRUPTIBLE);
+    schedule_hrtimeout_range(&timeout, INPUT_BATCH_DELAY_SLACK_NS, HRTIMER_MODE_REL);
+    return signal_pending(current) ? -EINTR : 0;
+}
+
+/* Emite un input_sync en cada dispositivo con eventos pendientes */
+static void flush_batch_group(bool *pointer_dirty, bool *keyboard_dirty)
+{
+    if (*pointer_dirty)
+        input_sync(batch_pointer);
+    if (*keyboard_dirty)
+        input_sync(batch_keyboard);
+    *pointer_dirty = false;
+    *keyboard_dirty = false;
+}
+
+/*
+ * SYSCALL: input_batch
+ * Propósito: Inyectar una secuencia de eventos de teclado y mouse
+ *
+ * Parámetros:
+ *   @events: Arreglo de struct input_batch_event
+ *   @count:  Cantidad de eventos (hasta INPUT_BATCH_MAX_EVENTS)
+ *
+ * Retorno:
+ *   Cantidad de eventos aplicados en éxito
+ *   -EINVAL si algún evento es inválido o las esperas suman más de
+ *           INPUT_BATCH_MAX_DELAY_US (no se aplica ninguno)
+ *   -E2BIG si el lote es demasiado grande
+ *   -EFAULT si no se puede leer el arreglo
+ *   -EINTR si llegó una señal durante una espera (los eventos anteriores
+ *          ya se aplicaron)
+ */
+SYSCALL_DEFINE2(input_batch, const struct input_batch_event __user *, events, unsigned int, count)
+{
+    struct input_batch_event *batch;
+    bool pointer_dirty = false;
+    bool keyboard_dirty = false;
+    u64 total_delay = 0;
+    int max_x, max_y;
+    unsigned int i;
+    long ret;
+
+    if (count == 0)
+        return 0;
+    if (count > INPUT_BATCH_MAX_EVENTS)
+        return -E2BIG;
+
+    batch = vmemdup_array_user(events, count, sizeof(*batch));
+    if (IS_ERR(batch))
+        return PTR_ERR(batch);
+
+    for (i = 0; i < count; i++) {
+        if (validate_batch_event(&batch[i])) {
+            pr_warn("input_batch: Evento %u inválido (tipo %u, código %u)\n",
+                    i, batch[i].type, batch[i].code);
+            kvfree(batch);
+            return -EINVAL;
+        }
+        if (batch[i].type == INPUT_BATCH_DELAY)
+            total_delay += batch[i].x;
+    }
+    if (total_delay > INPUT_BATCH_MAX_DELAY_US) {
+        pr_warn("input_batch: Esperas de %llu us en un lote (máximo %u)\n",
+                total_delay, INPUT_BATCH_MAX_DELAY_US);
+        kvfree(batch);
+        return -EINVAL;
+    }
+
+    mutex_lock(&batch_lock);
+
+    ret = init_batch_devices();
+    if (ret) {
+        mutex_unlock(&batch_lock);
+        kvfree(batch);
+        return ret;
+    }
+    max_x = input_abs_get_max(batch_pointer, ABS_X);
+    max_y = input_abs_get_max(batch_pointer, ABS_Y);
+
+    for (i = 0; i < count; i++) {
+        const struct input_batch_event *ev = &batch[i];
+
+        switch (ev->type) {
+        case INPUT_BATCH_MOVE:
+            input_report_abs(batch_pointer, ABS_X, clamp(ev->x, 0, max_x));
+            input_report_abs(batch_pointer, ABS_Y, clamp(ev->y, 0, max_y));
+            pointer_dirty = true;
+            break;
+        case INPUT_BATCH_BUTTON_DOWN:
+        case INPUT_BATCH_BUTTON_UP:
+            input_report_key(batch_pointer, batch_buttons[ev->code],
+                             ev->type == INPUT_BATCH_BUTTON_DOWN);
+            pointer_dirty = true;
+            break;
+        case INPUT_BATCH_KEY_DOWN:
+        case INPUT_BATCH_KEY_UP:
+            input_report_key(batch_keyboard, ev->code, ev->type == INPUT_BATCH_KEY_DOWN);
+            keyboard_dirty = true;
+            break;
+        case INPUT_BATCH_WHEEL:
+            input_report_rel(batch_pointer, ev->code ? REL_HWHEEL : REL_WHEEL, ev->x);
+            pointer_dirty = true;
+            break;
+        case INPUT_BATCH_SYNC:
+            flush_batch_group(&pointer_dirty, &keyboard_dirty);
+            break;
+        case INPUT_BATCH_DELAY:
+            flush_batch_group(&pointer_dirty, &keyboard_dirty);
+            if (ev->x == 0)
+                break;
+            /* Sin el lock: los demás lotes no esperan esta pausa */
+            mutex_unlock(&batch_lock);
+            ret = batch_sleep(ev->x);
+            if (ret) {
+                kvfree(batch);
+                return ret;
+            }
+            if (mutex_lock_interruptible(&batch_lock)) {
+                kvfree(batch);
+                return -EINTR;
+            }
+            /* La resolución pudo cambiar mientras tanto */
+            update_batch_range();
+            max_x = input_abs_get_max(batch_pointer, ABS_X);
+            max_y = input_abs_get_max(batch_pointer, ABS_Y);
+            break;
+        }
+    }
+
+    flush_batch_group(&pointer_dirty, &keyboard_dirty);
+    ret = count;
+
+    mutex_unlock(&batch_lock);
+    kvfree(batch);
+    return ret;
+}
@@ -0,0 +1,78 @@
+#include <linux/kernel.h>
+#include <linux/input.h>
+#include <linux/jiffies.h>
+#include <linux/mutex.h>
+#include <linux/workqueue.h>
+
+#include "input_release.h"
+
+/* Suelta la tecla más vieja de la cola (con el lock tomado) */
+static void release_oldest(struct input_release_queue *queue)
+{
+    struct input_release_entry *entry = &queue->entries[queue->head];
+
+    input_report_key(*queue->dev, entry->code, 0);
+    input_sync(*queue->dev);
+    clear_bit(entry->code, queue->pending);
+
+    queue->head = (queue->head + 1) % INPUT_RELEASE_SLOTS;
+    queue->count--;
+}
+
+static void input_release_work(struct work_struct *work)
+{
+    struct input_release_queue *queue =
+        container_of(to_delayed_work(work), struct input_release_queue, work);
+
+    mutex_lock(queue->lock);
+
+    while (queue->count > 0 &&
+           time_after_eq(jiffies, queue->entries[queue->head].deadline))
+        release_oldest(queue);
+
+    /* Quedan pulsaciones más nuevas: volver cuando venza la siguiente */
+    if (queue->count > 0) {
+        unsigned long deadline = queue->entries[queue->head].deadline;
+
+        mod_delayed_work(system_wq, &queue->work,
+                         time_after(deadline, jiffies) ? deadline - jiffies : 0);
+    }
+
+    mutex_unlock(queue->lock);
+}
+
+void input_release_flush(struct input_release_queue *queue)
+{
+    while (queue->count > 0)
+        release_oldest(queue);
+}
+
+void input_release_press(struct input_release_queue *queue, unsigned int code,
+                         unsigned int hold_ms)
+{
+    struct input_release_entry *entry;
+
+    if (!queue->initialized) {
+        INIT_DELAYED_WORK(&queue->work, input_release_work);
+        queue->initialized = true;
+    }
+
+    /* La misma tecla sigue presionada: soltar antes de volver a presionar */
+    if (test_bit(code, queue->pending))
+        input_release_flush(queue);
+    if (queue->count == INPUT_RELEASE_SLOTS)
+        release_oldest(queue);
+
+    input_report_key(*queue->dev, code, 1);
+    input_sync(*queue->dev);
+
+    entry = &queue->entries[(queue->head + queue->count) % INPUT_RELEASE_SLOTS];
+    entry->code = code;
+    entry->deadline = jiffies + msecs_to_jiffies(hold_ms);
+    set_bit(code, queue->pending);
+    queue->count++;
+
+    /* Si ya había pendientes el work está programado para la más vieja */
+    if (queue->count == 1)
+        mod_delayed_work(system_wq, &queue->work, msecs_to_jiffies(hold_ms));
+}
@@ -0,0 +1,53 @@
+#ifndef _KERNEL_INPUT_RELEASE_H
+#define _KERNEL_INPUT_RELEASE_H
+
+#include <linux/input.h>
+#include <linux/mutex.h>
+#include <linux/workqueue.h>
+
+/*
+ * Liberaciones diferidas de teclas y botones
+ *
+ * keyboard_caption y mouse_action presionan y devuelven el control de
+ * inmediato: la liberación se encola y la suelta un delayed work pasado el
+ * tiempo de pulsación, sin dormir con el mutex tomado.
+ *
+ * Orden: todas las pulsaciones duran lo mismo, así que la cola (FIFO) está
+ * ordenada por vencimiento y las teclas se sueltan en el orden en que se
+ * presionaron. Si se vuelve a presionar una tecla que todavía no se soltó,
+ * o la cola se llena, primero se sueltan las pendientes (en orden) y
+ * después se presiona, así nunca llegan dos keydown seguidos.
+ *
+ * Todas las funciones se llaman con 'lock' tomado, salvo el work, que lo
+ * toma él mismo.
+ */
+
+#define INPUT_RELEASE_SLOTS 64
+
+struct input_release_entry {
+    unsigned int code;
+    unsigned long deadline;     /* jiffies */
+};
+
+struct input_release_queue {
+    struct mutex *lock;         /* Mutex del dispositivo */
+    struct input_dev **dev;     /* Dispositivo (se crea en la primera llamada) */
+    struct delayed_work work;
+    unsigned int head;
+    unsigned int count;
+    struct input_release_entry entries[INPUT_RELEASE_SLOTS];
+    DECLARE_BITMAP(pending, KEY_CNT);
+    bool initialized;
+};
+
+#define INPUT_RELEASE_QUEUE(name, _lock, _dev) \
+    struct input_release_queue name = { .lock = (_lock), .dev = (_dev) }
+
+/* Reporta keydown + input_sync y encola el keyup para dentro de hold_ms */
+void input_release_press(struct input_release_queue *queue, unsigned int code,
+                         unsigned int hold_ms);
+
+/* Suelta ya todas las teclas pendientes, en orden */
+void input_release_flush(struct input_release_queue *queue);
+
+#endif /* _KERNEL_INPUT_RELEASE_H */
@@ -3,9 +3,13 @@
 #include <linux/input.h>
 #include <linux/slab.h>
 #include <linux/uaccess.h>
-#include <linux/delay.h>
 #include <linux/mutex.h>
 
+#include "input_release.h"
+
+/* Tiempo entre keydown y keyup */
+#define KBD_CAPTION_HOLD_MS 50
+
 /* Dispositivo virtual global que persiste entre llamadas */
 static struct input_dev *global_virtual_kbd = NULL;
 
@@ -15,6 +19,9 @@ static DEFINE_MUTEX(kbd_caption_mutex);
 /* Flag para indicar si el dispositivo ha sido inicializado */
 static bool kbd_caption_initialized = false;
 
+/* Keyups pendientes: se sueltan desde un delayed work, no con msleep */
+static INPUT_RELEASE_QUEUE(kbd_caption_release, &kbd_caption_mutex, &global_virtual_kbd);
+
 /**
  * init_virtual_keyboard_caption - Inicializa el dispositivo virtual del teclado
  * Return: 0 si es exitoso, código de error negativo si falla
@@ -109,25 +116,18 @@ SYSCALL_DEFINE1(keyboard_caption, int, keycode)
         return -ENODEV;
     }
 
-    /* FASE 1: PRESIONAR LA TECLA (keydown) */
-    input_report_key(global_virtual_kbd, keycode, 1);
-    input_sync(global_virtual_kbd);
-    
-    printk(KERN_INFO "keyboard_caption: Tecla %d PRESIONADA\n", keycode);
-    
-    /* PAUSA ENTRE KEYDOWN Y KEYUP */
-    msleep(50);
-    
-    /* FASE 2: SOLTAR LA TECLA (keyup) */
-    input_report_key(global_virtual_kbd, keycode, 0);
-    input_sync(global_virtual_kbd);
-    
-    printk(KERN_INFO "keyboard_caption: Tecla %d SOLTADA\n", keycode);
+    /*
+     * FASE 1: PRESIONAR LA TECLA (keydown)
+     * FASE 2: el keyup queda programado para dentro de KBD_CAPTION_HOLD_MS;
+     * la syscall vuelve sin esperarlo y las teclas se sueltan en orden
+     */
+    input_release_press(&kbd_caption_release, keycode, KBD_CAPTION_HOLD_MS);
 
     /* Liberamos el mutex */
     mutex_unlock(&kbd_caption_mutex);
     
-    printk(KERN_INFO "keyboard_caption: Pulsación completa de keycode=%d exitosa\n", keycode);
+    printk(KERN_INFO "keyboard_caption: Tecla %d presionada (keyup en %d ms)\n",
+           keycode, KBD_CAPTION_HOLD_MS);
     
     return 0;
 }
\ No newline at end of file
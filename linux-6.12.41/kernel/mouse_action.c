@@ -1,12 +1,19 @@
 #include <linux/syscalls.h>
 #include <linux/kernel.h>
 #include <linux/input.h>
-#include <linux/delay.h>
 #include <linux/mutex.h>
 
+#include "input_release.h"
+
+/* Tiempo entre presionar y soltar el botón */
+#define CLICK_HOLD_MS 50
+
 static struct input_dev *global_click_dev = NULL;
 static DEFINE_MUTEX(click_lock);
 
+/* Liberaciones pendientes: las suelta un delayed work, no un msleep */
+static INPUT_RELEASE_QUEUE(click_release, &click_lock, &global_click_dev);
+
 static int init_click_device(void)
 {
     int err;
@@ -75,16 +82,8 @@ SYSCALL_DEFINE1(mouse_action, int, button)
         return ret;
     }
     
-    // Hacer el click: presionar
-    input_report_key(global_click_dev, button_code, 1);
-    input_sync(global_click_dev);
-    
-    // Pequeña pausa
-    msleep(50);
-    
-    // Soltar
-    input_report_key(global_click_dev, button_code, 0);
-    input_sync(global_click_dev);
+    // Hacer el click: presionar ahora y soltar en CLICK_HOLD_MS, sin dormir con el lock
+    input_release_press(&click_release, button_code, CLICK_HOLD_MS);
     
     mutex_unlock(&click_lock);
     
@@ -2,12 +2,14 @@
 #include <linux/kernel.h>
 #include <linux/uaccess.h>
 #include <linux/slab.h>
-#include <linux/vmalloc.h>
 #include <linux/fs.h>
 #include <linux/file.h>
 #include <linux/mm.h>
 #include <linux/fb.h>
+#include <linux/mutex.h>
+#include <linux/io.h>
 
+/* ABI de screen_live (556): no cambiar, hay programas que la usan así */
 struct screen_capture_info {
     __u32 width;
     __u32 height;
@@ -16,28 +18,107 @@ struct screen_capture_info {
     void __user *data;
 };
 
+/*
+ * screen_live_rect (565): los mismos campos al principio, más la región y
+ * el tamaño del buffer del usuario
+ */
+struct screen_capture_rect {
+    __u32 width;
+    __u32 height;
+    __u32 bytes_per_pixel;
+    __u64 buffer_size;
+    void __user *data;
+    /* Región a copiar; w = 0 o h = 0 captura toda la pantalla visible */
+    __u32 x;
+    __u32 y;
+    __u32 w;
+    __u32 h;
+    __u64 capacity;         /* Tamaño del buffer 'data' */
+};
+
 /* Declarar símbolos externos del framebuffer */
 extern struct fb_info *registered_fb[];
 extern int num_registered_fb;
 
-SYSCALL_DEFINE1(screen_live, struct screen_capture_info __user *, capture_info_user)
+/*
+ * Buffer intermedio fijo para copiar desde memoria de I/O.
+ * Se copia por bloques en lugar de reservar (vmalloc) el framebuffer
+ * completo en cada llamada.
+ */
+#define SCREEN_LIVE_CHUNK (64 * 1024)
+static u8 screen_live_bounce[SCREEN_LIVE_CHUNK];
+static DEFINE_MUTEX(screen_live_lock);
+
+/*
+ * screen_live_copy_span - Copia un tramo contiguo del framebuffer al usuario
+ *
+ * Si el framebuffer está en RAM (screen_buffer) se copia directo; si está
+ * en memoria de I/O (screen_base) pasa por el buffer intermedio bloque a
+ * bloque. Se llama con screen_live_lock tomado.
+ */
+static int screen_live_copy_span(struct fb_info *fb, unsigned long src_offset,
+                                 u8 __user *dst, unsigned long size)
 {
-    struct screen_capture_info info_k;
-    struct fb_info *fb_info_ptr;
-    void *kbuf = NULL;
-    unsigned long fb_size;
+    unsigned long offset = 0;
+
+    /* screen_base y screen_buffer comparten union: FBINFO_VIRTFB indica RAM */
+    if (fb->flags & FBINFO_VIRTFB)
+        return copy_to_user(dst, fb->screen_buffer + src_offset, size) ? -EFAULT : 0;
+
+    while (offset < size) {
+        unsigned long chunk = min_t(unsigned long, size - offset, SCREEN_LIVE_CHUNK);
+
+        memcpy_fromio(screen_live_bounce, fb->screen_base + src_offset + offset, chunk);
+        if (copy_to_user(dst + offset, screen_live_bounce, chunk))
+            return -EFAULT;
+        offset += chunk;
+    }
+
+    return 0;
+}
+
+/*
+ * screen_live_copy_rect - Copia una región respetando el stride del framebuffer
+ *
+ * El resultado queda compacto en el buffer del usuario (w * bpp bytes por
+ * fila). Si la región ocupa filas completas sin padding se copia de una vez.
+ */
+static int screen_live_copy_rect(struct fb_info *fb, const struct screen_capture_rect *info,
+                                 u32 line_length)
+{
+    unsigned long row_bytes = (unsigned long)info->w * info->bytes_per_pixel;
+    unsigned long src = (unsigned long)info->y * line_length +
+                        (unsigned long)info->x * info->bytes_per_pixel;
+    u8 __user *dst = info->data;
     int ret = 0;
+    u32 row;
 
-    if (!capture_info_user)
-        return -EFAULT;
+    mutex_lock(&screen_live_lock);
+    if (row_bytes == line_length) {
+        ret = screen_live_copy_span(fb, src, dst, row_bytes * info->h);
+    } else {
+        for (row = 0; row < info->h && !ret; row++) {
+            ret = screen_live_copy_span(fb, src, dst, row_bytes);
+            src += line_length;
+            dst += row_bytes;
+        }
+    }
+    mutex_unlock(&screen_live_lock);
 
-    if (copy_from_user(&info_k, capture_info_user, sizeof(info_k)))
-        return -EFAULT;
+    return ret;
+}
+
+/*
+ * screen_live_fb - Framebuffer primario, sincronizado antes de leerlo
+ */
+static struct fb_info *screen_live_fb(void)
+{
+    struct fb_info *fb_info_ptr;
 
     /* Verificar que hay un framebuffer registrado */
     if (num_registered_fb < 1 || !registered_fb[0]) {
         pr_err("screen_live: no hay framebuffer registrado\n");
-        return -ENODEV;
+        return NULL;
     }
 
     fb_info_ptr = registered_fb[0];
@@ -55,6 +136,30 @@ SYSCALL_DEFINE1(screen_live, struct screen_capture_info __user *, capture_info_u
         }
     }
 
+    return fb_info_ptr;
+}
+
+/*
+ * screen_live - Copia el framebuffer completo (fix.smem_len bytes, con su
+ * stride) al buffer del usuario
+ */
+SYSCALL_DEFINE1(screen_live, struct screen_capture_info __user *, capture_info_user)
+{
+    struct screen_capture_info info_k;
+    struct fb_info *fb_info_ptr;
+    unsigned long fb_size;
+    int ret;
+
+    if (!capture_info_user)
+        return -EFAULT;
+
+    if (copy_from_user(&info_k, capture_info_user, sizeof(info_k)))
+        return -EFAULT;
+
+    fb_info_ptr = screen_live_fb();
+    if (!fb_info_ptr)
+        return -ENODEV;
+
     /* Obtener dimensiones */
     info_k.width = fb_info_ptr->var.xres;
     info_k.height = fb_info_ptr->var.yres;
@@ -67,46 +172,107 @@ SYSCALL_DEFINE1(screen_live, struct screen_capture_info __user *, capture_info_u
     info_k.buffer_size = fb_size;
 
     /* Verificar memoria disponible */
-    if (!fb_info_ptr->screen_base && !fb_info_ptr->screen_buffer) {
+    if (!fb_info_ptr->screen_base) {
         pr_err("screen_live: no hay memoria de framebuffer\n");
         return -ENOMEM;
     }
 
-    /* Alocar buffer temporal */
-    kbuf = vmalloc(fb_size);
-    if (!kbuf) {
-        pr_err("screen_live: no se pudo alocar buffer temporal\n");
-        return -ENOMEM;
-    }
+    /* Copiar metadata al usuario */
+    if (copy_to_user(capture_info_user, &info_k, sizeof(info_k)))
+        return -EFAULT;
+
+    /* Copiar datos al usuario */
+    if (!info_k.data)
+        return -EFAULT;
+
+    mutex_lock(&screen_live_lock);
+    ret = screen_live_copy_span(fb_info_ptr, 0, info_k.data, fb_size);
+    mutex_unlock(&screen_live_lock);
+    if (ret)
+        return ret;
+
+    pr_debug("screen_live: captura %ux%u bpp=%u (%lu bytes)\n",
+             info_k.width, info_k.height, info_k.bytes_per_pixel, fb_size);
+
+    return 0;
+}
+
+/*
+ * screen_live_rect - Copia una región de la pantalla visible, compacta y
+ * sin pasar del tamaño del buffer del usuario
+ */
+SYSCALL_DEFINE1(screen_live_rect, struct screen_capture_rect __user *, capture_info_user)
+{
+    struct screen_capture_rect info_k;
+    struct fb_info *fb_info_ptr;
+    unsigned long size;
+    u32 line_length;
+    int ret;
+
+    if (!capture_info_user)
+        return -EFAULT;
+
+    if (copy_from_user(&info_k, capture_info_user, sizeof(info_k)))
+        return -EFAULT;
 
-    /* Copiar datos del framebuffer */
-    if (fb_info_ptr->screen_base) {
-        memcpy_fromio(kbuf, fb_info_ptr->screen_base, fb_size);
-    } else if (fb_info_ptr->screen_buffer) {
-        memcpy(kbuf, fb_info_ptr->screen_buffer, fb_size);
+    fb_info_ptr = screen_live_fb();
+    if (!fb_info_ptr)
+        return -ENODEV;
+
+    /* Obtener dimensiones */
+    info_k.width = fb_info_ptr->var.xres;
+    info_k.height = fb_info_ptr->var.yres;
+    info_k.bytes_per_pixel = fb_info_ptr->var.bits_per_pixel / 8;
+
+    line_length = fb_info_ptr->fix.line_length;
+    if (line_length == 0)
+        line_length = info_k.width * info_k.bytes_per_pixel;
+
+    /* Región: toda la pantalla visible o el rectángulo pedido, recortado */
+    if (info_k.w == 0 || info_k.h == 0) {
+        info_k.x = 0;
+        info_k.y = 0;
+        info_k.w = info_k.width;
+        info_k.h = info_k.height;
     }
+    if (info_k.x >= info_k.width || info_k.y >= info_k.height)
+        return -EINVAL;
+    info_k.w = min(info_k.w, info_k.width - info_k.x);
+    info_k.h = min(info_k.h, info_k.height - info_k.y);
 
-    /* Copiar metadata al usuario */
-    if (copy_to_user(capture_info_user, &info_k, sizeof(info_k))) {
-        ret = -EFAULT;
-        goto cleanup;
+    /* Nunca copiar más allá del framebuffer ni del buffer del usuario */
+    size = (unsigned long)info_k.w * info_k.h * info_k.bytes_per_pixel;
+    if (fb_info_ptr->fix.smem_len &&
+        (unsigned long)(info_k.y + info_k.h - 1) * line_length +
+        (unsigned long)(info_k.x + info_k.w) * info_k.bytes_per_pixel > fb_info_ptr->fix.smem_len)
+        return -EINVAL;
+
+    info_k.buffer_size = size;
+
+    /* Verificar memoria disponible */
+    if (!fb_info_ptr->screen_base) {
+        pr_err("screen_live: no hay memoria de framebuffer\n");
+        return -ENOMEM;
     }
 
+    /* Copiar metadata al usuario (también si el buffer no alcanza: informa el tamaño) */
+    if (copy_to_user(capture_info_user, &info_k, sizeof(info_k)))
+        return -EFAULT;
+
+    if (size > info_k.capacity)
+        return -ENOSPC;
+
     /* Copiar datos al usuario */
-    if (!info_k.data) {
-        ret = -EFAULT;
-        goto cleanup;
-    }
+    if (!info_k.data)
+        return -EFAULT;
 
-    if (copy_to_user(info_k.data, kbuf, fb_size)) {
-        ret = -EFAULT;
-        goto cleanup;
-    }
+    ret = screen_live_copy_rect(fb_info_ptr, &info_k, line_length);
+    if (ret)
+        return ret;
 
-    pr_info("screen_live: captura %ux%u bpp=%u (%lu bytes)\n",
-            info_k.width, info_k.height, info_k.bytes_per_pixel, fb_size);
+    /* pr_debug: con captura adaptativa esto se llama hasta 30 veces por segundo */
+    pr_debug("screen_live_rect: captura %ux%u+%u+%u bpp=%u (%lu bytes)\n",
+             info_k.w, info_k.h, info_k.x, info_k.y, info_k.bytes_per_pixel, size);
 
-cleanup:
-    vfree(kbuf);
-    return ret;
-}
\ No newline at end of file
+    return 0;
+}
@@ -0,0 +1,669 @@
+#include <linux/syscalls.h>
+#include <linux/kernel.h>
+#include <linux/uaccess.h>
+#include <linux/slab.h>
+#include <linux/vmalloc.h>
+#include <linux/fs.h>
+#include <linux/file.h>
+#include <linux/mm.h>
+#include <linux/fb.h>
+#include <linux/io.h>
+#include <linux/mutex.h>
+#include <linux/anon_inodes.h>
+#include <linux/xxhash.h>
+#include <linux/delay.h>
+#include <linux/jiffies.h>
+#include <linux/sched.h>
+
+/*
+ * Anillo de frames compartido con el espacio de usuario
+ *
+ * screen_ring_open crea un buffer del kernel con slot_count slots y devuelve
+ * un fd; el backend lo mapea con mmap (solo lectura). Cada screen_ring_capture
+ * copia el framebuffer directo al siguiente slot y devuelve su índice y un
+ * número de secuencia: una sola copia y ninguna reserva de memoria por frame.
+ *
+ * Un slot se reescribe después de slot_count capturas; el usuario debe
+ * terminar de leerlo antes.
+ *
+ * Seguimiento de daño (tile_size > 0): el kernel guarda un hash por tile de
+ * la última captura y devuelve un bitmap con los tiles que cambiaron. Solo
+ * se copian al slot los tiles que cambiaron desde la última vez que se
+ * escribió ese slot, así una pantalla quieta cuesta una lectura y un hash.
+ *
+ * Generación: contador que avanza cada vez que el kernel observa un cambio
+ * en la pantalla (al capturar o al esperar). screen_ring_wait bloquea hasta
+ * que la generación pase de un valor dado o venza el timeout, así el
+ * backend solo captura cuando hay algo nuevo. fbdev no avisa de escrituras
+ * por mmap, por eso la espera muestrea la pantalla desde el kernel (solo
+ * hashes, sin copias ni fb_sync) en lugar de que el usuario capture.
+ *
+ * El intervalo de muestreo cuenta desde la última observación del anillo
+ * (captura o muestreo, de cualquier llamada): varias esperas cortas
+ * seguidas no muestrean más seguido que una larga. El usuario alarga el
+ * intervalo mientras la pantalla no cambia.
+ */
+
+#define SCREEN_RING_MAX_SLOTS 8
+#define SCREEN_RING_MIN_TILE  16
+#define SCREEN_RING_MAX_TILE  256
+#define SCREEN_RING_SAMPLE_MS 10    /* Muestreo por defecto de screen_ring_wait */
+#define SCREEN_RING_MAX_SAMPLE_MS 1000
+
+struct screen_ring_info {
+    __u32 width;
+    __u32 height;
+    __u32 bytes_per_pixel;
+    __u32 slot_count;
+    __u64 slot_size;        /* Bytes por slot (múltiplo de página) */
+    __u64 frame_size;       /* Bytes válidos de cada frame (width * height * bpp) */
+    __u32 tile_size;        /* Entrada: lado del tile para el daño (0 = sin seguimiento) */
+    __u32 tiles_x;          /* Salida: tiles por fila */
+    __u32 tiles_y;          /* Salida: filas de tiles */
+    __u32 dirty_map_size;   /* Salida: bytes del bitmap de daño */
+};
+
+struct screen_ring_frame {
+    __u32 slot;             /* Slot escrito: offset = slot * slot_size */
+    __u32 width;
+    __u32 height;
+    __u32 bytes_per_pixel;
+    __u64 sequence;         /* Número de captura, empieza en 1 */
+    __u64 frame_size;
+    void __user *dirty_map; /* Entrada: buffer para el bitmap (bit = tile, fila a fila) */
+    __u32 dirty_map_size;   /* Entrada: tamaño de ese buffer */
+    __u32 dirty_tiles;      /* Salida: tiles que cambiaron desde la captura anterior */
+    __u64 generation;       /* Salida: generación del contenido capturado */
+};
+
+struct screen_ring_wait {
+    __u64 generation;       /* Entrada: última vista; salida: generación actual */
+    __u32 timeout_ms;       /* Tiempo máximo de espera */
+    __u32 interval_ms;      /* Cada cuánto se muestrea la pantalla (0 = por defecto) */
+};
+
+struct screen_ring {
+    struct mutex lock;
+    void *buf;              /* vmalloc_user: slot_count * slot_size */
+    u32 width;
+    u32 height;
+    u32 bytes_per_pixel;
+    u32 slot_count;
+    size_t slot_size;
+    size_t frame_size;
+    u64 sequence;
+
+    /* Seguimiento de daño (todo reservado en screen_ring_open) */
+    u32 tile_size;
+    u32 tiles_x;
+    u32 tiles_y;
+    u64 *tile_hash;         /* Hash de cada tile en la última captura */
+    u64 *tile_seq;          /* Captura en la que cambió cada tile por última vez */
+    u64 slot_seq[SCREEN_RING_MAX_SLOTS];   /* Última captura escrita en cada slot */
+    u8 *dirty_map;          /* Bitmap de la última captura */
+    size_t dirty_map_size;
+    u8 *band;               /* Una fila de tiles leída de memoria de I/O */
+    u64 *row_hash;          /* Hash combinado de cada fila de tiles (generación) */
+    u64 *scan_hash;         /* Hashes temporales de una fila al esperar */
+    u64 generation;
+    unsigned long last_sample;  /* jiffies de la última captura o muestreo */
+};
+
+/* Declarar símbolos externos del framebuffer */
+extern struct fb_info *registered_fb[];
+extern int num_registered_fb;
+
+static int screen_ring_mmap(struct file *file, struct vm_area_struct *vma)
+{
+    struct screen_ring *ring = file->private_data;
+    unsigned long size = vma->vm_end - vma->vm_start;
+
+    /* El anillo es de solo lectura para el usuario */
+    if (vma->vm_flags & VM_WRITE)
+        return -EPERM;
+    vm_flags_clear(vma, VM_MAYWRITE);
+
+    if (vma->vm_pgoff != 0 || size > ring->slot_count * ring->slot_size)
+        return -EINVAL;
+
+    return remap_vmalloc_range(vma, ring->buf, 0);
+}
+
+static void screen_ring_free(struct screen_ring *ring)
+{
+    vfree(ring->buf);
+    vfree(ring->band);
+    kvfree(ring->tile_hash);
+    kvfree(ring->tile_seq);
+    kfree(ring->dirty_map);
+    kvfree(ring->row_hash);
+    kvfree(ring->scan_hash);
+    kfree(ring);
+}
+
+static int screen_ring_release(struct inode *inode, struct file *file)
+{
+    screen_ring_free(file->private_data);
+    return 0;
+}
+
+static int screen_ring_alloc_damage(struct screen_ring *ring, u32 tile_size)
+{
+    size_t tiles;
+
+    if (tile_size == 0)
+        return 0;
+    if (tile_size < SCREEN_RING_MIN_TILE || tile_size > SCREEN_RING_MAX_TILE)
+        return -EINVAL;
+
+    ring->tile_size = tile_size;
+    ring->tiles_x = DIV_ROUND_UP(ring->width, tile_size);
+    ring->tiles_y = DIV_ROUND_UP(ring->height, tile_size);
+    tiles = (size_t)ring->tiles_x * ring->tiles_y;
+
+    ring->tile_hash = kvcalloc(tiles, sizeof(u64), GFP_KERNEL);
+    ring->tile_seq = kvcalloc(tiles, sizeof(u64), GFP_KERNEL);
+    ring->dirty_map_size = DIV_ROUND_UP(tiles, 8);
+    ring->dirty_map = kzalloc(ring->dirty_map_size, GFP_KERNEL);
+    ring->band = vmalloc((size_t)tile_size * ring->width * ring->bytes_per_pixel);
+    ring->row_hash = kvcalloc(ring->tiles_y, sizeof(u64), GFP_KERNEL);
+    ring->scan_hash = kvcalloc(ring->tiles_x, sizeof(u64), GFP_KERNEL);
+
+    if (!ring->tile_hash || !ring->tile_seq || !ring->dirty_map || !ring->band ||
+        !ring->row_hash || !ring->scan_hash)
+        return -ENOMEM;
+    return 0;
+}
+
+/*
+ * screen_ring_fits - Indica si la pantalla visible entra en el framebuffer
+ *
+ * Con un line_length o una resolución que no coinciden con fix.smem_len, las
+ * copias leerían más allá de la memoria del framebuffer (igual que en
+ * screen_live_rect). Sin smem_len no hay con qué comparar.
+ */
+static bool screen_ring_fits(const struct fb_info *fb, u32 width, u32 height,
+                             u32 bytes_per_pixel, u32 line_length)
+{
+    if (!fb->fix.smem_len)
+        return true;
+    return (u64)(height - 1) * line_length + (u64)width * bytes_per_pixel <=
+           fb->fix.smem_len;
+}
+
+/*
+ * screen_ring_read_band - Devuelve las filas de una fila de tiles
+ *
+ * Si el framebuffer está en RAM se lee directo; si es memoria de I/O se
+ * copia antes a 'band'.
+ */
+static const u8 *screen_ring_read_band(struct screen_ring *ring, struct fb_info *fb,
+                                       u32 line_length, u32 y0, u32 rows, size_t *stride)
+{
+    size_t row_bytes = (size_t)ring->width * ring->bytes_per_pixel;
+    u32 r;
+
+    if (fb->flags & FBINFO_VIRTFB) {
+        *stride = line_length;
+        return (const u8 *)fb->screen_buffer + (size_t)y0 * line_length;
+    }
+
+    for (r = 0; r < rows; r++)
+        memcpy_fromio(ring->band + r * row_bytes,
+                      fb->screen_base + (size_t)(y0 + r) * line_length, row_bytes);
+    *stride = row_bytes;
+    return ring->band;
+}
+
+static u64 screen_ring_hash_tile(struct screen_ring *ring, const u8 *src, size_t stride,
+                                 u32 tx, u32 rows)
+{
+    u32 x0 = tx * ring->tile_size;
+    size_t bytes = (size_t)min(ring->tile_size, ring->width - x0) * ring->bytes_per_pixel;
+    u64 hash = 0;
+    u32 r;
+
+    for (r = 0; r < rows; r++)
+        hash = xxh64(src + r * stride + (size_t)x0 * ring->bytes_per_pixel, bytes, hash);
+    return hash;
+}
+
+/*
+ * screen_ring_note_row - Registra el hash combinado de una fila de tiles
+ *
+ * Captura y espera combinan los mismos hashes de tile, así un cambio hace
+ * avanzar la generación una sola vez, lo observe quien lo observe.
+ *
+ * Return: true si la fila cambió desde la última observación
+ */
+static bool screen_ring_note_row(struct screen_ring *ring, u32 ty, const u64 *tile_hashes)
+{
+    u64 hash = xxh64(tile_hashes, ring->tiles_x * sizeof(u64), 0);
+
+    if (hash == ring->row_hash[ty])
+        return false;
+    ring->row_hash[ty] = hash;
+    return true;
+}
+
+/*
+ * screen_ring_scan - Muestrea la pantalla sin copiarla (screen_ring_wait)
+ *
+ * Toma ring->lock por cada fila de tiles y lo suelta entre una y otra, así
+ * una captura no espera a que se recorra toda la pantalla. Termina antes si
+ * otra captura o espera ya vio un cambio posterior a 'after'. Con un cambio
+ * la generación avanza una vez y se siguen registrando las filas restantes.
+ *
+ * Return: 0, o -EINTR si llegó una señal esperando el lock
+ */
+static int screen_ring_scan(struct screen_ring *ring, struct fb_info *fb, u32 line_length,
+                            u64 after)
+{
+    bool changed = false;
+    u32 tx, ty;
+
+    for (ty = 0; ty < ring->tiles_y; ty++) {
+        u32 y0 = ty * ring->tile_size;
+        u32 rows = min(ring->tile_size, ring->height - y0);
+        size_t stride;
+        const u8 *src;
+
+        if (mutex_lock_interruptible(&ring->lock))
+            return -EINTR;
+        if (!changed && ring->generation > after) {
+            mutex_unlock(&ring->lock);
+            return 0;
+        }
+        if (ty == 0)
+            ring->last_sample = jiffies;
+
+        src = screen_ring_read_band(ring, fb, line_length, y0, rows, &stride);
+        for (tx = 0; tx < ring->tiles_x; tx++)
+            ring->scan_hash[tx] = screen_ring_hash_tile(ring, src, stride, tx, rows);
+
+        if (screen_ring_note_row(ring, ty, ring->scan_hash) && !changed) {
+            ring->generation++;
+            changed = true;
+        }
+        mutex_unlock(&ring->lock);
+        cond_resched();
+    }
+
+    return 0;
+}
+
+/*
+ * screen_ring_fill_damage - Copia al slot con seguimiento de daño
+ *
+ * Recorre la pantalla por filas de tiles. Cada fila de tiles se lee una vez
+ * (de memoria de I/O a 'band', o directo si está en RAM) y se calcula el
+ * hash de cada tile. Un tile se copia al slot si cambió después de la
+ * última vez que se escribió ese slot.
+ */
+static u32 screen_ring_fill_damage(struct screen_ring *ring, struct fb_info *fb,
+                                   u32 line_length, u8 *dst, u64 seq, u64 slot_seq)
+{
+    size_t row_bytes = (size_t)ring->width * ring->bytes_per_pixel;
+    u32 bpp = ring->bytes_per_pixel;
+    bool changed = false;
+    u32 dirty = 0;
+    u32 tx, ty, r;
+
+    memset(ring->dirty_map, 0, ring->dirty_map_size);
+
+    for (ty = 0; ty < ring->tiles_y; ty++) {
+        u32 y0 = ty * ring->tile_size;
+        u32 rows = min(ring->tile_size, ring->height - y0);
+        size_t src_stride;
+        const u8 *src = screen_ring_read_band(ring, fb, line_length, y0, rows, &src_stride);
+
+        for (tx = 0; tx < ring->tiles_x; tx++) {
+            u32 x0 = tx * ring->tile_size;
+            size_t bytes = (size_t)min(ring->tile_size, ring->width - x0) * bpp;
+            u32 tile = ty * ring->tiles_x + tx;
+            u64 hash = screen_ring_hash_tile(ring, src, src_stride, tx, rows);
+
+            /* La primera captura marca todo */
+            if (seq == 1 || hash != ring->tile_hash[tile]) {
+                ring->tile_hash[tile] = hash;
+                ring->tile_seq[tile] = seq;
+                ring->dirty_map[tile / 8] |= 1 << (tile % 8);
+                dirty++;
+            }
+
+            /* El slot solo necesita lo que cambió desde que se escribió */
+            if (ring->tile_seq[tile] > slot_seq) {
+                for (r = 0; r < rows; r++)
+                    memcpy(dst + (size_t)(y0 + r) * row_bytes + (size_t)x0 * bpp,
+                           src + r * src_stride + (size_t)x0 * bpp, bytes);
+            }
+        }
+
+        if (screen_ring_note_row(ring, ty, &ring->tile_hash[ty * ring->tiles_x]))
+            changed = true;
+    }
+
+    if (changed)
+        ring->generation++;
+    return dirty;
+}
+
+static const struct file_operations screen_ring_fops = {
+    .owner   = THIS_MODULE,
+    .mmap    = screen_ring_mmap,
+    .release = screen_ring_release,
+};
+
+SYSCALL_DEFINE2(screen_ring_open, unsigned int, slot_count,
+                struct screen_ring_info __user *, info_user)
+{
+    struct screen_ring_info info_k;
+    struct screen_ring *ring;
+    struct fb_info *fb;
+    int fd;
+    int ret;
+
+    if (!info_user)
+        return -EFAULT;
+
+    if (slot_count < 2 || slot_count > SCREEN_RING_MAX_SLOTS)
+        return -EINVAL;
+
+    if (num_registered_fb < 1 || !registered_fb[0]) {
+        pr_err("screen_ring: no hay framebuffer registrado\n");
+        return -ENODEV;
+    }
+    fb = registered_fb[0];
+
+    if (!fb->screen_base)
+        return -ENOMEM;
+
+    if (copy_from_user(&info_k, info_user, sizeof(info_k)))
+        return -EFAULT;
+
+    ring = kzalloc(sizeof(*ring), GFP_KERNEL);
+    if (!ring)
+        return -ENOMEM;
+
+    mutex_init(&ring->lock);
+    ring->last_sample = jiffies;
+    ring->width = fb->var.xres;
+    ring->height = fb->var.yres;
+    ring->bytes_per_pixel = fb->var.bits_per_pixel / 8;
+    ring->slot_count = slot_count;
+    ring->frame_size = (size_t)ring->width * ring->height * ring->bytes_per_pixel;
+    ring->slot_size = PAGE_ALIGN(ring->frame_size);
+
+    if (ring->frame_size == 0 ||
+        !screen_ring_fits(fb, ring->width, ring->height, ring->bytes_per_pixel,
+                          fb->fix.line_length ? fb->fix.line_length
+                                              : ring->width * ring->bytes_per_pixel)) {
+        kfree(ring);
+        return -EINVAL;
+    }
+
+    /* Memoria reservada una sola vez, mapeable por el usuario */
+    ring->buf = vmalloc_user(ring->slot_count * ring->slot_size);
+    if (!ring->buf) {
+        screen_ring_free(ring);
+        return -ENOMEM;
+    }
+
+    ret = screen_ring_alloc_damage(ring, info_k.tile_size);
+    if (ret) {
+        screen_ring_free(ring);
+        return ret;
+    }
+
+    info_k.width = ring->width;
+    info_k.height = ring->height;
+    info_k.bytes_per_pixel = ring->bytes_per_pixel;
+    info_k.slot_count = ring->slot_count;
+    info_k.slot_size = ring->slot_size;
+    info_k.frame_size = ring->frame_size;
+    info_k.tile_size = ring->tile_size;
+    info_k.tiles_x = ring->tiles_x;
+    info_k.tiles_y = ring->tiles_y;
+    info_k.dirty_map_size = ring->dirty_map_size;
+
+    if (copy_to_user(info_user, &info_k, sizeof(info_k))) {
+        screen_ring_free(ring);
+        return -EFAULT;
+    }
+
+    fd = anon_inode_getfd("[screen_ring]", &screen_ring_fops, ring, O_RDWR | O_CLOEXEC);
+    if (fd < 0) {
+        screen_ring_free(ring);
+        return fd;
+    }
+
+    pr_info("screen_ring: %ux%u bpp=%u, %u slots de %zu bytes\n",
+            ring->width, ring->height, ring->bytes_per_pixel,
+            ring->slot_count, ring->slot_size);
+    return fd;
+}
+
+SYSCALL_DEFINE2(screen_ring_capture, int, ring_fd,
+                struct screen_ring_frame __user *, frame_user)
+{
+    struct screen_ring_frame frame_k;
+    struct screen_ring *ring;
+    struct fb_info *fb;
+    struct fd f;
+    size_t row_bytes;
+    u32 line_length;
+    u8 *dst;
+    u32 y;
+    int ret = 0;
+
+    if (!frame_user)
+        return -EFAULT;
+
+    if (copy_from_user(&frame_k, frame_user, sizeof(frame_k)))
+        return -EFAULT;
+
+    f = fdget(ring_fd);
+    if (!fd_file(f))
+        return -EBADF;
+
+    if (fd_file(f)->f_op != &screen_ring_fops) {
+        ret = -EINVAL;
+        goto out_fd;
+    }
+    ring = fd_file(f)->private_data;
+
+    if (num_registered_fb < 1 || !registered_fb[0]) {
+        ret = -ENODEV;
+        goto out_fd;
+    }
+    fb = registered_fb[0];
+
+    /* Si cambió la resolución el anillo ya no sirve: el usuario lo vuelve a abrir */
+    if (fb->var.xres != ring->width || fb->var.yres != ring->height ||
+        fb->var.bits_per_pixel / 8 != ring->bytes_per_pixel) {
+        ret = -ESTALE;
+        goto out_fd;
+    }
+
+    /* line_length o smem_len pueden cambiar sin cambiar la resolución */
+    row_bytes = (size_t)ring->width * ring->bytes_per_pixel;
+    line_length = fb->fix.line_length ? fb->fix.line_length : row_bytes;
+    if (!screen_ring_fits(fb, ring->width, ring->height, ring->bytes_per_pixel, line_length)) {
+        ret = -EINVAL;
+        goto out_fd;
+    }
+
+    if (fb->fbops && fb->fbops->fb_sync)
+        fb->fbops->fb_sync(fb);
+
+    mutex_lock(&ring->lock);
+
+    frame_k.slot = ring->sequence % ring->slot_count;
+    dst = (u8 *)ring->buf + (size_t)frame_k.slot * ring->slot_size;
+
+    /* Copia directa del framebuffer al slot; fila por fila si hay padding */
+    frame_k.dirty_tiles = 0;
+
+    /* screen_base y screen_buffer comparten union: FBINFO_VIRTFB indica RAM */
+    if (ring->tile_size) {
+        frame_k.dirty_tiles = screen_ring_fill_damage(ring, fb, line_length, dst,
+                                                      ring->sequence + 1,
+                                                      ring->slot_seq[frame_k.slot]);
+        ring->slot_seq[frame_k.slot] = ring->sequence + 1;
+        ring->last_sample = jiffies;
+    } else if (line_length == row_bytes) {
+        if (fb->flags & FBINFO_VIRTFB)
+            memcpy(dst, fb->screen_buffer, ring->frame_size);
+        else
+            memcpy_fromio(dst, fb->screen_base, ring->frame_size);
+    } else {
+        for (y = 0; y < ring->height; y++) {
+            if (fb->flags & FBINFO_VIRTFB)
+                memcpy(dst + y * row_bytes,
+                       fb->screen_buffer + (size_t)y * line_length, row_bytes);
+            else
+                memcpy_fromio(dst + y * row_bytes,
+                              fb->screen_base + (size_t)y * line_length, row_bytes);
+        }
+    }
+
+    frame_k.sequence = ++ring->sequence;
+    frame_k.generation = ring->generation;
+
+    /* Bitmap de daño (copiado con el lock: otra captura lo sobrescribiría) */
+    if (ring->tile_size && frame_k.dirty_map) {
+        if (frame_k.dirty_map_size < ring->dirty_map_size)
+            ret = -ENOSPC;
+        else if (copy_to_user(frame_k.dirty_map, ring->dirty_map, ring->dirty_map_size))
+            ret = -EFAULT;
+    }
+
+    mutex_unlock(&ring->lock);
+
+    frame_k.width = ring->width;
+    frame_k.height = ring->height;
+    frame_k.bytes_per_pixel = ring->bytes_per_pixel;
+    frame_k.frame_size = ring->frame_size;
+
+    if (copy_to_user(frame_user, &frame_k, sizeof(frame_k)))
+        ret = -EFAULT;
+
+out_fd:
+    fdput(f);
+    return ret;
+}
+
+/*
+ * screen_ring_wait - Espera a que cambie la pantalla
+ *
+ * Bloquea hasta que la generación supere wait.generation o venza
+ * wait.timeout_ms. Requiere seguimiento de daño (tile_size > 0). Muestrea
+ * cada wait.interval_ms contados desde la última observación del anillo y
+ * duerme sin el lock entre muestreos.
+ *
+ * Return: 0 si cambió, -ETIMEDOUT si venció el timeout, -EINTR si llegó
+ * una señal, -ESTALE si cambió la resolución, -EINVAL si la pantalla ya no
+ * entra en fix.smem_len. En todos los casos
+ * wait.generation queda con la generación actual.
+ */
+SYSCALL_DEFINE2(screen_ring_wait, int, ring_fd,
+                struct screen_ring_wait __user *, wait_user)
+{
+    struct screen_ring_wait wait_k;
+    struct screen_ring *ring;
+    struct fb_info *fb;
+    unsigned long deadline;
+    unsigned long next;
+    unsigned long wake;
+    u32 interval_ms;
+    u32 line_length;
+    u64 after;
+    struct fd f;
+    int ret = 0;
+
+    if (!wait_user)
+        return -EFAULT;
+
+    if (copy_from_user(&wait_k, wait_user, sizeof(wait_k)))
+        return -EFAULT;
+
+    f = fdget(ring_fd);
+    if (!fd_file(f))
+        return -EBADF;
+
+    if (fd_file(f)->f_op != &screen_ring_fops) {
+        ret = -EINVAL;
+        goto out_fd;
+    }
+    ring = fd_file(f)->private_data;
+
+    if (!ring->tile_size) {
+        ret = -EINVAL;
+        goto out_fd;
+    }
+
+    after = wait_k.generation;
+    interval_ms = wait_k.interval_ms ? min_t(u32, wait_k.interval_ms, SCREEN_RING_MAX_SAMPLE_MS)
+                                     : SCREEN_RING_SAMPLE_MS;
+    deadline = jiffies + msecs_to_jiffies(wait_k.timeout_ms);
+
+    for (;;) {
+        if (num_registered_fb < 1 || !registered_fb[0]) {
+            ret = -ENODEV;
+            break;
+        }
+        fb = registered_fb[0];
+
+        if (fb->var.xres != ring->width || fb->var.yres != ring->height ||
+            fb->var.bits_per_pixel / 8 != ring->bytes_per_pixel) {
+            ret = -ESTALE;
+            break;
+        }
+        line_length = fb->fix.line_length ? fb->fix.line_length
+                                          : ring->width * ring->bytes_per_pixel;
+        if (!screen_ring_fits(fb, ring->width, ring->height, ring->bytes_per_pixel,
+                              line_length)) {
+            ret = -EINVAL;
+            break;
+        }
+
+        /* Solo si pasó el intervalo desde la última captura o muestreo */
+        next = READ_ONCE(ring->last_sample) + msecs_to_jiffies(interval_ms);
+        if (!time_before(jiffies, next)) {
+            ret = screen_ring_scan(ring, fb, line_length, after);
+            if (ret)
+                break;
+            next = jiffies + msecs_to_jiffies(interval_ms);
+        }
+
+        /* Otra captura o espera pudo haber visto el cambio ya */
+        if (mutex_lock_interruptible(&ring->lock)) {
+            ret = -EINTR;
+            break;
+        }
+        wait_k.generation = ring->generation;
+        mutex_unlock(&ring->lock);
+
+        if (wait_k.generation > after)
+            break;
+
+        if (time_after_eq(jiffies, deadline)) {
+            ret = -ETIMEDOUT;
+            break;
+        }
+
+        wake = time_before(next, deadline) ? next : deadline;
+        if (time_after(wake, jiffies) &&
+            msleep_interruptible(jiffies_to_msecs(wake - jiffies))) {
+            ret = -EINTR;
+            break;
+        }
+    }
+
+    if (copy_to_user(wait_user, &wait_k, sizeof(wait_k)))
+        ret = -EFAULT;
+
+out_fd:
+    fdput(f);
+    return ret;
+}
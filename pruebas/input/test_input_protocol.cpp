@@ -0,0 +1,71 @@
+/*
+ * Prueba: mensajes binarios de entrada del WebSocket (Utils::InputMessage)
+ *
+ * Compilar (desde pruebas/input):
+ *   g++ -O2 -std=c++17 -I../../backend/include test_input_protocol.cpp \
+ *       ../../backend/src/utils/input_protocol.cpp -o test_input_protocol
+ *
+ * Comprueba la lectura little-endian de varios mensajes seguidos (con
+ * coordenadas negativas) y que un tamaño que no es múltiplo de 12 o un tipo
+ * desconocido rechazan el mensaje entero sin agregar nada. Retorna 0 si
+ * todo pasa.
+ */
+#include "utils/input_protocol.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using Utils::InputMessage;
+using Utils::InputType;
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    std::printf(" %s %s\n", ok ? "OK  " : "FALLA", what);
+    if (!ok) {
+        failures++;
+    }
+}
+
+// Codifica un mensaje como lo hace el frontend (DataView little-endian)
+static void append(std::string& out, uint8_t type, uint16_t code, uint32_t seq, int16_t x, int16_t y) {
+    const unsigned char bytes[] = {
+        type, 0,
+        static_cast<unsigned char>(code & 0xFF), static_cast<unsigned char>(code >> 8),
+        static_cast<unsigned char>(seq & 0xFF), static_cast<unsigned char>((seq >> 8) & 0xFF),
+        static_cast<unsigned char>((seq >> 16) & 0xFF), static_cast<unsigned char>(seq >> 24),
+        static_cast<unsigned char>(static_cast<uint16_t>(x) & 0xFF), static_cast<unsigned char>(static_cast<uint16_t>(x) >> 8),
+        static_cast<unsigned char>(static_cast<uint16_t>(y) & 0xFF), static_cast<unsigned char>(static_cast<uint16_t>(y) >> 8),
+    };
+    out.append(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+}
+
+int main() {
+    std::string data;
+    append(data, 2, 1, 0x01020304, 640, 400);
+    append(data, 4, 0x2A0, 7, 0, 0);
+    append(data, 6, 0, 8, -2, 3);
+
+    std::vector<InputMessage> messages;
+    bool ok = Utils::parseInputMessages(data, messages);
+    check(ok && messages.size() == 3, "tres mensajes en un mismo mensaje binario");
+    check(ok && messages[0].type == InputType::BUTTON_DOWN && messages[0].code == 1 &&
+          messages[0].seq == 0x01020304 && messages[0].x == 640 && messages[0].y == 400,
+          "botón: código, seq y posición");
+    check(ok && messages[1].type == InputType::KEY_DOWN && messages[1].code == 0x2A0 && messages[1].seq == 7,
+          "tecla con keycode de 16 bits");
+    check(ok && messages[2].type == InputType::WHEEL && messages[2].x == -2 && messages[2].y == 3,
+          "rueda con pasos negativos");
+
+    std::vector<InputMessage> rejected;
+    check(!Utils::parseInputMessages(data.substr(0, 20), rejected) && rejected.empty(),
+          "tamaño que no es múltiplo de 12: se rechaza");
+    std::string unknown = data;
+    append(unknown, 9, 0, 9, 0, 0);
+    check(!Utils::parseInputMessages(unknown, rejected) && rejected.empty(),
+          "tipo desconocido: se rechaza el mensaje entero");
+    check(!Utils::parseInputMessages(std::string(), rejected), "mensaje vacío: se rechaza");
+
+    std::printf(" %s\n", failures == 0 ? "Todas las pruebas pasaron" : "Hay pruebas fallidas");
+    return failures == 0 ? 0 : 1;
+}
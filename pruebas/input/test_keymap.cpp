@@ -0,0 +1,88 @@
+/*
+ * Prueba: tablas de teclado para escribir texto (Utils::keyStroke)
+ *
+ * Compilar (desde pruebas/input):
+ *   g++ -O2 -std=c++17 -I../../backend/include test_keymap.cpp \
+ *       ../../backend/src/utils/keymap.cpp -o test_keymap
+ *
+ * Comprueba que todo el ASCII imprimible se puede escribir en las tres
+ * distribuciones, las modificadoras de mayúsculas y símbolos, las teclas
+ * muertas de los acentos y la lectura UTF-8 (Latin-1 sí, el resto se
+ * salta). Retorna 0 si todo pasa.
+ */
+#include "utils/keymap.h"
+#include <cstdio>
+#include <linux/input-event-codes.h>
+#include <string>
+
+using Utils::KeyboardLayout;
+using Utils::KeyStroke;
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    std::printf(" %s %s\n", ok ? "OK  " : "FALLA", what);
+    if (!ok) {
+        failures++;
+    }
+}
+
+static bool is(KeyboardLayout layout, unsigned char c, int keycode, int modifiers,
+               int dead_keycode = 0, int dead_modifiers = 0) {
+    const KeyStroke& stroke = Utils::keyStroke(layout, c);
+    return stroke.keycode == keycode && stroke.modifiers == modifiers &&
+           stroke.dead_keycode == dead_keycode && stroke.dead_modifiers == dead_modifiers;
+}
+
+int main() {
+    const KeyboardLayout layouts[] = {KeyboardLayout::US, KeyboardLayout::ES, KeyboardLayout::LATAM};
+    for (KeyboardLayout layout : layouts) {
+        int missing = 0;
+        for (int c = 0x20; c < 0x7F; c++) {
+            if (Utils::keyStroke(layout, static_cast<unsigned char>(c)).keycode == 0) {
+                std::printf("      %s: falta '%c'\n", Utils::keyboardLayoutName(layout), c);
+                missing++;
+            }
+        }
+        std::string what = std::string("ASCII imprimible completo en ") + Utils::keyboardLayoutName(layout);
+        check(missing == 0, what.c_str());
+    }
+
+    check(is(KeyboardLayout::US, 'a', KEY_A, 0) && is(KeyboardLayout::US, 'A', KEY_A, Utils::KEY_MOD_SHIFT),
+          "us: mayúscula con Shift");
+    check(is(KeyboardLayout::US, '@', KEY_2, Utils::KEY_MOD_SHIFT) && is(KeyboardLayout::US, '~', KEY_GRAVE, Utils::KEY_MOD_SHIFT),
+          "us: símbolos con Shift");
+    check(is(KeyboardLayout::ES, '@', KEY_2, Utils::KEY_MOD_ALTGR) && is(KeyboardLayout::LATAM, '@', KEY_Q, Utils::KEY_MOD_ALTGR),
+          "es/latam: @ con AltGr");
+    check(is(KeyboardLayout::ES, 0xF1, KEY_SEMICOLON, 0) && is(KeyboardLayout::LATAM, 0xD1, KEY_SEMICOLON, Utils::KEY_MOD_SHIFT),
+          "es/latam: ñ y Ñ");
+    check(is(KeyboardLayout::ES, 0xE1, KEY_A, 0, KEY_APOSTROPHE, 0) &&
+          is(KeyboardLayout::LATAM, 0xC9, KEY_E, Utils::KEY_MOD_SHIFT, KEY_LEFTBRACE, 0),
+          "es/latam: á y É con tecla muerta");
+    check(is(KeyboardLayout::LATAM, 0xFC, KEY_U, 0, KEY_LEFTBRACE, Utils::KEY_MOD_SHIFT),
+          "latam: ü con diéresis (Shift + tecla muerta)");
+    check(Utils::keyStroke(KeyboardLayout::US, 0xE1).keycode == 0, "us: á no se puede escribir");
+
+    KeyboardLayout parsed = KeyboardLayout::US;
+    check(Utils::parseKeyboardLayout("latam", parsed) && parsed == KeyboardLayout::LATAM &&
+          !Utils::parseKeyboardLayout("dvorak", parsed) && parsed == KeyboardLayout::LATAM,
+          "nombres de distribución");
+
+    // "añ€b" + byte suelto: € (3 bytes) y el byte inválido se saltan
+    std::string text = "a\xC3\xB1\xE2\x82\xAC" "b\x80";
+    std::string read;
+    size_t offset = 0;
+    unsigned char c = 0;
+    int skipped = 0;
+    while (offset < text.size()) {
+        if (Utils::nextLatin1(text, offset, c)) {
+            read.push_back(static_cast<char>(c));
+        } else {
+            skipped++;
+        }
+    }
+    check(read == "a\xF1" "b" && skipped == 2, "UTF-8: Latin-1 se lee, lo demás se salta");
+
+    std::printf(" %s\n", failures == 0 ? "Todas las pruebas pasaron" : "Hay pruebas fallidas");
+    return failures == 0 ? 0 : 1;
+}
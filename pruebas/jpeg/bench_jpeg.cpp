@@ -0,0 +1,145 @@
+/*
+ * Benchmark: encoder JPEG en memoria vs. ruta anterior con ImageMagick
+ *
+ * Compilar (desde pruebas/jpeg):
+ *   g++ -O2 -std=c++17 -pthread -I../../backend/include bench_jpeg.cpp \
+ *       ../../backend/src/utils/jpeg_encoder.cpp \
+ *       ../../backend/src/utils/pixel_kernels.cpp \
+ *       ../../backend/src/utils/thread_pool.cpp -o bench_jpeg
+ *
+ * Uso:
+ *   ./bench_jpeg [frame.raw] [iteraciones] [calidad] [444|422|420]
+ *
+ * Si se pasa un archivo .raw (BGRA 1280x800, por ejemplo el que dejaba
+ * /tmp/screen.raw) se usa como frame; si no, se genera un escritorio
+ * sintético con ventanas, texto y un degradado.
+ */
+#include "utils/jpeg_encoder.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+static const int WIDTH = 1280;
+static const int HEIGHT = 800;
+
+static void syntheticDesktop(std::vector<unsigned char>& frame) {
+    frame.resize(WIDTH * HEIGHT * 4);
+    for (int y = 0; y < HEIGHT; y++) {
+        for (int x = 0; x < WIDTH; x++) {
+            unsigned char* px = &frame[(y * WIDTH + x) * 4];
+            // Fondo degradado
+            px[0] = static_cast<unsigned char>(120 + y / 8);
+            px[1] = static_cast<unsigned char>(60 + x / 12);
+            px[2] = static_cast<unsigned char>(40);
+            px[3] = 255;
+            // Ventana clara con "texto" (patrón de alta frecuencia)
+            if (x > 100 && x < 900 && y > 80 && y < 600) {
+                bool glyph = ((x / 2) % 7 < 4) && ((y / 3) % 6 < 3) && (y % 18 < 12);
+                unsigned char v = glyph ? 20 : 245;
+                px[0] = px[1] = px[2] = v;
+            }
+            // Barra de tareas
+            if (y > HEIGHT - 40) {
+                px[0] = 50; px[1] = 45; px[2] = 40;
+            }
+        }
+    }
+}
+
+static bool loadRaw(const char* path, std::vector<unsigned char>& frame) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) return false;
+    size_t size = file.tellg();
+    if (size < static_cast<size_t>(WIDTH * HEIGHT * 4)) return false;
+    frame.resize(size);
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(frame.data()), size);
+    return true;
+}
+
+// Ruta anterior de Syscalls::convertToJPEG: archivo temporal + convert + lectura
+static bool imagemagickEncode(const std::vector<unsigned char>& frame,
+                              std::vector<unsigned char>& jpeg) {
+    const char* raw_path = "/tmp/bench_screen.raw";
+    const char* jpeg_path = "/tmp/bench_screen.jpeg";
+
+    std::ofstream raw_file(raw_path, std::ios::binary);
+    raw_file.write(reinterpret_cast<const char*>(frame.data()), WIDTH * HEIGHT * 4);
+    raw_file.close();
+
+    std::string command = "convert -size " + std::to_string(WIDTH) + "x" +
+                          std::to_string(HEIGHT) + " -depth 8 bgra:" + raw_path +
+                          " " + jpeg_path + " 2>/dev/null";
+    if (system(command.c_str()) != 0) return false;
+
+    std::ifstream jpeg_file(jpeg_path, std::ios::binary | std::ios::ate);
+    if (!jpeg_file) return false;
+    size_t size = jpeg_file.tellg();
+    jpeg_file.seekg(0);
+    jpeg.resize(size);
+    jpeg_file.read(reinterpret_cast<char*>(jpeg.data()), size);
+
+    std::remove(raw_path);
+    std::remove(jpeg_path);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    std::vector<unsigned char> frame;
+    if (argc > 1 && std::string(argv[1]) != "-") {
+        if (!loadRaw(argv[1], frame)) {
+            fprintf(stderr, "No se pudo leer %s\n", argv[1]);
+            return 1;
+        }
+    } else {
+        syntheticDesktop(frame);
+    }
+
+    int iterations = argc > 2 ? atoi(argv[2]) : 50;
+    Utils::JpegOptions options;
+    if (argc > 3) options.quality = atoi(argv[3]);
+    if (argc > 4) options.subsampling = static_cast<Utils::ChromaSubsampling>(atoi(argv[4]));
+
+    Utils::JpegEncoder encoder(options);
+    std::vector<unsigned char> jpeg;
+
+    // Calentamiento (reserva de buffers)
+    encoder.encode(frame.data(), WIDTH, HEIGHT, WIDTH * 4, jpeg);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        encoder.encode(frame.data(), WIDTH, HEIGHT, WIDTH * 4, jpeg);
+    }
+    double ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count() / iterations;
+
+    printf("En memoria   : %8.2f ms/frame  %8zu bytes  (q=%d, %d)\n",
+           ms, jpeg.size(), options.quality, static_cast<int>(options.subsampling));
+
+    FILE* out = fopen("bench_jpeg.jpg", "wb");
+    if (out) {
+        fwrite(jpeg.data(), 1, jpeg.size(), out);
+        fclose(out);
+    }
+
+    std::vector<unsigned char> legacy;
+    int legacy_iterations = iterations < 10 ? iterations : 10;
+    start = std::chrono::steady_clock::now();
+    bool ok = true;
+    for (int i = 0; i < legacy_iterations && ok; i++) {
+        ok = imagemagickEncode(frame, legacy);
+    }
+    if (!ok) {
+        printf("ImageMagick  : no disponible (se omite la comparación)\n");
+        return 0;
+    }
+    double legacy_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count() / legacy_iterations;
+
+    printf("ImageMagick  : %8.2f ms/frame  %8zu bytes\n", legacy_ms, legacy.size());
+    printf("Aceleración  : %8.1fx\n", legacy_ms / ms);
+    return 0;
+}
@@ -0,0 +1,116 @@
+/*
+ * Benchmark: escalado del encoder JPEG por franjas con 1 a N threads
+ *
+ * Compilar (desde pruebas/jpeg):
+ *   g++ -O2 -std=c++17 -pthread -I../../backend/include bench_jpeg_threads.cpp \
+ *       ../../backend/src/utils/jpeg_encoder.cpp \
+ *       ../../backend/src/utils/pixel_kernels.cpp \
+ *       ../../backend/src/utils/thread_pool.cpp -o bench_jpeg_threads
+ *
+ * Uso:
+ *   ./bench_jpeg_threads [ancho] [alto] [max_threads] [iteraciones] [restart_rows]
+ *
+ * Codifica un escritorio sintético (por defecto 1280x800; 3840x1080 simula
+ * tres monitores) con 1, 2, 4, ... hasta max_threads (por defecto todos los
+ * núcleos). Verifica que el JPEG sea idéntico byte a byte al de 1 thread y
+ * muestra ms/frame y aceleración. Retorna 1 si algún resultado difiere.
+ */
+#include "utils/jpeg_encoder.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+static void syntheticDesktop(std::vector<unsigned char>& frame, int width, int height) {
+    frame.resize(static_cast<size_t>(width) * height * 4);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            unsigned char* px = &frame[(static_cast<size_t>(y) * width + x) * 4];
+            // Fondo degradado
+            px[0] = static_cast<unsigned char>(120 + y / 8);
+            px[1] = static_cast<unsigned char>(60 + x / 12);
+            px[2] = static_cast<unsigned char>(40);
+            px[3] = 255;
+            // Ventana clara con "texto" (patrón de alta frecuencia)
+            if (x > 100 && x < 900 && y > 80 && y < 600) {
+                bool glyph = ((x / 2) % 7 < 4) && ((y / 3) % 6 < 3) && (y % 18 < 12);
+                unsigned char v = glyph ? 20 : 245;
+                px[0] = px[1] = px[2] = v;
+            }
+            // Barra de tareas
+            if (y > height - 40) {
+                px[0] = 50; px[1] = 45; px[2] = 40;
+            }
+        }
+    }
+}
+
+static double measure(Utils::JpegEncoder& encoder, const std::vector<unsigned char>& frame,
+                      int width, int height, int iterations, std::vector<unsigned char>& jpeg) {
+    // Calentamiento (buffers y threads del pool)
+    encoder.encode(frame.data(), width, height, width * 4, jpeg);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        encoder.encode(frame.data(), width, height, width * 4, jpeg);
+    }
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+int main(int argc, char** argv) {
+    int width = argc > 1 ? atoi(argv[1]) : 1280;
+    int height = argc > 2 ? atoi(argv[2]) : 800;
+    int max_threads = argc > 3 ? atoi(argv[3]) : static_cast<int>(std::thread::hardware_concurrency());
+    int iterations = argc > 4 ? atoi(argv[4]) : 30;
+    if (max_threads < 1) max_threads = 1;
+
+    std::vector<unsigned char> frame;
+    syntheticDesktop(frame, width, height);
+
+    Utils::JpegOptions options;
+    if (argc > 5) options.restart_rows = atoi(argv[5]);
+
+    // Referencia: sin franjas (un solo scan, como antes)
+    Utils::JpegOptions plain = options;
+    plain.restart_rows = 0;
+    plain.threads = 1;
+    Utils::JpegEncoder plain_encoder(plain);
+    std::vector<unsigned char> plain_jpeg;
+    double plain_ms = measure(plain_encoder, frame, width, height, iterations, plain_jpeg);
+
+    printf("%dx%d, restart_rows=%d, q=%d, %d\n", width, height, options.restart_rows,
+           options.quality, static_cast<int>(options.subsampling));
+    printf("sin franjas : %8.2f ms/frame  %8zu bytes\n", plain_ms, plain_jpeg.size());
+
+    std::vector<unsigned char> reference;
+    double base_ms = 0.0;
+    bool identical = true;
+
+    // 1, 2, 4, ... y siempre max_threads al final
+    std::vector<int> counts;
+    for (int threads = 1; threads < max_threads; threads *= 2) {
+        counts.push_back(threads);
+    }
+    counts.push_back(max_threads);
+
+    for (int threads : counts) {
+        options.threads = threads;
+        Utils::JpegEncoder encoder(options);
+        std::vector<unsigned char> jpeg;
+        double ms = measure(encoder, frame, width, height, iterations, jpeg);
+
+        if (threads == 1) {
+            reference = jpeg;
+            base_ms = ms;
+        }
+        bool same = (jpeg == reference);
+        identical = identical && same;
+
+        printf("%3d threads : %8.2f ms/frame  %8zu bytes  x%.2f  %s\n", threads, ms,
+               jpeg.size(), base_ms / ms, same ? "idéntico" : "DISTINTO");
+    }
+
+    return identical ? 0 : 1;
+}
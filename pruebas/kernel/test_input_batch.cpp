@@ -0,0 +1,127 @@
+/*
+ * Prueba: entrada por lotes (syscall 564, input_batch)
+ *
+ * Compilar (desde pruebas/kernel):
+ *   g++ -O2 -std=c++17 -I../../backend/include test_input_batch.cpp -o test_input_batch
+ *
+ * Ejecutar en una VM con el kernel modificado:
+ *   sudo ./test_input_batch
+ *
+ * Comprueba que un lote con cualquier evento inválido o con más de 1 s de
+ * esperas se rechaza entero (EINVAL) y uno demasiado grande con E2BIG, que
+ * un lote válido devuelve la cantidad de eventos, que una posición fuera de
+ * la pantalla se recorta, que INPUT_BATCH_DELAY espera en el kernel (y una
+ * señal la corta) y cuánto cuesta un lote de 100 pulsaciones (solo Shift,
+ * para no escribir en la terminal). Mueve el cursor a (10, 10). Retorna 0
+ * si todo pasa.
+ */
+#include "types.h"
+#include "syscalls.h"
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <csignal>
+#include <cstring>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+static const uint16_t KEY_LEFTSHIFT_CODE = 42;
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    std::printf(" %s %s\n", ok ? "OK  " : "FALLA", what);
+    if (!ok) {
+        failures++;
+    }
+}
+
+static input_batch_event event(uint16_t type, uint16_t code = 0, int32_t x = 0, int32_t y = 0) {
+    input_batch_event ev;
+    ev.type = type;
+    ev.code = code;
+    ev.x = x;
+    ev.y = y;
+    return ev;
+}
+
+static long submit(const std::vector<input_batch_event>& events) {
+    return syscall(SYS_INPUT_BATCH, events.data(), events.size());
+}
+
+static bool rejected(const std::vector<input_batch_event>& events, int error) {
+    return submit(events) == -1 && errno == error;
+}
+
+int main() {
+    std::vector<input_batch_event> empty;
+    if (submit(empty) != 0) {
+        std::printf(" input_batch: %s\n", std::strerror(errno));
+        return 1;
+    }
+
+    // Validación: el evento inválido va al final, así nada se aplica antes de rechazarlo
+    std::vector<input_batch_event> events = {event(INPUT_BATCH_MOVE, 0, 10, 10), event(INPUT_BATCH_SYNC)};
+    events.push_back(event(99));
+    check(rejected(events, EINVAL), "tipo desconocido: EINVAL");
+    events.back() = event(INPUT_BATCH_BUTTON_DOWN, 4);
+    check(rejected(events, EINVAL), "botón inexistente: EINVAL");
+    events.back() = event(INPUT_BATCH_KEY_DOWN, 0x110);
+    check(rejected(events, EINVAL), "un botón (BTN_LEFT) como tecla: EINVAL");
+    events.back() = event(INPUT_BATCH_DELAY, 0, 2000000);
+    check(rejected(events, EINVAL), "espera de más de 1 s: EINVAL");
+    events.back() = event(INPUT_BATCH_DELAY, 0, 600000);
+    events.push_back(event(INPUT_BATCH_DELAY, 0, 600000));
+    check(rejected(events, EINVAL), "esperas que suman más de 1 s: EINVAL");
+    events.pop_back();
+
+    std::vector<input_batch_event> huge(Config::INPUT_BATCH_MAX_EVENTS + 1, event(INPUT_BATCH_SYNC));
+    check(rejected(huge, E2BIG), "más de INPUT_BATCH_MAX_EVENTS eventos: E2BIG");
+
+    events.pop_back();
+    check(submit(events) == 2, "movimiento válido: devuelve la cantidad de eventos");
+
+    // Fuera de la pantalla se recorta al borde en lugar de rechazar el lote
+    std::vector<input_batch_event> outside = {event(INPUT_BATCH_MOVE, 0, 100000, -5),
+                                              event(INPUT_BATCH_MOVE, 0, 10, 10)};
+    check(submit(outside) == 2, "movimiento fuera de la pantalla: se recorta");
+
+    // La espera ocurre dentro de la syscall
+    std::vector<input_batch_event> wait = {event(INPUT_BATCH_DELAY, 0, 20000)};
+    auto start = std::chrono::steady_clock::now();
+    long result = submit(wait);
+    auto waited = std::chrono::steady_clock::now() - start;
+    check(result == 1 && waited >= std::chrono::milliseconds(20), "INPUT_BATCH_DELAY espera 20 ms");
+
+    // Una señal corta la espera (sin SA_RESTART la syscall devuelve EINTR)
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = [](int) {};
+    sigaction(SIGALRM, &action, nullptr);
+    wait = {event(INPUT_BATCH_DELAY, 0, 900000)};
+    start = std::chrono::steady_clock::now();
+    ualarm(50000, 0);
+    bool interrupted = rejected(wait, EINTR);
+    waited = std::chrono::steady_clock::now() - start;
+    check(interrupted && waited < std::chrono::milliseconds(500), "una señal corta INPUT_BATCH_DELAY: EINTR");
+
+    // 100 pulsaciones (presionar y soltar en grupos distintos) en una sola syscall
+    std::vector<input_batch_event> taps;
+    for (int i = 0; i < 100; i++) {
+        taps.push_back(event(INPUT_BATCH_KEY_DOWN, KEY_LEFTSHIFT_CODE));
+        taps.push_back(event(INPUT_BATCH_SYNC));
+        taps.push_back(event(INPUT_BATCH_KEY_UP, KEY_LEFTSHIFT_CODE));
+        taps.push_back(event(INPUT_BATCH_SYNC));
+    }
+    start = std::chrono::steady_clock::now();
+    result = submit(taps);
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    check(result == 400, "100 pulsaciones en una syscall");
+    std::printf("      %lld us (keyboard_caption: 100 syscalls de al menos 50 ms)\n",
+                static_cast<long long>(elapsed));
+
+    std::printf(" %s\n", failures == 0 ? "Todas las pruebas pasaron" : "Hay pruebas fallidas");
+    return failures == 0 ? 0 : 1;
+}
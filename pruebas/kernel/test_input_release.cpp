@@ -0,0 +1,139 @@
+/*
+ * Prueba: keyup diferido de keyboard_caption (syscall 559)
+ *
+ * Compilar (desde pruebas/kernel):
+ *   g++ -O2 -std=c++17 -I../../backend/include test_input_release.cpp -o test_input_release -pthread
+ *
+ * Ejecutar en una VM con el kernel modificado:
+ *   sudo ./test_input_release
+ *
+ * Comprueba que la syscall vuelve sin esperar los 50 ms de pulsación, que
+ * 8 llamadas concurrentes no se encolan detrás de esa pausa y, leyendo el
+ * dispositivo virtual por evdev, que las teclas se sueltan en el orden en
+ * que se presionaron y que repetir una tecla pendiente la suelta antes.
+ * Solo usa Shift y Ctrl, para no escribir en la terminal. Retorna 0 si
+ * todo pasa.
+ */
+#include "syscalls.h"
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <string>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    std::printf(" %s %s\n", ok ? "OK  " : "FALLA", what);
+    if (!ok) {
+        failures++;
+    }
+}
+
+static long pressKey(int keycode) {
+    return syscall(SYS_KEYBOARD_CAPTION, keycode);
+}
+
+static long long elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+// Abre el /dev/input/eventN del teclado virtual de keyboard_caption
+static int openVirtualKeyboard() {
+    DIR* dir = opendir("/dev/input");
+    if (!dir) {
+        return -1;
+    }
+    int found = -1;
+    while (dirent* entry = readdir(dir)) {
+        if (std::strncmp(entry->d_name, "event", 5) != 0) {
+            continue;
+        }
+        std::string path = std::string("/dev/input/") + entry->d_name;
+        int fd = open(path.c_str(), O_RDONLY);
+        char name[128] = {0};
+        if (fd >= 0 && ioctl(fd, EVIOCGNAME(sizeof(name) - 1), name) >= 0 &&
+            std::strcmp(name, "Virtual Keyboard Caption") == 0) {
+            found = fd;
+            break;
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+    closedir(dir);
+    return found;
+}
+
+// Lee las transiciones de teclas (código con signo: + presionada, - soltada)
+static std::vector<int> readKeys(int fd, size_t expected) {
+    std::vector<int> keys;
+    auto start = std::chrono::steady_clock::now();
+    while (keys.size() < expected && elapsedMs(start) < 1000) {
+        input_event ev;
+        if (read(fd, &ev, sizeof(ev)) == static_cast<ssize_t>(sizeof(ev)) && ev.type == EV_KEY) {
+            keys.push_back(ev.value ? ev.code : -static_cast<int>(ev.code));
+        }
+    }
+    return keys;
+}
+
+int main() {
+    // La primera llamada crea el dispositivo
+    if (pressKey(KEY_LEFTSHIFT) != 0) {
+        std::printf(" keyboard_caption: %s\n", std::strerror(errno));
+        return 1;
+    }
+    usleep(100000);
+
+    auto start = std::chrono::steady_clock::now();
+    long result = pressKey(KEY_LEFTSHIFT);
+    long long single = elapsedMs(start);
+    check(result == 0 && single < 20, "la syscall vuelve sin esperar el keyup");
+
+    usleep(100000);
+    start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; i++) {
+        threads.emplace_back([i]() { pressKey(i % 2 ? KEY_LEFTSHIFT : KEY_LEFTCTRL); });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    long long concurrent = elapsedMs(start);
+    check(concurrent < 100, "8 llamadas concurrentes no se encolan detrás de la pausa");
+    std::printf("      1 llamada: %lld ms, 8 concurrentes: %lld ms (antes: >= 50 y >= 400)\n",
+                single, concurrent);
+    usleep(200000);
+
+    int fd = openVirtualKeyboard();
+    if (fd < 0) {
+        std::printf(" No se encontró el dispositivo \"Virtual Keyboard Caption\"\n");
+        return 1;
+    }
+
+    pressKey(KEY_LEFTSHIFT);
+    pressKey(KEY_LEFTCTRL);
+    std::vector<int> keys = readKeys(fd, 4);
+    check(keys == std::vector<int>({KEY_LEFTSHIFT, KEY_LEFTCTRL, -KEY_LEFTSHIFT, -KEY_LEFTCTRL}),
+          "las teclas se sueltan en el orden en que se presionaron");
+
+    pressKey(KEY_LEFTSHIFT);
+    pressKey(KEY_LEFTSHIFT);
+    keys = readKeys(fd, 4);
+    check(keys == std::vector<int>({KEY_LEFTSHIFT, -KEY_LEFTSHIFT, KEY_LEFTSHIFT, -KEY_LEFTSHIFT}),
+          "repetir una tecla pendiente la suelta antes de presionarla");
+    close(fd);
+
+    std::printf(" %s\n", failures == 0 ? "Todas las pruebas pasaron" : "Hay pruebas fallidas");
+    return failures == 0 ? 0 : 1;
+}
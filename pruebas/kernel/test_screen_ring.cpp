@@ -0,0 +1,159 @@
+/*
+ * Prueba: bitmap de daño y espera de cambios de screen_ring (syscalls 561-563)
+ *
+ * Compilar (desde pruebas/kernel):
+ *   g++ -O2 -std=c++17 -I../../backend/include test_screen_ring.cpp -o test_screen_ring
+ *
+ * Ejecutar en una VM con el kernel modificado y un framebuffer (vfb o vkms):
+ *   sudo ./test_screen_ring /dev/fb0
+ *
+ * Comprueba que la primera captura marca todos los tiles, que una pantalla
+ * quieta no marca ninguno y que al pintar un bloque en /dev/fb0 solo se
+ * marca su tile y el slot tiene los pixeles nuevos. También que
+ * screen_ring_wait vence el timeout con la pantalla quieta y despierta
+ * (con una generación mayor) al pintar. Retorna 0 si todo pasa.
+ */
+#include "types.h"
+#include "syscalls.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/fb.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    std::printf(" %s %s\n", ok ? "OK  " : "FALLA", what);
+    if (!ok) {
+        failures++;
+    }
+}
+
+static long capture(int fd, screen_ring_frame& frame, std::vector<uint8_t>& damage) {
+    std::memset(&frame, 0, sizeof(frame));
+    frame.dirty_map = damage.data();
+    frame.dirty_map_size = static_cast<uint32_t>(damage.size());
+    return syscall(SYS_SCREEN_RING_CAPTURE, fd, &frame);
+}
+
+static bool isDirty(const std::vector<uint8_t>& damage, uint32_t tile) {
+    return (damage[tile / 8] >> (tile % 8)) & 1;
+}
+
+int main(int argc, char** argv) {
+    const char* fb_path = argc > 1 ? argv[1] : "/dev/fb0";
+
+    screen_ring_info info;
+    std::memset(&info, 0, sizeof(info));
+    info.tile_size = Config::TILE_SIZE;
+
+    long ring_fd = syscall(SYS_SCREEN_RING_OPEN, 3, &info);
+    if (ring_fd < 0) {
+        std::printf(" screen_ring_open: %s\n", std::strerror(errno));
+        return 1;
+    }
+    std::printf(" %ux%u, tiles %ux%u de %u\n", info.width, info.height,
+                info.tiles_x, info.tiles_y, info.tile_size);
+
+    size_t map_size = info.slot_count * info.slot_size;
+    void* map = mmap(nullptr, map_size, PROT_READ, MAP_SHARED, static_cast<int>(ring_fd), 0);
+    if (map == MAP_FAILED) {
+        std::printf(" mmap: %s\n", std::strerror(errno));
+        return 1;
+    }
+    const unsigned char* slots = static_cast<const unsigned char*>(map);
+
+    std::vector<uint8_t> damage(info.dirty_map_size);
+    const uint32_t tiles = info.tiles_x * info.tiles_y;
+    screen_ring_frame frame;
+
+    // 1. Primera captura: todo sucio
+    check(capture(static_cast<int>(ring_fd), frame, damage) == 0, "primera captura");
+    check(frame.dirty_tiles == tiles, "primera captura marca todos los tiles");
+
+    // 2. Pantalla quieta: nada sucio (la consola puede tener el cursor parpadeando)
+    check(capture(static_cast<int>(ring_fd), frame, damage) == 0, "segunda captura");
+    check(frame.dirty_tiles <= 1, "pantalla quieta no marca tiles");
+
+    // 3. Pintar un bloque dentro del tile (1, 1)
+    int fb = open(fb_path, O_RDWR);
+    if (fb < 0) {
+        std::printf(" %s: %s\n", fb_path, std::strerror(errno));
+        return 1;
+    }
+    fb_fix_screeninfo fix;
+    ioctl(fb, FBIOGET_FSCREENINFO, &fix);
+    unsigned char* screen = static_cast<unsigned char*>(
+        mmap(nullptr, fix.smem_len, PROT_READ | PROT_WRITE, MAP_SHARED, fb, 0));
+    if (screen == MAP_FAILED) {
+        std::printf(" mmap %s: %s\n", fb_path, std::strerror(errno));
+        return 1;
+    }
+
+    const uint32_t x0 = info.tile_size + 4;
+    const uint32_t y0 = info.tile_size + 4;
+    const uint32_t bpp = info.bytes_per_pixel;
+    for (uint32_t y = y0; y < y0 + 8; y++) {
+        for (uint32_t x = x0; x < x0 + 8; x++) {
+            unsigned char* px = screen + static_cast<size_t>(y) * fix.line_length + x * bpp;
+            px[0] = static_cast<unsigned char>(~px[0]);
+        }
+    }
+
+    check(capture(static_cast<int>(ring_fd), frame, damage) == 0, "captura tras pintar");
+    const uint32_t painted = info.tiles_x + 1;
+    check(isDirty(damage, painted), "el tile pintado está marcado");
+    check(frame.dirty_tiles <= 2, "solo cambia el tile pintado");
+
+    // El slot tiene los pixeles nuevos
+    const unsigned char* slot = slots + static_cast<size_t>(frame.slot) * info.slot_size;
+    bool same = true;
+    for (uint32_t y = y0; y < y0 + 8 && same; y++) {
+        same = std::memcmp(slot + static_cast<size_t>(y) * info.width * bpp + x0 * bpp,
+                           screen + static_cast<size_t>(y) * fix.line_length + x0 * bpp,
+                           8 * bpp) == 0;
+    }
+    check(same, "el slot contiene el bloque pintado");
+
+    // Bitmap demasiado chico
+    if (info.dirty_map_size > 1) {
+        std::vector<uint8_t> small(1);
+        check(capture(static_cast<int>(ring_fd), frame, small) != 0 && errno == ENOSPC,
+              "bitmap chico devuelve ENOSPC");
+    }
+
+    // 4. Espera de cambios: pantalla quieta -> timeout
+    check(capture(static_cast<int>(ring_fd), frame, damage) == 0, "captura antes de esperar");
+    screen_ring_wait wait;
+    std::memset(&wait, 0, sizeof(wait));
+    wait.generation = frame.generation;
+    wait.timeout_ms = 200;
+    long result = syscall(SYS_SCREEN_RING_WAIT, ring_fd, &wait);
+    check(result != 0 && errno == ETIMEDOUT && wait.generation == frame.generation,
+          "pantalla quieta: la espera vence el timeout");
+
+    // 5. Pintar y esperar: despierta con una generación mayor
+    screen[static_cast<size_t>(y0) * fix.line_length + x0 * bpp] ^= 0xFF;
+    wait.generation = frame.generation;
+    wait.timeout_ms = 1000;
+    result = syscall(SYS_SCREEN_RING_WAIT, ring_fd, &wait);
+    check(result == 0 && wait.generation > frame.generation, "la espera despierta al pintar");
+
+    // La captura siguiente ve la misma generación (el cambio cuenta una vez)
+    check(capture(static_cast<int>(ring_fd), frame, damage) == 0 &&
+          frame.generation == wait.generation, "la captura no repite la generación");
+
+    munmap(screen, fix.smem_len);
+    close(fb);
+    munmap(map, map_size);
+    close(static_cast<int>(ring_fd));
+
+    std::printf(" %s\n", failures == 0 ? "Todas las pruebas pasaron" : "Hay pruebas fallidas");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,196 @@
+/*
+ * Prueba: elección automática de la capa de calidad (simulcast)
+ *
+ * Compilar (desde pruebas/layers):
+ *   g++ -O2 -std=c++17 -pthread -I../../backend/include test_layer_selector.cpp \
+ *       ../../backend/src/stream/layer_selector.cpp \
+ *       ../../backend/src/stream/send_queue.cpp \
+ *       ../../backend/src/stream/stage_stats.cpp \
+ *       ../../backend/src/stream/frame_pool.cpp -o test_layer_selector
+ *
+ * Simula una conexión que recibe 30 frames por segundo con distintos
+ * porcentajes de descarte en su cola: comprueba que baja de capa al
+ * congestionarse (por descartes o por pasar frenada esperando al cliente),
+ * que sube de a una tras Config::LAYER_UP_HOLD_MS estable y que una subida
+ * fallida duplica la espera. Al final alimenta el selector con las
+ * estadísticas de una SendQueue real con un cliente lento, como lo hace el
+ * handler (tarda unos 2 segundos). Retorna 0 si todo pasa.
+ */
+#include "stream/layer_selector.h"
+#include "stream/send_queue.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+
+using Stream::LayerSelector;
+using Stream::StreamLayer;
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    std::printf(" %s %s\n", ok ? "OK  " : "FALLA", what);
+    if (!ok) {
+        failures++;
+    }
+}
+
+// Conexión simulada: contadores acumulados como los de Stream::SendQueue
+struct Link {
+    LayerSelector selector;
+    std::chrono::steady_clock::time_point now;
+    Stream::SendQueueStats stats = Stream::SendQueueStats();
+    int changes = 0;
+
+    Link() : now(std::chrono::steady_clock::now()) {
+        selector.update(stats, now);
+    }
+
+    // 'seconds' ventanas de 30 frames con 'drops' descartados en cada una y
+    // 'stalled_ms' frenada esperando confirmaciones
+    void run(int seconds, int drops, int stalled_ms = 0) {
+        for (int i = 0; i < seconds; i++) {
+            now += std::chrono::milliseconds(Config::LAYER_WINDOW_MS);
+            stats.frames_queued += 30;
+            stats.frames_dropped += drops;
+            stats.bytes_sent += 30 * 20000;
+            stats.stalled_us += static_cast<uint64_t>(stalled_ms) * 1000;
+            changes += selector.update(stats, now) ? 1 : 0;
+        }
+    }
+};
+
+static const int HOLD_S = Config::LAYER_UP_HOLD_MS / Config::LAYER_WINDOW_MS;
+
+static void testNames() {
+    bool ok = true;
+    for (size_t i = 0; i < Stream::LAYER_COUNT; i++) {
+        StreamLayer layer = StreamLayer::LOW;
+        StreamLayer expected = static_cast<StreamLayer>(i);
+        ok = ok && Stream::parseLayer(Stream::layerName(expected), layer) && layer == expected;
+    }
+    StreamLayer layer = StreamLayer::LOW;
+    check(ok && !Stream::parseLayer("auto", layer) && layer == StreamLayer::LOW,
+          "nombres de capas (\"auto\" no es una capa)");
+}
+
+static void testStableLink() {
+    Link link;
+    link.run(30, 0);
+    check(link.selector.layer() == StreamLayer::HIGH && link.changes == 0, "enlace rápido: se queda en high");
+    check(link.selector.drainPercent() == 100 && link.selector.drainKbps() == 4800,
+          "drenado medido: 100 % y 4800 kbit/s");
+
+    // Un descarte aislado no alcanza para bajar
+    link.run(1, 1);
+    check(link.selector.layer() == StreamLayer::HIGH, "descarte aislado: sigue en high");
+}
+
+static void testCongestion() {
+    Link link;
+    link.run(1, 15);
+    check(link.selector.layer() == StreamLayer::LOW && link.selector.drainPercent() == 50,
+          "drena 50 %: baja a low");
+    link.run(1, 15);
+    check(link.selector.layer() == StreamLayer::HALF, "sigue congestionado: baja a half");
+    link.run(3, 15);
+    check(link.selector.layer() == StreamLayer::HALF && link.changes == 2, "half es la capa mínima");
+
+    // Recuperación: una capa por espera
+    link.run(HOLD_S - 1, 0);
+    check(link.selector.layer() == StreamLayer::HALF, "antes de la espera no sube");
+    link.run(1, 0);
+    check(link.selector.layer() == StreamLayer::LOW, "tras la espera prueba low");
+    link.run(HOLD_S, 0);
+    check(link.selector.layer() == StreamLayer::HIGH, "la prueba se sostiene: vuelve a high");
+}
+
+static void testFailedProbe() {
+    Link link;
+    link.run(2, 20);
+    link.run(HOLD_S, 0);
+    check(link.selector.layer() == StreamLayer::LOW, "prueba de low");
+
+    // La capa superior no alcanza: vuelve a bajar y la espera se duplica
+    link.run(1, 10);
+    check(link.selector.layer() == StreamLayer::HALF, "prueba fallida: vuelve a half");
+    link.run(HOLD_S, 0);
+    check(link.selector.layer() == StreamLayer::HALF, "no reintenta con la espera base");
+    link.run(HOLD_S, 0);
+    check(link.selector.layer() == StreamLayer::LOW, "reintenta con la espera duplicada");
+
+    link.selector.reset();
+    check(link.selector.layer() == StreamLayer::HIGH, "reset vuelve a high");
+}
+
+static void testStall() {
+    // Sin descartes pero frenada 600 ms de cada segundo: el enlace no alcanza
+    Link link;
+    link.run(1, 0, 600);
+    check(link.selector.layer() == StreamLayer::LOW && link.selector.stallPercent() == 60,
+          "frenada 60 % sin descartes: baja a low");
+
+    // Esperas cortas no bajan, pero tampoco dejan subir
+    link.run(HOLD_S + 1, 0, 200);
+    check(link.selector.layer() == StreamLayer::LOW, "frenada 20 %: no sube");
+    link.run(HOLD_S, 0, 0);
+    check(link.selector.layer() == StreamLayer::HIGH, "sin esperas: vuelve a high");
+}
+
+// Conexión que no bloquea, como la de Crow
+class BufferingSink : public Stream::MessageSink {
+public:
+    void sendBinary(std::string data) override { written += data.size(); }
+    void sendText(std::string) override {}
+    std::atomic<uint64_t> written{0};
+};
+
+static void testRealQueue() {
+    // 30 frames de 100 KB por segundo (3 MB/s) a un cliente que recibe 512 KB/s
+    BufferingSink* sink = new BufferingSink();
+    Stream::SendQueue queue{std::unique_ptr<Stream::MessageSink>(sink)};
+    std::atomic<bool> running{true};
+    std::thread client([&]() {
+        uint64_t received = 0;
+        while (running) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            received = std::min<uint64_t>(sink->written, received + 512 * 1024 / 200);
+            queue.ack(received);
+        }
+    });
+
+    LayerSelector selector;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 70; i++) {
+        Stream::OutgoingMessage frame;
+        frame.data = std::make_shared<const std::string>(100 * 1024, 'x');
+        frame.binary = true;
+        frame.keyframe = (i == 0);
+        queue.pushFrame(frame);
+        // Como captureFrame: el selector lee las estadísticas de la cola en cada frame
+        selector.update(queue.stats(), std::chrono::steady_clock::now());
+        std::this_thread::sleep_until(start + std::chrono::milliseconds(1000 * (i + 1) / 30));
+    }
+    running = false;
+    client.join();
+    queue.close();
+
+    std::printf("      cola real: drena %d %%, frenada %d %%, %llu kbit/s\n", selector.drainPercent(),
+                selector.stallPercent(), static_cast<unsigned long long>(selector.drainKbps()));
+    check(selector.layer() != StreamLayer::HIGH, "cola real con cliente lento: deja high");
+}
+
+int main() {
+    testNames();
+    testStableLink();
+    testCongestion();
+    testFailedProbe();
+    testStall();
+    testRealQueue();
+
+    std::printf(" %s\n", failures == 0 ? "Todas las pruebas pasaron" : "Hay pruebas fallidas");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,176 @@
+/*
+ * Prueba: cola SPSC del pipeline captura -> codificación
+ *
+ * Compilar (desde pruebas/pipeline):
+ *   g++ -O2 -std=c++17 -pthread -I../../backend/include test_spsc_queue.cpp \
+ *       ../../backend/src/stream/stage_stats.cpp \
+ *       ../../backend/src/stream/event_count.cpp -o test_spsc_queue
+ *
+ * Comprueba llena/vacía, que un elemento ocupa su slot hasta pop() y que
+ * con dos threads llegan todos los elementos en orden y con su contenido
+ * (el productor escribe en el slot, como la etapa de captura). Lo mismo
+ * durmiendo con Stream::EventCount como el pipeline, que un aviso no se
+ * pierde y que con la cola fluyendo casi no hace falta despertar a nadie.
+ * También verifica las estadísticas de etapa. Retorna 0 si todo pasa.
+ */
+#include "stream/event_count.h"
+#include "stream/spsc_queue.h"
+#include "stream/stage_stats.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    std::printf(" %s %s\n", ok ? "OK  " : "FALLA", what);
+    if (!ok) {
+        failures++;
+    }
+}
+
+struct Item {
+    uint64_t sequence;
+    std::vector<uint64_t> payload;   // Se reutiliza entre vueltas, como CapturedFrame::dirty
+};
+
+static void testBasics() {
+    Stream::SpscQueue<Item> queue(2);
+    check(queue.front() == nullptr && queue.size() == 0, "vacía al crear");
+
+    Item* a = queue.producerSlot();
+    a->sequence = 1;
+    queue.push();
+    Item* b = queue.producerSlot();
+    b->sequence = 2;
+    queue.push();
+    check(queue.producerSlot() == nullptr && queue.size() == 2, "llena con capacity elementos");
+
+    Item* front = queue.front();
+    check(front && front->sequence == 1, "front devuelve el más viejo");
+    check(queue.producerSlot() == nullptr, "el elemento ocupa su slot hasta pop()");
+
+    queue.pop();
+    check(queue.producerSlot() != nullptr && queue.front()->sequence == 2, "pop libera un slot");
+    queue.pop();
+    check(queue.front() == nullptr, "vacía tras consumir todo");
+}
+
+static void testThreads() {
+    const uint64_t COUNT = 1000000;
+    Stream::SpscQueue<Item> queue(3);
+    bool in_order = true;
+
+    std::thread consumer([&] {
+        uint64_t expected = 0;
+        while (expected < COUNT) {
+            Item* item = queue.front();
+            if (!item) {
+                std::this_thread::yield();
+                continue;
+            }
+            if (item->sequence != expected || item->payload.size() != 4 ||
+                item->payload[3] != expected * 3) {
+                in_order = false;
+            }
+            queue.pop();
+            expected++;
+        }
+    });
+
+    for (uint64_t i = 0; i < COUNT; i++) {
+        Item* slot;
+        while ((slot = queue.producerSlot()) == nullptr) {
+            std::this_thread::yield();
+        }
+        slot->sequence = i;
+        slot->payload.assign(4, i * 3);
+        queue.push();
+    }
+    consumer.join();
+
+    check(in_order, "1M elementos en orden y completos entre dos threads");
+}
+
+// Simula trabajo de una etapa sin dormir
+static void busy(std::chrono::microseconds duration) {
+    auto end = std::chrono::steady_clock::now() + duration;
+    while (std::chrono::steady_clock::now() < end) {
+    }
+}
+
+// Como captura -> codificación: cada lado solo duerme con la cola llena o
+// vacía. La codificación es la etapa lenta, así que solo la captura espera
+static void testEventCount() {
+    const uint64_t COUNT = 100000;
+    Stream::SpscQueue<Item> queue(3);
+    Stream::EventCount event;
+    bool in_order = true;
+
+    std::thread consumer([&] {
+        for (uint64_t expected = 0; expected < COUNT; expected++) {
+            Item* item = nullptr;
+            event.await([&] { return (item = queue.front()) != nullptr; });
+            if (item->sequence != expected || item->payload[3] != expected * 3) {
+                in_order = false;
+            }
+            busy(std::chrono::microseconds(5));
+            queue.pop();
+            event.notify();
+        }
+    });
+
+    for (uint64_t i = 0; i < COUNT; i++) {
+        Item* slot = nullptr;
+        event.await([&] { return (slot = queue.producerSlot()) != nullptr; });
+        slot->sequence = i;
+        slot->payload.assign(4, i * 3);
+        queue.push();
+        event.notify();
+    }
+    consumer.join();
+
+    check(in_order, "100k elementos en orden durmiendo en el futex");
+    std::printf("      %llu despertares para %llu push/pop\n",
+                static_cast<unsigned long long>(event.wakeups()),
+                static_cast<unsigned long long>(2 * COUNT));
+    check(event.wakeups() <= COUNT + COUNT / 10,
+          "solo se despierta a la etapa que espera (push a una codificación ocupada no hace syscall)");
+
+    // Un thread dormido se despierta con el aviso (como stop())
+    std::atomic<bool> stop(false);
+    std::atomic<bool> woke(false);
+    std::thread sleeper([&] {
+        event.await([&] { return stop.load(); });
+        woke = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    bool slept = !woke;
+    stop = true;
+    event.notify();
+    sleeper.join();
+    check(slept && woke, "el aviso despierta a quien duerme");
+}
+
+static void testStageStats() {
+    Stream::StageStats stats;
+    stats.record(std::chrono::microseconds(800));
+    stats.record(std::chrono::microseconds(1600));
+    Stream::StageSnapshot snapshot = stats.snapshot();
+    check(snapshot.frames == 2, "cuenta frames");
+    check(snapshot.last_us == 1600 && snapshot.max_us == 1600, "último y máximo");
+    check(snapshot.avg_us == 900, "media móvil con peso 1/8");
+}
+
+int main() {
+    testBasics();
+    testThreads();
+    testEventCount();
+    testStageStats();
+
+    std::printf(" %s\n", failures == 0 ? "OK" : "Hay pruebas fallidas");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,218 @@
+/*
+ * Prueba: pool de frames y reservas de memoria por frame en régimen estable
+ *
+ * Compilar (desde pruebas/pool):
+ *   g++ -O2 -std=c++17 -pthread -I../../backend/include test_frame_pool.cpp \
+ *       ../../backend/src/stream/frame_pool.cpp \
+ *       ../../backend/src/stream/send_queue.cpp \
+ *       ../../backend/src/stream/stage_stats.cpp \
+ *       ../../backend/src/stream/tile_encoder.cpp \
+ *       ../../backend/src/utils/jpeg_encoder.cpp \
+ *       ../../backend/src/utils/pixel_kernels.cpp \
+ *       ../../backend/src/utils/thread_pool.cpp \
+ *       ../../backend/src/utils/frame_protocol.cpp -o test_frame_pool
+ *
+ * Reproduce el camino del thread de screenshots (slot de captura, detección
+ * de tiles, JPEG, mensaje en un slot compartido por varias colas) hasta el
+ * envío por una Stream::SendQueue real, y cuenta las llamadas a operator new.
+ * Del slot al sink hay exactamente una reserva por frame enviado: la copia
+ * del slot a un std::string que pide la API de Crow (send_binary). Todo lo
+ * demás no reserva memoria. Retorna 0 si todo pasa.
+ */
+#include "stream/frame_pool.h"
+#include "stream/send_queue.h"
+#include "stream/tile_encoder.h"
+#include "utils/frame_protocol.h"
+#include "utils/jpeg_encoder.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <thread>
+#include <vector>
+
+static std::atomic<size_t> allocations(0);
+
+void* operator new(size_t size) {
+    allocations++;
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+static const int WIDTH = 1280;
+static const int HEIGHT = 800;
+static const int QUEUES = 3;        // Conexiones simuladas
+static const int QUEUE_DEPTH = 2;   // Como Config::SEND_QUEUE_FRAMES
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    if (!ok) {
+        printf("  FALLO %s\n", what);
+        failures++;
+    }
+}
+
+// Conexión que solo cuenta lo recibido (Crow copiaría a su buffer de escritura)
+class CountingSink : public Stream::MessageSink {
+public:
+    explicit CountingSink(std::atomic<size_t>& sent) : sent_(sent) {}
+    void sendBinary(std::string data) override {
+        if (!data.empty()) sent_++;
+    }
+    void sendText(std::string) override {}
+private:
+    std::atomic<size_t>& sent_;
+};
+
+// Escritorio con una "ventana" que se mueve en un ciclo de 16 frames
+static void renderFrame(unsigned char* bgra, int frame) {
+    for (int y = 0; y < HEIGHT; y++) {
+        unsigned char* row = bgra + static_cast<size_t>(y) * WIDTH * 4;
+        for (int x = 0; x < WIDTH; x++) {
+            row[x * 4 + 0] = static_cast<unsigned char>(100 + y / 8);
+            row[x * 4 + 1] = static_cast<unsigned char>(50 + x / 10);
+            row[x * 4 + 2] = 40;
+            row[x * 4 + 3] = 255;
+        }
+    }
+    int x0 = 100 + (frame % 16) * 40;
+    for (int y = 200; y < 400; y++) {
+        unsigned char* row = bgra + static_cast<size_t>(y) * WIDTH * 4;
+        for (int x = x0; x < x0 + 300; x++) {
+            bool glyph = ((x / 2) % 7 < 4) && ((y / 3) % 6 < 3);
+            row[x * 4 + 0] = row[x * 4 + 1] = row[x * 4 + 2] = glyph ? 20 : 240;
+        }
+    }
+}
+
+static void testRefCounting() {
+    Stream::FramePool pool(3, 1000);
+    check(pool.slotCapacity() >= 1000 && pool.slotCapacity() % 4096 == 0, "capacidad redondeada a página");
+    check(reinterpret_cast<uintptr_t>(pool.acquire().data()) % 4096 == 0, "alineación a página");
+    check(pool.available() == 3, "slot liberado al destruir la referencia");
+
+    Stream::FrameRef a = pool.acquire();
+    Stream::FrameRef b = pool.acquire();
+    Stream::FrameRef c = pool.acquire();
+    check(a && b && c, "acquire con slots libres");
+    check(!pool.acquire(), "acquire con el pool agotado devuelve vacío");
+
+    Stream::FrameRef copy = a;
+    a.reset();
+    check(pool.available() == 0, "la copia mantiene el slot ocupado");
+    copy.reset();
+    check(pool.available() == 1, "la última referencia libera el slot");
+
+    Stream::FrameRef moved = std::move(b);
+    check(!b && moved, "mover transfiere la referencia");
+    moved = c;
+    check(pool.available() == 2, "asignar suelta la referencia anterior");
+}
+
+static void testSteadyState() {
+    Stream::FramePool raw_pool(2, static_cast<size_t>(WIDTH) * HEIGHT * 4);
+    Stream::FramePool message_pool(8, Utils::FRAME_HEADER_SIZE + static_cast<size_t>(WIDTH) * HEIGHT * 4);
+    Stream::TileEncoder tiles;
+    Utils::JpegEncoder encoder;
+    std::vector<unsigned char> jpeg;
+    std::vector<unsigned char> payload;
+    std::vector<Stream::TileRect> dirty;
+
+    // La conexión 0 envía por una SendQueue real; las demás son clientes
+    // lentos que retienen sus frames (anillo fijo, como Stream::SendQueue)
+    std::atomic<size_t> sent(0);
+    size_t pushed = 0;
+    Stream::SendQueue send_queue(std::unique_ptr<Stream::MessageSink>(new CountingSink(sent)), QUEUE_DEPTH);
+    Stream::FrameRef queues[QUEUES][QUEUE_DEPTH];
+    size_t dropped = 0;
+    size_t starved = 0;
+
+    auto runFrame = [&](int frame) {
+        Stream::FrameRef raw = raw_pool.acquire();
+        renderFrame(raw.data(), frame);
+        raw.setSize(static_cast<size_t>(WIDTH) * HEIGHT * 4);
+
+        tiles.update(raw.data(), WIDTH, HEIGHT, WIDTH * 4, dirty);
+        bool keyframe = (frame % 30 == 0);
+
+        Utils::FrameHeader header;
+        header.codec = Utils::FrameCodec::JPEG;
+        header.frame_id = static_cast<uint32_t>(frame);
+        header.timestamp = frame;
+        header.width = WIDTH;
+        header.height = HEIGHT;
+
+        Stream::FrameRef message = message_pool.acquire();
+        if (!message) {
+            starved++;
+            return;
+        }
+        size_t size = 0;
+        if (keyframe) {
+            encoder.encode(raw.data(), WIDTH, HEIGHT, WIDTH * 4, jpeg);
+            header.type = Utils::FrameType::SCREENSHOT;
+            header.flags = Utils::FRAME_FLAG_KEYFRAME;
+            size = Utils::writeFrameMessage(header, jpeg.data(), jpeg.size(),
+                                            message.data(), message.capacity());
+        } else {
+            tiles.encodeTiles(raw.data(), WIDTH * 4, dirty, encoder, payload);
+            header.type = Utils::FrameType::TILES;
+            header.flags = 0;
+            size = Utils::writeFrameMessage(header, payload.data(), payload.size(),
+                                            message.data(), message.capacity());
+        }
+        message.setSize(size);
+
+        Stream::OutgoingMessage outgoing;
+        outgoing.frame = message;
+        outgoing.binary = true;
+        outgoing.keyframe = keyframe;
+        send_queue.pushFrame(outgoing);
+        pushed++;
+
+        // Cada cola lenta descarta el más viejo
+        for (int q = 1; q < QUEUES; q++) {
+            if (queues[q][QUEUE_DEPTH - 1]) dropped++;
+            for (int i = QUEUE_DEPTH - 1; i > 0; i--) {
+                queues[q][i] = std::move(queues[q][i - 1]);
+            }
+            queues[q][0] = message;
+        }
+
+        // Esperar el envío: así cada frame sale una vez y la cuenta es exacta
+        while (sent.load() < pushed) std::this_thread::yield();
+    };
+
+    // Calentamiento: un ciclo completo de movimiento más un keyframe
+    int frame = 0;
+    for (; frame < 40; frame++) runFrame(frame);
+
+    size_t before = allocations.load();
+    size_t sent_before = sent.load();
+    for (; frame < 340; frame++) runFrame(frame);
+    size_t during = allocations.load() - before;
+    size_t sends = sent.load() - sent_before;
+
+    printf("  300 frames: %zu reservas, %zu enviados, %zu descartados en colas, %zu sin slot libre\n",
+           during, sends, dropped, starved);
+    check(sends == 300, "la SendQueue envía cada frame");
+    check(during == sends, "una reserva por envío (copia a std::string para Crow) y ninguna más");
+    check(starved == 0, "el pool alcanza para colas llenas");
+    send_queue.close();
+}
+
+int main() {
+    testRefCounting();
+    testSteadyState();
+    printf("%s\n", failures == 0 ? "OK" : "FALLO");
+    return failures == 0 ? 0 : 1;
+}
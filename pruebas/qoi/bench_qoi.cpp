@@ -0,0 +1,148 @@
+/*
+ * Benchmark: codec sin pérdida QOI vs. JPEG sobre frames de escritorio
+ *
+ * Compilar (desde pruebas/qoi):
+ *   g++ -O2 -std=c++17 -pthread -I../../backend/include bench_qoi.cpp \
+ *       ../../backend/src/utils/qoi_codec.cpp \
+ *       ../../backend/src/utils/jpeg_encoder.cpp \
+ *       ../../backend/src/utils/pixel_kernels.cpp \
+ *       ../../backend/src/utils/thread_pool.cpp -o bench_qoi
+ *
+ * Uso:
+ *   ./bench_qoi [iteraciones] [frame.raw ...]
+ *
+ * Cada .raw es una captura BGRA 1280x800 (por ejemplo
+ * ../screen/screenshot.raw). Sin archivos se usa ../screen/screenshot.raw
+ * si existe, y además un escritorio sintético. Por frame imprime tiempo de
+ * codificación, throughput sobre los bytes crudos, tamaño y relación de
+ * compresión de cada codec, y comprueba que QOI decodifica exacto
+ * (ignorando el alfa). Retorna 0 si todas las decodificaciones coinciden.
+ */
+#include "utils/jpeg_encoder.h"
+#include "utils/qoi_codec.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+static const int WIDTH = 1280;
+static const int HEIGHT = 800;
+static const size_t RAW_BYTES = static_cast<size_t>(WIDTH) * HEIGHT * 4;
+
+static void syntheticDesktop(std::vector<unsigned char>& frame) {
+    frame.resize(RAW_BYTES);
+    for (int y = 0; y < HEIGHT; y++) {
+        for (int x = 0; x < WIDTH; x++) {
+            unsigned char* px = &frame[(y * WIDTH + x) * 4];
+            // Fondo degradado
+            px[0] = static_cast<unsigned char>(120 + y / 8);
+            px[1] = static_cast<unsigned char>(60 + x / 12);
+            px[2] = static_cast<unsigned char>(40);
+            px[3] = 255;
+            // Ventana clara con "texto" (patrón de alta frecuencia)
+            if (x > 100 && x < 900 && y > 80 && y < 600) {
+                bool glyph = ((x / 2) % 7 < 4) && ((y / 3) % 6 < 3) && (y % 18 < 12);
+                unsigned char v = glyph ? 20 : 245;
+                px[0] = px[1] = px[2] = v;
+            }
+            // Barra de tareas
+            if (y > HEIGHT - 40) {
+                px[0] = 50; px[1] = 45; px[2] = 40;
+            }
+        }
+    }
+}
+
+static bool loadRaw(const char* path, std::vector<unsigned char>& frame) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    frame.resize(RAW_BYTES);
+    file.read(reinterpret_cast<char*>(frame.data()), RAW_BYTES);
+    return static_cast<size_t>(file.gcount()) == RAW_BYTES;
+}
+
+// Milisegundos promedio por frame
+static double timeEncode(Utils::ImageEncoder& encoder, const std::vector<unsigned char>& frame,
+                         int iterations, std::vector<unsigned char>& out) {
+    // Calentamiento (reserva de buffers)
+    encoder.encode(frame.data(), WIDTH, HEIGHT, WIDTH * 4, out);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        encoder.encode(frame.data(), WIDTH, HEIGHT, WIDTH * 4, out);
+    }
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+static void report(const char* name, double ms, size_t bytes) {
+    printf("  %-5s: %7.2f ms/frame  %7.0f MB/s  %8zu bytes  %6.1f:1\n", name, ms,
+           RAW_BYTES / (ms * 1000.0), bytes, static_cast<double>(RAW_BYTES) / bytes);
+}
+
+static bool sameRgb(const std::vector<unsigned char>& a, const std::vector<unsigned char>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i += 4) {
+        if (a[i] != b[i] || a[i + 1] != b[i + 1] || a[i + 2] != b[i + 2]) return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 20;
+    if (iterations < 1) iterations = 1;
+
+    std::vector<std::string> names;
+    std::vector<std::vector<unsigned char>> frames;
+
+    std::vector<std::string> paths(argv + (argc > 1 ? 2 : argc), argv + argc);
+    if (paths.empty()) {
+        paths.push_back("../screen/screenshot.raw");
+    }
+    for (const std::string& path : paths) {
+        std::vector<unsigned char> frame;
+        if (loadRaw(path.c_str(), frame)) {
+            names.push_back(path);
+            frames.push_back(frame);
+        } else {
+            fprintf(stderr, "No se pudo leer %s (se omite)\n", path.c_str());
+        }
+    }
+    if (argc <= 2) {
+        names.push_back("sintético");
+        frames.emplace_back();
+        syntheticDesktop(frames.back());
+    }
+
+    Utils::JpegEncoder jpeg;
+    Utils::QoiEncoder qoi;
+    std::vector<unsigned char> jpeg_data, qoi_data, decoded;
+    int failures = 0;
+
+    for (size_t f = 0; f < frames.size(); f++) {
+        printf(" %s (%dx%d, %zu bytes crudos)\n", names[f].c_str(), WIDTH, HEIGHT, RAW_BYTES);
+
+        double qoi_ms = timeEncode(qoi, frames[f], iterations, qoi_data);
+        double jpeg_ms = timeEncode(jpeg, frames[f], iterations, jpeg_data);
+        report("QOI", qoi_ms, qoi_data.size());
+        report("JPEG", jpeg_ms, jpeg_data.size());
+        printf("  QOI es %.1fx más rápido y %.1fx más grande\n", jpeg_ms / qoi_ms,
+               static_cast<double>(qoi_data.size()) / jpeg_data.size());
+
+        int w = 0, h = 0;
+        bool ok = Utils::qoiDecode(qoi_data.data(), qoi_data.size(), decoded, w, h) &&
+                  w == WIDTH && h == HEIGHT && sameRgb(decoded, frames[f]);
+        printf(" %s QOI decodifica sin pérdida\n", ok ? "OK  " : "FALLA");
+        if (!ok) failures++;
+    }
+
+    FILE* out = fopen("bench_qoi.qoi", "wb");
+    if (out) {
+        fwrite(qoi_data.data(), 1, qoi_data.size(), out);
+        fclose(out);
+    }
+
+    return failures == 0 ? 0 : 1;
+}
@@ -8,7 +8,9 @@
 #include <errno.h>
 
 #define __NR_screen_live 556
+#define __NR_screen_live_rect 565
 
+/* Estructura original de screen_live: el kernel debe seguir aceptándola */
 struct screen_capture_info {
     uint32_t width;
     uint32_t height;
@@ -17,6 +19,61 @@ struct screen_capture_info {
     void *data;
 };
 
+/* screen_live_rect: los mismos campos más la región y la capacidad */
+struct screen_capture_rect {
+    uint32_t width;
+    uint32_t height;
+    uint32_t bytes_per_pixel;
+    uint64_t buffer_size;
+    void *data;
+    uint32_t x;
+    uint32_t y;
+    uint32_t w;
+    uint32_t h;
+    uint64_t capacity;
+};
+
+/* Copia una región de 64x32 y comprueba que no pasa de la capacidad */
+static int test_rect(void *buf, size_t buf_size) {
+    struct screen_capture_rect rect;
+    int ret;
+
+    memset(&rect, 0, sizeof(rect));
+    rect.data = buf;
+    rect.x = 16;
+    rect.y = 16;
+    rect.w = 64;
+    rect.h = 32;
+    rect.capacity = buf_size;
+
+    ret = syscall(__NR_screen_live_rect, &rect);
+    if (ret < 0) {
+        fprintf(stderr, "screen_live_rect falló: ret=%d, errno=%d (%s)\n",
+                ret, errno, strerror(errno));
+        return 1;
+    }
+    if (rect.buffer_size != (uint64_t)rect.w * rect.h * rect.bytes_per_pixel) {
+        fprintf(stderr, "screen_live_rect: buffer_size %llu no es w * h * bpp\n",
+                (unsigned long long)rect.buffer_size);
+        return 1;
+    }
+    printf("✅ Región %ux%u+%u+%u: %llu bytes\n", rect.w, rect.h, rect.x, rect.y,
+           (unsigned long long)rect.buffer_size);
+
+    /* Un buffer que no alcanza: no se copia nada y se informa el tamaño */
+    rect.w = 64;
+    rect.h = 32;
+    rect.capacity = 16;
+    ret = syscall(__NR_screen_live_rect, &rect);
+    if (ret != -1 || errno != ENOSPC || rect.buffer_size <= rect.capacity) {
+        fprintf(stderr, "screen_live_rect: se esperaba ENOSPC con un buffer chico\n");
+        return 1;
+    }
+    printf("✅ Buffer chico rechazado (ENOSPC, hacen falta %llu bytes)\n",
+           (unsigned long long)rect.buffer_size);
+    return 0;
+}
+
 int main(void) {
     struct screen_capture_info info;
     int ret;
@@ -56,6 +113,8 @@ int main(void) {
         printf("   Guardado: screenshot.raw\n");
     }
 
+    ret = test_rect(buf, 1920ULL * 1080ULL * 4ULL);
+
     free(buf);
-    return 0;
+    return ret;
 }
\ No newline at end of file
@@ -0,0 +1,121 @@
+/*
+ * Prueba: control de flujo de la cola de envío con un cliente lento
+ *
+ * Compilar (desde pruebas/send_queue):
+ *   g++ -O2 -std=c++17 -pthread -I../../backend/include test_send_queue.cpp \
+ *       ../../backend/src/stream/send_queue.cpp \
+ *       ../../backend/src/stream/stage_stats.cpp \
+ *       ../../backend/src/stream/frame_pool.cpp -o test_send_queue
+ *
+ * La conexión falsa se comporta como la de Crow: enviar no bloquea, solo
+ * agrega al buffer. El "cliente" confirma lo recibido (frame_ack) a una
+ * velocidad fija. Con un cliente rápido no se descarta nada; con uno que
+ * recibe la sexta parte de lo que se produce los frames se descartan, se
+ * pide un keyframe y lo no confirmado nunca pasa del límite. Tarda unos
+ * 3 segundos. Retorna 0 si todo pasa.
+ */
+#include "stream/send_queue.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+using Stream::SendQueue;
+using Stream::SendQueueStats;
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    std::printf(" %s %s\n", ok ? "OK  " : "FALLA", what);
+    if (!ok) {
+        failures++;
+    }
+}
+
+// Conexión que no bloquea: solo cuenta lo que se le entregó
+class BufferingSink : public Stream::MessageSink {
+public:
+    void sendBinary(std::string data) override { written += data.size(); }
+    void sendText(std::string) override {}
+    std::atomic<uint64_t> written{0};
+};
+
+static const size_t FRAME_BYTES = 100 * 1024;
+static const int FPS = 30;
+
+struct Result {
+    SendQueueStats stats;
+    bool resync;
+    uint64_t max_unacked;   // Máximo de bytes entregados sin confirmar
+};
+
+// Produce frames a FPS durante 'seconds' mientras el cliente recibe a 'client_bps'
+static Result run(uint64_t client_bps, double seconds) {
+    BufferingSink* sink = new BufferingSink();
+    SendQueue queue{std::unique_ptr<Stream::MessageSink>(sink)};
+    std::atomic<bool> running{true};
+    std::atomic<uint64_t> max_unacked{0};
+
+    // Cliente: cada 5 ms confirma lo que alcanzó a recibir
+    std::thread client([&]() {
+        uint64_t received = 0;
+        auto last = std::chrono::steady_clock::now();
+        while (running) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            auto now = std::chrono::steady_clock::now();
+            double dt = std::chrono::duration<double>(now - last).count();
+            last = now;
+            uint64_t written = sink->written;
+            received = std::min<uint64_t>(written, received + static_cast<uint64_t>(client_bps * dt));
+            if (written - received > max_unacked) {
+                max_unacked = written - received;
+            }
+            queue.ack(received);
+        }
+    });
+
+    Result result;
+    result.resync = false;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < static_cast<int>(seconds * FPS); i++) {
+        Stream::OutgoingMessage frame;
+        frame.data = std::make_shared<const std::string>(FRAME_BYTES, 'x');
+        frame.binary = true;
+        frame.keyframe = (i == 0);
+        queue.pushFrame(frame);
+        result.resync = queue.takeResyncRequest() || result.resync;
+        std::this_thread::sleep_until(start + std::chrono::milliseconds(1000 * (i + 1) / FPS));
+    }
+
+    result.stats = queue.stats();
+    running = false;
+    client.join();
+    queue.close();
+    result.max_unacked = max_unacked;
+    return result;
+}
+
+int main() {
+    // 3 MB/s producidos
+    Result fast = run(50 * 1024 * 1024, 1.5);
+    check(fast.stats.frames_dropped == 0 && !fast.resync, "cliente rápido: no se descarta nada");
+    check(fast.stats.acks, "el primer ack activa el control de flujo");
+
+    Result slow = run(512 * 1024, 1.5);
+    std::printf("      cliente lento: %llu encolados, %llu enviados, %llu descartados, frenada %llu ms\n",
+                static_cast<unsigned long long>(slow.stats.frames_queued),
+                static_cast<unsigned long long>(slow.stats.frames_sent),
+                static_cast<unsigned long long>(slow.stats.frames_dropped),
+                static_cast<unsigned long long>(slow.stats.stalled_us / 1000));
+    check(slow.stats.frames_dropped > slow.stats.frames_queued / 2, "cliente lento: se descartan los frames que no alcanza");
+    check(slow.resync, "cliente lento: se pide un keyframe tras descartar deltas");
+    check(slow.max_unacked <= Config::SEND_INFLIGHT_BYTES + FRAME_BYTES,
+          "lo entregado sin confirmar no pasa del límite (más un frame)");
+    check(slow.stats.stalled_us > 500000, "cliente lento: la cola pasa frenada la mayor parte del tiempo");
+
+    std::printf(" %s\n", failures == 0 ? "Todas las pruebas pasaron" : "Hay pruebas fallidas");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,83 @@
+/*
+ * Microbenchmark de los kernels de pixeles (MPixels/s) sobre un frame 1280x800
+ *
+ * Compilar (desde pruebas/simd):
+ *   g++ -O2 -std=c++17 -I../../backend/include bench_pixel_kernels.cpp \
+ *       ../../backend/src/utils/pixel_kernels.cpp -o bench_pixel_kernels
+ *
+ * Uso:
+ *   ./bench_pixel_kernels [iteraciones]
+ */
+#include "utils/pixel_kernels.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using Utils::PixelKernels::KernelTable;
+
+static const int WIDTH = 1280;
+static const int HEIGHT = 800;
+
+template <typename Fn>
+static double mpixelsPerSecond(int iterations, Fn fn) {
+    fn();  // Calentamiento
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        fn();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(WIDTH) * HEIGHT * iterations / seconds / 1e6;
+}
+
+static void bench(const KernelTable& k, int iterations) {
+    std::vector<uint8_t> bgra(WIDTH * HEIGHT * 4);
+    for (size_t i = 0; i < bgra.size(); i++) bgra[i] = static_cast<uint8_t>(rand());
+
+    std::vector<uint8_t> y(WIDTH * HEIGHT), cb(WIDTH * HEIGHT), cr(WIDTH * HEIGHT);
+    std::vector<uint8_t> out(WIDTH * HEIGHT / 2);
+    float block[64];
+
+    double ycc = mpixelsPerSecond(iterations, [&]() {
+        for (int row = 0; row < HEIGHT; row++) {
+            k.bgraToYccRow(&bgra[row * WIDTH * 4], WIDTH, &y[row * WIDTH], &cb[row * WIDTH], &cr[row * WIDTH]);
+        }
+    });
+
+    double ds21 = mpixelsPerSecond(iterations, [&]() {
+        for (int row = 0; row < HEIGHT; row++) {
+            k.downsample2x1(&cb[row * WIDTH], WIDTH / 2, &out[(row / 2) * (WIDTH / 2)]);
+        }
+    });
+
+    double ds22 = mpixelsPerSecond(iterations, [&]() {
+        for (int row = 0; row < HEIGHT; row += 2) {
+            k.downsample2x2(&cb[row * WIDTH], &cb[(row + 1) * WIDTH], WIDTH / 2,
+                            &out[(row / 2) * (WIDTH / 2)]);
+        }
+    });
+
+    volatile float sink = 0;
+    double load = mpixelsPerSecond(iterations, [&]() {
+        for (int by = 0; by < HEIGHT; by += 8) {
+            for (int bx = 0; bx < WIDTH; bx += 8) {
+                k.loadBlock(&y[by * WIDTH + bx], WIDTH, block);
+                sink = sink + block[0];
+            }
+        }
+    });
+
+    printf("%-7s  bgra->ycc %8.1f  2x1 %8.1f  2x2 %8.1f  loadBlock %8.1f  MPixels/s\n",
+           k.name, ycc, ds21, ds22, load);
+}
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 50;
+
+    printf("Kernels activos: %s\n", Utils::PixelKernels::active().name);
+
+    bench(Utils::PixelKernels::scalar(), iterations);
+    if (const KernelTable* k = Utils::PixelKernels::sse2()) bench(*k, iterations);
+    if (const KernelTable* k = Utils::PixelKernels::avx2()) bench(*k, iterations);
+    return 0;
+}
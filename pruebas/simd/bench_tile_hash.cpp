@@ -0,0 +1,156 @@
+/*
+ * Microbenchmark: huellas de tiles (GB/s) sobre el frame capturado
+ *
+ * Compilar (desde pruebas/simd):
+ *   g++ -O2 -std=c++17 -I../../backend/include bench_tile_hash.cpp \
+ *       ../../backend/src/stream/tile_encoder.cpp \
+ *       ../../backend/src/utils/pixel_kernels.cpp -o bench_tile_hash
+ *
+ * Uso:
+ *   ./bench_tile_hash [iteraciones] [frame.raw]
+ *
+ * El .raw es una captura BGRA 1280x800 (por defecto ../screen/screenshot.raw;
+ * si no existe se usan pixeles aleatorios). Mide hashBlock de cada tabla de
+ * kernels recorriendo todos los tiles de 64x64, y TileEncoder::update frente
+ * a la detección anterior contra una copia del frame (memcmp por fila de tile
+ * + copia de los tiles distintos), con el frame sin cambios y con todos los
+ * tiles cambiando en cada frame.
+ */
+#include "stream/tile_encoder.h"
+#include "utils/pixel_kernels.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+using Utils::PixelKernels::KernelTable;
+
+static const int WIDTH = 1280;
+static const int HEIGHT = 800;
+static const int TILE = 64;
+static const size_t RAW_BYTES = static_cast<size_t>(WIDTH) * HEIGHT * 4;
+
+static bool loadRaw(const char* path, std::vector<unsigned char>& frame) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    frame.resize(RAW_BYTES);
+    file.read(reinterpret_cast<char*>(frame.data()), RAW_BYTES);
+    return static_cast<size_t>(file.gcount()) == RAW_BYTES;
+}
+
+// GB/s sobre los bytes del frame completo
+template <typename Fn>
+static double gigabytesPerSecond(int iterations, Fn fn) {
+    fn();  // Calentamiento
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        fn();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(RAW_BYTES) * iterations / seconds / 1e9;
+}
+
+static void report(const char* name, double gbps) {
+    printf("  %-22s %7.2f GB/s  %6.3f ms/frame\n", name, gbps, RAW_BYTES / (gbps * 1e6));
+}
+
+static uint64_t hashTiles(const KernelTable& k, const unsigned char* bgra) {
+    uint64_t sum = 0;
+    for (int y = 0; y < HEIGHT; y += TILE) {
+        const int rows = std::min(TILE, HEIGHT - y);
+        for (int x = 0; x < WIDTH; x += TILE) {
+            sum += k.hashBlock(bgra + static_cast<size_t>(y) * WIDTH * 4 + x * 4,
+                               WIDTH * 4, std::min(TILE, WIDTH - x) * 4, rows);
+        }
+    }
+    return sum;
+}
+
+// Detección anterior: compara cada tile con la copia y copia los distintos
+static size_t compareShadow(const unsigned char* bgra, std::vector<unsigned char>& shadow) {
+    size_t changed = 0;
+    for (int y = 0; y < HEIGHT; y += TILE) {
+        const int rows = std::min(TILE, HEIGHT - y);
+        for (int x = 0; x < WIDTH; x += TILE) {
+            const size_t bytes = static_cast<size_t>(std::min(TILE, WIDTH - x)) * 4;
+            bool diff = false;
+            for (int r = 0; r < rows && !diff; r++) {
+                size_t offset = static_cast<size_t>(y + r) * WIDTH * 4 + x * 4;
+                diff = std::memcmp(bgra + offset, &shadow[offset], bytes) != 0;
+            }
+            if (diff) {
+                for (int r = 0; r < rows; r++) {
+                    size_t offset = static_cast<size_t>(y + r) * WIDTH * 4 + x * 4;
+                    std::memcpy(&shadow[offset], bgra + offset, bytes);
+                }
+                changed++;
+            }
+        }
+    }
+    return changed;
+}
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 200;
+    if (iterations < 1) iterations = 1;
+    const char* path = argc > 2 ? argv[2] : "../screen/screenshot.raw";
+
+    std::vector<unsigned char> frame;
+    if (loadRaw(path, frame)) {
+        printf("Frame: %s (%dx%d)\n", path, WIDTH, HEIGHT);
+    } else {
+        printf("Frame: aleatorio (no se pudo leer %s)\n", path);
+        frame.resize(RAW_BYTES);
+        for (auto& v : frame) v = static_cast<unsigned char>(rand());
+    }
+    printf("Kernels activos: %s\n", Utils::PixelKernels::active().name);
+
+    volatile uint64_t sink = 0;
+    const KernelTable* tables[] = {&Utils::PixelKernels::scalar(), Utils::PixelKernels::sse2(),
+                                   Utils::PixelKernels::avx2()};
+    for (const KernelTable* k : tables) {
+        if (!k) continue;
+        char name[32];
+        snprintf(name, sizeof(name), "hashBlock %s", k->name);
+        report(name, gigabytesPerSecond(iterations, [&]() { sink = sink + hashTiles(*k, frame.data()); }));
+    }
+
+    // Camino completo de la captura sobre un frame que no cambió
+    printf(" Frame sin cambios\n");
+    Stream::TileEncoder tiles;
+    std::vector<Stream::TileRect> dirty;
+    tiles.update(frame.data(), WIDTH, HEIGHT, WIDTH * 4, dirty);  // Huellas de referencia
+    size_t dirty_tiles = 0;
+    report("TileEncoder::update", gigabytesPerSecond(iterations, [&]() {
+        dirty_tiles += tiles.update(frame.data(), WIDTH, HEIGHT, WIDTH * 4, dirty);
+    }));
+
+    // Referencia: el frame sin cambios recorre también la copia (el doble de lectura)
+    std::vector<unsigned char> shadow(frame);
+    size_t changed = 0;
+    report("memcmp + copia", gigabytesPerSecond(iterations, [&]() {
+        changed += compareShadow(frame.data(), shadow);
+    }));
+    printf("  Tiles sucios: %zu (huellas), %zu (copia)\n", dirty_tiles, changed);
+
+    // Todos los tiles cambian: se alterna entre el frame y una versión distinta
+    printf(" Frame cambiando por completo\n");
+    std::vector<unsigned char> other(frame);
+    for (auto& v : other) v ^= 1;
+    const std::vector<unsigned char>* frames[] = {&frame, &other};
+    int turn = 0;
+    report("TileEncoder::update", gigabytesPerSecond(iterations, [&]() {
+        tiles.update(frames[++turn & 1]->data(), WIDTH, HEIGHT, WIDTH * 4, dirty);
+    }));
+    report("memcmp + copia", gigabytesPerSecond(iterations, [&]() {
+        compareShadow(frames[++turn & 1]->data(), shadow);
+    }));
+
+    printf("  Estado por frame: %zu bytes de huellas vs %zu bytes de copia\n",
+           static_cast<size_t>((WIDTH + TILE - 1) / TILE) * ((HEIGHT + TILE - 1) / TILE) * sizeof(uint64_t),
+           RAW_BYTES);
+    return 0;
+}
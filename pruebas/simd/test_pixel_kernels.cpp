@@ -0,0 +1,116 @@
+/*
+ * Prueba: los kernels SSE2/AVX2 deben dar exactamente lo mismo que los escalares
+ *
+ * Compilar (desde pruebas/simd):
+ *   g++ -O2 -std=c++17 -I../../backend/include test_pixel_kernels.cpp \
+ *       ../../backend/src/utils/pixel_kernels.cpp -o test_pixel_kernels
+ *
+ * Retorna 0 si todas las comparaciones coinciden bit a bit.
+ */
+#include "utils/pixel_kernels.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using Utils::PixelKernels::KernelTable;
+
+static int failures = 0;
+
+static void check(bool ok, const char* kernel, const char* impl, int size) {
+    if (!ok) {
+        printf("  FALLO %-14s %-6s n=%d\n", kernel, impl, size);
+        failures++;
+    }
+}
+
+static void fillRandom(std::vector<uint8_t>& data, unsigned seed) {
+    srand(seed);
+    for (auto& v : data) v = static_cast<uint8_t>(rand() & 0xFF);
+}
+
+static void testTable(const KernelTable& ref, const KernelTable& impl) {
+    // Tamaños que cubren el cuerpo vectorial y las colas escalares
+    const int sizes[] = {0, 1, 7, 15, 16, 17, 31, 32, 33, 63, 64, 100, 640, 1280, 1283};
+
+    for (int n : sizes) {
+        std::vector<uint8_t> bgra(n * 4 + 64);
+        fillRandom(bgra, 1000 + n);
+
+        // Extremos: blanco, negro y colores saturados
+        for (int i = 0; i < n && i < 6; i++) {
+            const uint8_t corners[6][3] = {{0, 0, 0}, {255, 255, 255}, {255, 0, 0},
+                                           {0, 255, 0}, {0, 0, 255}, {255, 0, 255}};
+            std::memcpy(&bgra[i * 4], corners[i], 3);
+        }
+
+        std::vector<uint8_t> y1(n + 1), cb1(n + 1), cr1(n + 1);
+        std::vector<uint8_t> y2(n + 1), cb2(n + 1), cr2(n + 1);
+        ref.bgraToYccRow(bgra.data(), n, y1.data(), cb1.data(), cr1.data());
+        impl.bgraToYccRow(bgra.data(), n, y2.data(), cb2.data(), cr2.data());
+        check(y1 == y2 && cb1 == cb2 && cr1 == cr2, "bgraToYccRow", impl.name, n);
+
+        std::vector<uint8_t> row0(2 * n + 64), row1(2 * n + 64);
+        fillRandom(row0, 2000 + n);
+        fillRandom(row1, 3000 + n);
+
+        std::vector<uint8_t> o1(n + 1), o2(n + 1);
+        ref.downsample2x1(row0.data(), n, o1.data());
+        impl.downsample2x1(row0.data(), n, o2.data());
+        check(o1 == o2, "downsample2x1", impl.name, n);
+
+        ref.downsample2x2(row0.data(), row1.data(), n, o1.data());
+        impl.downsample2x2(row0.data(), row1.data(), n, o2.data());
+        check(o1 == o2, "downsample2x2", impl.name, n);
+    }
+
+    for (int stride : {8, 13, 1280}) {
+        std::vector<uint8_t> plane(stride * 8);
+        fillRandom(plane, 4000 + stride);
+        float b1[64], b2[64];
+        ref.loadBlock(plane.data(), stride, b1);
+        impl.loadBlock(plane.data(), stride, b2);
+        check(std::memcmp(b1, b2, sizeof(b1)) == 0, "loadBlock", impl.name, stride);
+    }
+
+    // Reducción BGRA: pares completos con y sin cola escalar
+    for (int count : {1, 3, 4, 5, 17, 640}) {
+        std::vector<uint8_t> rows(count * 16);
+        fillRandom(rows, 4000 + count);
+        std::vector<uint8_t> o1(count * 4), o2(count * 4);
+        ref.downsampleBgra(rows.data(), rows.data() + count * 8, count, o1.data());
+        impl.downsampleBgra(rows.data(), rows.data() + count * 8, count, o2.data());
+        check(o1 == o2, "downsampleBgra", impl.name, count);
+    }
+
+    // Huellas: filas con y sin cola escalar (anchos que no son múltiplo de 8 pixeles)
+    for (int width : {1, 5, 8, 13, 64, 67, 1280}) {
+        const int stride = width * 4 + 12;
+        std::vector<uint8_t> tile(stride * 9);
+        fillRandom(tile, 5000 + width);
+        for (int rows : {1, 9}) {
+            check(ref.hashBlock(tile.data(), stride, width * 4, rows) ==
+                  impl.hashBlock(tile.data(), stride, width * 4, rows), "hashBlock", impl.name, width);
+        }
+    }
+}
+
+int main() {
+    const KernelTable& ref = Utils::PixelKernels::scalar();
+    const KernelTable* impls[] = {Utils::PixelKernels::sse2(), Utils::PixelKernels::avx2()};
+    const char* names[] = {"sse2", "avx2"};
+
+    printf("Kernels activos: %s\n", Utils::PixelKernels::active().name);
+
+    for (int i = 0; i < 2; i++) {
+        if (!impls[i]) {
+            printf("%s: no soportado por esta CPU (omitido)\n", names[i]);
+            continue;
+        }
+        int before = failures;
+        testTable(ref, *impls[i]);
+        printf("%s: %s\n", names[i], failures == before ? "OK" : "FALLO");
+    }
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,154 @@
+/*
+ * Prueba: detección de scroll y copias de rectángulos
+ *
+ * Compilar (desde pruebas/tiles):
+ *   g++ -O2 -std=c++17 -I../../backend/include test_scroll_detector.cpp \
+ *       ../../backend/src/stream/scroll_detector.cpp \
+ *       ../../backend/src/stream/tile_encoder.cpp \
+ *       ../../backend/src/utils/pixel_kernels.cpp -o test_scroll_detector
+ *
+ * Simula un documento dentro de una ventana (con una barra lateral fija)
+ * que se desplaza vertical y horizontalmente. Para cada paso reproduce lo
+ * que hace el cliente: aplica las copias sobre el frame anterior, pega los
+ * tiles sucios que quedan, y comprueba que el resultado es el frame nuevo
+ * y que se enviaron muchos menos tiles. Retorna 0 si todo pasa.
+ */
+#include "stream/scroll_detector.h"
+#include "stream/tile_encoder.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+static const int WIDTH = 1280;
+static const int HEIGHT = 800;
+static const int STRIDE = WIDTH * 4;
+
+// Ventana del documento
+static const int DOC_X = 256;
+static const int DOC_Y = 64;
+static const int DOC_W = 768;
+static const int DOC_H = 640;
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    std::printf(" %s %s\n", ok ? "OK  " : "FALLA", what);
+    if (!ok) {
+        failures++;
+    }
+}
+
+// Pseudo-texto: cada línea del documento tiene "glifos" distintos
+static unsigned char docPixel(int x, int y) {
+    const int line = y / 20;
+    if (y % 20 >= 14) {
+        return 250;   // Espacio entre líneas
+    }
+    unsigned hash = static_cast<unsigned>(line * 7919 + x * 104729 + (y % 20) * 31);
+    hash ^= hash >> 13;
+    hash *= 0x5bd1e995u;
+    hash ^= hash >> 15;
+    bool glyph = (hash & 3) != 0 && (x % 9) < 6;
+    return glyph ? 30 : 250;
+}
+
+static void paintScreen(std::vector<unsigned char>& frame, int scroll_x, int scroll_y) {
+    frame.resize(static_cast<size_t>(STRIDE) * HEIGHT);
+    for (int y = 0; y < HEIGHT; y++) {
+        for (int x = 0; x < WIDTH; x++) {
+            unsigned char* px = &frame[static_cast<size_t>(y) * STRIDE + x * 4];
+            unsigned char v;
+            if (x >= DOC_X && x < DOC_X + DOC_W && y >= DOC_Y && y < DOC_Y + DOC_H) {
+                v = docPixel(x - DOC_X + scroll_x, y - DOC_Y + scroll_y);
+            } else {
+                v = static_cast<unsigned char>(60 + (x / 64 + y / 64) % 2 * 20);   // Fondo fijo
+            }
+            px[0] = v;
+            px[1] = v;
+            px[2] = static_cast<unsigned char>(v / 2 + 40);
+            px[3] = 255;
+        }
+    }
+}
+
+// Lo que hace el frontend: copias sobre el canvas y luego los tiles
+static void applyToClient(std::vector<unsigned char>& client, const std::vector<unsigned char>& frame,
+                          const std::vector<Stream::MoveRect>& moves,
+                          const std::vector<Stream::TileRect>& dirty) {
+    std::vector<unsigned char> copy;
+    for (const Stream::MoveRect& move : moves) {
+        copy.resize(static_cast<size_t>(move.w) * move.h * 4);
+        for (int y = 0; y < move.h; y++) {
+            std::memcpy(&copy[static_cast<size_t>(y) * move.w * 4],
+                        &client[static_cast<size_t>(move.src_y + y) * STRIDE + move.src_x * 4], move.w * 4);
+        }
+        for (int y = 0; y < move.h; y++) {
+            std::memcpy(&client[static_cast<size_t>(move.dst_y + y) * STRIDE + move.dst_x * 4],
+                        &copy[static_cast<size_t>(y) * move.w * 4], move.w * 4);
+        }
+    }
+    for (const Stream::TileRect& rect : dirty) {
+        for (int y = rect.y; y < rect.y + rect.h; y++) {
+            std::memcpy(&client[static_cast<size_t>(y) * STRIDE + rect.x * 4],
+                        &frame[static_cast<size_t>(y) * STRIDE + rect.x * 4], rect.w * 4);
+        }
+    }
+}
+
+static size_t area(const std::vector<Stream::TileRect>& rects) {
+    size_t total = 0;
+    for (const Stream::TileRect& rect : rects) {
+        total += static_cast<size_t>(rect.w) * rect.h;
+    }
+    return total;
+}
+
+int main() {
+    Stream::TileEncoder tiles;
+    Stream::ScrollDetector detector;
+    std::vector<unsigned char> frame, client;
+    std::vector<Stream::TileRect> dirty;
+    std::vector<Stream::MoveRect> moves;
+
+    paintScreen(frame, 0, 0);
+    tiles.update(frame.data(), WIDTH, HEIGHT, STRIDE, dirty);
+    detector.detect(frame.data(), WIDTH, HEIGHT, STRIDE, dirty, moves);
+    check(moves.empty(), "primer frame: sin copias");
+    client = frame;
+
+    struct Step { int scroll_x; int scroll_y; const char* what; };
+    const Step steps[] = {
+        {0, 60, "scroll hacia abajo 60 px"},
+        {0, 45, "scroll hacia arriba 15 px"},
+        {0, 245, "scroll hacia abajo 200 px"},
+        {72, 245, "scroll horizontal 72 px"},
+    };
+
+    for (const Step& step : steps) {
+        paintScreen(frame, step.scroll_x, step.scroll_y);
+        tiles.update(frame.data(), WIDTH, HEIGHT, STRIDE, dirty);
+        const size_t before = area(dirty);
+        detector.detect(frame.data(), WIDTH, HEIGHT, STRIDE, dirty, moves);
+        const size_t after = area(dirty);
+
+        applyToClient(client, frame, moves, dirty);
+        std::printf("   %s: %zu copias, %zu -> %zu pixeles sucios\n", step.what, moves.size(), before, after);
+        check(!moves.empty() && after * 2 < before, step.what);
+        check(client == frame, "el cliente reconstruye el frame exacto");
+    }
+
+    // Un cambio que no es scroll no genera copias
+    paintScreen(frame, 72, 245);
+    for (int y = 300; y < 340; y++) {
+        std::memset(&frame[static_cast<size_t>(y) * STRIDE + 400 * 4], 0x80, 40 * 4);
+    }
+    tiles.update(frame.data(), WIDTH, HEIGHT, STRIDE, dirty);
+    const size_t before = area(dirty);
+    detector.detect(frame.data(), WIDTH, HEIGHT, STRIDE, dirty, moves);
+    applyToClient(client, frame, moves, dirty);
+    check(moves.empty() && area(dirty) == before, "cambio local: sin copias");
+    check(client == frame, "el cliente sigue sincronizado");
+
+    std::printf(" %s\n", failures == 0 ? "Todas las pruebas pasaron" : "Hay pruebas fallidas");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,196 @@
+/*
+ * Prueba: clasificación de tiles por contenido y payload MIXED
+ *
+ * Compilar (desde pruebas/tiles):
+ *   g++ -O2 -std=c++17 -pthread -I../../backend/include test_tile_classifier.cpp \
+ *       ../../backend/src/stream/tile_classifier.cpp \
+ *       ../../backend/src/stream/stage_stats.cpp \
+ *       ../../backend/src/utils/qoi_codec.cpp \
+ *       ../../backend/src/utils/jpeg_encoder.cpp \
+ *       ../../backend/src/utils/pixel_kernels.cpp \
+ *       ../../backend/src/utils/thread_pool.cpp -o test_tile_classifier
+ *
+ * Arma una pantalla de 4x2 tiles con texto, una foto, un color plano y
+ * una región que cambia en cada frame; comprueba la clase de cada tile,
+ * que la región cambiante pasa a VIDEO, que split() corta donde cambia
+ * la clase y que las regiones de texto del payload decodifican exacto.
+ * Retorna 0 si todo pasa.
+ */
+#include "stream/tile_classifier.h"
+#include "utils/jpeg_encoder.h"
+#include "utils/qoi_codec.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+static const int TILE = 64;
+static const int WIDTH = TILE * 4;
+static const int HEIGHT = TILE * 2;
+static const int STRIDE = WIDTH * 4;
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    std::printf(" %s %s\n", ok ? "OK  " : "FALLA", what);
+    if (!ok) {
+        failures++;
+    }
+}
+
+static void setPixel(std::vector<unsigned char>& frame, int x, int y, int r, int g, int b) {
+    unsigned char* px = &frame[static_cast<size_t>(y) * STRIDE + x * 4];
+    px[0] = static_cast<unsigned char>(b);
+    px[1] = static_cast<unsigned char>(g);
+    px[2] = static_cast<unsigned char>(r);
+    px[3] = 255;
+}
+
+// Foto: degradado suave con ruido (muchos colores, sin bordes nítidos)
+static void paintPhoto(std::vector<unsigned char>& frame, int x0, int y0, int seed) {
+    unsigned state = 12345u + seed;
+    for (int y = y0; y < y0 + TILE; y++) {
+        for (int x = x0; x < x0 + TILE; x++) {
+            state = state * 1103515245u + 12345u;
+            int noise = static_cast<int>((state >> 16) % 12);
+            setPixel(frame, x, y, 90 + (x - x0) + noise, 60 + (y - y0) + noise, 40 + seed % 50 + noise);
+        }
+    }
+}
+
+static void paintScreen(std::vector<unsigned char>& frame, int video_seed) {
+    frame.assign(static_cast<size_t>(STRIDE) * HEIGHT, 0);
+    for (int y = 0; y < HEIGHT; y++) {
+        for (int x = 0; x < WIDTH; x++) {
+            setPixel(frame, x, y, 230, 230, 230);   // Fondo plano de la UI
+        }
+    }
+    // Tile (0, 0): texto negro con bordes suavizados
+    for (int y = 0; y < TILE; y++) {
+        for (int x = 0; x < TILE; x++) {
+            bool glyph = ((x / 2) % 7 < 4) && ((y / 3) % 6 < 3) && (y % 18 < 12);
+            bool border = ((x / 2) % 7 == 4);
+            int v = glyph ? 20 : (border ? 140 : 245);
+            setPixel(frame, x, y, v, v, v);
+        }
+    }
+    paintPhoto(frame, TILE, 0, 7);               // Tile (1, 0): foto
+    paintPhoto(frame, TILE * 3, TILE, video_seed); // Tile (3, 1): video
+}
+
+static void dirtyTile(std::vector<Stream::TileRect>& dirty, int tx, int ty) {
+    Stream::TileRect rect;
+    rect.x = static_cast<uint16_t>(tx * TILE);
+    rect.y = static_cast<uint16_t>(ty * TILE);
+    rect.w = TILE;
+    rect.h = TILE;
+    dirty.push_back(rect);
+}
+
+static Stream::TileClass classOfRegion(const std::vector<Stream::ClassifiedRect>& regions, int x, int y) {
+    for (const Stream::ClassifiedRect& region : regions) {
+        if (x >= region.rect.x && x < region.rect.x + region.rect.w &&
+            y >= region.rect.y && y < region.rect.y + region.rect.h) {
+            return region.tile_class;
+        }
+    }
+    return static_cast<Stream::TileClass>(255);
+}
+
+int main() {
+    Stream::TileClassifier classifier(TILE);
+    Utils::QoiEncoder qoi;
+    Utils::JpegEncoder jpeg;
+    classifier.setTreatment(Stream::TileClass::TEXT, Utils::FrameCodec::QOI, &qoi);
+    classifier.setTreatment(Stream::TileClass::PHOTO, Utils::FrameCodec::JPEG, &jpeg);
+    classifier.setTreatment(Stream::TileClass::VIDEO, Utils::FrameCodec::JPEG, &jpeg);
+
+    std::vector<unsigned char> frame;
+    std::vector<Stream::TileRect> dirty;
+    std::vector<Stream::ClassifiedRect> regions;
+
+    // 1. Primer frame: se analiza toda la pantalla
+    paintScreen(frame, 0);
+    classifier.update(frame.data(), WIDTH, HEIGHT, STRIDE, dirty);
+    classifier.fullFrame(regions);
+    check(classOfRegion(regions, 0, 0) == Stream::TileClass::TEXT, "texto -> TEXT");
+    check(classOfRegion(regions, TILE, 0) == Stream::TileClass::PHOTO, "foto -> PHOTO");
+    check(classOfRegion(regions, TILE * 2, 0) == Stream::TileClass::TEXT, "color plano -> TEXT");
+    check(classOfRegion(regions, TILE * 3, TILE) == Stream::TileClass::PHOTO, "región quieta -> PHOTO");
+    check(regions.size() == 5, "keyframe: 3 regiones en la fila 0 y 2 en la fila 1");
+
+    // 2. La región cambia en cada frame: pasa a VIDEO
+    for (int i = 1; i <= Config::TILE_VIDEO_CHANGES; i++) {
+        paintScreen(frame, i);
+        dirty.clear();
+        dirtyTile(dirty, 3, 1);
+        classifier.update(frame.data(), WIDTH, HEIGHT, STRIDE, dirty);
+    }
+    classifier.fullFrame(regions);
+    check(classOfRegion(regions, TILE * 3, TILE) == Stream::TileClass::VIDEO, "región cambiante -> VIDEO");
+    check(classOfRegion(regions, TILE, 0) == Stream::TileClass::PHOTO, "la foto quieta sigue PHOTO");
+
+    // 3. Deja de cambiar: vuelve a su clase de contenido
+    for (int i = 0; i < 16; i++) {
+        dirty.clear();
+        classifier.update(frame.data(), WIDTH, HEIGHT, STRIDE, dirty);
+    }
+    classifier.fullFrame(regions);
+    check(classOfRegion(regions, TILE * 3, TILE) == Stream::TileClass::PHOTO, "región quieta vuelve a PHOTO");
+
+    // 4. split() corta una región sucia donde cambia la clase
+    std::vector<Stream::TileRect> row(1);
+    row[0].x = 0;
+    row[0].y = 0;
+    row[0].w = TILE * 3;
+    row[0].h = TILE;
+    classifier.split(row, regions);
+    check(regions.size() == 3 && regions[1].rect.x == TILE && regions[1].rect.w == TILE,
+          "split corta texto | foto | texto");
+
+    // 5. Payload MIXED: codec por región y texto sin pérdida
+    std::vector<unsigned char> payload;
+    classifier.fullFrame(regions);
+    check(classifier.encodeRegions(frame.data(), STRIDE, regions, payload), "encodeRegions");
+
+    size_t offset = 2;
+    bool codecs_ok = payload[0] == regions.size();
+    bool lossless = true;
+    for (size_t i = 0; i < regions.size() && offset + 14 <= payload.size(); i++) {
+        uint8_t codec = payload[offset + 8];
+        uint8_t tile_class = payload[offset + 9];
+        uint32_t length;
+        std::memcpy(&length, &payload[offset + 10], 4);
+        const unsigned char* data = &payload[offset + 14];
+        const Stream::TileRect& rect = regions[i].rect;
+
+        bool text = tile_class == static_cast<uint8_t>(Stream::TileClass::TEXT);
+        codecs_ok = codecs_ok && codec == static_cast<uint8_t>(text ? Utils::FrameCodec::QOI
+                                                                      : Utils::FrameCodec::JPEG);
+        if (text) {
+            std::vector<unsigned char> decoded;
+            int w = 0, h = 0;
+            lossless = lossless && Utils::qoiDecode(data, length, decoded, w, h) &&
+                       w == rect.w && h == rect.h;
+            for (int y = 0; y < h && lossless; y++) {
+                for (int x = 0; x < w && lossless; x++) {
+                    const unsigned char* a = &decoded[(static_cast<size_t>(y) * w + x) * 4];
+                    const unsigned char* b = &frame[static_cast<size_t>(rect.y + y) * STRIDE + (rect.x + x) * 4];
+                    lossless = std::memcmp(a, b, 3) == 0;
+                }
+            }
+        } else {
+            codecs_ok = codecs_ok && length > 2 && data[0] == 0xFF && data[1] == 0xD8;
+        }
+        offset += 14 + length;
+    }
+    check(codecs_ok && offset == payload.size(), "cada región lleva el codec de su clase");
+    check(lossless, "las regiones de texto decodifican exacto");
+
+    Stream::TileClassSnapshot text = classifier.stats(Stream::TileClass::TEXT);
+    Stream::TileClassSnapshot photo = classifier.stats(Stream::TileClass::PHOTO);
+    check(text.regions > 0 && text.bytes > 0 && photo.regions > 0 && photo.encode.frames == photo.regions,
+          "estadísticas por clase");
+
+    std::printf(" %s\n", failures == 0 ? "Todas las pruebas pasaron" : "Hay pruebas fallidas");
+    return failures == 0 ? 0 : 1;
+}
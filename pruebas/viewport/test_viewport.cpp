@@ -0,0 +1,150 @@
+/*
+ * Prueba: viewports ampliados (recorte, tamaño codificado y escalado)
+ *
+ * Compilar (desde pruebas/viewport):
+ *   g++ -O2 -std=c++17 -I../../backend/include test_viewport.cpp \
+ *       ../../backend/src/stream/viewport.cpp ../../backend/src/utils/pixel_kernels.cpp \
+ *       -o test_viewport
+ *
+ * Comprueba que la región se recorta a la pantalla, que el tamaño
+ * codificado nunca amplía y respeta la proporción, que solo los cambios
+ * dentro de la región la marcan y que el escalado por mitades coincide con
+ * PixelKernels::downsampleBgra. Retorna 0 si todo pasa.
+ */
+#include "stream/viewport.h"
+#include "utils/pixel_kernels.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using Stream::Viewport;
+using Stream::ViewportScaler;
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    std::printf(" %s %s\n", ok ? "OK  " : "FALLA", what);
+    if (!ok) {
+        failures++;
+    }
+}
+
+static Viewport makeViewport(int x, int y, int w, int h, int out_w, int out_h) {
+    Viewport viewport;
+    viewport.x = static_cast<uint16_t>(x);
+    viewport.y = static_cast<uint16_t>(y);
+    viewport.w = static_cast<uint16_t>(w);
+    viewport.h = static_cast<uint16_t>(h);
+    viewport.out_w = static_cast<uint16_t>(out_w);
+    viewport.out_h = static_cast<uint16_t>(out_h);
+    return viewport;
+}
+
+static void testClamp() {
+    Viewport viewport = makeViewport(1800, 1000, 400, 200, 4000, 3000);
+    check(viewport.clamp(1920, 1080) && viewport.w == 120 && viewport.h == 80,
+          "la región se recorta al borde de la pantalla");
+    check(viewport.out_w == 1920 && viewport.out_h == 1080, "la salida se limita al tamaño de la pantalla");
+
+    Viewport tiny = makeViewport(1910, 0, 100, 100, 800, 600);
+    check(!tiny.clamp(1920, 1080), "una región más chica que VIEWPORT_MIN_SIZE se rechaza");
+}
+
+static void testEncodedSize() {
+    int width = 0;
+    int height = 0;
+    makeViewport(0, 0, 480, 270, 1280, 720).encodedSize(width, height);
+    check(width == 480 && height == 270, "zoom: se envía a resolución nativa, sin ampliar");
+
+    makeViewport(0, 0, 1920, 1080, 960, 720).encodedSize(width, height);
+    check(width == 960 && height == 540, "región grande: se reduce manteniendo la proporción");
+
+    makeViewport(0, 0, 1000, 1000, 800, 400).encodedSize(width, height);
+    check(width == 400 && height == 400, "la dimensión más restrictiva manda");
+}
+
+static void testTouches() {
+    Viewport viewport = makeViewport(256, 256, 256, 256, 800, 600);
+    std::vector<Stream::TileRect> dirty(1);
+    std::vector<Stream::MoveRect> moves;
+
+    dirty[0].x = 0;
+    dirty[0].y = 0;
+    dirty[0].w = 256;
+    dirty[0].h = 256;
+    check(!viewport.touches(dirty, moves), "un tile adyacente no toca la región");
+
+    dirty[0].x = 448;
+    dirty[0].y = 448;
+    dirty[0].w = 64;
+    dirty[0].h = 64;
+    check(viewport.touches(dirty, moves), "un tile dentro la toca");
+
+    dirty.clear();
+    Stream::MoveRect move;
+    std::memset(&move, 0, sizeof(move));
+    move.dst_x = 300;
+    move.dst_y = 200;
+    move.w = 64;
+    move.h = 64;
+    moves.push_back(move);
+    check(viewport.touches(dirty, moves), "el destino de una copia también la toca");
+}
+
+static void testScale() {
+    const int w = 256;
+    const int h = 128;
+    std::vector<unsigned char> src(static_cast<size_t>(w) * h * 4);
+    for (size_t i = 0; i < src.size(); i++) {
+        src[i] = static_cast<unsigned char>((i * 7 + i / 1024) & 0xFF);
+    }
+
+    ViewportScaler scaler;
+    int stride = 0;
+    const unsigned char* same = scaler.scale(src.data(), w * 4, w, h, w, h, stride);
+    check(same == src.data() && stride == w * 4, "sin escalar se devuelve el origen");
+
+    // Una reducción exacta a la mitad es exactamente downsampleBgra
+    const Utils::PixelKernels::KernelTable& kernels = Utils::PixelKernels::active();
+    std::vector<unsigned char> expected(static_cast<size_t>(w / 2) * (h / 2) * 4);
+    for (int y = 0; y < h / 2; y++) {
+        const unsigned char* row = &src[static_cast<size_t>(2 * y) * w * 4];
+        kernels.downsampleBgra(row, row + w * 4, w / 2, &expected[static_cast<size_t>(y) * (w / 2) * 4]);
+    }
+    const unsigned char* half = scaler.scale(src.data(), w * 4, w, h, w / 2, h / 2, stride);
+    check(stride == w * 2 && std::memcmp(half, expected.data(), expected.size()) == 0,
+          "mitad exacta: igual a downsampleBgra");
+
+    // Tamaño arbitrario: un color uniforme se conserva
+    std::vector<unsigned char> flat(static_cast<size_t>(w) * h * 4);
+    for (size_t i = 0; i < flat.size(); i += 4) {
+        flat[i] = 10;
+        flat[i + 1] = 120;
+        flat[i + 2] = 240;
+        flat[i + 3] = 255;
+    }
+    const unsigned char* scaled = scaler.scale(flat.data(), w * 4, w, h, 100, 37, stride);
+    bool uniform = stride == 100 * 4;
+    for (int y = 0; y < 37 && uniform; y++) {
+        for (int x = 0; x < 100; x++) {
+            const unsigned char* px = scaled + static_cast<size_t>(y) * stride + x * 4;
+            uniform = uniform && px[0] == 10 && px[1] == 120 && px[2] == 240 && px[3] == 255;
+        }
+    }
+    check(uniform, "escala arbitraria (256x128 -> 100x37) conserva un color uniforme");
+
+    unsigned char header[ViewportScaler::HEADER_SIZE];
+    ViewportScaler::writeHeader(makeViewport(0x102, 3, 0x400, 0x300, 1, 1), header);
+    const unsigned char expected_header[] = {0x02, 0x01, 0x03, 0x00, 0x00, 0x04, 0x00, 0x03};
+    check(std::memcmp(header, expected_header, sizeof(header)) == 0, "prefijo x, y, w, h en little endian");
+}
+
+int main() {
+    testClamp();
+    testEncodedSize();
+    testTouches();
+    testScale();
+
+    std::printf(" %s\n", failures == 0 ? "Todas las pruebas pasaron" : "Hay pruebas fallidas");
+    return failures == 0 ? 0 : 1;
+}